@@ -35,6 +35,7 @@ void Punctuation::print(std::ostream& os) const {
 	case EndOfSubStream: os << "EndOfSubStream"; break;
 	case WindowExpired: os << "WindowExpired"; break;
 	case SlideExpired: os << "SlideExpired"; break;
+	case Watermark: os << "Watermark(" << mTstamp.count() << ")"; break;
 	default: os << mPtype; break;
 	}
 	os << "|" << /*mData << */ "]";
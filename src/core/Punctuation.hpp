@@ -52,6 +52,9 @@ public:
 																//< given in the mData field
 		TxAbort        = (1u << 6), //< aborting the transaction whose TransactionID is
 																//< given in the mData field
+		Watermark      = (1u << 7), //< the event time has progressed to the timestamp of the
+																//< punctuation, i.e. no tuples with a smaller or equal
+																//< timestamp will follow
 		All            = (~0u),     //< all of the above, used for masking
 	};
 
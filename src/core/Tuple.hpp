@@ -23,6 +23,9 @@
 #include "parser/TupleParser.hpp"
 #include "serialize.hpp"
 #include "ElementSerializable.hpp"
+#ifdef USE_TUPLE_POOL
+#include "TuplePool.hpp"
+#endif
 
 #include <vector>
 #include <iostream>
@@ -259,6 +262,29 @@ public:
 		return static_cast<Base const&>(*this);
 	}
 
+#ifdef USE_TUPLE_POOL
+	/**
+	 * @brief Allocates tuples from the per-thread slab pool of their size class
+	 *        instead of the general purpose heap (see TuplePool).
+	 */
+	static void* operator new(std::size_t sz) {
+		if (alignof(Tuple) > TupleSlabPool::HeaderSize)
+			return ::operator new(sz, std::align_val_t(alignof(Tuple)));
+		return TuplePool<TupleSlabPool::sizeClass(sizeof(Tuple))>::allocate(sz);
+	}
+
+	/**
+	 * @brief Returns the tuple memory to the pool it was allocated from,
+	 *        which may be owned by another thread.
+	 */
+	static void operator delete(void* p) {
+		if (alignof(Tuple) > TupleSlabPool::HeaderSize)
+			::operator delete(p, std::align_val_t(alignof(Tuple)));
+		else
+			TuplePool<TupleSlabPool::sizeClass(sizeof(Tuple))>::deallocate(p);
+	}
+#endif
+
 	/**
 	 * Helper functions for supporting intrusive pointers.
 	 */
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TupleBatch_hpp_
+#define TupleBatch_hpp_
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "core/Tuple.hpp"
+
+namespace pfabric {
+
+/**
+ * @brief A TupleBatch represents a set of tuples in a columnar layout.
+ *
+ * In contrast to the batches produced by the Batcher operator (a vector of
+ * tuple pointers), a TupleBatch stores the values of each attribute in a
+ * separate contiguous column (struct-of-arrays). Null values and outdated
+ * flags are kept in bitmaps / byte vectors next to the columns. This allows
+ * batch-native operators to process predicates and aggregates as tight
+ * loops over the columns.
+ *
+ * Filtering does not copy or compact the columns: instead, a batch may carry
+ * a selection vector containing the (ascending) indexes of the rows which
+ * are still valid. Batches created by @c select share the column data with
+ * the original batch, i.e. columns are immutable once shared.
+ *
+ * @code
+ * TupleBatch<int, double> batch;
+ * batch.append(makeTuplePtr(1, 2.0));
+ * batch.appendRow(std::make_tuple(2, 3.0));
+ * auto s = batch.sum<1>(); // = 5.0
+ * @endcode
+ *
+ * @tparam Types
+ *    the attribute types of the tuples stored in the batch
+ */
+template <typename... Types>
+class TupleBatch {
+public:
+	static const TupleSize NUM_ATTRIBUTES = sizeof...(Types);
+
+	/// the type of a single row of the batch
+	typedef std::tuple<Types...> RowType;
+	/// the tuple type corresponding to a single row of the batch
+	typedef TuplePtr<Types...> TupleType;
+	/// the type for representing the indexes of selected rows
+	typedef std::vector<std::uint32_t> SelectionVector;
+
+	/**
+	 * @brief Meta function returning the type of a specific column.
+	 */
+	template <AttributeIdx ID>
+	struct getAttributeType {
+		typedef typename std::tuple_element<ID, RowType>::type type;
+	};
+
+	/**
+	 * @brief Creates a new empty batch.
+	 *
+	 * @param capacity
+	 *    the number of rows for which memory is reserved in advance
+	 */
+	explicit TupleBatch(std::size_t capacity = 0) : mData(std::make_shared<Columns>()), mSelected(false) {
+		reserve(capacity, std::index_sequence_for<Types...>());
+	}
+
+	/**
+	 * @brief Appends the given tuple (including its null values) to the batch.
+	 *
+	 * @param tp
+	 *    the tuple to be appended
+	 * @param outdated
+	 *    flag indicating whether the tuple is new or invalidated now
+	 */
+	void append(const TupleType& tp, bool outdated = false) {
+		appendRow(tp->data(), outdated);
+		for (AttributeIdx i = 0; i < NUM_ATTRIBUTES; i++)
+			if (tp->isNull(i)) setNull(i, mData->numRows - 1);
+	}
+
+	/**
+	 * @brief Appends a row with the given values to the batch.
+	 *
+	 * @param row
+	 *    the attribute values of the new row
+	 * @param outdated
+	 *    flag indicating whether the row is new or invalidated now
+	 */
+	void appendRow(const RowType& row, bool outdated = false) {
+		assert(!mSelected);
+		makeUnique();
+		appendValues(row, std::index_sequence_for<Types...>());
+		mData->outdated.push_back(outdated ? 1 : 0);
+		mData->anyOutdated |= outdated;
+		mData->numRows++;
+	}
+
+	/**
+	 * @brief Marks the given attribute of the given row as null value.
+	 */
+	void setNull(AttributeIdx col, std::size_t row) {
+		assert(col < NUM_ATTRIBUTES && row < mData->numRows);
+		makeUnique();
+		auto& bitmap = mData->nulls[col];
+		if (bitmap.size() * 64 <= row) bitmap.resize(row / 64 + 1, 0);
+		bitmap[row / 64] |= (std::uint64_t(1) << (row % 64));
+		mData->anyNulls = true;
+	}
+
+	/**
+	 * @brief Returns a new batch sharing the columns with this batch, but
+	 *        restricted to the rows given in the selection vector.
+	 *
+	 * @param sel
+	 *    the ascending list of row indexes which shall be visible in the result
+	 * @return the new batch
+	 */
+	TupleBatch select(SelectionVector&& sel) const {
+		TupleBatch res(*this);
+		res.mSelection = std::move(sel);
+		res.mSelected = true;
+		return res;
+	}
+
+	/**
+	 * @brief Returns the number of physical rows stored in the batch.
+	 */
+	std::size_t numRows() const { return mData->numRows; }
+
+	/**
+	 * @brief Returns the number of (selected) rows visible in the batch.
+	 */
+	std::size_t size() const { return mSelected ? mSelection.size() : mData->numRows; }
+
+	/**
+	 * @brief Returns true if the batch contains no visible rows.
+	 */
+	bool empty() const { return size() == 0; }
+
+	/**
+	 * @brief Returns true if the visible rows are given by a selection vector.
+	 */
+	bool hasSelection() const { return mSelected; }
+
+	/**
+	 * @brief Returns the selection vector (only valid if @c hasSelection() is true).
+	 */
+	const SelectionVector& selection() const { return mSelection; }
+
+	/**
+	 * @brief Returns the index of the i-th visible row.
+	 */
+	std::size_t row(std::size_t i) const { return mSelected ? mSelection[i] : i; }
+
+	/**
+	 * @brief Invokes @c func for the index of each visible row.
+	 *
+	 * @tparam Func
+	 *    a callable with the signature <tt>void (std::size_t)</tt>
+	 */
+	template <typename Func>
+	void forEachRow(Func&& func) const {
+		if (mSelected)
+			for (auto r : mSelection) func(r);
+		else
+			for (std::size_t r = 0, n = mData->numRows; r < n; r++) func(r);
+	}
+
+	/**
+	 * @brief Returns the column (including rows which are not selected) of attribute @c ID.
+	 */
+	template <AttributeIdx ID>
+	const std::vector<typename getAttributeType<ID>::type>& column() const {
+		return std::get<ID>(mData->values);
+	}
+
+	/**
+	 * @brief Returns the value of attribute @c ID in the given (physical) row.
+	 */
+	template <AttributeIdx ID>
+	const typename getAttributeType<ID>::type& value(std::size_t row) const {
+		return std::get<ID>(mData->values)[row];
+	}
+
+	/**
+	 * @brief Checks whether the attribute @c col of the given row contains a null value.
+	 */
+	bool isNull(AttributeIdx col, std::size_t row) const {
+		const auto& bitmap = mData->nulls[col];
+		return row / 64 < bitmap.size() && (bitmap[row / 64] & (std::uint64_t(1) << (row % 64)));
+	}
+
+	/**
+	 * @brief Returns true if the batch contains any null value.
+	 */
+	bool hasNulls() const { return mData->anyNulls; }
+
+	/**
+	 * @brief Checks whether the given row is outdated.
+	 */
+	bool isOutdated(std::size_t row) const { return mData->outdated[row] != 0; }
+
+	/**
+	 * @brief Returns true if the batch contains any outdated row.
+	 */
+	bool hasOutdated() const { return mData->anyOutdated; }
+
+	/**
+	 * @brief Creates a tuple from the given (physical) row.
+	 */
+	TupleType tuple(std::size_t row) const {
+		auto tp = makeTuple(row, std::index_sequence_for<Types...>());
+		if (mData->anyNulls)
+			for (AttributeIdx i = 0; i < NUM_ATTRIBUTES; i++)
+				if (isNull(i, row)) tp->setNull(i);
+		return tp;
+	}
+
+	/**
+	 * @brief Returns the number of visible rows, where outdated rows are
+	 *        counted negatively (analogous to AggrCount).
+	 */
+	long count() const {
+		if (!mData->anyOutdated) return static_cast<long>(size());
+		long cnt = 0;
+		const auto* outdated = mData->outdated.data();
+		forEachRow([&](std::size_t r) { cnt += outdated[r] ? -1 : 1; });
+		return cnt;
+	}
+
+	/**
+	 * @brief Returns the sum of the non-null values of attribute @c ID over
+	 *        all visible rows, where outdated rows are subtracted.
+	 */
+	template <AttributeIdx ID>
+	typename getAttributeType<ID>::type sum() const {
+		typedef typename getAttributeType<ID>::type ValueType;
+		const ValueType* col = std::get<ID>(mData->values).data();
+		ValueType res = ValueType();
+		if (!mSelected && !mData->anyNulls && !mData->anyOutdated) {
+			// the common case: a plain loop which can be vectorized
+			for (std::size_t r = 0, n = mData->numRows; r < n; r++) res += col[r];
+		}
+		else {
+			const auto* outdated = mData->outdated.data();
+			forEachRow([&](std::size_t r) {
+				if (!isNull(ID, r)) res += outdated[r] ? -col[r] : col[r];
+			});
+		}
+		return res;
+	}
+
+private:
+	/// the (shareable) column data of a batch
+	struct Columns {
+		Columns() : numRows(0), anyNulls(false), anyOutdated(false) {}
+
+		std::tuple<std::vector<Types>...> values;                //< a column for each attribute
+		std::array<std::vector<std::uint64_t>, sizeof...(Types)> nulls; //< null bitmaps (created lazily)
+		std::vector<std::uint8_t> outdated;                     //< outdated flag for each row
+		std::size_t numRows;                                     //< the number of rows
+		bool anyNulls, anyOutdated;                              //< summary flags for fast paths
+	};
+
+	void makeUnique() {
+		if (mData.use_count() > 1) mData = std::make_shared<Columns>(*mData);
+	}
+
+	template <std::size_t... Is>
+	void reserve(std::size_t capacity, std::index_sequence<Is...>) {
+		if (capacity == 0) return;
+		(void) std::initializer_list<int>{ (std::get<Is>(mData->values).reserve(capacity), 0)... };
+		mData->outdated.reserve(capacity);
+	}
+
+	template <std::size_t... Is>
+	void appendValues(const RowType& row, std::index_sequence<Is...>) {
+		(void) std::initializer_list<int>{ (std::get<Is>(mData->values).push_back(std::get<Is>(row)), 0)... };
+	}
+
+	template <std::size_t... Is>
+	TupleType makeTuple(std::size_t row, std::index_sequence<Is...>) const {
+		return TupleType(new Tuple<Types...>(std::get<Is>(mData->values)[row]...));
+	}
+
+	std::shared_ptr<Columns> mData; //< the columns, possibly shared with other batches
+	SelectionVector mSelection;     //< the indexes of the visible rows
+	bool mSelected;                 //< true if mSelection is used
+};
+
+/**
+ * @brief The stream element type for columnar batches.
+ */
+template <typename... Types>
+using TupleBatchPtr = TuplePtr<TupleBatch<Types...>>;
+
+/**
+ * @brief Meta function returning the batch types for a given tuple type.
+ *
+ * @tparam StreamElement
+ *    a tuple type (TuplePtr<Types...>)
+ */
+template <typename StreamElement>
+struct TupleBatchTraits;
+
+template <typename... Types>
+struct TupleBatchTraits<TuplePtr<Types...>> {
+	typedef TupleBatch<Types...> BatchType;  //< the columnar batch
+	typedef TupleBatchPtr<Types...> type;    //< the stream element type of the batch
+};
+
+template <typename... Types>
+struct TupleBatchTraits<TupleBatchPtr<Types...>> {
+	typedef TupleBatch<Types...> BatchType;
+	typedef TupleBatchPtr<Types...> type;
+};
+
+/**
+ * @brief Returns the value of attribute @c ID in the given (physical) row of a batch.
+ */
+template <AttributeIdx ID, typename... Types>
+auto get(const TupleBatch<Types...>& batch, std::size_t row) -> decltype(batch.template value<ID>(row)) {
+	return batch.template value<ID>(row);
+}
+
+} /* end namespace pfabric */
+
+#endif /* TupleBatch_hpp_ */
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TuplePool_hpp_
+#define TuplePool_hpp_
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace pfabric {
+
+/**
+ * @brief A slab pool of fixed-size memory cells owned by a single thread.
+ *
+ * The pool carves cells from large slabs using a bump pointer and recycles
+ * freed cells via an intrusive free list. Only the owning thread allocates
+ * from the pool. Cells released by the owner go to the local free list
+ * without any synchronization; cells released by other threads (e.g. after
+ * a tuple was handed over by a Queue) are pushed to a lock-free remote
+ * list which the owner drains as soon as its local list runs empty.
+ *
+ * Each cell starts with a header referring to the owning pool so that a
+ * block can always be returned to the pool it was taken from. Slabs are
+ * never returned to the system: when the owning thread terminates, the
+ * pool is abandoned and later adopted by the next thread requesting a pool
+ * of the same size class.
+ */
+class TupleSlabPool {
+	struct FreeCell { FreeCell* next; };
+
+public:
+	/// alignment of the cells and size of the cell header
+	static constexpr std::size_t HeaderSize = alignof(std::max_align_t);
+	/// the (minimal) number of bytes allocated per slab
+	static constexpr std::size_t SlabBytes = 64 * 1024;
+
+	/**
+	 * @brief Create a new pool for blocks of the given size.
+	 *
+	 * @param blockSize
+	 *    the number of bytes available to the user per block
+	 */
+	explicit TupleSlabPool(std::size_t blockSize) :
+		mCellSize((blockSize + 2 * HeaderSize - 1) / HeaderSize * HeaderSize),
+		mLocalFree(nullptr), mRemoteFree(nullptr), mBump(nullptr), mBumpEnd(nullptr) {}
+
+	TupleSlabPool(const TupleSlabPool&) = delete;
+	TupleSlabPool& operator=(const TupleSlabPool&) = delete;
+
+	/**
+	 * @brief Returns the size class (i.e. the block size) used for blocks of @c size bytes.
+	 */
+	static constexpr std::size_t sizeClass(std::size_t size) {
+		return (size + HeaderSize - 1) / HeaderSize * HeaderSize;
+	}
+
+	/**
+	 * @brief Returns the pool owning the given block or @c nullptr if the
+	 *        block was not taken from a pool.
+	 */
+	static TupleSlabPool* owner(void* block) {
+		return *reinterpret_cast<TupleSlabPool**>(static_cast<char*>(block) - HeaderSize);
+	}
+
+	/**
+	 * @brief Allocates a block of @c size bytes from the system heap which is
+	 *        not owned by any pool but can be released via the same path.
+	 */
+	static void* allocateUnpooled(std::size_t size) {
+		return initCell(static_cast<char*>(::operator new(size + HeaderSize)), nullptr);
+	}
+
+	/**
+	 * @brief Takes a block from the pool. Must be called by the owning thread only.
+	 */
+	void* allocate() {
+		FreeCell* cell = mLocalFree;
+		if (cell == nullptr && mRemoteFree.load(std::memory_order_relaxed) != nullptr)
+			cell = mRemoteFree.exchange(nullptr, std::memory_order_acquire);
+		if (cell != nullptr) {
+			mLocalFree = cell->next;
+			return initCell(reinterpret_cast<char*>(cell), this);
+		}
+		if (mBump == mBumpEnd) allocateSlab();
+		char* mem = mBump;
+		mBump += mCellSize;
+		return initCell(mem, this);
+	}
+
+	/**
+	 * @brief Returns a block to the pool. Must be called by the owning thread only.
+	 */
+	void releaseLocal(void* block) {
+		auto cell = reinterpret_cast<FreeCell*>(static_cast<char*>(block) - HeaderSize);
+		cell->next = mLocalFree;
+		mLocalFree = cell;
+	}
+
+	/**
+	 * @brief Returns a block to the pool from any thread other than the owner.
+	 */
+	void releaseRemote(void* block) {
+		auto cell = reinterpret_cast<FreeCell*>(static_cast<char*>(block) - HeaderSize);
+		FreeCell* head = mRemoteFree.load(std::memory_order_relaxed);
+		do {
+			cell->next = head;
+		} while (!mRemoteFree.compare_exchange_weak(head, cell,
+				std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	/**
+	 * @brief Returns the number of slabs allocated by this pool so far.
+	 */
+	std::size_t numSlabs() const { return mSlabs.size(); }
+
+private:
+	static void* initCell(char* cell, TupleSlabPool* pool) {
+		*reinterpret_cast<TupleSlabPool**>(cell) = pool;
+		return cell + HeaderSize;
+	}
+
+	void allocateSlab() {
+		std::size_t numCells = SlabBytes / mCellSize < 16 ? 16 : SlabBytes / mCellSize;
+		mBump = static_cast<char*>(::operator new(numCells * mCellSize));
+		mBumpEnd = mBump + numCells * mCellSize;
+		mSlabs.push_back(mBump);
+	}
+
+	const std::size_t mCellSize;           //< size of a cell including its header
+	FreeCell* mLocalFree;                  //< cells released by the owner
+	std::atomic<FreeCell*> mRemoteFree;    //< cells released by other threads
+	char* mBump;                           //< next unused cell of the current slab
+	char* mBumpEnd;                        //< end of the current slab
+	std::vector<char*> mSlabs;             //< all slabs allocated by this pool
+};
+
+/**
+ * @brief Per-thread slab allocator for blocks of a given size class.
+ *
+ * TuplePool is used by Tuple's class-specific @c operator @c new and
+ * @c operator @c delete, so every tuple created via @c makeTuplePtr,
+ * @c StreamElementTraits::create or a plain @c new is taken from the
+ * pool of the allocating thread. Each thread lazily creates (or adopts)
+ * one TupleSlabPool per size class.
+ *
+ * @tparam BlockSize
+ *    the size class of the blocks handed out by this allocator
+ */
+template <std::size_t BlockSize>
+class TuplePool {
+public:
+	/**
+	 * @brief Allocates a block of @c size bytes. Requests not matching the
+	 *        size class (e.g. from derived classes) are served by the heap.
+	 */
+	static void* allocate(std::size_t size) {
+		if (size <= BlockSize) {
+			if (TupleSlabPool* pool = tlsPool) return pool->allocate();
+			if (TupleSlabPool* pool = threadPool()) return pool->allocate();
+		}
+		return TupleSlabPool::allocateUnpooled(size);
+	}
+
+	/**
+	 * @brief Releases a block allocated by @c allocate on any thread.
+	 */
+	static void deallocate(void* block) {
+		if (block == nullptr) return;
+		TupleSlabPool* pool = TupleSlabPool::owner(block);
+		if (pool == nullptr)
+			::operator delete(static_cast<char*>(block) - TupleSlabPool::HeaderSize);
+		else if (pool == tlsPool)
+			pool->releaseLocal(block);
+		else
+			pool->releaseRemote(block);
+	}
+
+	/**
+	 * @brief Returns the pool of the calling thread (for diagnostics).
+	 */
+	static const TupleSlabPool* localPool() { return threadPool(); }
+
+private:
+	/// pools of terminated threads waiting for adoption
+	struct Registry {
+		std::mutex mtx;
+		std::vector<TupleSlabPool*> abandoned;
+	};
+
+	/// owns the pool of a thread and abandons it on thread exit
+	struct ThreadHandle {
+		ThreadHandle() {
+			auto& reg = registry();
+			std::lock_guard<std::mutex> guard(reg.mtx);
+			if (reg.abandoned.empty()) {
+				pool = new TupleSlabPool(BlockSize);
+			}
+			else {
+				pool = reg.abandoned.back();
+				reg.abandoned.pop_back();
+			}
+			tlsPool = pool;
+		}
+
+		~ThreadHandle() {
+			tlsPool = nullptr;
+			tlsTerminated = true;
+			auto& reg = registry();
+			std::lock_guard<std::mutex> guard(reg.mtx);
+			reg.abandoned.push_back(pool);
+		}
+
+		TupleSlabPool* pool;
+	};
+
+	static Registry& registry() {
+		// never destroyed: pools may outlive all static objects
+		static Registry* reg = new Registry();
+		return *reg;
+	}
+
+	static TupleSlabPool* threadPool() {
+		// during thread teardown the handle may already be gone
+		if (tlsTerminated) return nullptr;
+		static thread_local ThreadHandle handle;
+		return handle.pool;
+	}
+
+	static thread_local TupleSlabPool* tlsPool;  //< fast path access to the pool
+	static thread_local bool tlsTerminated;      //< true after the handle was destroyed
+};
+
+template <std::size_t BlockSize>
+thread_local TupleSlabPool* TuplePool<BlockSize>::tlsPool = nullptr;
+
+template <std::size_t BlockSize>
+thread_local bool TuplePool<BlockSize>::tlsTerminated = false;
+
+} // namespace pfabric
+
+#endif /* TuplePool_hpp_ */
@@ -23,6 +23,8 @@
 
 #include "qop/DataSink.hpp"
 #include "qop/DataSource.hpp"
+#include "qop/Executor.hpp"
+#include "qop/TimerWheel.hpp"
 
 namespace pfabric {
 
@@ -103,9 +105,50 @@ namespace pfabric {
      */
     std::size_t size() const;
 
+    /**
+     * @brief Sets the executor for running the operators of the dataflow.
+     *
+     * @param exec
+     *    the executor or nullptr if operators should use their own threads
+     */
+    void setExecutor(ExecutorPtr exec) { executor = exec; }
+
+    /**
+     * @brief Returns the executor of the dataflow.
+     *
+     * @return
+     *    the executor or nullptr if no executor is used
+     */
+    ExecutorPtr getExecutor() const { return executor; }
+
+    /**
+     * @brief Sets the timer wheel for running the time-driven operators of the dataflow.
+     *
+     * @param timers
+     *    the timer wheel (e.g. shared by several dataflows)
+     */
+    void setTimerWheel(TimerWheelPtr timers) { timerWheel = timers; }
+
+    /**
+     * @brief Returns the timer wheel of the dataflow.
+     *
+     * If no timer wheel was set, a new one is created which is shared by all
+     * time-driven operators of the dataflow.
+     *
+     * @return
+     *    the timer wheel
+     */
+    TimerWheelPtr getTimerWheel() {
+      if (!timerWheel)
+        timerWheel = std::make_shared<TimerWheel>();
+      return timerWheel;
+    }
+
 private:
   BaseOpList publishers; //< the list of all operators acting as publisher (source)
   BaseOpList sinks;     //< the list of sink operators (which are not publishers)
+  ExecutorPtr executor; //< the executor shared by all operators (if any)
+  TimerWheelPtr timerWheel; //< the timer wheel shared by all time-driven operators
 };
 
 typedef std::shared_ptr<Dataflow> DataflowPtr;
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FusedPipe_hpp_
+#define FusedPipe_hpp_
+
+#include "dsl/Pipe.hpp"
+
+namespace pfabric {
+
+/**
+ * @brief The initial (empty) chain of a FusedPipe which forwards the input unchanged.
+ */
+struct FusedIdentity {
+  template <typename StreamElement, typename Sink>
+  void operator()(const StreamElement& tp, bool outdated, Sink&& sink) const {
+    sink(tp, outdated);
+  }
+};
+
+/**
+ * @brief FusedPipe collects a sequence of stateless operators which are
+ * executed as a single operator.
+ *
+ * A FusedPipe is created by @c Pipe::fuse(). The operators added to a
+ * FusedPipe (@c where, @c map, @c notify) are not instantiated as separate
+ * operators connected via channels, but composed at compile time into a
+ * single callable. @c endFuse() finally adds this chain as one Fused
+ * operator to the dataflow and returns a regular Pipe:
+ *
+ * @code
+ * t->newStreamFrom...
+ *    .fuse()
+ *      .map<T2>([](auto tp, bool outdated) -> T2 { ... })
+ *      .where([](auto tp, bool outdated) { ... })
+ *    .endFuse()
+ *    .print(std::cout);
+ * @endcode
+ *
+ * Because the UDFs are template parameters (and not std::function objects),
+ * the compiler can inline them into the body of the fused operator.
+ *
+ * @tparam Tin
+ *    the input tuple type of the fused chain
+ * @tparam T
+ *    the tuple type produced by the chain so far
+ * @tparam Body
+ *    the type of the composed chain
+ */
+template <typename Tin, typename T, typename Body>
+class FusedPipe {
+ public:
+  /**
+   * @brief Creates a new FusedPipe with the given chain appended to @c pipe.
+   */
+  FusedPipe(const Pipe<Tin>& pipe, Body body) : mPipe(pipe), mBody(body) {}
+
+  /**
+   * @brief Adds a selection to the fused chain.
+   *
+   * @tparam Predicate
+   *    the type of the predicate: <tt>bool (const T&, bool)</tt>
+   * @param[in] pred
+   *    the filter predicate
+   * @return a new FusedPipe
+   */
+  template <typename Predicate>
+  auto where(Predicate pred) {
+    auto body = [b = mBody, pred](const Tin& tp, bool outdated, auto&& sink) {
+      b(tp, outdated, [&](const T& res, bool o) {
+        if (pred(res, o)) sink(res, o);
+      });
+    };
+    return FusedPipe<Tin, T, decltype(body)>(mPipe, body);
+  }
+
+  /**
+   * @brief Adds a projection to the fused chain.
+   *
+   * @tparam Tout
+   *    the result tuple type of the projection
+   * @tparam MapFunc
+   *    the type of the projection function: <tt>Tout (const T&, bool)</tt>
+   * @param[in] func
+   *    the projection function
+   * @return a new FusedPipe
+   */
+  template <typename Tout, typename MapFunc>
+  auto map(MapFunc func) {
+    auto body = [b = mBody, func](const Tin& tp, bool outdated, auto&& sink) {
+      b(tp, outdated, [&](const T& res, bool o) {
+        sink(Tout(func(res, o)), o);
+      });
+    };
+    return FusedPipe<Tin, Tout, decltype(body)>(mPipe, body);
+  }
+
+  /**
+   * @brief Adds a callback to the fused chain which is invoked for each tuple.
+   *
+   * @tparam CallbackFunc
+   *    the type of the callback: <tt>void (const T&, bool)</tt>
+   * @param[in] func
+   *    the callback function
+   * @return a new FusedPipe
+   */
+  template <typename CallbackFunc>
+  auto notify(CallbackFunc func) {
+    auto body = [b = mBody, func](const Tin& tp, bool outdated, auto&& sink) {
+      b(tp, outdated, [&](const T& res, bool o) {
+        func(res, o);
+        sink(res, o);
+      });
+    };
+    return FusedPipe<Tin, T, decltype(body)>(mPipe, body);
+  }
+
+  /**
+   * @brief Closes the fusion scope and adds the chain as a single Fused
+   *        operator to the dataflow.
+   *
+   * @return a new pipe
+   */
+  Pipe<T> endFuse() noexcept(false) {
+    return mPipe.template addFused<T, Body>(mBody);
+  }
+
+ private:
+  Pipe<Tin> mPipe;  //< the pipe to which the fused operator is appended
+  Body mBody;       //< the composed chain
+};
+
+}
+
+#endif
@@ -22,14 +22,18 @@
 
 using namespace pfabric;
 
-PFabricContext::PFabricContext() {
+PFabricContext::PFabricContext() : mTimerWheel(std::make_shared<TimerWheel>()) {
 }
 
 PFabricContext::~PFabricContext() {
 }
 
 PFabricContext::TopologyPtr PFabricContext::createTopology() {
-  return std::make_shared<Topology>();
+  return std::make_shared<Topology>(mExecutor, mTimerWheel);
+}
+
+void PFabricContext::setNumWorkerThreads(unsigned int numThreads) {
+  mExecutor = numThreads > 0 ? std::make_shared<Executor>(numThreads) : nullptr;
 }
 
 TableInfoPtr PFabricContext::getTableInfo(const std::string& tblName) {
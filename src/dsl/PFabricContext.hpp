@@ -65,13 +65,29 @@ public:
    * @brief Creates a topology.
    *
    * Creates a new empty topology which can be used to construct a new
-   * dataflow program.
+   * dataflow program. If worker threads were configured via
+   * @c setNumWorkerThreads, the topology uses the shared executor of the
+   * context. The timers of all topologies are run by a single timer wheel
+   * of the context.
    *
    * @return
    *    a pointer to a new and empty topology object.
    */
   TopologyPtr createTopology();
 
+  /**
+   * @brief Configures a shared executor for all topologies.
+   *
+   * Creates an executor with the given number of worker threads which is used
+   * by all topologies and named streams created afterwards. Queues, partitions
+   * and timers of these topologies are run as tasks on the worker threads instead
+   * of spawning separate threads. A value of 0 disables the executor again.
+   *
+   * @param[in] numThreads
+   *    the number of worker threads
+   */
+  void setNumWorkerThreads(unsigned int numThreads);
+
   /**
    * @brief Creates a new table with the given name and schema.
    *
@@ -217,7 +233,7 @@ public:
    */
   template <typename StreamElement>
   Dataflow::BaseOpPtr createStream(const std::string& streamName) {
-    auto streamOp = std::make_shared<Queue<StreamElement>>();
+    auto streamOp = std::make_shared<Queue<StreamElement>>(mExecutor);
     // TODO: check whether the stream already exists
     mStreamSet[streamName] = streamOp;
     return streamOp;
@@ -228,6 +244,8 @@ private:
 
   std::map<std::string, BaseTablePtr> mTableSet;         //< a dictionary collecting all existing tables
   std::map<std::string, Dataflow::BaseOpPtr> mStreamSet; //< a dictionary collecting all named streams
+  ExecutorPtr mExecutor;                                 //< the executor shared by all topologies (if any)
+  TimerWheelPtr mTimerWheel;                             //< the timer wheel shared by all topologies
 #ifdef SUPPORT_MATRICES
   using BaseMatrixPtr = typename std::shared_ptr<BaseMatrix>;
   std::map<std::string, BaseMatrixPtr> matrixMap;        //< a dictionary collecting all existing matrix
@@ -19,7 +19,9 @@
 #define Pipe_hpp_
 
 #include <string>
+#include <tuple>
 #include <typeinfo>
+#include <utility>
 
 #include <boost/any.hpp>
 
@@ -28,21 +30,31 @@
 #include "dsl/Dataflow.hpp"
 #include "dsl/TopologyException.hpp"
 #include "qop/Aggregation.hpp"
+#include "qop/BandJoin.hpp"
 #include "qop/Barrier.hpp"
+#include "qop/BatchAggregation.hpp"
+#include "qop/BatchMap.hpp"
+#include "qop/BatchWhere.hpp"
 #include "qop/Batcher.hpp"
 #include "qop/ConsoleWriter.hpp"
 #include "qop/DataSink.hpp"
 #include "qop/DataSource.hpp"
 #include "qop/FileWriter.hpp"
+#include "qop/Fused.hpp"
 #include "qop/GroupedAggregation.hpp"
+#include "qop/PartialAggregation.hpp"
 #include "qop/JsonExtractor.hpp"
+#include "qop/KeyedWindow.hpp"
+#include "qop/LookupJoin.hpp"
 #include "qop/Map.hpp"
 #include "qop/Merge.hpp"
+#include "qop/MultiWayJoin.hpp"
 #include "qop/Notify.hpp"
 #include "qop/OperatorMacros.hpp"
 #include "qop/PartitionBy.hpp"
 #include "qop/Queue.hpp"
 #include "qop/SHJoin.hpp"
+#include "qop/SessionWindow.hpp"
 #include "qop/SlidingWindow.hpp"
 #include "qop/StatefulMap.hpp"
 #include "qop/TextFileSource.hpp"
@@ -51,8 +63,12 @@
 #include "qop/TumblingWindow.hpp"
 #include "qop/TupleDeserializer.hpp"
 #include "qop/TupleExtractor.hpp"
+#include "qop/TopK.hpp"
 #include "qop/Tuplifier.hpp"
+#include "qop/WatermarkGenerator.hpp"
 #include "qop/Where.hpp"
+#include "qop/WindowedSHJoin.hpp"
+#include "qop/WindowAggregation.hpp"
 #include "qop/ZMQSink.hpp"
 #include "qop/ScaleJoin.hpp"
 #ifdef SUPPORT_MATRICES
@@ -63,6 +79,9 @@
 
 namespace pfabric {
 
+struct FusedIdentity;
+template <typename Tin, typename T, typename Body> class FusedPipe;
+
 enum PartitioningState {
   NoPartitioning,
   FirstInPartitioning,
@@ -84,6 +103,7 @@ class Pipe {
  private:
   friend class Topology;
   template<typename> friend class Pipe;
+  template<typename, typename, typename> friend class FusedPipe;
 
   PartitioningState partitioningState;
 
@@ -178,10 +198,29 @@ class Pipe {
     return dataflow->addPublisher(op);
   }
 
-  template <typename T2, typename KeyType>
-  OpIterator addJoin(std::vector<std::shared_ptr<SHJoin<T, T2, KeyType>>>& opList,
+  template <typename Tout, typename FusedFunc>
+  Pipe<Tout> addFused(FusedFunc func) noexcept(false) {
+    typedef Fused<T, Tout, FusedFunc> OpType;
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<OpType>(func);
+      auto iter = addPublisher<OpType, DataSource<T>>(op);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<OpType>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<OpType>(func));
+      }
+      auto iter = addPartitionedPublisher<OpType, T>(ops);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    }
+  }
+
+  template <typename T2, typename KeyType, typename JoinOp = SHJoin<T, T2, KeyType>>
+  OpIterator addJoin(std::vector<std::shared_ptr<JoinOp>>& opList,
                                 Pipe<T2>& otherPipe) noexcept(false) {
-    typedef typename std::shared_ptr<SHJoin<T, T2, KeyType>> JoinOpPtr;
+    typedef typename std::shared_ptr<JoinOp> JoinOpPtr;
 
     auto otherOpIt = otherPipe.getPublishers();
 
@@ -194,13 +233,13 @@ class Pipe {
         //connect to left input channels
         partition->connectChannelsForPartition(i,
                                                op->getLeftInputDataChannel(),
-                                               op->getInputPunctuationChannel());
+                                               op->getLeftInputPunctuationChannel());
         //connect to right input channels
         if (otherPipe.partitioningState == NoPartitioning) {
           //other pipe has no partitions
           auto otherOp = castOperator<DataSource<T2>>(otherPipe.getPublisher());
           connectChannels(otherOp->getOutputDataChannel(), op->getRightInputDataChannel());
-          connectChannels(otherOp->getOutputPunctuationChannel(), op->getInputPunctuationChannel());
+          connectChannels(otherOp->getOutputPunctuationChannel(), op->getRightInputPunctuationChannel());
         } else {
           //other pipe has partitions
           auto otherOp = castOperator<DataSource<T2>>(otherOpIt->get());
@@ -210,12 +249,12 @@ class Pipe {
             auto partition2 = castOperator<PartitionBy<T2>>(otherOpIt->get());
             partition2->connectChannelsForPartition(i,
                                                     op->getRightInputDataChannel(),
-                                                    op->getInputPunctuationChannel());
+                                                    op->getRightInputPunctuationChannel());
           } else {
             //only if there are partitions left on the other pipe
             if(otherOpIt != dataflow->publisherEnd()) {
               connectChannels(otherOp->getOutputDataChannel(), op->getRightInputDataChannel());
-              connectChannels(otherOp->getOutputPunctuationChannel(), op->getInputPunctuationChannel());
+              connectChannels(otherOp->getOutputPunctuationChannel(), op->getRightInputPunctuationChannel());
               otherOpIt++;
             }
           }
@@ -228,7 +267,7 @@ class Pipe {
 
         //connect to left input channels
         connectChannels(pOp->getOutputDataChannel(), opList[0]->getLeftInputDataChannel());
-        connectChannels(pOp->getOutputPunctuationChannel(), opList[0]->getInputPunctuationChannel());
+        connectChannels(pOp->getOutputPunctuationChannel(), opList[0]->getLeftInputPunctuationChannel());
 
         //connect to right input channels
         auto otherOp = castOperator<DataSource<T2>>(otherOpIt->get());
@@ -239,14 +278,14 @@ class Pipe {
           for (unsigned int i=0; i<otherPipe.numPartitions; ++i) {
             partition2->connectChannelsForPartition(i,
                                                     opList[0]->getRightInputDataChannel(),
-                                                    opList[0]->getInputPunctuationChannel());
+                                                    opList[0]->getRightInputPunctuationChannel());
           }
         } else {
           for (auto iter = otherPipe.getPublishers(); iter != dataflow->publisherEnd(); iter++) {
             auto otherOp = castOperator<DataSource<T2>>(iter->get());
             if (otherOp->opName() != "BaseOp") {
               connectChannels(otherOp->getOutputDataChannel(), opList[0]->getRightInputDataChannel());
-              connectChannels(otherOp->getOutputPunctuationChannel(), opList[0]->getInputPunctuationChannel());
+              connectChannels(otherOp->getOutputPunctuationChannel(), opList[0]->getRightInputPunctuationChannel());
             }
           }
         }
@@ -256,14 +295,14 @@ class Pipe {
           auto pOp = castOperator<DataSource<T>>(iter->get());
           //connect to left input channels
           connectChannels(pOp->getOutputDataChannel(), opList[i]->getLeftInputDataChannel());
-          connectChannels(pOp->getOutputPunctuationChannel(), opList[i]->getInputPunctuationChannel());
+          connectChannels(pOp->getOutputPunctuationChannel(), opList[i]->getLeftInputPunctuationChannel());
 
           //connect to right input channels
           if (otherPipe.partitioningState == NoPartitioning) {
             //other pipe has no partitions
             auto otherOp = castOperator<DataSource<T2>>(otherPipe.getPublisher());
             connectChannels(otherOp->getOutputDataChannel(), opList[i]->getRightInputDataChannel());
-            connectChannels(otherOp->getOutputPunctuationChannel(), opList[i]->getInputPunctuationChannel());
+            connectChannels(otherOp->getOutputPunctuationChannel(), opList[i]->getRightInputPunctuationChannel());
           } else {
             //other pipe has partitions
             auto otherOp = castOperator<DataSource<T2>>(otherOpIt->get());
@@ -273,12 +312,12 @@ class Pipe {
               auto partition2 = castOperator<PartitionBy<T2>>(otherOpIt->get());
               partition2->connectChannelsForPartition(i,
                                                       opList[i]->getRightInputDataChannel(),
-                                                      opList[i]->getInputPunctuationChannel());
+                                                      opList[i]->getRightInputPunctuationChannel());
             } else {
               //only if there are partitions left on the other pipe
               if(otherOpIt != dataflow->publisherEnd()) {
                 connectChannels(otherOp->getOutputDataChannel(), opList[i]->getRightInputDataChannel());
-                connectChannels(otherOp->getOutputPunctuationChannel(), opList[i]->getInputPunctuationChannel());
+                connectChannels(otherOp->getOutputPunctuationChannel(), opList[i]->getRightInputPunctuationChannel());
                 otherOpIt++;
               }
             }
@@ -291,6 +330,22 @@ class Pipe {
     return dataflow->addPublisherList(bops);
   }
 
+  /**
+   * @brief Checks whether the last operator is a FIFO sliding window.
+   *
+   * The window itself reports whether its outdated tuples are published in
+   * the same order as the tuples were inserted (see
+   * SlidingWindow::evictsInInsertionOrder).
+   *
+   * @return true if the publisher of this pipe is a FIFO sliding window
+   */
+  bool isFifoWindow() {
+    if (partitioningState != NoPartitioning || tailIter == dataflow->publisherEnd())
+      return false;
+    auto win = std::dynamic_pointer_cast<SlidingWindow<T>>(getPublisher());
+    return win && win->evictsInInsertionOrder();
+  }
+
   template <typename Publisher, typename StreamElement>
   OpIterator addPartitionedPublisher(std::vector<std::shared_ptr<Publisher>>&
                                          opList) noexcept(false) {
@@ -320,6 +375,35 @@ class Pipe {
     return dataflow->addPublisherList(bops);
   }
 
+  /**
+   * @brief Returns the key extractor of the given pipe for a multi-way join.
+   */
+  template <typename KeyType, typename T2>
+  static std::function<KeyType(const T2&)> multiJoinKeyExtractor(Pipe<T2>& pipe) noexcept(false) {
+    try {
+      return boost::any_cast<std::function<KeyType(const T2&)>>(pipe.keyExtractor);
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException("No KeyExtractor defined for multiJoin.");
+    }
+  }
+
+  /**
+   * @brief Connects the publishers of the given pipes to the inputs of a multi-way join.
+   */
+  template <typename JoinOp, typename PipeTuple, std::size_t... Is>
+  static void connectMultiJoinInputs(const std::shared_ptr<JoinOp>& op, PipeTuple& pipes,
+                                     std::index_sequence<Is...>) {
+    (connectMultiJoinInput<Is>(op, std::get<Is>(pipes)), ...);
+  }
+
+  template <std::size_t I, typename JoinOp, typename T2>
+  static void connectMultiJoinInput(const std::shared_ptr<JoinOp>& op, Pipe<T2>& pipe) {
+    auto pOp = pipe.template castOperator<DataSource<T2>>(pipe.getPublisher());
+    auto input = op->template getInput<I>();
+    connectChannels(pOp->getOutputDataChannel(), input->getInputDataChannel());
+    connectChannels(pOp->getOutputPunctuationChannel(), input->getInputPunctuationChannel());
+  }
+
  public:
   /**
    * @brief Destructor of the pipe.
@@ -418,6 +502,51 @@ class Pipe {
       partitioningState, numPartitions);
   }
 
+  /**
+   * @brief Creates an operator generating watermarks as the next operator on the pipe.
+   *
+   * Creates an operator which publishes Watermark punctuations derived from the
+   * timestamps defined by @c assignTimestamps. A watermark lags behind the
+   * largest timestamp seen so far by the allowed lateness, thus tuples may arrive
+   * out of order within this bound. Tuples delayed even more are dropped.
+   * Subsequent range windows and aggregates triggered by timestamps use
+   * the watermarks as clock.
+   *
+   * @tparam T
+   *      the input tuple type (usually a TuplePtr) for the operator.
+   * @param[in] lateness
+   *      the allowed lateness of out-of-order tuples (in milliseconds)
+   * @param[in] interval
+   *      the minimal progress of the watermark between two punctuations
+   *      (in milliseconds)
+   * @return a new pipe
+   */
+  Pipe<T> assignWatermarks(const unsigned int lateness, const unsigned int interval = 0) noexcept(false) {
+    typedef typename WatermarkGenerator<T>::TimestampExtractorFunc ExtractorFunc;
+    try {
+      auto fn = boost::any_cast<ExtractorFunc>(timestampExtractor);
+      const auto late = std::chrono::duration_cast<Timestamp>(std::chrono::milliseconds(lateness));
+      const auto ival = std::chrono::duration_cast<Timestamp>(std::chrono::milliseconds(interval));
+
+      if (partitioningState == NoPartitioning) {
+        auto op = std::make_shared<WatermarkGenerator<T>>(fn, late, ival);
+        auto iter = addPublisher<WatermarkGenerator<T>, DataSource<T>>(op);
+        return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                       partitioningState, numPartitions);
+      } else {
+        std::vector<std::shared_ptr<WatermarkGenerator<T>>> ops;
+        for (auto i = 0u; i < numPartitions; i++) {
+          ops.push_back(std::make_shared<WatermarkGenerator<T>>(fn, late, ival));
+        }
+        auto iter = addPartitionedPublisher<WatermarkGenerator<T>, T>(ops);
+        return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                       partitioningState, numPartitions);
+      }
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException("No TimestampExtractor defined for assignWatermarks.");
+    }
+  }
+
   /**
    * @brief Creates a sliding window operator as the next operator on the pipe.
    *
@@ -453,9 +582,11 @@ class Pipe {
         if (wt == WindowParams::RangeWindow) {
           // a range window requires a timestamp extractor
           fn = boost::any_cast<ExtractorFunc>(timestampExtractor);
-          op = std::make_shared<SlidingWindow<T>>(fn, wt, sz, windowFunc, ei);
+          op = std::make_shared<SlidingWindow<T>>(fn, wt, sz, windowFunc, ei, dataflow->getExecutor(),
+            dataflow->getTimerWheel());
         } else
-          op = std::make_shared<SlidingWindow<T>>(wt, sz, windowFunc, ei);
+          op = std::make_shared<SlidingWindow<T>>(wt, sz, windowFunc, ei, dataflow->getExecutor(),
+            dataflow->getTimerWheel());
         auto iter = addPublisher<SlidingWindow<T>, DataSource<T>>(op);
         return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
                        partitioningState, numPartitions);
@@ -465,11 +596,13 @@ class Pipe {
           // a range window requires a timestamp extractor
           fn = boost::any_cast<ExtractorFunc>(timestampExtractor);
           for (auto i = 0u; i < numPartitions; i++) {
-            ops.push_back(std::make_shared<SlidingWindow<T>>(fn, wt, sz, windowFunc, ei));
+            ops.push_back(std::make_shared<SlidingWindow<T>>(fn, wt, sz, windowFunc, ei, dataflow->getExecutor(),
+              dataflow->getTimerWheel()));
           }
         } else {
           for (auto i = 0u; i < numPartitions; i++) {
-            ops.push_back(std::make_shared<SlidingWindow<T>>(wt, sz, windowFunc, ei));
+            ops.push_back(std::make_shared<SlidingWindow<T>>(wt, sz, windowFunc, ei, dataflow->getExecutor(),
+              dataflow->getTimerWheel()));
           }
         }
         auto iter = addPartitionedPublisher<SlidingWindow<T>, T>(ops);
@@ -497,11 +630,17 @@ class Pipe {
    *      milliseconds for range windows)
    * @param[in] windowFunc
    *      optional function applied on each incoming tuple
+   * @param[in] mode
+   *      the way the end of a window is signaled: either by publishing all
+   *      tuples as outdated (ExpireTuples) or only by a WindowExpired
+   *      punctuation (ExpireBoundary) which is sufficient if the window
+   *      feeds an aggregate
    * @return a new pipe
    */
   Pipe<T> tumblingWindow(const WindowParams::WinType& wt,
                          const unsigned int sz,
-                         typename Window<T>::WindowOpFunc windowFunc = nullptr) noexcept(false) {
+                         typename Window<T>::WindowOpFunc windowFunc = nullptr,
+                         WindowParams::ExpiryMode mode = WindowParams::ExpireTuples) noexcept(false) {
     typedef typename Window<T>::TimestampExtractorFunc ExtractorFunc;
     ExtractorFunc fn;
 
@@ -512,9 +651,9 @@ class Pipe {
         if (wt == WindowParams::RangeWindow) {
           // a range window requires a timestamp extractor
           fn = boost::any_cast<ExtractorFunc>(timestampExtractor);
-          op = std::make_shared<TumblingWindow<T>>(fn, wt, sz, windowFunc);
+          op = std::make_shared<TumblingWindow<T>>(fn, wt, sz, windowFunc, mode);
         } else
-          op = std::make_shared<TumblingWindow<T>>(wt, sz, windowFunc);
+          op = std::make_shared<TumblingWindow<T>>(wt, sz, windowFunc, mode);
         auto iter = addPublisher<TumblingWindow<T>, DataSource<T>>(op);
         return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
                        partitioningState, numPartitions);
@@ -524,11 +663,11 @@ class Pipe {
           // a range window requires a timestamp extractor
           fn = boost::any_cast<ExtractorFunc>(timestampExtractor);
           for (auto i = 0u; i < numPartitions; i++) {
-            ops.push_back(std::make_shared<TumblingWindow<T>>(fn, wt, sz, windowFunc));
+            ops.push_back(std::make_shared<TumblingWindow<T>>(fn, wt, sz, windowFunc, mode));
           }
         } else {
           for (auto i = 0u; i < numPartitions; i++) {
-            ops.push_back(std::make_shared<TumblingWindow<T>>(wt, sz, windowFunc));
+            ops.push_back(std::make_shared<TumblingWindow<T>>(wt, sz, windowFunc, mode));
           }
         }
         auto iter = addPartitionedPublisher<TumblingWindow<T>, T>(ops);
@@ -541,6 +680,120 @@ class Pipe {
     }
   }
 
+  /**
+   * @brief Creates a sliding window per key as the next operator on the pipe.
+   *
+   * Creates a window operator which keeps a separate sliding window of the given
+   * type and size for each key defined by @c keyBy, e.g. the last N readings per
+   * sensor. As for @c slidingWindow, tuples leaving the window of their key are
+   * published as outdated. The state for idle keys can be bounded by a maximum
+   * number of keys (least recently used keys are evicted first) and by a
+   * time-to-live. A range window or a time-to-live requires a timestamp extractor
+   * defined by @c assignTimestamps.
+   *
+   * @tparam KeyType
+   *      the data type of the keys
+   * @param[in] wt
+   *      the type of the window (range or row)
+   * @param[in] sz
+   *      the window size per key (seconds or number of tuples)
+   * @param[in] maxKeys
+   *      the maximum number of keys kept (0 = unbounded)
+   * @param[in] ttl
+   *      the time (in seconds) after which an idle key is evicted (0 = never)
+   * @return a new pipe
+   */
+  template <typename KeyType = DefaultKeyType>
+  Pipe<T> keyedWindow(const WindowParams::WinType& wt, const unsigned int sz,
+                      const std::size_t maxKeys = 0, const unsigned int ttl = 0) noexcept(false) {
+    typedef typename KeyedWindow<T, KeyType>::KeyExtractorFunc KeyExtractorFunc;
+    typedef typename KeyedWindow<T, KeyType>::TimestampExtractorFunc ExtractorFunc;
+    KeyExtractorFunc keyFunc;
+    ExtractorFunc fn;
+
+    try {
+      keyFunc = boost::any_cast<KeyExtractorFunc>(keyExtractor);
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException("No KeyExtractor defined for keyedWindow.");
+    }
+    if (wt == WindowParams::RangeWindow || ttl > 0) {
+      try {
+        fn = boost::any_cast<ExtractorFunc>(timestampExtractor);
+      } catch (const boost::bad_any_cast& e) {
+        throw TopologyException("No TimestampExtractor defined for keyedWindow.");
+      }
+    }
+
+    auto makeOp = [&]() {
+      if (fn != nullptr)
+        return std::make_shared<KeyedWindow<T, KeyType>>(keyFunc, fn, wt, sz, maxKeys, ttl);
+      return std::make_shared<KeyedWindow<T, KeyType>>(keyFunc, wt, sz, maxKeys);
+    };
+
+    if (partitioningState == NoPartitioning) {
+      auto op = makeOp();
+      auto iter = addPublisher<KeyedWindow<T, KeyType>, DataSource<T>>(op);
+      return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                     partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<KeyedWindow<T, KeyType>>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(makeOp());
+      }
+      auto iter = addPartitionedPublisher<KeyedWindow<T, KeyType>, T>(ops);
+      return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                     partitioningState, numPartitions);
+    }
+  }
+
+  /**
+   * @brief Creates a session window operator as the next operator on the pipe.
+   *
+   * Creates a window operator which groups the tuples of each key (defined by
+   * @c keyBy) into sessions separated by a gap of inactivity. The tuples of a
+   * session are published as outdated as soon as the session is closed.
+   * The window requires a timestamp extractor defined by @c assignTimestamps.
+   *
+   * @tparam KeyType
+   *      the data type of the keys for identifying sessions
+   * @param[in] gap
+   *      the minimal gap of inactivity between two sessions (in seconds)
+   * @return a new pipe
+   */
+  template <typename KeyType = DefaultKeyType>
+  Pipe<T> sessionWindow(const unsigned int gap) noexcept(false) {
+    typedef typename SessionWindow<T, KeyType>::KeyExtractorFunc KeyExtractorFunc;
+    typedef typename SessionWindow<T, KeyType>::TimestampExtractorFunc ExtractorFunc;
+    KeyExtractorFunc keyFunc;
+    ExtractorFunc fn;
+
+    try {
+      keyFunc = boost::any_cast<KeyExtractorFunc>(keyExtractor);
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException("No KeyExtractor defined for sessionWindow.");
+    }
+    try {
+      fn = boost::any_cast<ExtractorFunc>(timestampExtractor);
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException("No TimestampExtractor defined for sessionWindow.");
+    }
+
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<SessionWindow<T, KeyType>>(keyFunc, fn, gap);
+      auto iter = addPublisher<SessionWindow<T, KeyType>, DataSource<T>>(op);
+      return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                     partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<SessionWindow<T, KeyType>>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<SessionWindow<T, KeyType>>(keyFunc, fn, gap));
+      }
+      auto iter = addPartitionedPublisher<SessionWindow<T, KeyType>, T>(ops);
+      return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                     partitioningState, numPartitions);
+    }
+  }
+
   /**
    * @brief Creates a print operator (ConsoleWriter) with an optional
    * user-defined formatting function
@@ -762,6 +1015,213 @@ class Pipe {
     }
   }
 
+  /*---------------------- columnar batches ---------------------*/
+
+  /**
+   * @brief Creates an operator gathering tuples into columnar batches.
+   *
+   * Creates a ColumnBatcher which copies the attribute values of incoming tuples
+   * into the columns of a TupleBatch and forwards the batch when @c bsize tuples
+   * were collected (or when a punctuation arrives). The resulting batches can be
+   * processed by the batch-native operators @c whereBatch, @c mapBatch,
+   * @c aggregateBatch and @c groupByBatch.
+   *
+   * @param[in] bsize
+   *      the number of tuples per batch
+   * @return a new pipe
+   */
+  Pipe<typename TupleBatchTraits<T>::type> batchColumns(size_t bsize) noexcept(false) {
+    typedef typename TupleBatchTraits<T>::type Tout;
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<ColumnBatcher<T>>(bsize);
+      auto iter = addPublisher<ColumnBatcher<T>, DataSource<T>>(op);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<ColumnBatcher<T>>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<ColumnBatcher<T>>(bsize));
+      }
+      auto iter = addPartitionedPublisher<ColumnBatcher<T>, T>(ops);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    }
+  }
+
+  /**
+   * @brief Creates an operator converting columnar batches back into tuples.
+   *
+   * Creates a ColumnUnBatcher which forwards a tuple for each visible row of
+   * the incoming TupleBatches.
+   *
+   * @return a new pipe
+   */
+  Pipe<typename TupleBatchTraits<T>::BatchType::TupleType> unbatchColumns() noexcept(false) {
+    typedef typename TupleBatchTraits<T>::BatchType::TupleType Tout;
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<ColumnUnBatcher<T>>();
+      auto iter = addPublisher<ColumnUnBatcher<T>, DataSource<T>>(op);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<ColumnUnBatcher<T>>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<ColumnUnBatcher<T>>());
+      }
+      auto iter = addPartitionedPublisher<ColumnUnBatcher<T>, T>(ops);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    }
+  }
+
+  /**
+   * @brief Creates a batch-native filter operator.
+   *
+   * Creates a BatchWhere operator which evaluates the predicate on all rows of
+   * the incoming TupleBatches and forwards the batches restricted to the
+   * qualifying rows (via a selection vector).
+   *
+   * @code
+   * t->newStreamFrom...
+   *    .batchColumns(1024)
+   *    .whereBatch([](const auto& batch, std::size_t row) {
+   *        return get<0>(batch, row) % 2 == 0; })
+   * @endcode
+   *
+   * @tparam Predicate
+   *      the type of the predicate: <tt>bool (const TupleBatch<...>&, std::size_t)</tt>
+   * @param[in] pred
+   *      the filter predicate evaluated for each row
+   * @return a new pipe
+   */
+  template <typename Predicate>
+  Pipe<T> whereBatch(Predicate pred) noexcept(false) {
+    typedef BatchWhere<T, Predicate> OpType;
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<OpType>(pred);
+      auto iter = addPublisher<OpType, DataSource<T>>(op);
+      return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                     partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<OpType>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<OpType>(pred));
+      }
+      auto iter = addPartitionedPublisher<OpType, T>(ops);
+      return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                     partitioningState, numPartitions);
+    }
+  }
+
+  /**
+   * @brief Creates a batch-native projection operator.
+   *
+   * Creates a BatchMap operator which applies the projection function to all
+   * rows of the incoming TupleBatches and produces new batches of type @c Tout.
+   *
+   * @tparam Tout
+   *      the result batch type (a TupleBatchPtr)
+   * @tparam MapFunc
+   *      the type of the projection function:
+   *      <tt>std::tuple<...> (const TupleBatch<...>&, std::size_t)</tt>
+   * @param[in] func
+   *      the projection function invoked for each row
+   * @return a new pipe
+   */
+  template <typename Tout, typename MapFunc>
+  Pipe<Tout> mapBatch(MapFunc func) noexcept(false) {
+    typedef BatchMap<T, Tout, MapFunc> OpType;
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<OpType>(func);
+      auto iter = addPublisher<OpType, DataSource<T>>(op);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<OpType>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<OpType>(func));
+      }
+      auto iter = addPartitionedPublisher<OpType, T>(ops);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    }
+  }
+
+  /**
+   * @brief Creates a batch-native aggregation operator.
+   *
+   * Creates a BatchAggregation operator which updates the aggregation state
+   * once per incoming TupleBatch and publishes the aggregate after each batch.
+   *
+   * @tparam Tout
+   *      the result tuple type (usually a TuplePtr) for the operator.
+   * @tparam AggrState
+   *      the (default constructible) type of the aggregation state
+   * @param[in] iterFun
+   *      the function updating the state: <tt>void (const TupleBatch<...>&, AggrState&)</tt>
+   * @param[in] finalFun
+   *      the function producing the result: <tt>Tout (const AggrState&)</tt>
+   * @return a new pipe
+   */
+  template <typename Tout, typename AggrState, typename IterateFunc, typename FinalFunc>
+  Pipe<Tout> aggregateBatch(IterateFunc iterFun, FinalFunc finalFun) noexcept(false) {
+    typedef BatchAggregation<T, Tout, AggrState, IterateFunc, FinalFunc> OpType;
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<OpType>(iterFun, finalFun);
+      auto iter = addPublisher<OpType, DataSource<T>>(op);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<OpType>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<OpType>(iterFun, finalFun));
+      }
+      auto iter = addPartitionedPublisher<OpType, T>(ops);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    }
+  }
+
+  /**
+   * @brief Creates a batch-native grouped aggregation operator.
+   *
+   * Creates a BatchGroupedAggregation operator which groups the rows of the
+   * incoming TupleBatches by column @c KeyID and publishes the aggregates of
+   * all groups updated by a batch.
+   *
+   * @tparam KeyID
+   *      the index of the column used as grouping key
+   * @tparam Tout
+   *      the result tuple type (usually a TuplePtr) for the operator.
+   * @tparam AggrState
+   *      the (default constructible) type of the aggregation state of a group
+   * @param[in] iterFun
+   *      the function updating the state of a group with a row:
+   *      <tt>void (const TupleBatch<...>&, std::size_t, AggrState&)</tt>
+   * @param[in] finalFun
+   *      the function producing the result of a group:
+   *      <tt>Tout (const KeyType&, const AggrState&)</tt>
+   * @return a new pipe
+   */
+  template <AttributeIdx KeyID, typename Tout, typename AggrState, typename IterateFunc, typename FinalFunc>
+  Pipe<Tout> groupByBatch(IterateFunc iterFun, FinalFunc finalFun) noexcept(false) {
+    typedef BatchGroupedAggregation<T, Tout, AggrState, KeyID, IterateFunc, FinalFunc> OpType;
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<OpType>(iterFun, finalFun);
+      auto iter = addPublisher<OpType, DataSource<T>>(op);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<OpType>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<OpType>(iterFun, finalFun));
+      }
+      auto iter = addPartitionedPublisher<OpType, T>(ops);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    }
+  }
+
   /**
    * @brief
    *
@@ -822,6 +1282,59 @@ class Pipe {
     }
   }
 
+  /**
+   * @brief Creates a filter operator for selecting tuples.
+   *
+   * In contrast to the other @c where method, the predicate is not converted
+   * into a std::function but stored by value in the Where operator. Thus, the
+   * compiler can inline the predicate (e.g. a lambda) into the operator.
+   *
+   * @tparam Predicate
+   *      the type of the predicate: <tt>bool (const T&, bool)</tt>
+   * @param[in] pred
+   *      a function object or lambda function implementing a predicate.
+   * @return a new pipe
+   */
+  template <typename Predicate>
+  Pipe<T> where(Predicate pred) noexcept(false) {
+    typedef Where<T, Predicate> OpType;
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<OpType>(pred);
+      auto iter = addPublisher<OpType, DataSource<T>>(op);
+      return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                     partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<OpType>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<OpType>(pred));
+      }
+      auto iter = addPartitionedPublisher<OpType, T>(ops);
+      return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                     partitioningState, numPartitions);
+    }
+  }
+
+  /**
+   * @brief Opens a scope for fusing a sequence of stateless operators.
+   *
+   * The operators added to the returned FusedPipe (where, map, notify) are
+   * composed into a single Fused operator which is added to the dataflow
+   * by calling @c endFuse():
+   *
+   * @code
+   * t->newStreamFrom...
+   *    .fuse()
+   *      .where([](auto tp, bool outdated) { return get<0>(tp) % 2 == 0; })
+   *      .map<T2>([](auto tp, bool outdated) -> T2 { ... })
+   *    .endFuse()
+   * @endcode
+   *
+   * @return a new FusedPipe
+   */
+  FusedPipe<T, T, FusedIdentity> fuse() {
+    return FusedPipe<T, T, FusedIdentity>(*this, FusedIdentity());
+  }
+
   /**
     * @brief Creates a notify operator for passing stream tuples to a callback
    * function.
@@ -867,21 +1380,25 @@ class Pipe {
    * dataflow. The upstream part inserts tuples into the queue which is
    * processed by a separate thread to retrieve tuples from the queue and sent
    * them downstream. In this way, the upstream part is not blocked anymore.
+   * If a capacity is given, a lock-free bounded ring buffer is used instead
+   * of the unbounded mutex-based queue.
    *
    * @tparam T
    *      the input tuple type (usually a TuplePtr) for the operator.
+   * @param capacity
+   *      the capacity of the ring buffer or 0 for an unbounded queue
    * @return a new pipe
    */
-  Pipe<T> queue() noexcept(false) {
+  Pipe<T> queue(std::size_t capacity = 0) noexcept(false) {
     if (partitioningState == NoPartitioning) {
-      auto op = std::make_shared<Queue<T>>();
+      auto op = std::make_shared<Queue<T>>(dataflow->getExecutor(), capacity);
       auto iter = addPublisher<Queue<T>, DataSource<T>>(op);
       return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
                      partitioningState, numPartitions);
     } else {
       std::vector<std::shared_ptr<Queue<T>>> ops;
       for (auto i = 0u; i < numPartitions; i++) {
-        ops.push_back(std::make_shared<Queue<T>>());
+        ops.push_back(std::make_shared<Queue<T>>(dataflow->getExecutor(), capacity));
       }
       auto iter = addPartitionedPublisher<Queue<T>, T>(ops);
       return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
@@ -948,11 +1465,48 @@ class Pipe {
     }
   }
 
+  /**
+   * @brief Creates a projection operator.
+   *
+   * In contrast to the other @c map method, the projection function is not
+   * converted into a std::function but stored by value in the Map operator.
+   * Thus, the compiler can inline the function (e.g. a lambda) into the operator.
+   *
+   * @tparam Tout
+   *      the result tuple type (usually a TuplePtr) for the operator.
+   * @tparam MapFunc
+   *      the type of the projection function: <tt>Tout (const T&, bool)</tt>
+   * @param[in] func
+   *      a function object or lambda function creating a new tuple of type
+   *      @c Tout from the input tuple
+   * @return new pipe
+   */
+  template <typename Tout, typename MapFunc,
+            typename = typename std::enable_if<
+              !std::is_same<MapFunc, typename Map<T, Tout>::MapFunc>::value>::type>
+  Pipe<Tout> map(MapFunc func) noexcept(false) {
+    typedef Map<T, Tout, MapFunc> OpType;
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<OpType>(func);
+      auto iter = addPublisher<OpType, DataSource<T>>(op);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<OpType>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<OpType>(func));
+      }
+      auto iter = addPartitionedPublisher<OpType, T>(ops);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    }
+  }
+
   template <typename Tout>
   Pipe<Tout> tuplify(const std::initializer_list<std::string>& predList, TuplifierParams::TuplifyMode m,
       unsigned int ws = 0) noexcept(false) {
     if (partitioningState == NoPartitioning) {
-      auto op = std::make_shared<Tuplifier<T, Tout>>(predList, m, ws);
+      auto op = std::make_shared<Tuplifier<T, Tout>>(predList, m, ws, dataflow->getExecutor(), dataflow->getTimerWheel());
       auto iter = addPublisher<Tuplifier<T, Tout>, DataSource<T>>(op);
       return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
                         partitioningState, numPartitions);
@@ -960,7 +1514,8 @@ class Pipe {
     } else {
       std::vector<std::shared_ptr<Tuplifier<T, Tout>>> ops;
       for (auto i = 0u; i < numPartitions; i++) {
-        ops.push_back(std::make_shared<Tuplifier<T, Tout>>(predList, m, ws));
+        ops.push_back(std::make_shared<Tuplifier<T, Tout>>(predList, m, ws, dataflow->getExecutor(),
+          dataflow->getTimerWheel()));
       }
       auto iter = addPartitionedPublisher<Tuplifier<T, Tout>, T>(ops);
       return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
@@ -1045,6 +1600,12 @@ class Pipe {
       AggregationTriggerType tType = TriggerAll,
       const unsigned int tInterval = 0) noexcept(false) {
     static_assert(typename AggrStateTraits<AggrState>::type(), "aggregate requires an AggrState class");
+    typedef typename WindowedAggrState<AggrState>::type WindowedState;
+    if (!std::is_same<AggrState, WindowedState>::value && isFifoWindow()) {
+      // use the aggregate functions specialized for FIFO sliding windows
+      return aggregate<typename AggrState::ResultTypePtr, WindowedState>(WindowedState::finalize,
+                                      WindowedState::iterate, tType, tInterval);
+    }
     return aggregate<typename AggrState::ResultTypePtr, AggrState>(AggrState::finalize, AggrState::iterate,
                                       tType, tInterval);
   }
@@ -1132,7 +1693,7 @@ class Pipe {
       const unsigned int tInterval = 0) noexcept(false) {
     if (partitioningState == NoPartitioning) {
       auto op = std::make_shared<Aggregation<T, Tout, AggrState>>(
-          state, finalFun, iterFun, tType, tInterval);
+          state, finalFun, iterFun, tType, tInterval, dataflow->getExecutor(), dataflow->getTimerWheel());
       auto iter =
           addPublisher<Aggregation<T, Tout, AggrState>, DataSource<T>>(op);
       return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
@@ -1141,7 +1702,7 @@ class Pipe {
       std::vector<std::shared_ptr<Aggregation<T, Tout, AggrState>>> ops;
       for (auto i = 0u; i < numPartitions; i++) {
         ops.push_back(std::make_shared<Aggregation<T, Tout, AggrState>>(
-            state, finalFun, iterFun, tType, tInterval));
+            state, finalFun, iterFun, tType, tInterval, dataflow->getExecutor(), dataflow->getTimerWheel()));
       }
       auto iter =
           addPartitionedPublisher<Aggregation<T, Tout, AggrState>, T>(ops);
@@ -1173,12 +1734,13 @@ class Pipe {
    * @return a new pipe
    */
   template <typename AggrState,
-            typename KeyType = DefaultKeyType>
+            typename KeyType = DefaultKeyType,
+            typename KeyHash = boost::hash<KeyType>>
   Pipe<typename AggrState::ResultTypePtr> groupBy(
       AggregationTriggerType tType = TriggerAll,
       const unsigned int tInterval = 0) noexcept(false) {
     static_assert(typename AggrStateTraits<AggrState>::type(), "groupBy requires an AggrState class");
-    return groupBy<typename AggrState::ResultTypePtr, AggrState, KeyType>(
+    return groupBy<typename AggrState::ResultTypePtr, AggrState, KeyType, KeyHash>(
         AggrState::finalize, AggrState::iterateForKey, tType, tInterval);
   }
 
@@ -1201,6 +1763,8 @@ class Pipe {
    *      @c Aggregator1 ... @c AggregatorN which can be used directly here.
    * @tparam KeyType
    *      the data type for representing keys (grouping values)
+   * @tparam KeyHash
+   *      the hash function for the keys (default: boost::hash)
    * @param[in] aggrStatePtr
    *      an instance of the AggrState class which is used as prototype
    * @param[in] finalFun
@@ -1216,14 +1780,15 @@ class Pipe {
    * @return a new pipe
    */
   template <typename Tout, typename AggrState,
-            typename KeyType = DefaultKeyType>
+            typename KeyType = DefaultKeyType,
+            typename KeyHash = boost::hash<KeyType>>
   Pipe<Tout> groupBy(
       typename AggrState::AggrStatePtr& state,
-      typename GroupedAggregation<T, Tout, AggrState, KeyType>::FactoryFunc
+      typename GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>::FactoryFunc
           createFun,
-      typename GroupedAggregation<T, Tout, AggrState, KeyType>::FinalFunc
+      typename GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>::FinalFunc
           finalFun,
-      typename GroupedAggregation<T, Tout, AggrState, KeyType>::IterateFunc
+      typename GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>::IterateFunc
           iterFun,
       AggregationTriggerType tType = TriggerAll,
       const unsigned int tInterval = 0) noexcept(false) {
@@ -1234,24 +1799,26 @@ class Pipe {
 
       if (partitioningState == NoPartitioning) {
         auto op =
-            std::make_shared<GroupedAggregation<T, Tout, AggrState, KeyType>>(
-                state, createFun, keyFunc, finalFun, iterFun, tType, tInterval);
+            std::make_shared<GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>>(
+                state, createFun, keyFunc, finalFun, iterFun, tType, tInterval, dataflow->getExecutor(),
+                  dataflow->getTimerWheel());
         auto iter =
-            addPublisher<GroupedAggregation<T, Tout, AggrState, KeyType>,
+            addPublisher<GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>,
                          DataSource<T>>(op);
         return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
                           partitioningState, numPartitions);
       } else {
         std::vector<
-            std::shared_ptr<GroupedAggregation<T, Tout, AggrState, KeyType>>>
+            std::shared_ptr<GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>>>
             ops;
         for (auto i = 0u; i < numPartitions; i++) {
           ops.push_back(
-              std::make_shared<GroupedAggregation<T, Tout, AggrState, KeyType>>(
-                  state, createFun, keyFunc, finalFun, iterFun, tType, tInterval));
+              std::make_shared<GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>>(
+                  state, createFun, keyFunc, finalFun, iterFun, tType, tInterval, dataflow->getExecutor(),
+                    dataflow->getTimerWheel()));
         }
         auto iter =
-            addPartitionedPublisher<GroupedAggregation<T, Tout, AggrState, KeyType>, T>(ops);
+            addPartitionedPublisher<GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>, T>(ops);
         return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
                           partitioningState, numPartitions);
       }
@@ -1261,39 +1828,54 @@ class Pipe {
   }
 
   template <typename Tout, typename AggrState,
-            typename KeyType = DefaultKeyType>
+            typename KeyType = DefaultKeyType,
+            typename KeyHash = boost::hash<KeyType>>
   Pipe<Tout> groupBy(
-      typename GroupedAggregation<T, Tout, AggrState, KeyType>::FinalFunc
+      typename GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>::FinalFunc
           finalFun,
-      typename GroupedAggregation<T, Tout, AggrState, KeyType>::IterateFunc
+      typename GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>::IterateFunc
           iterFun,
       AggregationTriggerType tType = TriggerAll,
       const unsigned int tInterval = 0) noexcept(false) {
+    using AggrType = GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>;
+    typedef std::function<Timestamp(const T&)> ExtractorFunc;
+    ExtractorFunc tsFunc;
+    if (tType == TriggerByTimestamp) {
+      // the trigger requires a timestamp extractor
+      try {
+        tsFunc = boost::any_cast<ExtractorFunc>(timestampExtractor);
+      } catch (const boost::bad_any_cast& e) {
+        throw TopologyException("No TimestampExtractor defined for groupBy.");
+      }
+    }
     try {
       typedef std::function<KeyType(const T&)> KeyExtractorFunc;
       KeyExtractorFunc keyFunc =
           boost::any_cast<KeyExtractorFunc>(keyExtractor);
 
+      auto makeOp = [&]() {
+        if (tType == TriggerByTimestamp)
+          return std::make_shared<AggrType>(keyFunc, finalFun, iterFun, tsFunc, tType, tInterval);
+        return std::make_shared<AggrType>(keyFunc, finalFun, iterFun, tType, tInterval,
+                                          dataflow->getExecutor(), dataflow->getTimerWheel());
+      };
+
       if (partitioningState == NoPartitioning) {
-        auto op =
-            std::make_shared<GroupedAggregation<T, Tout, AggrState, KeyType>>(
-                keyFunc, finalFun, iterFun, tType, tInterval);
+        auto op = makeOp();
         auto iter =
-            addPublisher<GroupedAggregation<T, Tout, AggrState, KeyType>,
+            addPublisher<GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>,
                          DataSource<T>>(op);
         return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
                           partitioningState, numPartitions);
       } else {
         std::vector<
-            std::shared_ptr<GroupedAggregation<T, Tout, AggrState, KeyType>>>
+            std::shared_ptr<GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>>>
             ops;
         for (auto i = 0u; i < numPartitions; i++) {
-          ops.push_back(
-              std::make_shared<GroupedAggregation<T, Tout, AggrState, KeyType>>(
-                  keyFunc, finalFun, iterFun, tType, tInterval));
+          ops.push_back(makeOp());
         }
         auto iter =
-            addPartitionedPublisher<GroupedAggregation<T, Tout, AggrState, KeyType>, T>(ops);
+            addPartitionedPublisher<GroupedAggregation<T, Tout, AggrState, KeyType, KeyHash>, T>(ops);
         return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
                           partitioningState, numPartitions);
       }
@@ -1302,6 +1884,246 @@ class Pipe {
     }
   }
 
+  /**
+   * @brief Creates a two-phase grouped aggregation over a partitioned stream.
+   *
+   * In the first phase each partition pre-aggregates the groups of its
+   * stream elements locally (see PartialAggregation) and publishes the
+   * partial states after every @c flushInterval elements and before each
+   * punctuation. In the second phase the partial states of all partitions
+   * are merged and combined per group by a GroupedAggregation using the
+   * @c combine function of the aggregation state. Thus, the stream can be
+   * partitioned independently of the grouping key (e.g. round-robin) and
+   * skewed keys do not overload a single partition. The operator replaces
+   * the sequence groupBy + merge on a partitioned pipe.
+   *
+   * @tparam AggrState
+   *      the type of representing the aggregation state as a subclass of
+   *      @c AggregationStateBase which provides a @c combine function, e.g.
+   *      @c Aggregator1 ... @c AggregatorN.
+   * @tparam KeyType
+   *      the data type for representing keys (grouping values)
+   * @param[in] flushInterval
+   *    the number of elements per partition after which the partial states
+   *    are published (0 = only before punctuations)
+   * @param[in] tType
+   *    the mode for triggering the calculation of the final aggregate (TriggerAll,
+   *    TriggerByCount, TriggerByTime)
+   * @param[in] tInterval
+   *    the interval for producing aggregate tuples
+   * @return a new (non-partitioned) pipe
+   */
+  template <typename AggrState,
+            typename KeyType = DefaultKeyType>
+  Pipe<typename AggrState::ResultTypePtr> twoPhaseGroupBy(
+      unsigned int flushInterval,
+      AggregationTriggerType tType = TriggerAll,
+      const unsigned int tInterval = 0) noexcept(false) {
+    static_assert(typename AggrStateTraits<AggrState>::type(), "twoPhaseGroupBy requires an AggrState class");
+    typedef PartialAggregation<T, AggrState, KeyType> PartialOp;
+    typedef typename PartialOp::PartialAggregatePtr PartialPtr;
+    typedef std::function<KeyType(const T&)> KeyExtractorFunc;
+
+    if (tType == TriggerByTimestamp)
+      throw TopologyException("TriggerByTimestamp is not supported by twoPhaseGroupBy.");
+    KeyExtractorFunc keyFunc;
+    try {
+      keyFunc = boost::any_cast<KeyExtractorFunc>(keyExtractor);
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException("No KeyExtractor defined for twoPhaseGroupBy.");
+    }
+
+    // phase 1: pre-aggregation in each partition
+    std::vector<std::shared_ptr<PartialOp>> ops;
+    for (auto i = 0u; i < numPartitions; i++) {
+      ops.push_back(std::make_shared<PartialOp>(keyFunc, AggrState::iterateForKey, flushInterval));
+    }
+    auto iter = addPartitionedPublisher<PartialOp, T>(ops);
+    Pipe<PartialPtr> partials(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                              NextInPartitioning, numPartitions);
+
+    // phase 2: combine the partial states of all partitions
+    return partials.merge()
+      .template keyBy<KeyType>([](const PartialPtr& tp) { return get<0>(tp); })
+      .template groupBy<typename AggrState::ResultTypePtr, AggrState, KeyType>(
+        AggrState::finalize,
+        [](const PartialPtr& tp, const KeyType&, typename AggrState::AggrStatePtr state, const bool) {
+          AggrState::combine(state, get<1>(tp));
+        },
+        tType, tInterval);
+  }
+
+  /**
+   * @brief Creates an operator determining the most frequent keys.
+   *
+   * Creates a TopK operator which counts the keys (defined by keyBy) of the
+   * stream elements with a Space-Saving summary of bounded size and publishes
+   * the k most frequent keys as tuples (rank, key, count). If the pipe
+   * follows a sliding window, outdated elements are subtracted; after a
+   * tumbling window the summary is cleared for each window, i.e. the top-k
+   * keys per window are obtained with TriggerByCount and the window size as
+   * interval. On a partitioned pipe each partition determines the top-k
+   * keys of its elements.
+   *
+   * @tparam KeyType
+   *      the data type for representing keys
+   * @tparam KeyHash
+   *      the hash function for the keys (default: boost::hash)
+   * @param[in] k
+   *    the number of keys to be published
+   * @param[in] capacity
+   *    the number of keys monitored by the summary (0 = 10 * k)
+   * @param[in] tType
+   *    the mode for triggering the publishing of the top-k keys (TriggerAll,
+   *    TriggerByCount, TriggerByTime)
+   * @param[in] tInterval
+   *    the interval for publishing the top-k keys
+   * @return a new pipe
+   */
+  template <typename KeyType = DefaultKeyType,
+            typename KeyHash = boost::hash<KeyType>>
+  Pipe<typename TopK<T, KeyType, KeyHash>::TopKTuplePtr> topK(
+      unsigned int k, unsigned int capacity = 0,
+      AggregationTriggerType tType = TriggerAll,
+      const unsigned int tInterval = 0) noexcept(false) {
+    typedef TopK<T, KeyType, KeyHash> TopKOp;
+    typedef typename TopKOp::TopKTuplePtr Tout;
+    typedef std::function<KeyType(const T&)> KeyExtractorFunc;
+
+    if (tType == TriggerByTimestamp)
+      throw TopologyException("TriggerByTimestamp is not supported by topK.");
+    if (capacity == 0)
+      capacity = 10 * k;
+    try {
+      KeyExtractorFunc keyFunc = boost::any_cast<KeyExtractorFunc>(keyExtractor);
+
+      if (partitioningState == NoPartitioning) {
+        auto op = std::make_shared<TopKOp>(keyFunc, k, capacity, tType, tInterval,
+                                           dataflow->getExecutor(), dataflow->getTimerWheel());
+        auto iter = addPublisher<TopKOp, DataSource<T>>(op);
+        return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                          partitioningState, numPartitions);
+      } else {
+        std::vector<std::shared_ptr<TopKOp>> ops;
+        for (auto i = 0u; i < numPartitions; i++) {
+          ops.push_back(std::make_shared<TopKOp>(keyFunc, k, capacity, tType, tInterval,
+                                                 dataflow->getExecutor(), dataflow->getTimerWheel()));
+        }
+        auto iter = addPartitionedPublisher<TopKOp, T>(ops);
+        return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                          partitioningState, numPartitions);
+      }
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException("No KeyExtractor defined for topK.");
+    }
+  }
+
+  /**
+   * @brief Creates an operator for calculating aggregates over a sliding window.
+   *
+   * Creates an operator which combines a sliding window with an aggregation.
+   * The window content is not materialized, instead partial aggregates are
+   * computed for panes of the window which are combined to produce the window
+   * aggregate. Thus, no outdated tuples are needed and also aggregate functions
+   * which cannot handle outdated tuples (e.g. AggrGlobalMin or AggrGlobalMax)
+   * can be used. For a range window a timestamp extractor has to be defined
+   * by @c assignTimestamps before.
+   * @code
+   * // calculate the maximum of column #0 over the last 100 tuples
+   * typedef Aggregator1<T1, AggrGlobalMax<double>, 0> MyAggrState;
+   *
+   * t->newStreamFrom...
+   *    .windowAggregate<MyAggrState>(WindowParams::RowWindow, 100)
+   * @endcode
+   *
+   * @tparam AggrState
+   *      the type of representing the aggregation state as a subclass of
+   *      @c AggregationStateBase which has to provide a @c combine function.
+   *      The predefined template classes @c Aggregator1 ... @c AggregatorN
+   *      can be used directly here.
+   * @param[in] wt
+   *      the type of the window (row or range)
+   * @param[in] sz
+   *      the window size (in number of tuples for row windows or in seconds
+   *      for range windows)
+   * @param[in] slide
+   *      the slide of the window, i.e. the number of tuples or seconds after
+   *      which an aggregate is produced
+   * @return a new pipe
+   */
+  template <typename AggrState>
+  Pipe<typename AggrState::ResultTypePtr> windowAggregate(
+      const WindowParams::WinType& wt, const unsigned int sz,
+      const unsigned int slide = 1) noexcept(false) {
+    static_assert(typename AggrStateTraits<AggrState>::type(), "windowAggregate requires an AggrState class");
+    return windowAggregate<typename AggrState::ResultTypePtr, AggrState>(AggrState::finalize, AggrState::iterate,
+                                                                        wt, sz, slide);
+  }
+
+  /**
+   * @brief Creates an operator for calculating aggregates over a sliding window.
+   *
+   * Creates an operator which combines a sliding window with an aggregation
+   * (see above) where the finalize and iterate functions are specified
+   * explicitly.
+   *
+   * @tparam Tout
+   *      the result tuple type (usually a TuplePtr) for the operator.
+   * @tparam AggrState
+   *      the type of representing the aggregation state as a subclass of
+   *      @c AggregationStateBase which has to provide a @c combine function.
+   * @param[in] finalFun
+   *    a function pointer for constructing the aggregation tuple
+   * @param[in] iterFun
+   *    a function pointer for adding a tuple to the aggregate values
+   * @param[in] wt
+   *      the type of the window (row or range)
+   * @param[in] sz
+   *      the window size (in number of tuples for row windows or in seconds
+   *      for range windows)
+   * @param[in] slide
+   *      the slide of the window, i.e. the number of tuples or seconds after
+   *      which an aggregate is produced
+   * @return a new pipe
+   */
+  template <typename Tout, typename AggrState>
+  Pipe<Tout> windowAggregate(
+      typename WindowAggregation<T, Tout, AggrState>::FinalFunc finalFun,
+      typename WindowAggregation<T, Tout, AggrState>::IterateFunc iterFun,
+      const WindowParams::WinType& wt, const unsigned int sz,
+      const unsigned int slide = 1) noexcept(false) {
+    using AggrType = WindowAggregation<T, Tout, AggrState>;
+    using ExtractorFunc = typename AggrType::TimestampExtractorFunc;
+
+    auto makeOp = [&]() {
+      if (wt == WindowParams::RangeWindow) {
+        // a range window requires a timestamp extractor
+        auto fn = boost::any_cast<ExtractorFunc>(timestampExtractor);
+        return std::make_shared<AggrType>(finalFun, iterFun, fn, sz, slide);
+      }
+      return std::make_shared<AggrType>(finalFun, iterFun, sz, slide);
+    };
+
+    try {
+      if (partitioningState == NoPartitioning) {
+        auto iter = addPublisher<AggrType, DataSource<T>>(makeOp());
+        return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor,
+                          transactionIDExtractor, partitioningState, numPartitions);
+      } else {
+        std::vector<std::shared_ptr<AggrType>> ops;
+        for (auto i = 0u; i < numPartitions; i++) {
+          ops.push_back(makeOp());
+        }
+        auto iter = addPartitionedPublisher<AggrType, T>(ops);
+        return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor,
+                          transactionIDExtractor, partitioningState, numPartitions);
+      }
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException(
+          "No TimestampExtractor defined for windowAggregate.");
+    }
+  }
+
   /*--------------------------------- CEP -------------------------------*/
 
   /**
@@ -1470,13 +2292,258 @@ class Pipe {
   }
 
     /**
+   * @brief Creates an operator for joining two streams over sliding windows.
+   *
+   * Creates an operator implementing a symmetric hash join with a built-in
+   * sliding window on each input (see WindowedSHJoin). Each tuple is joined
+   * with the tuples of the other input's window, i.e. the last @c rSize
+   * (@c lSize) tuples for row windows or the tuples of the last @c rSize
+   * (@c lSize) seconds for range windows. The windows are maintained by the
+   * join itself and expired in bulk, thus no preceding window operators and
+   * no outdated tuples are needed. Range windows require timestamp extractors
+   * (assignTimestamps) on both pipes and join tuples by their timestamps. Each
+   * window is expired by the progress of the other stream, i.e. by the
+   * timestamps of its tuples or, if present, by its watermarks. If the pipe is
+   * partitioned, each partition maintains its own windows.
+   *
+   * @tparam KeyType
+   *      the data type for representing keys (join values)
+   * @tparam T2
+   *      the input tuple type (usually a TuplePtr) of the right stream.
+   * @param[in] otherPipe
+   *      the pipe representing the right stream
+   * @param[in] pred
+   *      the join predicate which is applied in addition to the equi-join
+   *      condition of the hash join
+   * @param[in] wt
+   *      the type of both windows (row or range)
+   * @param[in] lSize
+   *      the window size of this (left) stream in tuples or seconds
+   * @param[in] rSize
+   *      the window size of the right stream (0 = lSize)
+   * @return a new pipe
+   */
+  template <typename KeyType = DefaultKeyType, typename T2>
+  Pipe<typename WindowedSHJoin<T, T2, KeyType>::ResultElement> windowJoin(Pipe<T2>& otherPipe,
+      typename WindowedSHJoin<T, T2, KeyType>::JoinPredicateFunc pred,
+      const WindowParams::WinType& wt, const unsigned int lSize,
+      const unsigned int rSize = 0) noexcept(false) {
+    typedef WindowedSHJoin<T, T2, KeyType> JoinOp;
+    typedef typename JoinOp::ResultElement Tout;
+    typedef std::function<KeyType(const T&)> LKeyExtractorFunc;
+    typedef std::function<KeyType(const T2&)> RKeyExtractorFunc;
+    typedef typename JoinOp::LTimestampExtractorFunc LTimestampExtractorFunc;
+    typedef typename JoinOp::RTimestampExtractorFunc RTimestampExtractorFunc;
+
+    LKeyExtractorFunc fn1;
+    RKeyExtractorFunc fn2;
+    try {
+      fn1 = boost::any_cast<LKeyExtractorFunc>(keyExtractor);
+      fn2 = boost::any_cast<RKeyExtractorFunc>(otherPipe.keyExtractor);
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException("No KeyExtractor defined for windowJoin.");
+    }
+    LTimestampExtractorFunc ts1;
+    RTimestampExtractorFunc ts2;
+    if (wt == WindowParams::RangeWindow) {
+      // range windows require timestamp extractors on both inputs
+      try {
+        ts1 = boost::any_cast<LTimestampExtractorFunc>(timestampExtractor);
+        ts2 = boost::any_cast<RTimestampExtractorFunc>(otherPipe.timestampExtractor);
+      } catch (const boost::bad_any_cast& e) {
+        throw TopologyException("No TimestampExtractor defined for windowJoin.");
+      }
+    }
+
+    const auto rightSize = rSize > 0 ? rSize : lSize;
+    auto makeOp = [&]() {
+      if (wt == WindowParams::RangeWindow)
+        return std::make_shared<JoinOp>(fn1, fn2, pred, lSize, rightSize, ts1, ts2);
+      return std::make_shared<JoinOp>(fn1, fn2, pred, lSize, rightSize);
+    };
+
+    if (partitioningState == NoPartitioning && otherPipe.partitioningState == NoPartitioning) {
+      //both streams are not partitioned
+      auto op = makeOp();
+
+      auto pOp = castOperator<DataSource<T>>(getPublisher());
+      connectChannels(pOp->getOutputDataChannel(), op->getLeftInputDataChannel());
+      connectChannels(pOp->getOutputPunctuationChannel(), op->getLeftInputPunctuationChannel());
+
+      auto otherOp = castOperator<DataSource<T2>>(otherPipe.getPublisher());
+      connectChannels(otherOp->getOutputDataChannel(), op->getRightInputDataChannel());
+      connectChannels(otherOp->getOutputPunctuationChannel(), op->getRightInputPunctuationChannel());
+
+      auto iter = dataflow->addPublisher(op);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    }
+
+    std::vector<std::shared_ptr<JoinOp>> ops;
+    const auto numOps = partitioningState == NoPartitioning ? 1u : numPartitions;
+    for (auto i = 0u; i < numOps; i++) {
+      ops.push_back(makeOp());
+    }
+    auto iter = addJoin<T2, KeyType>(ops, otherPipe);
+    return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                      partitioningState, numPartitions);
+  }
+
+  /**
+   * @brief Creates a band join of two streams on their timestamps and a key.
+   *
+   * Creates an operator joining the tuples of this stream with the tuples of
+   * @c otherPipe which have the same key (defined by @c keyBy on both pipes) and
+   * timestamps (defined by @c assignTimestamps on both pipes) differing by at most
+   * @c delta. The tuples are indexed by key and timestamp, thus a tuple probes only
+   * the tuples of the other stream within the band. The state is expired as the
+   * timestamps (or watermarks) of the other stream pass the band.
+   *
+   * @tparam KeyType
+   *      the data type for representing keys (join values)
+   * @tparam T2
+   *      the input tuple type (usually a TuplePtr) of the right stream.
+   * @param[in] otherPipe
+   *      the pipe representing the right stream
+   * @param[in] pred
+   *      an additional join predicate (nullptr = key and band only)
+   * @param[in] delta
+   *      the maximal distance of the timestamps of two joined tuples
+   * @return a new pipe
+   */
+  template <typename KeyType = DefaultKeyType, typename T2>
+  Pipe<typename BandJoin<T, T2, KeyType>::ResultElement> bandJoin(Pipe<T2>& otherPipe,
+      typename BandJoin<T, T2, KeyType>::JoinPredicateFunc pred, Timestamp delta) noexcept(false) {
+    typedef BandJoin<T, T2, KeyType> JoinOp;
+    typedef typename JoinOp::ResultElement Tout;
+    typedef std::function<KeyType(const T&)> LKeyExtractorFunc;
+    typedef std::function<KeyType(const T2&)> RKeyExtractorFunc;
+    typedef typename JoinOp::LTimestampExtractorFunc LTimestampExtractorFunc;
+    typedef typename JoinOp::RTimestampExtractorFunc RTimestampExtractorFunc;
+
+    LKeyExtractorFunc fn1;
+    RKeyExtractorFunc fn2;
+    try {
+      fn1 = boost::any_cast<LKeyExtractorFunc>(keyExtractor);
+      fn2 = boost::any_cast<RKeyExtractorFunc>(otherPipe.keyExtractor);
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException("No KeyExtractor defined for bandJoin.");
+    }
+    LTimestampExtractorFunc ts1;
+    RTimestampExtractorFunc ts2;
+    try {
+      ts1 = boost::any_cast<LTimestampExtractorFunc>(timestampExtractor);
+      ts2 = boost::any_cast<RTimestampExtractorFunc>(otherPipe.timestampExtractor);
+    } catch (const boost::bad_any_cast& e) {
+      throw TopologyException("No TimestampExtractor defined for bandJoin.");
+    }
+
+    if (partitioningState == NoPartitioning && otherPipe.partitioningState == NoPartitioning) {
+      //both streams are not partitioned
+      auto op = std::make_shared<JoinOp>(fn1, fn2, ts1, ts2, pred, delta);
+
+      auto pOp = castOperator<DataSource<T>>(getPublisher());
+      connectChannels(pOp->getOutputDataChannel(), op->getLeftInputDataChannel());
+      connectChannels(pOp->getOutputPunctuationChannel(), op->getLeftInputPunctuationChannel());
+
+      auto otherOp = castOperator<DataSource<T2>>(otherPipe.getPublisher());
+      connectChannels(otherOp->getOutputDataChannel(), op->getRightInputDataChannel());
+      connectChannels(otherOp->getOutputPunctuationChannel(), op->getRightInputPunctuationChannel());
+
+      auto iter = dataflow->addPublisher(op);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    }
+
+    std::vector<std::shared_ptr<JoinOp>> ops;
+    const auto numOps = partitioningState == NoPartitioning ? 1u : numPartitions;
+    for (auto i = 0u; i < numOps; i++) {
+      ops.push_back(std::make_shared<JoinOp>(fn1, fn2, ts1, ts2, pred, delta));
+    }
+    auto iter = addJoin<T2, KeyType>(ops, otherPipe);
+    return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                      partitioningState, numPartitions);
+  }
+
+  /**
+   * @brief Creates an operator for joining this stream with several other streams on a common key.
+   *
+   * Creates a MultiWayJoin operator which keeps one hash table per stream and
+   * produces the final join results directly instead of materializing the
+   * intermediate results of chained joins. All streams need a key extractor
+   * (see keyBy) returning the same KeyType. The hash tables are probed in the
+   * order of the observed input rates which is adapted every reorderInterval
+   * tuples. The output tuple type contains the attributes of all streams in
+   * the order of the pipes. Partitioned streams are not supported.
+   *
+   * @tparam KeyType
+   *      the data type for representing keys (join values)
+   * @tparam Ts
+   *      the input tuple types (usually TuplePtr) of the other streams
+   * @param[in] pred
+   *      the join predicate over one tuple of each stream (nullptr = key equality only)
+   * @param[in] reorderInterval
+   *      the number of tuples after which the probe order is adapted (0 = fixed order)
+   * @param[in] otherPipes
+   *      the pipes representing the other streams
+   * @return a new pipe
+   */
+  template <typename KeyType = DefaultKeyType, typename... Ts>
+  Pipe<typename MultiWayJoin<KeyType, T, Ts...>::ResultElement> multiJoin(
+      typename MultiWayJoin<KeyType, T, Ts...>::JoinPredicateFunc pred, std::size_t reorderInterval,
+      Pipe<Ts>&... otherPipes) noexcept(false) {
+    typedef MultiWayJoin<KeyType, T, Ts...> JoinOp;
+    typedef typename JoinOp::ResultElement Tout;
+
+    if (partitioningState != NoPartitioning ||
+        ((otherPipes.partitioningState != NoPartitioning) || ...))
+      throw TopologyException("multiJoin does not support partitioned streams.");
+
+    typename JoinOp::KeyExtractorFuncs keyFuncs(multiJoinKeyExtractor<KeyType>(*this),
+                                               multiJoinKeyExtractor<KeyType>(otherPipes)...);
+    auto op = std::make_shared<JoinOp>(keyFuncs, pred, reorderInterval);
+
+    std::tuple<Pipe<T>&, Pipe<Ts>&...> pipes(*this, otherPipes...);
+    connectMultiJoinInputs(op, pipes, std::index_sequence_for<T, Ts...>());
+
+    auto iter = dataflow->addPublisher(op);
+    return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                      partitioningState, numPartitions);
+  }
+
+  /**
+   * @brief Creates an operator for joining this stream with several other streams on a common key.
+   *
+   * Same as multiJoin above, but the probe order is adapted every 1024 tuples.
+   *
+   * @tparam KeyType
+   *      the data type for representing keys (join values)
+   * @tparam Ts
+   *      the input tuple types (usually TuplePtr) of the other streams
+   * @param[in] pred
+   *      the join predicate over one tuple of each stream (nullptr = key equality only)
+   * @param[in] otherPipes
+   *      the pipes representing the other streams
+   * @return a new pipe
+   */
+  template <typename KeyType = DefaultKeyType, typename... Ts>
+  Pipe<typename MultiWayJoin<KeyType, T, Ts...>::ResultElement> multiJoin(
+      typename MultiWayJoin<KeyType, T, Ts...>::JoinPredicateFunc pred,
+      Pipe<Ts>&... otherPipes) noexcept(false) {
+    return multiJoin<KeyType>(pred, 1024, otherPipes...);
+  }
+
+  /**
    * @brief Creates an operator for joining two streams represented by pipes.
    * Origin idea & paper: "ScaleJoin: a Deterministic, Disjoint-Parallel and
    * Skew-Resilient Stream Join" (2016)
    *
    * Creates an operator implementing a ScaleJoin to join two streams.
    * In addition a join predicate can be specified. Note, that the output
-   * tuple type is derived from the two input types.
+   * tuple type is derived from the two input types. The tuples of both
+   * streams are appended once to a ring shared by all join instances,
+   * each instance reads the ring in its own thread (or as task of the
+   * executor of the topology) and the results are combined by a queue.
    *
    * @tparam T
    *      the input tuple type (usually a TuplePtr) of the left stream.
@@ -1490,13 +2557,17 @@ class Pipe {
    *      the join predicate
    * @param[in] threadnum
    *      the number of threads for parallel joining
+   * @param[in] capacity
+   *      the capacity of the ring shared by the join instances
    * @return a new pipe
    */
   template <typename KeyType = DefaultKeyType, typename T2>
   Pipe<typename ScaleJoin<T, T2, KeyType>::ResultElement> scaleJoin(
-    Pipe<T2>& otherPipe, typename ScaleJoin<T, T2, KeyType>::JoinPredicateFunc pred, const int threadnum) {
+    Pipe<T2>& otherPipe, typename ScaleJoin<T, T2, KeyType>::JoinPredicateFunc pred, const int threadnum,
+    std::size_t capacity = 4096) {
 
     typedef typename ScaleJoin<T, T2, KeyType>::ResultElement Tout;
+    typedef typename ScaleJoin<T, T2, KeyType>::InputRing InputRing;
 
     try {
       typedef std::function<KeyType(const T&)> LKeyExtractorFunc;
@@ -1515,42 +2586,38 @@ class Pipe {
       assert(otherPipe.partitioningState == NoPartitioning);
       assert(threadnum > 0);
 
-      //vector for join operators as well as queues (multithreading encoupling)
+      //vector for join operators
       std::vector<std::shared_ptr<ScaleJoin<T, T2, KeyType> > > scJoinVec;
-      std::vector<std::shared_ptr<Queue<T> > > scQueueVec;
+
+      //ring shared by all join instances, each instance reads it with its own cursor
+      auto ring = std::make_shared<InputRing>(capacity, threadnum);
 
       //queue for collecting join results, forwarding as a single stream
-      auto combine = std::make_shared<Queue<Tout>>();
+      auto combine = std::make_shared<Queue<Tout>>(dataflow->getExecutor());
 
       //start thread instances, specified by threadnum
       for (auto i=0; i<threadnum; i++) {
 
-        //create queue and scaleJoin instances
-        auto qu = std::make_shared<Queue<T>>();
-        auto scJoin = std::make_shared<ScaleJoin<T, T2, KeyType> >(fn1, fn2, pred, i, threadnum);
-
-        //connect output of predecessing operator of left stream with input of the current queue instance
-        CREATE_LINK(pOp, qu);
-
-        //connect output of queue instance with input of scaleJoin instance
-        connectChannels(qu->getOutputDataChannel(), scJoin->getLeftInputDataChannel());
-        connectChannels(qu->getOutputPunctuationChannel(), scJoin->getInputPunctuationChannel());
-
-        //connect output of predecessing operator of right stream with input of scaleJoin instance
-        connectChannels(otherOp->getOutputDataChannel(), scJoin->getRightInputDataChannel());
-        connectChannels(otherOp->getOutputPunctuationChannel(), scJoin->getInputPunctuationChannel());
+        //create scaleJoin instance
+        auto scJoin = std::make_shared<ScaleJoin<T, T2, KeyType> >(fn1, fn2, pred, i, threadnum,
+                                                                   ring, dataflow->getExecutor());
 
         //connect output of current scaleJoin instance with the combining queue operator
         CREATE_LINK(scJoin, combine);
 
-        //add queue and scaleJoin instance to the vectors
-        scQueueVec.push_back(qu);
+        //add scaleJoin instance to the vector
         scJoinVec.push_back(scJoin);
       }
 
-      //add all queues, scaleJoins and the combining queue to the dataflow
-      Dataflow::BaseOpList scQueueList(scQueueVec.begin(), scQueueVec.end());
-      dataflow->addPublisherList(scQueueList);
+      //connect the left and right stream with the first instance only, which appends
+      //the tuples to the shared ring
+      auto scJoin = scJoinVec.front();
+      connectChannels(pOp->getOutputDataChannel(), scJoin->getLeftInputDataChannel());
+      connectChannels(pOp->getOutputPunctuationChannel(), scJoin->getInputPunctuationChannel());
+      connectChannels(otherOp->getOutputDataChannel(), scJoin->getRightInputDataChannel());
+      connectChannels(otherOp->getOutputPunctuationChannel(), scJoin->getInputPunctuationChannel());
+
+      //add all scaleJoins and the combining queue to the dataflow
       Dataflow::BaseOpList scJoinList(scJoinVec.begin(), scJoinVec.end());
       dataflow->addPublisherList(scJoinList);
       auto iter = dataflow->addPublisher(combine);
@@ -1564,6 +2631,49 @@ class Pipe {
     }
   }
 
+  /**
+   * @brief Creates an operator for joining the stream with the records of a table.
+   *
+   * Creates an operator which probes the given table (e.g. a Table or CuckooTable)
+   * with the key of each stream tuple and joins the tuple with the record of this key.
+   * Tuples without a record are discarded. The table is probed without copying the
+   * record. Optionally, the records can be cached by the operator (the cache is
+   * cleared if the table is modified) and tuples can be probed in batches.
+   *
+   * @tparam TableType
+   *      the type of the table
+   * @param[in] tbl
+   *      a pointer to the table which is probed
+   * @param[in] keyFunc
+   *      the function for extracting the key from a stream tuple
+   * @param[in] cacheSize
+   *      the maximal number of records cached per operator (0 = no cache)
+   * @param[in] batchSize
+   *      the number of tuples probed together (1 = no batching)
+   * @return a new pipe
+   */
+  template <typename TableType>
+  Pipe<typename LookupJoin<T, TableType>::ResultElement> lookupJoin(
+    std::shared_ptr<TableType> tbl, std::function<typename TableType::KType(const T&)> keyFunc,
+    std::size_t cacheSize = 0, std::size_t batchSize = 1) {
+    typedef typename LookupJoin<T, TableType>::ResultElement Tout;
+
+    if (partitioningState == NoPartitioning) {
+      auto op = std::make_shared<LookupJoin<T, TableType>>(tbl, keyFunc, cacheSize, batchSize);
+      auto iter = addPublisher<LookupJoin<T, TableType>, DataSource<T>>(op);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    } else {
+      std::vector<std::shared_ptr<LookupJoin<T, TableType>>> ops;
+      for (auto i = 0u; i < numPartitions; i++) {
+        ops.push_back(std::make_shared<LookupJoin<T, TableType>>(tbl, keyFunc, cacheSize, batchSize));
+      }
+      auto iter = addPartitionedPublisher<LookupJoin<T, TableType>, T>(ops);
+      return Pipe<Tout>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
+                        partitioningState, numPartitions);
+    }
+  }
+
   /*--------------------------- table operators  -------------------------*/
 
   /**
@@ -1778,14 +2888,18 @@ class Pipe {
    *        the function for deriving the partition id
        * @param numPartitions
    *        the number of partitions
+   * @param queueCapacity
+   *        the capacity of the queue of each partition (0 = unbounded). If
+   *        the queue is full, the upstream operators are blocked.
    * @return a new pipe
    */
   Pipe<T> partitionBy(typename PartitionBy<T>::PartitionFunc pFun,
-                      unsigned int nPartitions) noexcept(false) {
+                      unsigned int nPartitions, std::size_t queueCapacity = 0) noexcept(false) {
     if (partitioningState != NoPartitioning)
       throw TopologyException(
           "Cannot partition an already partitioned stream.");
-    auto op = std::make_shared<PartitionBy<T>>(pFun, nPartitions);
+    auto op = std::make_shared<PartitionBy<T>>(pFun, nPartitions, dataflow->getExecutor(),
+                                               queueCapacity);
     auto iter = addPublisher<PartitionBy<T>, DataSource<T>>(op);
     return Pipe<T>(dataflow, iter, keyExtractor, timestampExtractor, transactionIDExtractor,
                    FirstInPartitioning, nPartitions);
@@ -1800,9 +2914,11 @@ class Pipe {
    *
    * @tparam T
    *   the data stream element type consumed by PartitionBy
+   * @param queueCapacity
+   *   the capacity of the queue decoupling the merged stream (0 = unbounded)
    * @return a new pipe
    */
-  Pipe<T> merge() noexcept(false) {
+  Pipe<T> merge(std::size_t queueCapacity = 0) noexcept(false) {
     if (partitioningState != NextInPartitioning)
       throw TopologyException("Nothing to merge in topology.");
 
@@ -1816,7 +2932,7 @@ class Pipe {
     // return Pipe(dataflow, iter, keyExtractor, timestampExtractor,
     // partitioningState, numPartitions);
 
-    auto queue = std::make_shared<Queue<T>>();
+    auto queue = std::make_shared<Queue<T>>(dataflow->getExecutor(), queueCapacity);
     CREATE_LINK(op, queue);
     auto iter2 = dataflow->addPublisher(queue);
 
@@ -1860,4 +2976,8 @@ class Pipe {
 };
 }
 
+// -----------------------------------------------------------------------------------------------
+
+#include "dsl/FusedPipe.hpp"
+
 #endif
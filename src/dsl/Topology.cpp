@@ -20,14 +20,7 @@
 using namespace pfabric;
 
 Topology::~Topology() {
-  if (!wakeupTimers.empty()) {
-    for (auto& thr : wakeupTimers) {
-      thr.interrupt();
-    }
-    for (auto& thr : wakeupTimers) {
-      thr.join();
-    }
-  }
+  stopThreads();
 }
 
 void Topology::registerStartupFunction(StartupFunc func) {
@@ -86,23 +79,67 @@ void Topology::wait(const std::chrono::milliseconds &dur) {
     }
 }
 
+std::vector<QueueStatistics> Topology::queueStatistics() const {
+  std::vector<QueueStatistics> stats;
+  for (auto it = dataflow->publisherBegin(); it != dataflow->publisherEnd(); it++) {
+    auto op = dynamic_cast<BufferedOperator*>(it->get());
+    if (op != nullptr)
+      op->collectQueueStatistics(stats);
+  }
+  return stats;
+}
+
 void Topology::runEvery(unsigned long secs) {
-  wakeupTimers.push_back(boost::thread([this, secs](){
-        while(true) {
-          boost::this_thread::sleep_for(boost::chrono::nanoseconds(secs));
-          this->start(false);
+  auto executor = dataflow->getExecutor();
+  if (executor)
+    wakeupTasks.push_back(executor->registerTimer([this]() { this->start(false); },
+                                                  std::chrono::seconds(secs)));
+  else {
+    // the query is not run by the thread of the timer wheel (which is shared
+    // by all timers) but by a dedicated thread - the timer only notifies it
+    if (!runner.joinable())
+      runner = std::thread(&Topology::runRequests, this);
+    wakeupTimers.push_back(dataflow->getTimerWheel()->scheduleEvery([this]() {
+        {
+          std::lock_guard<std::mutex> lock(mRunMtx);
+          runRequested = true;
         }
-  }));
+        mRunCv.notify_one();
+      }, std::chrono::seconds(secs)));
+  }
+}
+
+void Topology::runRequests() {
+  std::unique_lock<std::mutex> lock(mRunMtx);
+  for (;;) {
+    mRunCv.wait(lock, [this]() { return runRequested || runnerStopped; });
+    if (runnerStopped)
+      return;
+    runRequested = false;
+    lock.unlock();
+    start(false);
+    lock.lock();
+  }
 }
 
 void Topology::stopThreads() {
-  if (!wakeupTimers.empty()) {
-    for (auto &thr : wakeupTimers) {
-      thr.interrupt();
-    }
-    for (auto &thr : wakeupTimers) {
-      thr.join();
+  for (auto &task : wakeupTasks) {
+    dataflow->getExecutor()->unregisterTask(task);
+  }
+  wakeupTasks.clear();
+  for (auto &timer : wakeupTimers) {
+    dataflow->getTimerWheel()->cancel(timer);
+  }
+  wakeupTimers.clear();
+  if (runner.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mRunMtx);
+      runnerStopped = true;
     }
+    mRunCv.notify_one();
+    // wait until a run in progress has finished
+    runner.join();
+    runnerStopped = runRequested = false;
   }
 }
     
@@ -26,6 +26,7 @@
 #include <vector>
 #include <future>
 #include <mutex>
+#include <thread>
 
 #include <boost/chrono.hpp>
 #include <boost/thread.hpp>
@@ -83,10 +84,10 @@ namespace pfabric {
    *
    * auto s = t->newStreamFromFile("file.csv")
    *           .extract<T1>(',')
-   *           .where<T1>([](auto tp, bool outdated) {
+   *           .where([](auto tp, bool outdated) {
    *                     return get<0>(tp) % 2 == 0;
    *            })
-   *           .map<T1,T2>([](auto tp, bool) -> T2 {
+   *           .map<T2>([](auto tp, bool) -> T2 {
    *                     return makeTuplePtr(get<2>(tp),
    *                                         get<0>(tp));
    *            })
@@ -104,7 +105,13 @@ namespace pfabric {
     std::vector<StartupFunc> prepareList; //< the list of functions to be called for startup
     bool asyncStarted;                    //< true if we started asynchronously
     std::vector<std::future<unsigned long> > startupFutures; //< futures for the startup functions
-    std::vector<boost::thread> wakeupTimers; //< interruptible threads for runEvery queries
+    std::vector<TimerWheel::TimerPtr> wakeupTimers; //< timers for runEvery queries
+    std::vector<Executor::TaskPtr> wakeupTasks; //< timers for runEvery queries run by the executor
+    std::thread runner;                   //< the thread running the runEvery queries without executor
+    std::mutex mRunMtx;                   //< mutex for the run requests of the runner thread
+    std::condition_variable mRunCv;       //< condition variable to wake up the runner thread
+    bool runRequested;                    //< true if the timer requested another run
+    bool runnerStopped;                   //< true if the runner thread has to terminate
     std::mutex mMutex;                    //< mutex for accessing startupFutures
     std::condition_variable mCv;          //< condition variable to check if sinks have received EndOfStream
     std::mutex mCv_m;
@@ -131,11 +138,57 @@ namespace pfabric {
      */
     void startAsync();
 
+    /**
+     * @brief The loop of the runner thread: runs the topology whenever requested by a runEvery timer.
+     */
+    void runRequests();
+
   public:
     /**
      * @brief Constructs a new empty topology.
      */
-    Topology() : asyncStarted(false), dataflow(std::make_shared<Dataflow>()) {}
+    Topology() : asyncStarted(false), runRequested(false), runnerStopped(false),
+      dataflow(std::make_shared<Dataflow>()) {}
+
+    /**
+     * @brief Constructs a new empty topology using the given executor.
+     *
+     * Constructs a new empty topology whose queues, partitions and timers
+     * are run as tasks by the given executor instead of separate threads.
+     *
+     * @param[in] executor
+     *    the executor shared by the operators (nullptr = separate threads)
+     */
+    explicit Topology(ExecutorPtr executor) : Topology() {
+      dataflow->setExecutor(executor);
+    }
+
+    /**
+     * @brief Constructs a new empty topology using the given executor and timer wheel.
+     *
+     * Constructs a new empty topology whose time-driven operators register their
+     * timers at the given timer wheel, e.g. shared by all topologies of a context.
+     *
+     * @param[in] executor
+     *    the executor shared by the operators (nullptr = separate threads)
+     * @param[in] timers
+     *    the timer wheel shared by the operators
+     */
+    Topology(ExecutorPtr executor, TimerWheelPtr timers) : Topology(executor) {
+      dataflow->setTimerWheel(timers);
+    }
+
+    /**
+     * @brief Constructs a new empty topology with its own executor.
+     *
+     * Constructs a new empty topology with an executor running
+     * @c numThreads worker threads.
+     *
+     * @param[in] numThreads
+     *    the number of worker threads (0 = number of hardware threads)
+     */
+    explicit Topology(unsigned int numThreads) :
+      Topology(std::make_shared<Executor>(numThreads)) {}
 
     /**
      * @brief Destructor for topology.
@@ -164,7 +217,10 @@ namespace pfabric {
      *
      * Starts the processing of the topology every @c secs seconds. Note,
      * that the topology should be a finite query not a continuous stream
-     * query.
+     * query. The query is run as a task by the executor (if given), otherwise
+     * by a dedicated thread of the topology; the timer only hands the run off.
+     * If a run is still in progress when the timer fires, the topology is run
+     * once more afterwards.
      *
      * @param[in] secs
      *  the period of time between two invocations
@@ -182,6 +238,18 @@ namespace pfabric {
      */
     void wait(const std::chrono::milliseconds &dur = 500ms);
 
+    /**
+     * @brief Returns the statistics of all queues of the topology.
+     *
+     * Collects the current size, the capacity, and the high-water mark of all
+     * queues in the topology (including the queues of partitions). This can be
+     * used to size the bounded queues.
+     *
+     * @return
+     *    a list of statistics, one entry per queue
+     */
+    std::vector<QueueStatistics> queueStatistics() const;
+
     /**
      * @brief Creates a pipe from a TextFileSource as input.
      *
@@ -25,12 +25,16 @@
 
 #include "aggr_functions/AggrAvg.hpp"
 #include "aggr_functions/AggrCount.hpp"
+#include "aggr_functions/AggrCountMin.hpp"
 #include "aggr_functions/AggrDCount.hpp"
+#include "aggr_functions/AggrHyperLogLog.hpp"
 #include "aggr_functions/AggrGlobalMin.hpp"
 #include "aggr_functions/AggrGlobalMax.hpp"
 #include "aggr_functions/AggrLRecent.hpp"
+#include "aggr_functions/AggrKLLQuantile.hpp"
 #include "aggr_functions/AggrMedian.hpp"
 #include "aggr_functions/AggrMinMax.hpp"
+#include "aggr_functions/AggrWindowMinMax.hpp"
 #include "aggr_functions/AggrMRecent.hpp"
 #include "aggr_functions/AggrSum.hpp"
 #include "aggr_functions/AggrIdentity.hpp"
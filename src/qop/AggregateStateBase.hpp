@@ -20,6 +20,8 @@
 
 #include "core/PFabricTypes.hpp"
 #include "core/StreamElementTraits.hpp"
+#include "qop/aggr_functions/AggrMinMax.hpp"
+#include "qop/aggr_functions/AggrWindowMinMax.hpp"
 
 namespace pfabric {
 
@@ -151,6 +153,18 @@ public:
 		state->aggr1_.iterate(getAttribute<Aggr1Col>(*tp), outdated);
 	}
 
+	/**
+	 * Merge the partial aggregation state @c other into @c state. Both states
+	 * have to be built from disjoint parts of the stream where @c other
+	 * covers the more recent part.
+	 *
+	 * @param state the aggregate state object which is updated
+	 * @param other the partial aggregate state which is merged into @c state
+	 */
+	static void combine(AggrStatePtr state, const AggrStatePtr& other) {
+		state->aggr1_.combine(other->aggr1_);
+	}
+
 	/**
 	 * Return the current value of the given aggregate as a tuple.
 	 * The method is a static member to simplify the usage in the aggregate operator.
@@ -236,6 +250,19 @@ public:
 		state->aggr2_.iterate(getAttribute<Aggr2Col>(*tp), outdated);
 	}
 
+	/**
+	 * Merge the partial aggregation state @c other into @c state. Both states
+	 * have to be built from disjoint parts of the stream where @c other
+	 * covers the more recent part.
+	 *
+	 * @param state the aggregate state object which is updated
+	 * @param other the partial aggregate state which is merged into @c state
+	 */
+	static void combine(AggrStatePtr state, const AggrStatePtr& other) {
+		state->aggr1_.combine(other->aggr1_);
+		state->aggr2_.combine(other->aggr2_);
+	}
+
 	/**
 	 * Return the current value of the given aggregate as a tuple.
 	 * The method is a static member to simplify the usage in the aggregate operator.
@@ -334,6 +361,20 @@ public:
 		state->aggr3_.iterate(getAttribute<Aggr3Col>(*tp), outdated);
 	}
 
+	/**
+	 * Merge the partial aggregation state @c other into @c state. Both states
+	 * have to be built from disjoint parts of the stream where @c other
+	 * covers the more recent part.
+	 *
+	 * @param state the aggregate state object which is updated
+	 * @param other the partial aggregate state which is merged into @c state
+	 */
+	static void combine(AggrStatePtr state, const AggrStatePtr& other) {
+		state->aggr1_.combine(other->aggr1_);
+		state->aggr2_.combine(other->aggr2_);
+		state->aggr3_.combine(other->aggr3_);
+	}
+
 	/**
 	 * Return the current value of the given aggregate as a tuple.
 	 * The method is a static member to simplify the usage in the aggregate operator.
@@ -443,6 +484,21 @@ public:
 		state->aggr4_.iterate(getAttribute<Aggr4Col>(*tp), outdated);
 	}
 
+	/**
+	 * Merge the partial aggregation state @c other into @c state. Both states
+	 * have to be built from disjoint parts of the stream where @c other
+	 * covers the more recent part.
+	 *
+	 * @param state the aggregate state object which is updated
+	 * @param other the partial aggregate state which is merged into @c state
+	 */
+	static void combine(AggrStatePtr state, const AggrStatePtr& other) {
+		state->aggr1_.combine(other->aggr1_);
+		state->aggr2_.combine(other->aggr2_);
+		state->aggr3_.combine(other->aggr3_);
+		state->aggr4_.combine(other->aggr4_);
+	}
+
 	/**
 	 * Return the current value of the given aggregate as a tuple.
 	 * The method is a static member to simplify the usage in the aggregate operator.
@@ -470,6 +526,76 @@ struct AggrStateTraits<Aggregator4<StreamElement,
   Aggr4Func, Aggr4Col
   >> : std::true_type{};
 
+/**
+ * WindowedAggrFunc maps an aggregate function to a variant which is specialized
+ * for FIFO sliding windows (i.e. outdated tuples arrive in insertion order).
+ * All other functions are mapped to themselves.
+ */
+template <typename AggrFunc>
+struct WindowedAggrFunc { typedef AggrFunc type; };
+
+template <typename Tin, class Comparator>
+struct WindowedAggrFunc<AggrMinMax<Tin, Comparator>> {
+  typedef AggrWindowMinMax<Tin, Comparator> type;
+};
+
+/**
+ * WindowedAggrState maps an aggregation state class to the class where all
+ * aggregate functions are replaced according to WindowedAggrFunc. It is used
+ * by Pipe::aggregate if the input is a FIFO sliding window (see
+ * SlidingWindow::evictsInInsertionOrder) and may be requested explicitly otherwise.
+ */
+template <typename AggrState>
+struct WindowedAggrState { typedef AggrState type; };
+
+template <typename StreamElement, typename Aggr1Func, int Aggr1Col, typename KeyType>
+struct WindowedAggrState<Aggregator1<StreamElement, Aggr1Func, Aggr1Col, KeyType>> {
+  typedef Aggregator1<StreamElement,
+    typename WindowedAggrFunc<Aggr1Func>::type, Aggr1Col, KeyType> type;
+};
+
+template <
+	typename StreamElement,
+	typename Aggr1Func, int Aggr1Col,
+	typename Aggr2Func, int Aggr2Col,
+	typename KeyType
+>
+struct WindowedAggrState<Aggregator2<StreamElement, Aggr1Func, Aggr1Col, Aggr2Func, Aggr2Col, KeyType>> {
+  typedef Aggregator2<StreamElement,
+    typename WindowedAggrFunc<Aggr1Func>::type, Aggr1Col,
+    typename WindowedAggrFunc<Aggr2Func>::type, Aggr2Col, KeyType> type;
+};
+
+template <
+	typename StreamElement,
+	typename Aggr1Func, int Aggr1Col,
+	typename Aggr2Func, int Aggr2Col,
+	typename Aggr3Func, int Aggr3Col
+>
+struct WindowedAggrState<Aggregator3<StreamElement, Aggr1Func, Aggr1Col,
+  Aggr2Func, Aggr2Col, Aggr3Func, Aggr3Col>> {
+  typedef Aggregator3<StreamElement,
+    typename WindowedAggrFunc<Aggr1Func>::type, Aggr1Col,
+    typename WindowedAggrFunc<Aggr2Func>::type, Aggr2Col,
+    typename WindowedAggrFunc<Aggr3Func>::type, Aggr3Col> type;
+};
+
+template <
+	typename StreamElement,
+	typename Aggr1Func, int Aggr1Col,
+	typename Aggr2Func, int Aggr2Col,
+	typename Aggr3Func, int Aggr3Col,
+	typename Aggr4Func, int Aggr4Col
+>
+struct WindowedAggrState<Aggregator4<StreamElement, Aggr1Func, Aggr1Col,
+  Aggr2Func, Aggr2Col, Aggr3Func, Aggr3Col, Aggr4Func, Aggr4Col>> {
+  typedef Aggregator4<StreamElement,
+    typename WindowedAggrFunc<Aggr1Func>::type, Aggr1Col,
+    typename WindowedAggrFunc<Aggr2Func>::type, Aggr2Col,
+    typename WindowedAggrFunc<Aggr3Func>::type, Aggr3Col,
+    typename WindowedAggrFunc<Aggr4Func>::type, Aggr4Col> type;
+};
+
 } /* end namespace pfabric */
 
 
@@ -106,25 +106,33 @@ namespace pfabric {
      * @param tInterval
      *    the time interval in seconds to produce aggregation tuples (for trigger by timestamp)
      *    or in the number of tuples (for trigger by count)
+     * @param executor
+     *    optional executor running the trigger for TriggerByTime (instead of the timer wheel)
+     * @param timers
+     *    optional timer wheel running the trigger for TriggerByTime (default = TimerWheel::defaultWheel())
      */
     Aggregation(FinalFunc final_fun, IterateFunc it_fun,
-                AggregationTriggerType tType = TriggerAll, const unsigned int tInterval = 0) :
+                AggregationTriggerType tType = TriggerAll, const unsigned int tInterval = 0,
+                ExecutorPtr executor = nullptr, TimerWheelPtr timers = nullptr) :
                 mAggrState(std::make_shared<AggregateState>()),
                 mIterateFunc( it_fun ),
                 mFinalFunc( final_fun ),
                 mNotifier(tInterval > 0 && tType == TriggerByTime ?
-                  new TriggerNotifier(std::bind(&Aggregation::notificationCallback, this), tInterval) : nullptr),
-                mLastTriggerTime(0), mTriggerType(tType), mTriggerInterval( tInterval ), mCounter(0) {
+                  new TriggerNotifier(std::bind(&Aggregation::notificationCallback, this), tInterval, executor, timers) : nullptr),
+                mLastTriggerTime(0), mTriggerType(tType), mTriggerInterval( tInterval ), mCounter(0),
+                mUseWatermarks(false) {
     }
 
     Aggregation(AggregateStatePtr state, FinalFunc final_fun, IterateFunc it_fun,
-                AggregationTriggerType tType = TriggerAll, const unsigned int tInterval = 0) :
+                AggregationTriggerType tType = TriggerAll, const unsigned int tInterval = 0,
+                ExecutorPtr executor = nullptr, TimerWheelPtr timers = nullptr) :
                 mAggrState(state),
                 mIterateFunc( it_fun ),
                 mFinalFunc( final_fun ),
                 mNotifier(tInterval > 0 && tType == TriggerByTime ?
-                  new TriggerNotifier(std::bind(&Aggregation::notificationCallback, this), tInterval) : nullptr),
-                mLastTriggerTime(0), mTriggerType(tType), mTriggerInterval( tInterval ), mCounter(0) {
+                  new TriggerNotifier(std::bind(&Aggregation::notificationCallback, this), tInterval, executor, timers) : nullptr),
+                mLastTriggerTime(0), mTriggerType(tType), mTriggerInterval( tInterval ), mCounter(0),
+                mUseWatermarks(false) {
     }
     /**
      * Create a new aggregation operator which receives an input stream and
@@ -161,7 +169,7 @@ namespace pfabric {
                 mTimestampExtractor(func), mNotifier(nullptr), mLastTriggerTime(0),
                 mTriggerType(TriggerByTimestamp),
                 mTriggerInterval(std::chrono::duration_cast<Timestamp>(tInterval)),
-                mCounter(0) {}
+                mCounter(0), mUseWatermarks(false) {}
 
     /**
      * @brief Bind the callback for the data channel.
@@ -211,6 +219,9 @@ namespace pfabric {
             break;
           }
           case TriggerByTimestamp: {
+            // with watermarks the aggregate is triggered by the punctuations
+            if (mUseWatermarks)
+              break;
             const auto ts = mTimestampExtractor(data);
             if (ts - mLastTriggerTime >= boost::get<Timestamp>(mTriggerInterval)) {
               myLock.unlock();
@@ -234,12 +245,27 @@ namespace pfabric {
      * @brief This method is invoked when a punctuation arrives.
      *
      * Punctuation tuples can trigger aggregation results if specified for the operator
-     * via the punctuation mask.
+     * via the punctuation mask. A WindowExpired punctuation resets the aggregation
+     * state, i.e. the aggregate starts from scratch for the next (tumbling) window.
+     * For TriggerByTimestamp, Watermark punctuations are used as clock instead of
+     * the timestamps of the tuples as soon as the first watermark arrives.
      *
      * @param[in] punctuation
      *    the incoming punctuation tuple
      */
     void processPunctuation( const PunctuationPtr& punctuation ) {
+      if (punctuation->ptype() == Punctuation::WindowExpired) {
+        std::lock_guard<std::mutex> guard(aggrMtx);
+        mAggrState->init();
+      }
+      else if (punctuation->ptype() == Punctuation::Watermark && mTriggerType == TriggerByTimestamp) {
+        mUseWatermarks = true;
+        const auto wm = punctuation->getTimestamp();
+        if (wm - mLastTriggerTime >= boost::get<Timestamp>(mTriggerInterval)) {
+          notificationCallback();
+          mLastTriggerTime = wm;
+        }
+      }
       // if we receive a punctuation on expired slides we produce aggregates
       //TODO: already handled by notificationCallback?...
       /*
@@ -265,7 +291,7 @@ namespace pfabric {
     }
 
     /**
-     * A function called by the TriggerNotifier thread which periodically produces
+     * A function called by the TriggerNotifier timer which periodically produces
      * the aggregate value and a SlideExpired punctuation.
      */
     void notificationCallback() {
@@ -293,6 +319,7 @@ namespace pfabric {
                                                 //< for publishing aggregates
     unsigned int mCounter;                      //< the number of tuples processed since the
                                                 //< last aggregate publishing
+    bool mUseWatermarks;                        //< true if TriggerByTimestamp is driven by watermarks
   };
 
 }
@@ -0,0 +1,422 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BandJoin_hpp_
+#define BandJoin_hpp_
+
+#include <algorithm>
+#include <cstdint>
+
+#include <boost/core/ignore_unused.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include "qop/BinaryTransform.hpp"
+#include "qop/BandJoinBuckets.hpp"
+#include "ElementJoinTraits.hpp"
+#include "DefaultElementJoin.hpp"
+
+namespace pfabric {
+
+  /**
+   * \brief A band join of two streams on their timestamps and a key.
+   *
+   * The operator joins a tuple l of the left stream with a tuple r of the right
+   * stream if both have the same key, |ts(l) - ts(r)| <= delta and the join
+   * predicate is satisfied. Both inputs are stored in BandJoinBuckets, i.e. in
+   * runs per key sorted by timestamp and partitioned into time buckets of width
+   * delta. An incoming tuple probes only the buckets of the other input
+   * overlapping [ts - delta, ts + delta] and is then added to the state of its
+   * own input. Thus, each pair of tuples is joined exactly once and only new join
+   * results are published.
+   *
+   * The state is expired by the progress of the other input: assuming that each
+   * input is ordered by timestamp, a left tuple can no longer find a partner once
+   * the most recent timestamp of the right input exceeds ts(l) + delta (and vice
+   * versa). As soon as the first watermark arrives, the progress is given only by
+   * the watermarks, i.e. tuples arriving out of order within the lateness of the
+   * watermarks still find their partners. Tuples which are already behind this
+   * time bound still probe the other input but are not stored. Outdated tuples
+   * arriving at the operator are ignored.
+   *
+   * Each input has its own punctuation channel (see getLeftInputPunctuationChannel
+   * and getRightInputPunctuationChannel), because a watermark of one input says
+   * nothing about the other one. A watermark advances only the progress of its
+   * input, the operator forwards the minimum of the watermarks of both inputs and
+   * an EndOfStream punctuation once both inputs have ended. Punctuations arriving
+   * at the shared punctuation channel of the BinaryTransform hold for both inputs.
+   *
+   * @tparam LeftInputStreamElement
+   *    the data stream element type from the left source
+   * @tparam RightInputStreamElement
+   *    the data stream element type from the right source
+   * @tparam KeyType
+   *    the data type of the join keys
+   * @tparam ElementJoinImpl
+   *    the actual join algorithm to be used for joining two input elements
+   */
+  template<
+  typename LeftInputStreamElement,
+  typename RightInputStreamElement,
+  typename KeyType = DefaultKeyType,
+  typename ElementJoinImpl = DefaultElementJoin< LeftInputStreamElement, RightInputStreamElement >
+  >
+  class BandJoin : public BinaryTransform<LeftInputStreamElement, RightInputStreamElement,
+  typename ElementJoinTraits< ElementJoinImpl >::ResultElement>{
+    private:
+      PFABRIC_BINARY_TRANSFORM_TYPEDEFS(LeftInputStreamElement, RightInputStreamElement, typename ElementJoinTraits< ElementJoinImpl >::ResultElement);
+
+    public:
+      /**
+       * Typedef for the key extractor functions.
+       */
+      typedef std::function<KeyType(const LeftInputStreamElement&)> LKeyExtractorFunc;
+      typedef std::function<KeyType(const RightInputStreamElement&)> RKeyExtractorFunc;
+
+      /**
+       * Typedef for the timestamp extractor functions.
+       */
+      typedef std::function<Timestamp(const LeftInputStreamElement&)> LTimestampExtractorFunc;
+      typedef std::function<Timestamp(const RightInputStreamElement&)> RTimestampExtractorFunc;
+
+      /**
+       * Typedef for the pointer to a function implementing the join predicate.
+       */
+      typedef std::function< bool(const LeftInputStreamElement&, const RightInputStreamElement&) > JoinPredicateFunc;
+
+      const std::string opName() const override { return std::string("BandJoin"); }
+
+    private:
+      /// the indexed states of both inputs
+      typedef BandJoinBuckets< KeyType, LeftInputStreamElement > LState;
+      typedef BandJoinBuckets< KeyType, RightInputStreamElement > RState;
+
+      /// the join algorithm to be used for concatenating the input elements
+      typedef ElementJoinTraits< ElementJoinImpl > ElementJoin;
+
+      /// a mutex for protecting join processing from concurrent sources
+      typedef boost::mutex JoinMutex;
+
+      /// a scoped lock for the mutex
+      typedef boost::lock_guard< JoinMutex > Lock;
+
+      /**
+       * \brief The sink receiving the punctuations of one input.
+       *
+       * The sink forwards the punctuations to the join operator together
+       * with the input they belong to.
+       */
+      template< bool Left >
+      class PunctuationInput : public Sink< InputChannelParameters< false, DefaultSlotFunction, PunctuationPtr > > {
+        typedef Sink< InputChannelParameters< false, DefaultSlotFunction, PunctuationPtr > > SinkBase;
+
+      public:
+        /// the input channel type for incoming punctuation tuples
+        IMPORT_INPUT_CHANNEL_TYPE( SinkBase, 0, InputPunctuationChannel );
+
+        PunctuationInput(BandJoin& join) : mJoin(join) {}
+
+        /**
+         * @brief Bind the callback for the punctuation channel.
+         */
+        BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, PunctuationInput, processPunctuation );
+
+        /**
+         * @brief Get a reference to the punctuation channel of the input.
+         */
+        InputPunctuationChannel& getInputPunctuationChannel() {
+          return SinkBase::template getInputChannelByID< 0 >();
+        }
+
+      private:
+        void processPunctuation( const PunctuationPtr& punctuation ) {
+          mJoin.processInputPunctuation( punctuation, Left, !Left );
+        }
+
+        BandJoin& mJoin; //< the join operator
+      };
+
+    public:
+
+      /// the join result for two input elements
+      typedef typename ElementJoin::ResultElement ResultElement;
+
+      /**
+       * Constructs a new band join operator.
+       *
+       * \param lKeyFunc function for extracting the join key of tuples of the lhs stream
+       * \param rKeyFunc function for extracting the join key of tuples of the rhs stream
+       * \param lTsFunc function for extracting the timestamp of tuples of the lhs stream
+       * \param rTsFunc function for extracting the timestamp of tuples of the rhs stream
+       * \param joinPred function pointer to a join predicate (nullptr = key and band only)
+       * \param delta the maximal distance of the timestamps of two joined tuples
+       */
+      BandJoin( LKeyExtractorFunc lKeyFunc, RKeyExtractorFunc rKeyFunc,
+                LTimestampExtractorFunc lTsFunc, RTimestampExtractorFunc rTsFunc,
+                JoinPredicateFunc joinPred, Timestamp delta) :
+        mLState(std::max<std::uint64_t>(delta.count(), 1)), mRState(std::max<std::uint64_t>(delta.count(), 1)),
+        mJoinPredicate(joinPred), mLKeyExtractor(lKeyFunc), mRKeyExtractor(rKeyFunc),
+        mLTimestampExtractor(lTsFunc), mRTimestampExtractor(rTsFunc),
+        mDelta(delta.count()), mLNow(0), mRNow(0),
+        mLWatermark(0), mRWatermark(0), mWatermark(0), mUseWatermarks(false), mLEnded(false), mREnded(false),
+        mLPunctuationInput(*this), mRPunctuationInput(*this) {}
+
+      /**
+       * @brief Bind the callback for the left handside data channel.
+       */
+      BIND_INPUT_CHANNEL_DEFAULT( LeftInputChannel, BandJoin, processLeftDataElement );
+
+      /**
+       * @brief Bind the callback for the data channel.
+       */
+      BIND_INPUT_CHANNEL_DEFAULT( RightInputChannel, BandJoin, processRightDataElement );
+
+      /**
+       * @brief Bind the callback for the punctuation channel.
+       */
+      BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, BandJoin, processPunctuation );
+
+      /**
+       * @brief Get a reference to the punctuation channel of the left input.
+       */
+      typename PunctuationInput< true >::InputPunctuationChannel& getLeftInputPunctuationChannel() {
+        return mLPunctuationInput.getInputPunctuationChannel();
+      }
+
+      /**
+       * @brief Get a reference to the punctuation channel of the right input.
+       */
+      typename PunctuationInput< false >::InputPunctuationChannel& getRightInputPunctuationChannel() {
+        return mRPunctuationInput.getInputPunctuationChannel();
+      }
+
+      /**
+       * Returns the number of tuples currently kept in the states of both inputs.
+       *
+       * @return the number of tuples
+       */
+      std::size_t stateSize() const {
+        Lock lock( mMtx );
+        return mLState.size() + mRState.size();
+      }
+
+    private:
+      ////////////   channel callbacks   ////////////
+
+      /**
+       * @brief This method is invoked when a data stream element arrives from the left input channel.
+       *
+       * It joins the element with the tuples of the right input within the band
+       * and inserts it into the state of the left input.
+       *
+       * @param[in] left
+       *    the incoming stream element from the left input channel
+       * @param[in] outdated
+       *    flag indicating whether the tuple is new or invalidated now (outdated tuples are ignored)
+       */
+      void processLeftDataElement( const LeftInputStreamElement& left, const bool outdated ) {
+        if (outdated)
+          return;
+        Lock lock( mMtx );
+
+        const std::uint64_t ts = mLTimestampExtractor(left).count();
+        if (!mUseWatermarks)
+          advanceLeftTime(ts, lock);
+
+        auto keyval = mLKeyExtractor( left );
+        mRState.probe(keyval, timeBound(ts), ts + mDelta, [&](const RightInputStreamElement& right) {
+          joinTuples(left, right);
+        });
+        if (ts >= timeBound(mRNow))
+          mLState.insert(keyval, ts, left);
+      }
+
+      /**
+       * @brief This method is invoked when a data stream element arrives from the right input channel.
+       *
+       * It joins the element with the tuples of the left input within the band
+       * and inserts it into the state of the right input.
+       *
+       * @param[in] right
+       *    the incoming stream element from the right input channel
+       * @param[in] outdated
+       *    flag indicating whether the tuple is new or invalidated now (outdated tuples are ignored)
+       */
+      void processRightDataElement( const RightInputStreamElement& right, const bool outdated ) {
+        if (outdated)
+          return;
+        Lock lock( mMtx );
+
+        const std::uint64_t ts = mRTimestampExtractor(right).count();
+        if (!mUseWatermarks)
+          advanceRightTime(ts, lock);
+
+        auto keyval = mRKeyExtractor( right );
+        mLState.probe(keyval, timeBound(ts), ts + mDelta, [&](const LeftInputStreamElement& left) {
+          joinTuples(left, right);
+        });
+        if (ts >= timeBound(mLNow))
+          mRState.insert(keyval, ts, right);
+      }
+
+      /**
+       * @brief This method is invoked when a punctuation arrives at the shared punctuation channel.
+       *
+       * The punctuation holds for both inputs.
+       *
+       * @param[in] punctuation
+       *    the incoming punctuation tuple
+       */
+      void processPunctuation( const PunctuationPtr& punctuation ) {
+        processInputPunctuation( punctuation, true, true );
+      }
+
+      /**
+       * @brief This method is invoked when a punctuation arrives from an input.
+       *
+       * A watermark advances the progress of its input and expires the state of
+       * the other input. From the first watermark on, the states are expired only
+       * by watermarks. The minimum of the watermarks of both inputs is forwarded
+       * if it has progressed, EndOfStream is forwarded once both inputs have ended
+       * and all other punctuations are forwarded directly.
+       *
+       * @param[in] punctuation
+       *    the incoming punctuation tuple
+       * @param[in] left
+       *    true if the punctuation holds for the left input
+       * @param[in] right
+       *    true if the punctuation holds for the right input
+       */
+      void processInputPunctuation( const PunctuationPtr& punctuation, bool left, bool right ) {
+        PunctuationPtr out;
+        {
+          Lock lock( mMtx );
+          if (punctuation->ptype() == Punctuation::Watermark) {
+            const std::uint64_t ts = punctuation->getTimestamp().count();
+            mUseWatermarks = true;
+            if (left && ts > mLWatermark) {
+              mLWatermark = ts;
+              advanceLeftTime(ts, lock);
+            }
+            if (right && ts > mRWatermark) {
+              mRWatermark = ts;
+              advanceRightTime(ts, lock);
+            }
+            const std::uint64_t wm = std::min(mLWatermark, mRWatermark);
+            if (wm > mWatermark) {
+              mWatermark = wm;
+              out = std::make_shared<Punctuation>(Punctuation::Watermark,
+                                                  Timestamp(static_cast<Timestamp::rep>(wm)));
+            }
+          }
+          else if (punctuation->ptype() == Punctuation::EndOfStream) {
+            const bool ended = mLEnded && mREnded;
+            mLEnded = mLEnded || left;
+            mREnded = mREnded || right;
+            if (!ended && mLEnded && mREnded)
+              out = punctuation;
+          }
+          else
+            out = punctuation;
+        }
+        if (out)
+          this->getOutputPunctuationChannel().publish( out );
+      }
+
+      ////////////   helper methods   ////////////
+
+      /**
+       * Returns the minimal timestamp of a tuple which can be joined with a tuple of the given timestamp.
+       */
+      std::uint64_t timeBound(std::uint64_t ts) const {
+        return ts >= mDelta ? ts - mDelta : 0;
+      }
+
+      /**
+       * @brief Advances the progress of the left input and expires the state of the right input.
+       *
+       * @param[in] ts
+       *    the timestamp of a tuple or watermark of the left input (in microseconds)
+       * @param[in] lock
+       *    reference to the lock protecting the states
+       */
+      void advanceLeftTime(std::uint64_t ts, const Lock& lock) {
+        boost::ignore_unused( lock );
+        if (ts > mLNow) {
+          mLNow = ts;
+          mRState.expire(timeBound(mLNow));
+        }
+      }
+
+      /**
+       * @brief Advances the progress of the right input and expires the state of the left input.
+       *
+       * @param[in] ts
+       *    the timestamp of a tuple or watermark of the right input (in microseconds)
+       * @param[in] lock
+       *    reference to the lock protecting the states
+       */
+      void advanceRightTime(std::uint64_t ts, const Lock& lock) {
+        boost::ignore_unused( lock );
+        if (ts > mRNow) {
+          mRNow = ts;
+          mLState.expire(timeBound(mRNow));
+        }
+      }
+
+      /**
+       * @brief Join two tuples and publish the result.
+       *
+       * This method joins two input tuples and produces a result if the join predicate matches.
+       *
+       * @param[in] left
+       *    the tuple from the left handside of the join
+       * @param[in] right
+       *    the tuple from the right handside of the join
+       */
+      void joinTuples( const LeftInputStreamElement& left, const RightInputStreamElement& right) {
+        if( !mJoinPredicate || mJoinPredicate( left, right ) ) {
+          ResultElement joinedTuple = ElementJoin::joinElements( left, right );
+          this->getOutputDataChannel().publish( joinedTuple, false );
+        }
+      }
+
+      LState mLState;                                //< the indexed state of the lhs stream
+      RState mRState;                                //< the indexed state of the rhs stream
+      JoinPredicateFunc mJoinPredicate;              //< a pointer to the function implementing the join predicate
+      LKeyExtractorFunc mLKeyExtractor;              //< key extractor for the lhs stream
+      RKeyExtractorFunc mRKeyExtractor;              //< key extractor for the rhs stream
+      LTimestampExtractorFunc mLTimestampExtractor;  //< timestamp extractor for the lhs stream
+      RTimestampExtractorFunc mRTimestampExtractor;  //< timestamp extractor for the rhs stream
+      std::uint64_t mDelta;                          //< the band width (microseconds)
+      std::uint64_t mLNow;                           //< the most recent timestamp of the lhs stream or watermark
+      std::uint64_t mRNow;                           //< the most recent timestamp of the rhs stream or watermark
+      std::uint64_t mLWatermark;                     //< the most recent watermark of the lhs stream
+      std::uint64_t mRWatermark;                     //< the most recent watermark of the rhs stream
+      std::uint64_t mWatermark;                      //< the most recent watermark forwarded
+      bool mUseWatermarks;                           //< true if the states are expired only by watermarks
+      bool mLEnded;                                  //< true if the lhs stream has ended
+      bool mREnded;                                  //< true if the rhs stream has ended
+      PunctuationInput< true > mLPunctuationInput;   //< the punctuation channel of the lhs stream
+      PunctuationInput< false > mRPunctuationInput;  //< the punctuation channel of the rhs stream
+      mutable JoinMutex mMtx;
+    };
+
+} /* end namespace pfabric */
+
+
+#endif
@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BandJoinBuckets_hpp_
+#define BandJoinBuckets_hpp_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "qop/FlatHashTable.hpp"
+
+namespace pfabric {
+
+  /**
+   * @brief The state of one input of a band join, indexed by key and timestamp.
+   *
+   * BandJoinBuckets stores the stream elements of one join input together with
+   * their timestamp. The timestamps are divided into consecutive buckets of a
+   * fixed width (usually the band width of the join). Each bucket maps a key via
+   * a FlatHashTable to a run of the elements with this key, sorted by timestamp.
+   * Thus, a probe for a time range visits only the buckets overlapping the range
+   * and finds the first matching element of a run by binary search. Elements
+   * arriving in timestamp order are simply appended to their run, late elements
+   * are inserted at their position.
+   *
+   * Only non-empty buckets are kept (ordered by time), so gaps in the timestamps
+   * do not cost any memory. As soon as all timestamps of the oldest bucket are
+   * below the time bound the whole bucket is dropped. Dropped buckets and their
+   * runs are recycled, i.e. in a steady state no memory is allocated.
+   *
+   * @tparam KeyType
+   *    the data type of the join keys
+   * @tparam StreamElement
+   *    the data stream element type of the input
+   * @tparam KeyHash
+   *    the hash function for the keys
+   */
+  template <typename KeyType, typename StreamElement,
+            typename KeyHash = boost::hash<KeyType>>
+  class BandJoinBuckets {
+    /// a stored element
+    struct Entry {
+      std::uint64_t mStamp;    //< the timestamp of the element
+      StreamElement mElement;  //< the stream element
+    };
+
+    /// a run of elements with the same key, sorted by timestamp
+    typedef std::vector<Entry> Run;
+
+    /// the elements of a range of timestamps
+    struct Bucket {
+      std::uint64_t mId;                                     //< the timestamp divided by the bucket width
+      std::vector<Run> mRuns;                                //< the runs (only the first mNumRuns are used)
+      std::uint32_t mNumRuns;                                //< the number of used runs
+      std::size_t mSize;                                     //< the number of elements of the bucket
+      FlatHashTable<KeyType, std::uint32_t, KeyHash> mKeys;  //< the index of the run per key
+    };
+
+    typedef std::unique_ptr<Bucket> BucketPtr;
+
+  public:
+    /**
+     * Creates a new, empty state.
+     *
+     * @param bucketWidth
+     *    the range of timestamps covered by a single bucket (at least 1)
+     */
+    explicit BandJoinBuckets(std::uint64_t bucketWidth) :
+      mBucketWidth(bucketWidth > 0 ? bucketWidth : 1), mSize(0) {}
+
+    /**
+     * Inserts an element.
+     *
+     * @param key
+     *    the join key of the element
+     * @param stamp
+     *    the timestamp of the element
+     * @param element
+     *    the stream element
+     */
+    void insert(const KeyType& key, std::uint64_t stamp, const StreamElement& element) {
+      Bucket& bucket = findOrCreateBucket(stamp / mBucketWidth);
+      auto res = bucket.mKeys.tryEmplace(key, bucket.mNumRuns);
+      if (res.second) {
+        if (bucket.mNumRuns == bucket.mRuns.size())
+          bucket.mRuns.emplace_back();
+        bucket.mNumRuns++;
+      }
+      Run& run = bucket.mRuns[*res.first];
+      if (run.empty() || run.back().mStamp <= stamp)
+        run.push_back({ stamp, element });
+      else
+        run.insert(std::upper_bound(run.begin(), run.end(), stamp, StampLess()), { stamp, element });
+      bucket.mSize++;
+      mSize++;
+    }
+
+    /**
+     * Invokes the given function for each element with the given key and a
+     * timestamp in [minStamp, maxStamp] (in timestamp order).
+     *
+     * @param key
+     *    the join key to look up
+     * @param minStamp
+     *    the minimal timestamp of the elements
+     * @param maxStamp
+     *    the maximal timestamp of the elements
+     * @param func
+     *    the function called with each matching stream element
+     */
+    template <typename Func>
+    void probe(const KeyType& key, std::uint64_t minStamp, std::uint64_t maxStamp, Func func) const {
+      const auto maxId = maxStamp / mBucketWidth;
+      for (auto b = lowerBound(minStamp / mBucketWidth); b != mBuckets.end() && (*b)->mId <= maxId; b++) {
+        const Bucket& bucket = **b;
+        auto idx = bucket.mKeys.find(key);
+        if (idx == nullptr)
+          continue;
+        const Run& run = bucket.mRuns[*idx];
+        auto e = run.begin();
+        if (e->mStamp < minStamp)
+          e = std::lower_bound(run.begin(), run.end(), minStamp, StampLess());
+        for (; e != run.end() && e->mStamp <= maxStamp; e++)
+          func(e->mElement);
+      }
+    }
+
+    /**
+     * Drops all buckets which contain only timestamps < minStamp.
+     *
+     * @param minStamp
+     *    the minimal timestamp of the elements which are still needed
+     * @return the number of dropped elements
+     */
+    std::size_t expire(std::uint64_t minStamp) {
+      std::size_t num = 0;
+      while (!mBuckets.empty() && (mBuckets.front()->mId + 1) * mBucketWidth <= minStamp) {
+        BucketPtr bucket = std::move(mBuckets.front());
+        mBuckets.pop_front();
+        num += bucket->mSize;
+        for (std::uint32_t i = 0; i < bucket->mNumRuns; i++)
+          bucket->mRuns[i].clear();
+        bucket->mNumRuns = 0;
+        bucket->mSize = 0;
+        bucket->mKeys.clear();
+        mFreeBuckets.push_back(std::move(bucket));
+      }
+      mSize -= num;
+      return num;
+    }
+
+    /**
+     * Removes all elements.
+     */
+    void clear() { expire(UINT64_MAX); }
+
+    /**
+     * Returns the number of stored elements.
+     */
+    std::size_t size() const { return mSize; }
+
+    /**
+     * Returns the number of buckets containing elements.
+     */
+    std::size_t numBuckets() const { return mBuckets.size(); }
+
+  private:
+    /// compares the timestamps of entries
+    struct StampLess {
+      bool operator()(const Entry& e, std::uint64_t stamp) const { return e.mStamp < stamp; }
+      bool operator()(std::uint64_t stamp, const Entry& e) const { return stamp < e.mStamp; }
+    };
+
+    typedef typename std::deque<BucketPtr>::const_iterator BucketIterator;
+
+    /**
+     * Returns the first bucket with an id >= the given id.
+     */
+    BucketIterator lowerBound(std::uint64_t id) const {
+      if (mBuckets.empty() || mBuckets.front()->mId >= id)
+        return mBuckets.begin();
+      return std::lower_bound(mBuckets.begin(), mBuckets.end(), id,
+                              [](const BucketPtr& b, std::uint64_t i) { return b->mId < i; });
+    }
+
+    /**
+     * Returns the bucket with the given id which is created if it does not exist yet.
+     */
+    Bucket& findOrCreateBucket(std::uint64_t id) {
+      if (mBuckets.empty() || mBuckets.back()->mId < id) {
+        mBuckets.push_back(newBucket(id));
+        return *mBuckets.back();
+      }
+      if (mBuckets.back()->mId == id)
+        return *mBuckets.back();
+      // a late element
+      auto pos = mBuckets.begin() + (lowerBound(id) - mBuckets.cbegin());
+      if (pos != mBuckets.end() && (*pos)->mId == id)
+        return **pos;
+      return **mBuckets.insert(pos, newBucket(id));
+    }
+
+    /**
+     * Returns an empty bucket for the given id, recycling a dropped bucket
+     * if possible.
+     */
+    BucketPtr newBucket(std::uint64_t id) {
+      BucketPtr bucket;
+      if (!mFreeBuckets.empty()) {
+        bucket = std::move(mFreeBuckets.back());
+        mFreeBuckets.pop_back();
+      }
+      else {
+        bucket.reset(new Bucket());
+        bucket->mNumRuns = 0;
+        bucket->mSize = 0;
+      }
+      bucket->mId = id;
+      return bucket;
+    }
+
+    std::uint64_t mBucketWidth;            //< the range of timestamps per bucket
+    std::deque<BucketPtr> mBuckets;        //< the non-empty buckets from the oldest to the newest one
+    std::vector<BucketPtr> mFreeBuckets;   //< dropped buckets for reuse
+    std::size_t mSize;                     //< the number of stored elements
+  };
+
+} /* end namespace pfabric */
+
+#endif
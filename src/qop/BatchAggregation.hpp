@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BatchAggregation_hpp_
+#define BatchAggregation_hpp_
+
+#include <unordered_map>
+#include <vector>
+
+#include "core/TupleBatch.hpp"
+#include "qop/OperatorMacros.hpp"
+#include "qop/UnaryTransform.hpp"
+
+namespace pfabric {
+
+  /**
+   * @brief A batch-native aggregation operator.
+   *
+   * BatchAggregation computes aggregates over a stream of TupleBatches. For
+   * each incoming batch the iterate function is invoked once with the whole
+   * batch and the aggregation state, so that it can update the state with
+   * tight loops over the columns (e.g. using @c TupleBatch::sum or
+   * @c TupleBatch::count). Afterwards, the result of the final function is
+   * published, i.e. one aggregate tuple is produced per batch.
+   *
+   * @code
+   * struct SumState { double sum = 0.0; long cnt = 0; };
+   * ...
+   *   .aggregateBatch<TuplePtr<double, long>, SumState>(
+   *      [](const auto& batch, SumState& s) { s.sum += batch.template sum<1>(); s.cnt += batch.count(); },
+   *      [](const SumState& s) { return makeTuplePtr(s.sum, s.cnt); })
+   * @endcode
+   *
+   * @tparam InputStreamElement
+   *    the data stream element type (TupleBatchPtr) consumed by the aggregation
+   * @tparam OutputStreamElement
+   *    the data stream element type produced by the aggregation
+   * @tparam AggregateState
+   *    the (default constructible) type of the aggregation state
+   * @tparam IterateFunc
+   *    the type of the iterate function: <tt>void (const TupleBatch<...>&, AggregateState&)</tt>
+   * @tparam FinalFunc
+   *    the type of the final function: <tt>OutputStreamElement (const AggregateState&)</tt>
+   */
+  template<
+    typename InputStreamElement,
+    typename OutputStreamElement,
+    typename AggregateState,
+    typename IterateFunc,
+    typename FinalFunc
+  >
+  class BatchAggregation : public UnaryTransform< InputStreamElement, OutputStreamElement > {
+  protected:
+    PFABRIC_UNARY_TRANSFORM_TYPEDEFS(InputStreamElement, OutputStreamElement);
+
+    typedef typename TupleBatchTraits<InputStreamElement>::BatchType BatchType;
+
+  public:
+    /**
+     * Creates a new batch aggregation operator.
+     *
+     * @param iterFun the function for updating the aggregation state with a batch
+     * @param finalFun the function for producing the aggregation result
+     */
+    BatchAggregation(IterateFunc iterFun, FinalFunc finalFun) :
+      mIterateFunc(iterFun), mFinalFunc(finalFun) {}
+
+    /**
+     * @brief Bind the callback for the data channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT( InputDataChannel, BatchAggregation, processDataElement );
+
+    /**
+     * @brief Bind the callback for the punctuation channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, BatchAggregation, processPunctuation );
+
+    const std::string opName() const override { return std::string("BatchAggregation"); }
+
+  protected:
+    /**
+     * @brief This method is invoked when a batch arrives from the publisher.
+     *
+     * It updates the aggregation state and publishes the new aggregate value.
+     *
+     * @param[in] data
+     *    the incoming batch
+     * @param[in] outdated
+     *    flag indicating whether the batch is new or invalidated now
+     */
+    void processDataElement( const InputStreamElement& data, const bool outdated ) {
+      const BatchType& batch = get<0>(data);
+      if (batch.empty()) return;
+      mIterateFunc(batch, mState);
+      this->getOutputDataChannel().publish(mFinalFunc(mState), false);
+    }
+
+    /**
+     * @brief This method is invoked when a punctuation arrives.
+     *
+     * It simply forwards the punctuation to the subscribers.
+     *
+     * @param[in] punctuation
+     *    the incoming punctuation tuple
+     */
+    void processPunctuation( const PunctuationPtr& punctuation ) {
+      this->getOutputPunctuationChannel().publish(punctuation);
+    }
+
+    AggregateState mState;     //< the current aggregation state
+    IterateFunc mIterateFunc;  //< the function for updating the state
+    FinalFunc mFinalFunc;      //< the function for producing the result
+  };
+
+  /**
+   * @brief A batch-native grouped aggregation operator.
+   *
+   * BatchGroupedAggregation groups the rows of incoming TupleBatches by the
+   * value of the column @c KeyID and maintains a separate aggregation state
+   * for each group. The iterate function is invoked for each visible row
+   * together with the state of its group. After a batch was processed, an
+   * aggregate tuple is published for each group which was updated by the
+   * batch (instead of one tuple per input row as in GroupedAggregation).
+   *
+   * @tparam InputStreamElement
+   *    the data stream element type (TupleBatchPtr) consumed by the aggregation
+   * @tparam OutputStreamElement
+   *    the data stream element type produced by the aggregation
+   * @tparam AggregateState
+   *    the (default constructible) type of the aggregation state of a group
+   * @tparam KeyID
+   *    the index of the column used as grouping key
+   * @tparam IterateFunc
+   *    the type of the iterate function:
+   *    <tt>void (const TupleBatch<...>&, std::size_t, AggregateState&)</tt>
+   * @tparam FinalFunc
+   *    the type of the final function:
+   *    <tt>OutputStreamElement (const KeyType&, const AggregateState&)</tt>
+   */
+  template<
+    typename InputStreamElement,
+    typename OutputStreamElement,
+    typename AggregateState,
+    AttributeIdx KeyID,
+    typename IterateFunc,
+    typename FinalFunc
+  >
+  class BatchGroupedAggregation : public UnaryTransform< InputStreamElement, OutputStreamElement > {
+  protected:
+    PFABRIC_UNARY_TRANSFORM_TYPEDEFS(InputStreamElement, OutputStreamElement);
+
+    typedef typename TupleBatchTraits<InputStreamElement>::BatchType BatchType;
+    typedef typename BatchType::template getAttributeType<KeyID>::type KeyType;
+
+    /// the state of a group together with the number of the batch which updated it last
+    struct GroupEntry {
+      GroupEntry() : lastBatch(0) {}
+      AggregateState state;
+      std::size_t lastBatch;
+    };
+    typedef std::unordered_map<KeyType, GroupEntry> GroupTable;
+
+  public:
+    /**
+     * Creates a new batch grouped aggregation operator.
+     *
+     * @param iterFun the function for updating the group state with a row
+     * @param finalFun the function for producing the aggregation result of a group
+     */
+    BatchGroupedAggregation(IterateFunc iterFun, FinalFunc finalFun) :
+      mIterateFunc(iterFun), mFinalFunc(finalFun), mBatchCounter(0) {}
+
+    /**
+     * @brief Bind the callback for the data channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT( InputDataChannel, BatchGroupedAggregation, processDataElement );
+
+    /**
+     * @brief Bind the callback for the punctuation channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, BatchGroupedAggregation, processPunctuation );
+
+    const std::string opName() const override { return std::string("BatchGroupedAggregation"); }
+
+  protected:
+    /**
+     * @brief This method is invoked when a batch arrives from the publisher.
+     *
+     * It updates the states of the groups of all visible rows and publishes
+     * the new aggregate values of the updated groups.
+     *
+     * @param[in] data
+     *    the incoming batch
+     * @param[in] outdated
+     *    flag indicating whether the batch is new or invalidated now
+     */
+    void processDataElement( const InputStreamElement& data, const bool outdated ) {
+      const BatchType& batch = get<0>(data);
+      const auto& keys = batch.template column<KeyID>();
+      mBatchCounter++;
+      mUpdated.clear();
+      batch.forEachRow([&](std::size_t r) {
+        auto& entry = *mGroups.emplace(keys[r], GroupEntry()).first;
+        if (entry.second.lastBatch != mBatchCounter) {
+          entry.second.lastBatch = mBatchCounter;
+          mUpdated.push_back(&entry);
+        }
+        mIterateFunc(batch, r, entry.second.state);
+      });
+      for (auto entry : mUpdated)
+        this->getOutputDataChannel().publish(mFinalFunc(entry->first, entry->second.state), false);
+    }
+
+    /**
+     * @brief This method is invoked when a punctuation arrives.
+     *
+     * It simply forwards the punctuation to the subscribers.
+     *
+     * @param[in] punctuation
+     *    the incoming punctuation tuple
+     */
+    void processPunctuation( const PunctuationPtr& punctuation ) {
+      this->getOutputPunctuationChannel().publish(punctuation);
+    }
+
+    GroupTable mGroups;                                    //< the aggregation states of all groups
+    std::vector<typename GroupTable::value_type*> mUpdated; //< the groups updated by the current batch
+    IterateFunc mIterateFunc;                              //< the function for updating a group state
+    FinalFunc mFinalFunc;                                  //< the function for producing the result
+    std::size_t mBatchCounter;                             //< the number of processed batches
+  };
+
+} /* end namespace pfabric */
+
+#endif
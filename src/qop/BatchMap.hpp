@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BatchMap_hpp_
+#define BatchMap_hpp_
+
+#include "core/TupleBatch.hpp"
+#include "qop/UnaryTransform.hpp"
+#include "qop/OperatorMacros.hpp"
+
+namespace pfabric {
+
+/**
+ * @brief A batch-native projection operator.
+ *
+ * BatchMap applies a projection function to all visible rows of an incoming
+ * TupleBatch and produces a new (dense) batch from the results. The outdated
+ * flags of the rows are preserved. The function is a template parameter, is
+ * called with the input batch and a row index and returns the values of the
+ * output row as @c std::tuple:
+ * @code
+ * [](const auto& batch, std::size_t row) {
+ *   return std::make_tuple(get<1>(batch, row) * 2.0, get<0>(batch, row));
+ * }
+ * @endcode
+ *
+ * @tparam InputStreamElement
+ *    the data stream element type (TupleBatchPtr) consumed by the projection
+ * @tparam OutputStreamElement
+ *    the data stream element type (TupleBatchPtr) produced by the projection
+ * @tparam MapFunc
+ *    the type of the projection function:
+ *    <tt>std::tuple<...> (const TupleBatch<...>&, std::size_t)</tt>
+ */
+template<
+	typename InputStreamElement,
+	typename OutputStreamElement,
+	typename MapFunc
+>
+class BatchMap :
+	public UnaryTransform< InputStreamElement, OutputStreamElement > // use default unary transform
+{
+private:
+	PFABRIC_UNARY_TRANSFORM_TYPEDEFS(InputStreamElement, OutputStreamElement)
+
+	typedef typename TupleBatchTraits<InputStreamElement>::BatchType InputBatchType;
+	typedef typename TupleBatchTraits<OutputStreamElement>::BatchType OutputBatchType;
+
+public:
+	/**
+	 * @brief Construct a new instance of the batch map operator.
+	 *
+	 * @param f the projection function
+	 */
+	BatchMap(MapFunc f) : mFunc(f) {}
+
+	/**
+	 * @brief Bind the callback for the data channel.
+	 */
+	BIND_INPUT_CHANNEL_DEFAULT( InputDataChannel, BatchMap, processDataElement );
+
+	/**
+	 * @brief Bind the callback for the punctuation channel.
+	 */
+	BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, BatchMap, processPunctuation );
+
+	const std::string opName() const override { return std::string("BatchMap"); }
+
+private:
+
+	/**
+	 * @brief This method is invoked when a punctuation arrives.
+	 *
+	 * It simply forwards the punctuation to the subscribers.
+	 *
+	 * @param[in] punctuation
+	 *    the incoming punctuation tuple
+	 */
+	void processPunctuation( const PunctuationPtr& punctuation ) {
+		this->getOutputPunctuationChannel().publish(punctuation);
+	}
+
+	/**
+	 * This method is invoked when a batch arrives.
+	 *
+	 * It applies the projection function to each visible row and forwards the
+	 * resulting batch to its subscribers.
+	 *
+	 * @param[in] data
+	 *    the incoming batch
+	 * @param[in] outdated
+	 *    flag indicating whether the batch is new or invalidated now
+	 */
+	void processDataElement( const InputStreamElement& data, const bool outdated ) {
+		const InputBatchType& batch = get<0>(data);
+		OutputBatchType result(batch.size());
+		batch.forEachRow([&](std::size_t r) {
+			result.appendRow(mFunc(batch, r), batch.isOutdated(r));
+		});
+		this->getOutputDataChannel().publish(makeTuplePtr(std::move(result)), outdated);
+	}
+
+	MapFunc mFunc; //< the projection function
+};
+
+}
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BatchWhere_hpp_
+#define BatchWhere_hpp_
+
+#include "core/TupleBatch.hpp"
+#include "qop/UnaryTransform.hpp"
+#include "qop/OperatorMacros.hpp"
+
+namespace pfabric {
+
+  /**
+   * @brief A batch-native selection operator.
+   *
+   * BatchWhere evaluates a predicate on all visible rows of an incoming
+   * TupleBatch and forwards a batch restricted to the qualifying rows. The
+   * columns are not copied: the result shares the column data with the input
+   * batch and only carries a new selection vector. Batches without any
+   * qualifying row are dropped.
+   *
+   * The predicate is a template parameter (not a std::function) and is called
+   * with the batch and a row index, so that it can be inlined into the loop:
+   * @code
+   * [](const auto& batch, std::size_t row) { return get<0>(batch, row) % 2 == 0; }
+   * @endcode
+   *
+   * @tparam StreamElement
+   *    the data stream element type (TupleBatchPtr) which shall be filtered
+   * @tparam Predicate
+   *    the type of the predicate: <tt>bool (const TupleBatch<...>&, std::size_t)</tt>
+   */
+  template<typename StreamElement, typename Predicate>
+  class BatchWhere : public UnaryTransform<StreamElement, StreamElement> {
+  private:
+    PFABRIC_UNARY_TRANSFORM_TYPEDEFS(StreamElement, StreamElement);
+
+    typedef typename TupleBatchTraits<StreamElement>::BatchType BatchType;
+
+  public:
+    /**
+     * Create a new batch filter operator evaluating the given predicate
+     * on each row of the incoming batches.
+     *
+     * @param pred the filter predicate
+     */
+    BatchWhere(Predicate pred) : mPred(pred) {}
+
+    /**
+     * @brief Bind the callback for the data channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT(InputDataChannel, BatchWhere, processDataElement);
+
+    /**
+     * @brief Bind the callback for the punctuation channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT(InputPunctuationChannel, BatchWhere, processPunctuation);
+
+    const std::string opName() const override { return std::string("BatchWhere"); }
+
+  private:
+
+    /**
+     * @brief This method is invoked when a punctuation arrives.
+     *
+     * It simply forwards the @c punctuation to the subscribers.
+     *
+     * @param[in] punctuation
+     *    the incoming punctuation tuple
+     */
+    void processPunctuation(const PunctuationPtr& punctuation) {
+      this->getOutputPunctuationChannel().publish(punctuation);
+    }
+
+    /**
+     * @brief This method is invoked when a batch arrives from the publisher.
+     *
+     * It computes the selection vector of the qualifying rows and forwards
+     * the restricted batch (or the input batch if all rows qualify).
+     *
+     * @param[in] data
+     *    the incoming batch
+     * @param[in] outdated
+     *    flag indicating whether the batch is new or invalidated now
+     */
+    void processDataElement(const StreamElement& data, const bool outdated) {
+      const BatchType& batch = get<0>(data);
+      const std::size_t n = batch.size();
+      typename BatchType::SelectionVector sel(n);
+      std::size_t k = 0;
+      // branch-free compaction of the qualifying row indexes
+      if (batch.hasSelection()) {
+        const auto* in = batch.selection().data();
+        for (std::size_t i = 0; i < n; i++) {
+          sel[k] = in[i];
+          k += mPred(batch, in[i]) ? 1 : 0;
+        }
+      }
+      else {
+        for (std::size_t i = 0; i < n; i++) {
+          sel[k] = static_cast<std::uint32_t>(i);
+          k += mPred(batch, i) ? 1 : 0;
+        }
+      }
+      if (k == n) {
+        if (n > 0) this->getOutputDataChannel().publish(data, outdated);
+      }
+      else if (k > 0) {
+        sel.resize(k);
+        this->getOutputDataChannel().publish(makeTuplePtr(batch.select(std::move(sel))), outdated);
+      }
+    }
+
+    Predicate mPred; //< the filter predicate
+  };
+
+} // namespace pfabric
+
+#endif
@@ -20,6 +20,7 @@
 
 #include <vector>
 
+#include "core/TupleBatch.hpp"
 #include "qop/UnaryTransform.hpp"
 #include "qop/OperatorMacros.hpp"
 
@@ -185,6 +186,158 @@ namespace pfabric {
 	  }
   };
 
+  /**
+   * @brief A column batcher gathers tuples into a columnar TupleBatch.
+   *
+   * In contrast to the Batcher, the tuples are not kept as pointers but their
+   * attribute values are copied into the columns of a TupleBatch which can be
+   * processed by the batch-native operators (BatchWhere, BatchMap, ...).
+   * When the batch size is reached, the batch is forwarded to the next
+   * operators. The remaining tuples are forwarded as a (smaller) batch when a
+   * punctuation arrives.
+   *
+   * @tparam InputStreamElement
+   *    the data stream element type (TuplePtr) which shall be batched
+   */
+  template <typename InputStreamElement>
+  class ColumnBatcher : public UnaryTransform< InputStreamElement,
+                                               typename TupleBatchTraits<InputStreamElement>::type >
+  {
+  typedef typename TupleBatchTraits<InputStreamElement>::type OutputStreamElement;
+  typedef typename TupleBatchTraits<InputStreamElement>::BatchType BatchType;
+
+  private:
+    PFABRIC_UNARY_TRANSFORM_TYPEDEFS(InputStreamElement, OutputStreamElement)
+
+  public:
+    /**
+     * @brief Create a new column batcher.
+     *
+     * @param batchSize
+     *    the number of tuples per batch
+     */
+    ColumnBatcher(std::size_t batchSize) : mBatchSize(batchSize), mBatch(batchSize) {}
+
+    /**
+     * @brief Bind the callback for the data channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT( InputDataChannel, ColumnBatcher, processDataElement );
+
+    /**
+     * @brief Bind the callback for the punctuation channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, ColumnBatcher, processPunctuation );
+
+    const std::string opName() const override { return std::string("ColumnBatcher"); }
+
+  private:
+
+    /**
+     * @brief This method is invoked when a punctuation arrives.
+     *
+     * It forwards the pending tuples as batch followed by the punctuation.
+     *
+     * @param[in] punctuation
+     *    the incoming punctuation tuple
+     */
+    void processPunctuation( const PunctuationPtr& punctuation ) {
+      if (!mBatch.empty())
+        publishBatch();
+      this->getOutputPunctuationChannel().publish(punctuation);
+    }
+
+    /**
+     * This method is invoked when a data stream element arrives.
+     *
+     * It appends the element to the columns of the batch. When the batch is full,
+     * it is forwarded to its subscribers.
+     *
+     * @param[in] data
+     *    the incoming stream element
+     * @param[in] outdated
+     *    flag indicating whether the tuple is new or invalidated now
+     */
+    void processDataElement( const InputStreamElement& data, const bool outdated ) {
+      mBatch.append(data, outdated);
+      if (mBatch.size() >= mBatchSize)
+        publishBatch();
+    }
+
+    /**
+     * This method is called when a batch is full.
+     */
+    void publishBatch() {
+      auto tup = makeTuplePtr(std::move(mBatch));
+      mBatch = BatchType(mBatchSize);
+      this->getOutputDataChannel().publish(tup, false);
+    }
+
+    std::size_t mBatchSize; //< the number of tuples per batch
+    BatchType mBatch;       //< the batch currently filled
+  };
+
+  /**
+   * @brief A column unbatcher converts the visible rows of a TupleBatch back
+   * into tuples, forwarding them tuplewise.
+   *
+   * @tparam InputStreamElement
+   *    the data stream element type of the batch (TupleBatchPtr)
+   */
+  template <typename InputStreamElement>
+  class ColumnUnBatcher : public UnaryTransform< InputStreamElement,
+                                                 typename TupleBatchTraits<InputStreamElement>::BatchType::TupleType >
+  {
+  typedef typename TupleBatchTraits<InputStreamElement>::BatchType::TupleType OutputStreamElement;
+
+  private:
+    PFABRIC_UNARY_TRANSFORM_TYPEDEFS(InputStreamElement, OutputStreamElement)
+
+  public:
+    /**
+     * @brief Bind the callback for the data channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT( InputDataChannel, ColumnUnBatcher, processDataElement );
+
+    /**
+     * @brief Bind the callback for the punctuation channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, ColumnUnBatcher, processPunctuation );
+
+    const std::string opName() const override { return std::string("ColumnUnBatcher"); }
+
+  private:
+
+    /**
+     * @brief This method is invoked when a punctuation arrives.
+     *
+     * It simply forwards the punctuation to the subscribers.
+     *
+     * @param[in] punctuation
+     *    the incoming punctuation tuple
+     */
+    void processPunctuation( const PunctuationPtr& punctuation ) {
+      this->getOutputPunctuationChannel().publish(punctuation);
+    }
+
+    /**
+     * This method is invoked when a batch arrives.
+     *
+     * It creates a tuple for each visible row of the batch and forwards it
+     * together with the outdated flag of the row.
+     *
+     * @param[in] data
+     *    the incoming batch
+     * @param[in] outdated
+     *    flag indicating whether the batch is new or invalidated now (not used)
+     */
+    void processDataElement( const InputStreamElement& data, const bool outdated ) {
+      auto& batch = get<0>(data);
+      batch.forEachRow([&](std::size_t r) {
+        this->getOutputDataChannel().publish(batch.tuple(r), batch.isOutdated(r));
+      });
+    }
+  };
+
 } //namespace pfabric
 
 #endif
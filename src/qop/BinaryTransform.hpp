@@ -144,6 +144,28 @@ public:
 	InputPunctuationChannel& getInputPunctuationChannel() {
 		return SinkBase::template getInputChannelByID< 2 >();
 	}
+
+	/**
+	 * @brief Get a reference to the punctuation channel for the left source.
+	 *
+	 * The punctuations of both sources share one channel by default. Operators which
+	 * have to distinguish the sources of punctuations provide separate channels instead.
+	 *
+	 * @return a reference to the punctuation data channel
+	 */
+	InputPunctuationChannel& getLeftInputPunctuationChannel() {
+		return getInputPunctuationChannel();
+	}
+
+	/**
+	 * @brief Get a reference to the punctuation channel for the right source.
+	 *
+	 * @return a reference to the punctuation data channel
+	 * @see getLeftInputPunctuationChannel
+	 */
+	InputPunctuationChannel& getRightInputPunctuationChannel() {
+		return getInputPunctuationChannel();
+	}
 };
 
 } /* end namespace pfabric */
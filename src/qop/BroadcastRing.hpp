@@ -0,0 +1,397 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BroadcastRing_hpp_
+#define BroadcastRing_hpp_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace pfabric {
+
+  /**
+   * @brief A bounded ring buffer broadcasting each element to a fixed number of readers.
+   *
+   * BroadcastRing stores each element exactly once and lets every reader consume
+   * all elements in the same order with its own cursor. Producers are serialized by
+   * a mutex which makes the insertion order a total order shared by all readers.
+   * A slot is reused only after all readers have passed it, i.e. the slowest reader
+   * applies backpressure to the producers: if the ring is full a producer spins,
+   * yields and finally blocks. Producers which must not block (e.g. tasks running
+   * on a worker of an executor) use @c pushOrDefer instead, which keeps the element
+   * in an overflow list until the readers have freed a slot. Readers either
+   * park on a condition variable (waitForData) or mark themselves as idle (markIdle)
+   * to be woken up by their wakeup handler as soon as a new element was appended.
+   *
+   * Note that the slots are not cleared after reading, so up to @c capacity elements
+   * are kept alive by the ring.
+   *
+   * @tparam T
+   *    the type of the elements stored in the ring
+   */
+  template <typename T>
+  class BroadcastRing {
+  public:
+    /**
+     * Creates a new ring. The capacity is rounded up to the next power of two.
+     *
+     * @param capacity the minimal number of elements the ring can hold
+     * @param numReaders the number of readers consuming all elements
+     */
+    BroadcastRing(std::size_t capacity, std::size_t numReaders) :
+      mCapacity(roundUpToPowerOfTwo(capacity)), mMask(mCapacity - 1),
+      mSlots(new T[mCapacity]), mNumReaders(numReaders), mReaders(new Reader[numReaders]),
+      mTail(0), mMinCursor(0), mNumParked(0), mWaitingProducers(0), mStopped(false),
+      mNumDeferred(0) {
+      for (std::size_t i = 0; i < mNumReaders; i++) {
+        mReaders[i].mCursor.store(0, std::memory_order_relaxed);
+        mReaders[i].mIdle.store(false, std::memory_order_relaxed);
+      }
+    }
+
+    BroadcastRing(const BroadcastRing&) = delete;            // disable copying
+    BroadcastRing& operator=(const BroadcastRing&) = delete; // disable assignment
+
+    /**
+     * Tries to append an element without blocking.
+     *
+     * @param item the element to be appended
+     * @return false if the ring is full
+     */
+    bool tryPush(const T& item) {
+      {
+        std::lock_guard<std::mutex> lock(mProducerMtx);
+        if (!append(item))
+          return false;
+      }
+      wakeupParkedReaders();
+      wakeupIdleReaders();
+      return true;
+    }
+
+    /**
+     * Appends an element. If the ring is full the producer spins, yields and
+     * finally blocks until the slowest reader has freed a slot or the ring was stopped.
+     *
+     * @param item the element to be appended
+     */
+    void push(const T& item) {
+      unsigned int spins = 0;
+      while (!tryPush(item)) {
+        if (mStopped)
+          return;
+        if (++spins < SpinLimit)
+          cpuRelax();
+        else if (spins < SpinLimit + YieldLimit)
+          std::this_thread::yield();
+        else
+          waitForCredits();
+      }
+    }
+
+    /**
+     * Appends an element without ever blocking the producer. If the ring is full
+     * (or older deferred elements are still waiting) the element is appended to an
+     * unbounded overflow list, thus the capacity may be exceeded temporarily.
+     * The deferred elements are moved into the ring by the readers.
+     *
+     * @param item the element to be appended
+     */
+    void pushOrDefer(const T& item) {
+      {
+        std::lock_guard<std::mutex> lock(mProducerMtx);
+        if (!mDeferred.empty() || !append(item)) {
+          mDeferred.push_back(item);
+          mNumDeferred.store(mDeferred.size(), std::memory_order_seq_cst);
+          // a reader may have freed slots before it could see the deferred elements
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          if (!appendDeferred())
+            return;
+        }
+      }
+      wakeupParkedReaders();
+      wakeupIdleReaders();
+    }
+
+    /**
+     * Passes up to @c maxBatch elements following the cursor of the given reader
+     * to the function and advances the cursor. Must only be called by the thread
+     * currently acting as this reader.
+     *
+     * @param reader the id of the reader
+     * @param func the function invoked for each element
+     * @param maxBatch the maximal number of elements to be processed
+     * @return the number of processed elements
+     */
+    template <typename Func>
+    std::size_t consume(std::size_t reader, Func&& func, std::size_t maxBatch) {
+      if (mNumDeferred.load(std::memory_order_seq_cst) > 0)
+        moveDeferred();
+      auto& r = mReaders[reader];
+      auto pos = r.mCursor.load(std::memory_order_relaxed);
+      auto tail = mTail.load(std::memory_order_acquire);
+      std::size_t n = 0;
+      while (pos != tail && n < maxBatch) {
+        func(static_cast<const T&>(mSlots[pos & mMask]));
+        pos++;
+        n++;
+      }
+      if (n > 0) {
+        r.mCursor.store(pos, std::memory_order_release);
+        returnCredits();
+        if (mNumDeferred.load(std::memory_order_seq_cst) > 0)
+          moveDeferred();
+      }
+      return n;
+    }
+
+    /**
+     * Checks whether the given reader has consumed all elements, including
+     * the deferred ones.
+     */
+    bool empty(std::size_t reader) const {
+      return mReaders[reader].mCursor.load(std::memory_order_relaxed) ==
+        mTail.load(std::memory_order_acquire) && mNumDeferred.load(std::memory_order_seq_cst) == 0;
+    }
+
+    /**
+     * Blocks the reader until at least one element is available or the ring
+     * is stopped.
+     *
+     * @param reader the id of the reader
+     * @return false if the ring was stopped
+     */
+    bool waitForData(std::size_t reader) {
+      for (unsigned int i = 0; i < SpinLimit; i++) {
+        if (mStopped) return false;
+        if (!empty(reader)) return true;
+        cpuRelax();
+      }
+      for (unsigned int i = 0; i < YieldLimit; i++) {
+        if (mStopped) return false;
+        if (!empty(reader)) return true;
+        std::this_thread::yield();
+      }
+      std::unique_lock<std::mutex> lock(mMtx);
+      mNumParked.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      mCond.wait(lock, [this, reader]() { return mStopped || !empty(reader); });
+      mNumParked.fetch_sub(1, std::memory_order_relaxed);
+      return !mStopped;
+    }
+
+    /**
+     * Sets the function invoked by a producer for waking up the given reader
+     * after it was marked as idle. Must be called before any element is appended.
+     * The reader is initially marked as idle.
+     *
+     * @param reader the id of the reader
+     * @param func the wakeup handler, e.g. scheduling a task
+     */
+    void setWakeupHandler(std::size_t reader, std::function<void()> func) {
+      mReaders[reader].mWakeup = std::move(func);
+      mReaders[reader].mIdle.store(true, std::memory_order_seq_cst);
+    }
+
+    /**
+     * Marks the reader as idle if it has consumed all elements. An idle reader
+     * is woken up by its wakeup handler when the next element is appended.
+     *
+     * @param reader the id of the reader
+     * @return true if the reader was marked as idle, false if elements are pending
+     */
+    bool markIdle(std::size_t reader) {
+      auto& r = mReaders[reader];
+      r.mIdle.store(true, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!empty(reader)) {
+        r.mIdle.store(false, std::memory_order_relaxed);
+        return false;
+      }
+      return true;
+    }
+
+    /**
+     * Returns the capacity of the ring.
+     */
+    std::size_t capacity() const { return mCapacity; }
+
+    /**
+     * Returns the number of readers.
+     */
+    std::size_t numReaders() const { return mNumReaders; }
+
+    /**
+     * Returns the (approximate) number of elements not yet consumed by the slowest reader,
+     * including the deferred ones.
+     */
+    std::size_t size() const {
+      return mTail.load(std::memory_order_relaxed) - minCursor() + mNumDeferred.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Stops the ring and wakes up all waiting threads.
+     */
+    void stop() {
+      {
+        std::lock_guard<std::mutex> lock(mMtx);
+        mStopped = true;
+      }
+      mCond.notify_all();
+      mNotFull.notify_all();
+    }
+
+  private:
+    static constexpr unsigned int SpinLimit = 128;
+    static constexpr unsigned int YieldLimit = 64;
+
+    /// the state of a reader, aligned to avoid false sharing between readers
+    struct alignas(64) Reader {
+      std::atomic<std::size_t> mCursor;  //< the next position to be read
+      std::atomic<bool> mIdle;           //< true if the reader waits for a wakeup call
+      std::function<void()> mWakeup;    //< the handler for waking up an idle reader
+    };
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t n) {
+      std::size_t c = 2;
+      while (c < n) c <<= 1;
+      return c;
+    }
+
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+    }
+
+    std::size_t minCursor() const {
+      auto m = mReaders[0].mCursor.load(std::memory_order_acquire);
+      for (std::size_t i = 1; i < mNumReaders; i++) {
+        auto c = mReaders[i].mCursor.load(std::memory_order_acquire);
+        if (c < m) m = c;
+      }
+      return m;
+    }
+
+    /**
+     * Appends an element to the ring if a slot is free, requires mProducerMtx to be held.
+     */
+    bool append(const T& item) {
+      auto pos = mTail.load(std::memory_order_relaxed);
+      if (pos - mMinCursor >= mCapacity) {
+        mMinCursor = minCursor();
+        if (pos - mMinCursor >= mCapacity)
+          return false;
+      }
+      mSlots[pos & mMask] = item;
+      mTail.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Moves deferred elements into the free slots of the ring, requires mProducerMtx
+     * to be held.
+     *
+     * @return true if at least one element was moved
+     */
+    bool appendDeferred() {
+      bool moved = false;
+      while (!mDeferred.empty() && append(mDeferred.front())) {
+        mDeferred.pop_front();
+        moved = true;
+      }
+      mNumDeferred.store(mDeferred.size(), std::memory_order_seq_cst);
+      return moved;
+    }
+
+    /**
+     * Moves deferred elements into the free slots of the ring and wakes up the readers.
+     */
+    void moveDeferred() {
+      {
+        std::lock_guard<std::mutex> lock(mProducerMtx);
+        if (!appendDeferred())
+          return;
+      }
+      wakeupParkedReaders();
+      wakeupIdleReaders();
+    }
+
+    bool full() const {
+      return mTail.load(std::memory_order_relaxed) - minCursor() >= mCapacity;
+    }
+
+    void waitForCredits() {
+      std::unique_lock<std::mutex> lock(mMtx);
+      mWaitingProducers.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      mNotFull.wait(lock, [this]() { return mStopped || !full(); });
+      mWaitingProducers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void returnCredits() {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (mWaitingProducers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mMtx);
+        mNotFull.notify_all();
+      }
+    }
+
+    void wakeupParkedReaders() {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (mNumParked.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mMtx);
+        mCond.notify_all();
+      }
+    }
+
+    void wakeupIdleReaders() {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      for (std::size_t i = 0; i < mNumReaders; i++) {
+        auto& r = mReaders[i];
+        if (r.mIdle.load(std::memory_order_relaxed) && r.mIdle.exchange(false))
+          r.mWakeup();
+      }
+    }
+
+    const std::size_t mCapacity;                   //< the number of slots (a power of two)
+    const std::size_t mMask;                       //< mask for mapping positions to slots
+    std::unique_ptr<T[]> mSlots;                   //< the ring of slots
+    const std::size_t mNumReaders;                 //< the number of readers
+    std::unique_ptr<Reader[]> mReaders;            //< the cursors of the readers
+    alignas(64) std::atomic<std::size_t> mTail;    //< the next position to be written
+    std::size_t mMinCursor;                        //< the cached minimal cursor (protected by mProducerMtx)
+    std::mutex mProducerMtx;                       //< mutex serializing the producers
+    alignas(64) std::atomic<unsigned int> mNumParked; //< the number of readers waiting on the condition variable
+    std::atomic<unsigned int> mWaitingProducers;   //< the number of producers waiting for free slots
+    std::atomic<bool> mStopped;                    //< true if the ring was stopped
+    std::mutex mMtx;                               //< mutex for parking readers and producers
+    std::condition_variable mCond;                 //< condition variable for parking readers
+    std::condition_variable mNotFull;              //< condition variable for producers waiting for free slots
+    std::atomic<std::size_t> mNumDeferred;         //< the number of elements in the overflow list
+    std::deque<T> mDeferred;                       //< elements deferred by pushOrDefer (protected by mProducerMtx)
+  };
+
+}
+
+#endif
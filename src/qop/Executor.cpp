@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "Executor.hpp"
+
+using namespace pfabric;
+
+namespace {
+  /// the states of a task
+  enum TaskState { Idle, Scheduled, Running, RunningNotified };
+
+  /// the executor and worker id of the current thread (if it is a worker)
+  thread_local Executor* tlsExecutor = nullptr;
+  thread_local int tlsWorkerID = -1;
+  /// the tasks currently executed by this thread: a task waiting in yield
+  /// runs other tasks on top of it
+  thread_local std::vector<Executor::Task*> tlsRunningTasks;
+}
+
+struct Executor::Task {
+  TaskFunc mFunc;                               //< the function processing a batch
+  std::chrono::microseconds mInterval;          //< the interval for timers (0 for normal tasks)
+  std::atomic<int> mState;                      //< the current TaskState
+  std::atomic<bool> mCancelled;                 //< true if the task was unregistered
+
+  Task(TaskFunc func, std::chrono::microseconds interval) :
+    mFunc(func), mInterval(interval), mState(Idle), mCancelled(false) {}
+};
+
+Executor::Executor(unsigned int numWorkers) :
+  mNextQueue(0), mNumRunnable(0), mNumIdle(0), mStopped(false), mTimerVersion(0), mNumWaiting(0) {
+  if (numWorkers == 0)
+    numWorkers = std::max(1u, std::thread::hardware_concurrency());
+  for (auto i = 0u; i < numWorkers; i++)
+    mQueues.push_back(std::make_unique<WorkQueue>());
+  for (auto i = 0u; i < numWorkers; i++)
+    mWorkers.emplace_back(&Executor::run, this, i);
+}
+
+Executor::~Executor() {
+  {
+    std::lock_guard<std::mutex> lock(mIdleMtx);
+    mStopped = true;
+  }
+  mIdleCond.notify_all();
+  for (auto& thr : mWorkers)
+    thr.join();
+}
+
+Executor::TaskPtr Executor::registerTask(TaskFunc func) {
+  return std::make_shared<Task>(func, std::chrono::microseconds(0));
+}
+
+Executor::TaskPtr Executor::registerTimer(TimerFunc func, std::chrono::microseconds interval) {
+  auto task = std::make_shared<Task>([func]() { func(); return false; }, interval);
+  {
+    std::lock_guard<std::mutex> lock(mTimerMtx);
+    mTimers.push_back({ std::chrono::steady_clock::now() + interval, task });
+    std::push_heap(mTimers.begin(), mTimers.end(), std::greater<TimerEntry>());
+  }
+  // wake up the idle workers to recompute their waiting time
+  {
+    std::lock_guard<std::mutex> lock(mIdleMtx);
+    mTimerVersion++;
+  }
+  mIdleCond.notify_all();
+  return task;
+}
+
+void Executor::unregisterTask(const TaskPtr& task) {
+  task->mCancelled = true;
+  if (std::find(tlsRunningTasks.begin(), tlsRunningTasks.end(), task.get()) != tlsRunningTasks.end())
+    // we are called from the task itself (or from a task running on top of it
+    // while it yields) - don't wait for ourself
+    return;
+  // wait until the task has finished its current batch and was removed
+  // from the work queues (cancelled tasks are skipped by the workers)
+  mNumWaiting++;
+  while (task->mState != Idle) {
+    if (tlsExecutor == this) {
+      // a worker runs other tasks meanwhile - the task may be queued here
+      auto other = dequeue(tlsWorkerID);
+      if (other) {
+        execute(other);
+        continue;
+      }
+    }
+    std::unique_lock<std::mutex> lock(mDoneMtx);
+    if (tlsExecutor == this)
+      // look for new work from time to time
+      mDoneCond.wait_for(lock, std::chrono::milliseconds(1), [&]() { return task->mState == Idle; });
+    else
+      mDoneCond.wait(lock, [&]() { return task->mState == Idle; });
+  }
+  mNumWaiting--;
+}
+
+void Executor::schedule(const TaskPtr& task) {
+  auto state = task->mState.load();
+  for (;;) {
+    if (state == Idle) {
+      if (task->mState.compare_exchange_weak(state, Scheduled)) {
+        enqueue(task);
+        return;
+      }
+    }
+    else if (state == Running) {
+      // the worker will run the task again after the current batch
+      if (task->mState.compare_exchange_weak(state, RunningNotified))
+        return;
+    }
+    else
+      // already scheduled or notified
+      return;
+  }
+}
+
+void Executor::yield() {
+  if (tlsExecutor == this) {
+    auto task = dequeue(tlsWorkerID);
+    if (task) {
+      execute(task);
+      return;
+    }
+  }
+  std::this_thread::yield();
+}
+
+bool Executor::isWorkerThread() const {
+  return tlsExecutor == this;
+}
+
+void Executor::enqueue(const TaskPtr& task) {
+  // tasks scheduled by a worker stay local, others are distributed round robin
+  auto id = tlsExecutor == this ? tlsWorkerID : mNextQueue++ % mQueues.size();
+  {
+    std::lock_guard<std::mutex> lock(mQueues[id]->mMtx);
+    mQueues[id]->mTasks.push_back(task);
+  }
+  mNumRunnable.fetch_add(1, std::memory_order_seq_cst);
+  if (mNumIdle.load(std::memory_order_seq_cst) > 0) {
+    std::lock_guard<std::mutex> lock(mIdleMtx);
+    mIdleCond.notify_one();
+  }
+}
+
+Executor::TaskPtr Executor::dequeue(int id) {
+  if (mNumRunnable.load() == 0)
+    return nullptr;
+  // first, look at our own queue ...
+  {
+    auto& q = *mQueues[id];
+    std::lock_guard<std::mutex> lock(q.mMtx);
+    if (!q.mTasks.empty()) {
+      auto task = std::move(q.mTasks.front());
+      q.mTasks.pop_front();
+      mNumRunnable--;
+      return task;
+    }
+  }
+  // ... and then steal from the back of the other queues
+  for (auto i = 1u; i < mQueues.size(); i++) {
+    auto& q = *mQueues[(id + i) % mQueues.size()];
+    std::unique_lock<std::mutex> lock(q.mMtx, std::try_to_lock);
+    if (lock.owns_lock() && !q.mTasks.empty()) {
+      auto task = std::move(q.mTasks.back());
+      q.mTasks.pop_back();
+      mNumRunnable--;
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void Executor::execute(const TaskPtr& task) {
+  task->mState = Running;
+  tlsRunningTasks.push_back(task.get());
+  bool more = !task->mCancelled && task->mFunc();
+  tlsRunningTasks.pop_back();
+  if (task->mCancelled) {
+    task->mState = Idle;
+    notifyIdle();
+    return;
+  }
+  int state = Running;
+  if (more || !task->mState.compare_exchange_strong(state, Idle)) {
+    // there is pending work: put the task at the end of the queue to
+    // give the other tasks a chance
+    task->mState = Scheduled;
+    enqueue(task);
+  }
+  else
+    notifyIdle();
+}
+
+void Executor::notifyIdle() {
+  // wake up the threads waiting in unregisterTask (if any)
+  if (mNumWaiting.load(std::memory_order_seq_cst) > 0) {
+    std::lock_guard<std::mutex> lock(mDoneMtx);
+    mDoneCond.notify_all();
+  }
+}
+
+void Executor::pollTimers() {
+  std::unique_lock<std::mutex> lock(mTimerMtx, std::try_to_lock);
+  if (!lock.owns_lock())
+    return;
+  auto now = std::chrono::steady_clock::now();
+  while (!mTimers.empty() && mTimers.front().mDeadline <= now) {
+    std::pop_heap(mTimers.begin(), mTimers.end(), std::greater<TimerEntry>());
+    auto entry = std::move(mTimers.back());
+    mTimers.pop_back();
+    if (entry.mTask->mCancelled)
+      continue;
+    schedule(entry.mTask);
+    entry.mDeadline = std::max(entry.mDeadline + entry.mTask->mInterval, now);
+    mTimers.push_back(entry);
+    std::push_heap(mTimers.begin(), mTimers.end(), std::greater<TimerEntry>());
+  }
+}
+
+void Executor::run(unsigned int id) {
+  tlsExecutor = this;
+  tlsWorkerID = id;
+
+  while (!mStopped) {
+    pollTimers();
+    auto task = dequeue(id);
+    if (task) {
+      execute(task);
+      continue;
+    }
+
+    // nothing to do: park until a task is scheduled, a timer is registered
+    // or the next timer is due
+    std::unique_lock<std::mutex> lock(mIdleMtx);
+    auto timerVersion = mTimerVersion;
+    lock.unlock();
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    {
+      std::lock_guard<std::mutex> timerLock(mTimerMtx);
+      if (!mTimers.empty())
+        deadline = mTimers.front().mDeadline;
+    }
+    lock.lock();
+    mNumIdle.fetch_add(1, std::memory_order_seq_cst);
+    if (!mStopped && mTimerVersion == timerVersion &&
+        mNumRunnable.load(std::memory_order_seq_cst) == 0) {
+      if (deadline == std::chrono::steady_clock::time_point::max())
+        mIdleCond.wait(lock);
+      else
+        mIdleCond.wait_until(lock, deadline);
+    }
+    mNumIdle--;
+  }
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Executor_hpp_
+#define Executor_hpp_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pfabric {
+
+  class Executor;
+
+  /**
+   * Typedef for a pointer to an executor.
+   */
+  typedef std::shared_ptr<Executor> ExecutorPtr;
+
+  /**
+   * @brief A pool of worker threads shared by all operators of a topology.
+   *
+   * Instead of spawning one OS thread per Queue, TriggerNotifier or EvictionNotifier,
+   * operators can register tasks at an executor which runs them on a fixed number of
+   * worker threads. A task is a function processing a batch of work (e.g. draining a
+   * number of tuples from a queue) which returns true if more work is pending. Tasks
+   * run to completion, are never executed concurrently with themselves and are made
+   * runnable by @c schedule. Each worker has its own deque of runnable tasks; idle
+   * workers steal tasks from the other workers. Periodic tasks (timers) are managed by
+   * the executor as well and are scheduled as soon as they are due.
+   */
+  class Executor {
+  public:
+    /**
+     * Typedef for a task function: processes a batch and returns true if
+     * the task has more work and should be scheduled again.
+     */
+    typedef std::function<bool()> TaskFunc;
+
+    /**
+     * Typedef for a function invoked periodically by a timer.
+     */
+    typedef std::function<void()> TimerFunc;
+
+    struct Task;
+
+    /**
+     * Typedef for a handle to a registered task.
+     */
+    typedef std::shared_ptr<Task> TaskPtr;
+
+    /**
+     * Creates a new executor and starts the worker threads.
+     *
+     * @param numWorkers the number of worker threads (0 = number of hardware threads)
+     */
+    Executor(unsigned int numWorkers = 0);
+
+    /**
+     * Stops and joins all worker threads.
+     */
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * Registers a new task. The task is executed only after it was scheduled.
+     *
+     * @param func the function processing a batch of work
+     * @return a handle to the task
+     */
+    TaskPtr registerTask(TaskFunc func);
+
+    /**
+     * Registers a function which is invoked periodically.
+     *
+     * @param func the function to be invoked
+     * @param interval the time interval between two invocations
+     * @return a handle to the timer task
+     */
+    TaskPtr registerTimer(TimerFunc func, std::chrono::microseconds interval);
+
+    /**
+     * Removes a task or timer. After the call returns the task function is not
+     * running and will never be invoked again. The call blocks until a running
+     * batch of the task has finished, unless it is invoked by the task itself
+     * (or by a task executed by the same thread while the task yields).
+     *
+     * @param task the handle of the task
+     */
+    void unregisterTask(const TaskPtr& task);
+
+    /**
+     * Makes the given task runnable. If the task is already scheduled the call has
+     * no effect, if it is currently running it is executed once more afterwards.
+     *
+     * @param task the handle of the task
+     */
+    void schedule(const TaskPtr& task);
+
+    /**
+     * Called by a thread which cannot proceed (e.g. while waiting for a task to finish).
+     * If invoked by a worker thread, another runnable task is executed instead of
+     * blocking the worker, otherwise the thread simply yields.
+     */
+    void yield();
+
+    /**
+     * Returns true if the calling thread is a worker thread of this executor.
+     */
+    bool isWorkerThread() const;
+
+    /**
+     * Returns the number of worker threads.
+     */
+    unsigned int numWorkers() const { return mWorkers.size(); }
+
+  private:
+    /// the queue of runnable tasks of a worker
+    struct WorkQueue {
+      std::mutex mMtx;
+      std::deque<TaskPtr> mTasks;
+    };
+
+    /// an entry of the timer heap
+    struct TimerEntry {
+      std::chrono::steady_clock::time_point mDeadline;
+      TaskPtr mTask;
+      bool operator>(const TimerEntry& other) const { return mDeadline > other.mDeadline; }
+    };
+
+    void run(unsigned int id);
+    void enqueue(const TaskPtr& task);
+    TaskPtr dequeue(int id);
+    void execute(const TaskPtr& task);
+    void pollTimers();
+    void notifyIdle();
+
+    std::vector<std::thread> mWorkers;                        //< the worker threads
+    std::vector<std::unique_ptr<WorkQueue>> mQueues;          //< one queue of runnable tasks per worker
+    std::atomic<unsigned int> mNextQueue;                     //< round robin counter for tasks scheduled
+                                                              //< by non-worker threads
+    std::atomic<std::size_t> mNumRunnable;                    //< the number of tasks in all queues
+    std::atomic<unsigned int> mNumIdle;                       //< the number of parked workers
+    std::atomic<bool> mStopped;                               //< true if the executor is shut down
+    std::mutex mIdleMtx;                                      //< mutex for parking idle workers
+    std::condition_variable mIdleCond;                        //< condition variable for parking idle workers
+    unsigned long mTimerVersion;                              //< incremented (under mIdleMtx) for each new timer
+    std::mutex mTimerMtx;                                     //< mutex protecting the timer heap
+    std::vector<TimerEntry> mTimers;                          //< a min-heap of timers ordered by deadline
+    std::atomic<unsigned int> mNumWaiting;                    //< the number of threads waiting in unregisterTask
+    std::mutex mDoneMtx;                                      //< mutex for waiting until a task becomes idle
+    std::condition_variable mDoneCond;                        //< condition variable signalled when a task becomes idle
+  };
+
+}
+
+#endif
@@ -0,0 +1,347 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FlatHashTable_hpp_
+#define FlatHashTable_hpp_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+namespace pfabric {
+
+  /**
+   * @brief A flat open-addressing hash table with stable, inline values.
+   *
+   * The table consists of two parts: a power-of-two array of small slots
+   * (32 bit of the hash value + the index of the entry) which is probed
+   * linearly, and a chunked array of entries where key and value are stored
+   * inline. Thus, a lookup touches one contiguous run of slots and a single
+   * entry, and inserting a new key does not allocate unless a new chunk of
+   * entries is needed. If the slot array grows only the slots are rehashed,
+   * the entries are never moved. Therefore, pointers to values stay valid until
+   * the key is erased and the value type neither has to be copyable nor movable.
+   * Erased entries are recycled via a free list, erased slots are closed by
+   * shifting the following slots backwards, i.e. no tombstones are needed.
+   *
+   * The hash value is scrambled by Fibonacci hashing (a multiplication with
+   * 2^64 / golden ratio) whose upper bits determine the home slot. Thus, cheap
+   * hash functions like boost::hash which map integers to themselves can be
+   * used: dense keys are spread evenly over the slots without collisions.
+   *
+   * Note, that the table is not thread-safe, the operators protect it by
+   * their own mutex.
+   *
+   * @tparam KeyType
+   *    the data type of the keys
+   * @tparam ValueType
+   *    the data type of the values
+   * @tparam Hash
+   *    the hash function for the keys
+   * @tparam KeyEqual
+   *    the function for comparing keys
+   */
+  template <typename KeyType, typename ValueType,
+            typename Hash = boost::hash<KeyType>,
+            typename KeyEqual = std::equal_to<KeyType>>
+  class FlatHashTable {
+    /// a key together with its value
+    struct Entry {
+      template <typename... Args>
+      Entry(const KeyType& k, Args&&... args) : mKey(k), mValue(std::forward<Args>(args)...) {}
+
+      KeyType mKey;      //< the key
+      ValueType mValue;  //< the value stored for the key
+    };
+
+    /// uninitialized memory for a single entry
+    typedef typename std::aligned_storage<sizeof(Entry), alignof(Entry)>::type EntryStorage;
+
+    /// a slot of the probing array
+    struct Slot {
+      std::uint32_t mHash;  //< the (scrambled) 32 bit hash value of the key
+      std::uint32_t mEntry; //< the index of the entry or EmptySlot
+    };
+
+    static constexpr std::uint32_t EmptySlot = UINT32_MAX;
+    static constexpr std::size_t ChunkSize = 64;    //< the number of entries per chunk
+    static constexpr std::size_t MinCapacity = 16;  //< the initial number of slots
+
+  public:
+    /**
+     * Creates a new, empty table.
+     *
+     * @param expectedSize
+     *    the number of keys the table should be able to store without rehashing
+     * @param hash
+     *    the hash function object
+     * @param equal
+     *    the key comparison function object
+     */
+    explicit FlatHashTable(std::size_t expectedSize = 0, const Hash& hash = Hash(),
+                           const KeyEqual& equal = KeyEqual()) :
+      mMask(0), mShift(32), mSize(0), mNextEntry(0), mHash(hash), mEqual(equal) {
+      if (expectedSize > 0) {
+        std::size_t cap = MinCapacity;
+        while (cap * 3 < expectedSize * 4)
+          cap *= 2;
+        rehash(cap);
+      }
+    }
+
+    FlatHashTable(const FlatHashTable&) = delete;
+    FlatHashTable& operator=(const FlatHashTable&) = delete;
+
+    ~FlatHashTable() { destroyEntries(); }
+
+    /**
+     * Returns a pointer to the value of the given key or nullptr if the key
+     * does not exist.
+     *
+     * @param key
+     *    the key to look up
+     * @return a pointer to the value or nullptr
+     */
+    ValueType* find(const KeyType& key) {
+      if (mSize == 0)
+        return nullptr;
+      const auto h = hashOf(key);
+      for (auto pos = h >> mShift; ; pos = (pos + 1) & mMask) {
+        const Slot& slot = mSlots[pos];
+        if (slot.mEntry == EmptySlot)
+          return nullptr;
+        if (slot.mHash == h && mEqual(entry(slot.mEntry).mKey, key))
+          return &entry(slot.mEntry).mValue;
+      }
+    }
+
+    const ValueType* find(const KeyType& key) const {
+      return const_cast<FlatHashTable*>(this)->find(key);
+    }
+
+    /**
+     * Looks up the given key and inserts a new value constructed from @c args
+     * if the key does not exist yet. The value is only constructed in the
+     * latter case. Both is done with a single probe sequence.
+     *
+     * @param key
+     *    the key to look up or insert
+     * @param args
+     *    the arguments for constructing a new value
+     * @return a pair of a pointer to the value and a flag which is true if
+     *    the value was inserted
+     */
+    template <typename... Args>
+    std::pair<ValueType*, bool> tryEmplace(const KeyType& key, Args&&... args) {
+      // keep the load factor below 0.75
+      if ((mSize + 1) * 4 > mSlots.size() * 3)
+        rehash(mSlots.empty() ? MinCapacity : mSlots.size() * 2);
+
+      const auto h = hashOf(key);
+      auto pos = h >> mShift;
+      for (; mSlots[pos].mEntry != EmptySlot; pos = (pos + 1) & mMask) {
+        const Slot& slot = mSlots[pos];
+        if (slot.mHash == h && mEqual(entry(slot.mEntry).mKey, key))
+          return { &entry(slot.mEntry).mValue, false };
+      }
+
+      const auto idx = allocateEntry();
+      try {
+        new (entryStorage(idx)) Entry(key, std::forward<Args>(args)...);
+      } catch (...) {
+        mFreeEntries.push_back(idx);
+        throw;
+      }
+      mSlots[pos] = Slot { h, idx };
+      ++mSize;
+      return { &entry(idx).mValue, true };
+    }
+
+    /**
+     * Removes the given key together with its value from the table.
+     *
+     * @param key
+     *    the key to be removed
+     * @return true if the key was found and removed
+     */
+    bool erase(const KeyType& key) {
+      if (mSize == 0)
+        return false;
+      const auto h = hashOf(key);
+      auto pos = h >> mShift;
+      for (; ; pos = (pos + 1) & mMask) {
+        const Slot& slot = mSlots[pos];
+        if (slot.mEntry == EmptySlot)
+          return false;
+        if (slot.mHash == h && mEqual(entry(slot.mEntry).mKey, key))
+          break;
+      }
+      const auto idx = mSlots[pos].mEntry;
+      entry(idx).~Entry();
+      mFreeEntries.push_back(idx);
+      --mSize;
+
+      // close the gap: move back all following slots of the cluster which
+      // are not at their home position yet
+      auto hole = pos;
+      for (auto next = (hole + 1) & mMask; mSlots[next].mEntry != EmptySlot; next = (next + 1) & mMask) {
+        const auto home = mSlots[next].mHash >> mShift;
+        // the slot may move into the hole if its home is not in (hole, next]
+        if (((next - home) & mMask) >= ((next - hole) & mMask)) {
+          mSlots[hole] = mSlots[next];
+          hole = next;
+        }
+      }
+      mSlots[hole].mEntry = EmptySlot;
+      return true;
+    }
+
+    /**
+     * Removes all keys from the table. The memory is kept for reuse.
+     */
+    void clear() {
+      destroyEntries();
+      for (auto& slot : mSlots)
+        slot.mEntry = EmptySlot;
+      mFreeEntries.clear();
+      mNextEntry = 0;
+      mSize = 0;
+    }
+
+    /**
+     * Invokes the given function for all key/value pairs of the table.
+     *
+     * @param func
+     *    a function with the signature void(const KeyType&, ValueType&)
+     */
+    template <typename Func>
+    void forEach(Func func) {
+      for (const auto& slot : mSlots) {
+        if (slot.mEntry != EmptySlot) {
+          Entry& e = entry(slot.mEntry);
+          func(e.mKey, e.mValue);
+        }
+      }
+    }
+
+    /**
+     * Returns the number of keys stored in the table.
+     */
+    std::size_t size() const { return mSize; }
+
+    /**
+     * Returns true if the table does not contain any keys.
+     */
+    bool empty() const { return mSize == 0; }
+
+    /**
+     * Returns the number of slots of the probing array.
+     */
+    std::size_t capacity() const { return mSlots.size(); }
+
+    /**
+     * Returns the number of bytes allocated by the table for slots and
+     * entries. Memory allocated by the keys or values themselves (e.g. for
+     * strings) is not included.
+     */
+    std::size_t memoryUsage() const {
+      return mSlots.capacity() * sizeof(Slot)
+        + mChunks.size() * ChunkSize * sizeof(EntryStorage)
+        + mChunks.capacity() * sizeof(typename ChunkList::value_type)
+        + mFreeEntries.capacity() * sizeof(std::uint32_t);
+    }
+
+  private:
+    typedef std::vector<std::unique_ptr<EntryStorage[]>> ChunkList;
+
+    std::uint32_t hashOf(const KeyType& key) const {
+      return static_cast<std::uint32_t>((static_cast<std::uint64_t>(mHash(key)) * 0x9e3779b97f4a7c15ULL) >> 32);
+    }
+
+    EntryStorage* entryStorage(std::uint32_t idx) {
+      return &mChunks[idx / ChunkSize][idx % ChunkSize];
+    }
+
+    Entry& entry(std::uint32_t idx) {
+      return *std::launder(reinterpret_cast<Entry*>(entryStorage(idx)));
+    }
+
+    /**
+     * Returns the index of an unused entry, either from the free list or
+     * from the end of the last chunk.
+     */
+    std::uint32_t allocateEntry() {
+      if (!mFreeEntries.empty()) {
+        auto idx = mFreeEntries.back();
+        mFreeEntries.pop_back();
+        return idx;
+      }
+      if (mNextEntry == mChunks.size() * ChunkSize)
+        mChunks.emplace_back(new EntryStorage[ChunkSize]);
+      return static_cast<std::uint32_t>(mNextEntry++);
+    }
+
+    /**
+     * Rebuilds the probing array with the given number of slots (a power of two).
+     */
+    void rehash(std::size_t newCapacity) {
+      std::vector<Slot> slots(newCapacity, Slot { 0, EmptySlot });
+      const std::uint32_t mask = static_cast<std::uint32_t>(newCapacity - 1);
+      unsigned int shift = 32;
+      for (auto c = newCapacity; c > 1; c >>= 1)
+        shift--;
+      for (const auto& slot : mSlots) {
+        if (slot.mEntry == EmptySlot)
+          continue;
+        auto pos = slot.mHash >> shift;
+        while (slots[pos].mEntry != EmptySlot)
+          pos = (pos + 1) & mask;
+        slots[pos] = slot;
+      }
+      mSlots.swap(slots);
+      mMask = mask;
+      mShift = shift;
+    }
+
+    void destroyEntries() {
+      for (const auto& slot : mSlots) {
+        if (slot.mEntry != EmptySlot)
+          entry(slot.mEntry).~Entry();
+      }
+    }
+
+    std::vector<Slot> mSlots;                 //< the probing array
+    ChunkList mChunks;                        //< the chunks storing the entries
+    std::vector<std::uint32_t> mFreeEntries;  //< indexes of erased entries for reuse
+    std::uint32_t mMask;                      //< the number of slots - 1
+    unsigned int mShift;                      //< 32 - log2(number of slots)
+    std::size_t mSize;                        //< the number of keys
+    std::size_t mNextEntry;                   //< the next never used entry
+    Hash mHash;                               //< the hash function
+    KeyEqual mEqual;                          //< the key comparison function
+  };
+
+} /* end namespace pfabric */
+
+#endif
@@ -63,7 +63,7 @@ namespace pfabric {
      */
     FromTable(TablePtr tbl, TableParams::NotificationMode mode = TableParams::Immediate) :
       mInterrupted(false)  {
-        tbl->registerObserver([this](const typename StreamElement::element_type& data, TableParams::ModificationMode m) {
+        mConnection = tbl->registerObserver([this](const typename StreamElement::element_type& data, TableParams::ModificationMode m) {
           tableCallback(data, m);
         }, mode);
         mProducerThread = std::thread(&FromTable<StreamElement, KeyType>::producer, this);
@@ -73,6 +73,8 @@ namespace pfabric {
      * Deallocates all resources.
      */
     ~FromTable() {
+      // the table may outlive the operator
+      mConnection.disconnect();
       mInterrupted = true;
       {
         std::unique_lock<std::mutex> lock(mMtx);
@@ -119,6 +121,7 @@ namespace pfabric {
     std::condition_variable mCondVar;                 //< condition variable for waking up the producer
     bool mInterrupted;                                //< flag for interrupting the producer thread
     std::thread mProducerThread;                      //< the thread running the producer method
+    boost::signals2::connection mConnection;          //< the connection of the observer at the table
                                                       //< to publish tuples
   };
 
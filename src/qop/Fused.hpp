@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Fused_hpp_
+#define Fused_hpp_
+
+#include "qop/UnaryTransform.hpp"
+#include "qop/OperatorMacros.hpp"
+
+namespace pfabric {
+
+/**
+ * @brief An operator executing a fused chain of stateless operators.
+ *
+ * Fused replaces a sequence of stateless operators (where, map, notify) by a
+ * single operator. The chain is represented by a single callable which is
+ * invoked for each incoming stream element together with a sink function and
+ * passes the resulting element(s) to the sink. Because the callable is a
+ * template parameter and is composed at compile time (see FusedPipe), the
+ * UDFs of the chain can be inlined and no channel dispatch is needed between
+ * the individual steps.
+ *
+ * @tparam InputStreamElement
+ *    the data stream element type consumed by the chain
+ * @tparam OutputStreamElement
+ *    the data stream element type produced by the chain
+ * @tparam FusedFunc
+ *    the type of the chain:
+ *    <tt>void (const InputStreamElement&, bool, Sink&&)</tt> where
+ *    <tt>Sink</tt> is callable with <tt>(const OutputStreamElement&, bool)</tt>
+ */
+template<
+	typename InputStreamElement,
+	typename OutputStreamElement,
+	typename FusedFunc
+>
+class Fused :
+	public UnaryTransform< InputStreamElement, OutputStreamElement > // use default unary transform
+{
+private:
+	PFABRIC_UNARY_TRANSFORM_TYPEDEFS(InputStreamElement, OutputStreamElement)
+
+public:
+	/**
+	 * @brief Construct a new instance of the fused operator.
+	 *
+	 * @param f the fused chain of operators
+	 */
+	Fused(FusedFunc f) : mFunc(f) {}
+
+	/**
+	 * @brief Bind the callback for the data channel.
+	 */
+	BIND_INPUT_CHANNEL_DEFAULT( InputDataChannel, Fused, processDataElement );
+
+	/**
+	 * @brief Bind the callback for the punctuation channel.
+	 */
+	BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, Fused, processPunctuation );
+
+	const std::string opName() const override { return std::string("Fused"); }
+
+private:
+
+	/**
+	 * @brief This method is invoked when a punctuation arrives.
+	 *
+	 * It simply forwards the punctuation to the subscribers.
+	 *
+	 * @param[in] punctuation
+	 *    the incoming punctuation tuple
+	 */
+	void processPunctuation( const PunctuationPtr& punctuation ) {
+		this->getOutputPunctuationChannel().publish(punctuation);
+	}
+
+	/**
+	 * This method is invoked when a data stream element arrives.
+	 *
+	 * It runs the fused chain and forwards the resulting elements to its subscribers.
+	 *
+	 * @param[in] data
+	 *    the incoming stream element
+	 * @param[in] outdated
+	 *    flag indicating whether the tuple is new or invalidated now
+	 */
+	void processDataElement( const InputStreamElement& data, const bool outdated ) {
+		mFunc(data, outdated, [this](const OutputStreamElement& res, bool o) {
+			this->getOutputDataChannel().publish(res, o);
+		});
+	}
+
+	FusedFunc mFunc; //< the fused chain of operators
+};
+
+}
+
+#endif
@@ -23,11 +23,14 @@
 #include "qop/UnaryTransform.hpp"
 #include "qop/OperatorMacros.hpp"
 #include "qop/TriggerNotifier.hpp"
+#include "qop/FlatHashTable.hpp"
+
+#include <vector>
 
 #include <boost/core/ignore_unused.hpp>
+#include <boost/optional.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/lock_guard.hpp>
-#include <boost/unordered/unordered_map.hpp>
 
 
 namespace pfabric {
@@ -42,6 +45,20 @@ namespace pfabric {
  * of the stream. The temporal behaviour is defined by the trigger type (all, timestamp, count - see
  * PipeFabricTypes.hpp)  and the trigger interval.
  *
+ * The groups are kept in a FlatHashTable which stores the aggregation states
+ * inline, i.e. a new group does not require a separate allocation (unless a
+ * factory is given) and each incoming tuple needs only a single lookup. The
+ * state pointers passed to the iterate and final functions are therefore
+ * non-owning and valid only during the call.
+ *
+ * With TriggerByCount, TriggerByTime and TriggerByTimestamp the operator keeps
+ * track of the groups which were changed since the last trigger (dirty groups).
+ * A trigger publishes the aggregate of each dirty group exactly once followed
+ * by a SlideExpired punctuation, i.e. the output depends on the number of
+ * changed groups and not on the number of tuples. A group whose tuples are all
+ * outdated is removed immediately or, if its result was already published by a
+ * trigger, published as outdated and removed at the next trigger.
+ *
  * @tparam InputStreamElement
  *    the data stream element type consumed by the aggregation
  * @tparam OutputStreamElement
@@ -51,12 +68,15 @@ namespace pfabric {
  *    to construct the OutputStreamElement
  * @tparam KeyType
  *    the data type for the key column
+ * @tparam KeyHash
+ *    the hash function for the keys
  */
 template<
 	typename InputStreamElement,
 	typename OutputStreamElement,
   typename AggregateState,
-  typename KeyType = DefaultKeyType
+  typename KeyType = DefaultKeyType,
+  typename KeyHash = boost::hash<KeyType>
 >
 class GroupedAggregation :
   public UnaryTransform< InputStreamElement, OutputStreamElement > {
@@ -69,8 +89,10 @@ protected:
 	/// the function for extracting the timestamp from a tuple
 	typedef std::function<Timestamp(const InputStreamElement&)> TimestampExtractorFunc;
 
+	class GroupEntry;
+
 	/// the type for the hash table to store group keys + aggregate states
-	typedef boost::unordered_map< KeyType, AggregateStatePtr > HashTable;
+	typedef FlatHashTable< KeyType, GroupEntry, KeyHash > HashTable;
 
 	/// the function for calculating a grouping key for an incoming stream element
 	typedef std::function< KeyType(const InputStreamElement&) > GroupByFunc;
@@ -135,18 +157,24 @@ public:
 	* @param tInterval
 	*    the time interval in seconds to produce aggregation tuples (for trigger by timestamp)
 	*    or in the number of tuples (for trigger by count)
+	* @param executor
+	*    optional executor running the trigger for TriggerByTime (instead of the timer wheel)
+	* @param timers
+	*    optional timer wheel running the trigger for TriggerByTime (default = TimerWheel::defaultWheel())
 	*/
 	GroupedAggregation(GroupByFunc groupby_fun,
 					FinalFunc final_fun,
 					IterateFunc it_fun,
 					AggregationTriggerType tType = TriggerAll,
-					const unsigned int tInterval = 0)  :
+					const unsigned int tInterval = 0,
+					ExecutorPtr executor = nullptr,
+					TimerWheelPtr timers = nullptr)  :
 		mGroupByFunc(groupby_fun),
 		mIterateFunc(it_fun), mFinalFunc(final_fun),
     mTriggerInterval( tInterval ),
     mNotifier(tInterval > 0 && tType == TriggerByTime ?
-             new TriggerNotifier(std::bind(&GroupedAggregation::notificationCallback, this), tInterval) : nullptr),
-    mLastTriggerTime(0), mTriggerType(tType), mCounter(0) {
+             new TriggerNotifier(std::bind(&GroupedAggregation::notificationCallback, this), tInterval, executor, timers) : nullptr),
+    mLastTriggerTime(0), mTriggerType(tType), mCounter(0), mUseWatermarks(false) {
 	}
 
 /**
@@ -177,19 +205,25 @@ public:
 	* @param tInterval
 	*    the time interval in seconds to produce aggregation tuples (for trigger by timestamp)
 	*    or in the number of tuples (for trigger by count)
+	* @param executor
+	*    optional executor running the trigger for TriggerByTime (instead of the timer wheel)
+	* @param timers
+	*    optional timer wheel running the trigger for TriggerByTime (default = TimerWheel::defaultWheel())
 	*/
 	GroupedAggregation(AggregateStatePtr& factory, FactoryFunc factory_fun,
 			GroupByFunc groupby_fun,
 					FinalFunc final_fun,
 					IterateFunc it_fun,
 					AggregationTriggerType tType = TriggerAll,
-					const unsigned int tInterval = 0)  :
+					const unsigned int tInterval = 0,
+					ExecutorPtr executor = nullptr,
+					TimerWheelPtr timers = nullptr)  :
 		mGroupByFunc(groupby_fun),
 		mIterateFunc(it_fun), mFinalFunc(final_fun),
     mTriggerInterval( tInterval ),
     mNotifier(tInterval > 0 && tType == TriggerByTime ?
-             new TriggerNotifier(std::bind(&GroupedAggregation::notificationCallback, this), tInterval) : nullptr),
-    mLastTriggerTime(0), mTriggerType(tType), mCounter(0),
+             new TriggerNotifier(std::bind(&GroupedAggregation::notificationCallback, this), tInterval, executor, timers) : nullptr),
+    mLastTriggerTime(0), mTriggerType(tType), mCounter(0), mUseWatermarks(false),
 		mFactory(factory), mFactoryFunc(factory_fun) {
 	}
 
@@ -219,9 +253,9 @@ public:
 			mGroupByFunc(groupby_fun),
 			mIterateFunc(it_fun), mFinalFunc(final_fun),
 			mTimestampExtractor(func),
-	    mTriggerInterval( tInterval ),
+	    mTriggerInterval( Timestamp(tInterval * 1000 * 1000) ),
 	    mNotifier(nullptr),
-	    mLastTriggerTime(0), mTriggerType(TriggerByTimestamp), mCounter(0) {
+	    mLastTriggerTime(0), mTriggerType(TriggerByTimestamp), mCounter(0), mUseWatermarks(false) {
 		}
 
 	/**
@@ -251,41 +285,50 @@ private:
 		Lock lock(mAggrMtx);
 
 		const KeyType grpKey = mGroupByFunc(data);
-		bool newGroup = mAggregateTable.count(grpKey) == 0;
 
-		if(newGroup) {
-			// case 1: we don't have a group yet for this key -> create a new one
-      if(!outdated) {
-				processNewAggregationGroup(grpKey, data, lock);
-			}
-      // ... and we ignore outdated tuples
-    }
+		if (outdated) {
+			// outdated tuples can only update an existing group ...
+			GroupEntry* group = mAggregateTable.find(grpKey);
+			if (group != nullptr)
+				updateAggregationGroup(grpKey, *group, data, outdated, lock);
+			// ... and we ignore them otherwise
+		}
 		else {
-			// case 2: we already have got a group for this key -> update its aggregates
-			updateAggregationGroup(grpKey, data, outdated, lock);
+			// look up the group and create it in the same probe if it doesn't exist yet
+			auto res = mAggregateTable.tryEmplace(grpKey, mFactory, mFactoryFunc);
+			if (res.second)
+				// case 1: we didn't have a group yet for this key -> initialize it
+				processNewAggregationGroup(grpKey, *res.first, data, lock);
+			else
+				// case 2: we already have got a group for this key -> update its aggregates
+				updateAggregationGroup(grpKey, *res.first, data, outdated, lock);
 		}
 
     switch (mTriggerType) {
       case TriggerByCount:
       {
-        if (++mCounter == boost::get<unsigned int>(mTriggerInterval)) {
-          notificationCallback();
+        // only new tuples are counted
+        if (!outdated && ++mCounter == boost::get<unsigned int>(mTriggerInterval)) {
+          triggerAggregates(lock);
           mCounter = 0;
         }
         break;
       }
       case TriggerByTimestamp:
       {
+        // with watermarks the aggregates are triggered by the punctuations
+        if (mUseWatermarks)
+          break;
         auto ts = mTimestampExtractor(data);
         if (ts - mLastTriggerTime >= boost::get<Timestamp>(mTriggerInterval)) {
-          notificationCallback();
+          triggerAggregates(lock);
           mLastTriggerTime = ts;
         }
         break;
       }
       default:
         // TriggerAll is handled in updateAggregationGroup
-        // TriggerByTime is handled by notifier thread
+        // TriggerByTime is handled by the notifier timer
         break;
     }
 
@@ -295,13 +338,32 @@ private:
 	 * @brief This method is invoked when a punctuation arrives.
 	 *
 	 * Punctuation tuples can trigger aggregation results if specified for the operator
-	 * via the punctuation mask.
+	 * via the punctuation mask. A WindowExpired punctuation first publishes the groups
+	 * changed since the last trigger and then removes all groups, i.e. the aggregates
+	 * (and the trigger counter) start from scratch for the next (tumbling) window. For
+	 * TriggerByTimestamp, Watermark punctuations are used as clock instead of the
+	 * timestamps of the tuples as soon as the first watermark arrives.
 	 *
 	 * @param[in] punctuation
 	 *    the incoming punctuation tuple
 	 */
 	void processPunctuation( const PunctuationPtr& punctuation ) {
 			Lock lock( mAggrMtx );
+			if (punctuation->ptype() == Punctuation::WindowExpired) {
+				// publish the final aggregates of the expired window before they vanish
+				produceAggregates(lock);
+				mAggregateTable.clear();
+				mDirtyKeys.clear();
+				mCounter = 0;
+			}
+			else if (punctuation->ptype() == Punctuation::Watermark && mTriggerType == TriggerByTimestamp) {
+				mUseWatermarks = true;
+				const auto wm = punctuation->getTimestamp();
+				if (wm - mLastTriggerTime >= boost::get<Timestamp>(mTriggerInterval)) {
+					triggerAggregates(lock);
+					mLastTriggerTime = wm;
+				}
+			}
 			this->getOutputPunctuationChannel().publish(punctuation);
 	}
 
@@ -311,35 +373,36 @@ private:
 	/**
 	 * @brief Handle a data stream element for a new group.
 	 *
-	 * This internal helper method will generate a new aggregation state for the group
-	 * and add it to the group state table. Further, the aggregation result for the
+	 * This internal helper method will initialize the aggregation state of a group
+	 * which was just added to the group state table. Further, the aggregation result for the
 	 * new element is published if no sliding window is implemented by this operator.
 	 *
 	 * @param[in] grpKey
 	 *    the key of the new group
+	 * @param[in] group
+	 *    the new entry of the group in the state table
 	 * @param[in] data
 	 *    the new data stream element
 	 * @param[in] lock
 	 *    a reference to the lock protecting the aggregation state
 	 */
-	void processNewAggregationGroup(KeyType grpKey, const InputStreamElement& data, const Lock& lock) {
+	void processNewAggregationGroup(const KeyType& grpKey, GroupEntry& group,
+	                                const InputStreamElement& data, const Lock& lock) {
 		const bool outdated = false;
     const Timestamp elementTime = mTimestampExtractor != nullptr ? mTimestampExtractor(data) : Timestamp(0);
 
-		// create a new aggregation state
-    // if a factory object was provided we can call its create method
-		AggregateStatePtr newAggrState = mFactory ? mFactoryFunc(mFactory) : std::make_shared<AggregateState>();
+		const AggregateStatePtr& newAggrState = group.state();
 		newAggrState->setTimestamp(elementTime);
 
 		// ... call the iterate function
 		mIterateFunc(data, grpKey, newAggrState, outdated);
-		// ... and insert it into the hashtable
-		mAggregateTable.insert({ grpKey, newAggrState });
 
 		// directly publish the new aggregation result if no sliding window was specified
 		if (mTriggerType == TriggerAll) {
 			produceAggregate(newAggrState, elementTime, outdated, lock);
 		}
+		else
+			markDirty(grpKey, group);
 	}
 
 	/**
@@ -352,7 +415,9 @@ private:
 	 * if no data elements belong to it any longer.
 	 *
 	 * @param[in] grpKey
-	 *    the key of the new group
+	 *    the key of the group
+	 * @param[in] group
+	 *    the entry of the group in the state table
 	 * @param[in] data
 	 *    the new data stream element
 	 * @param[in] outdated
@@ -360,18 +425,19 @@ private:
 	 * @param[in] lock
 	 *    a reference to the lock protecting the aggregation state
 	 */
-    void updateAggregationGroup(const KeyType& grpKey, const InputStreamElement& data,
+    void updateAggregationGroup(const KeyType& grpKey, GroupEntry& group, const InputStreamElement& data,
                                 const bool outdated, const Lock& lock) {
-      auto groupEntry = mAggregateTable.find(grpKey);
-
-      AggregateStatePtr aggrState = groupEntry->second;
+      const AggregateStatePtr& aggrState = group.state();
       const Timestamp elementTime = mTimestampExtractor != nullptr ? mTimestampExtractor(data) : Timestamp(0);
       /* 1. Send the previous aggregated state as outdated
       if (mTriggerType == TriggerAll) {
         produceAggregate(aggrState, elementTime, true, lock);
       }
 			*/
-      // 2. update the group state (counting algorithm)
+      // 2. update the group state (counting algorithm) - a vanished group which
+      // is still waiting for the next trigger starts from scratch
+      if (!outdated && aggrState->getCounter() == 0)
+        aggrState->init();
       aggrState->setTimestamp(elementTime);
       aggrState->updateCounter(outdated ? -1 : 1);
       const bool outdatedAggregate = (aggrState->getCounter() == 0);
@@ -382,41 +448,67 @@ private:
       if (mTriggerType == TriggerAll) {
         produceAggregate(aggrState, elementTime, outdated, lock);
       }
+      else {
+        markDirty(grpKey, group);
+        // a vanished group whose result was published before is published as
+        // outdated and purged by the next trigger
+        if (group.mPublished)
+          return;
+      }
 
       // 4. purge the aggregate if the group vanishes
       if (outdatedAggregate) {
         // we remove the entry from the hashtable if all tuples belonging to this
         // aggregate are outdated - counting algorithm
-        mAggregateTable.erase(groupEntry);
+        mAggregateTable.erase(grpKey);
       }
   }
 
-#if 0
 	/**
-	 * @brief Produce aggregate elements for all groups in the aggregation table.
+	 * @brief Marks a group as changed since the last trigger.
+	 *
+	 * @param[in] grpKey
+	 *    the key of the group
+	 * @param[in] group
+	 *    the entry of the group in the state table
+	 */
+	void markDirty(const KeyType& grpKey, GroupEntry& group) {
+		if (!group.mDirty) {
+			group.mDirty = true;
+			mDirtyKeys.push_back(grpKey);
+		}
+	}
+
+	/**
+	 * @brief Produce aggregate elements for all groups changed since the last trigger.
 	 *
-	 * This method produces an aggregation result for each group that is currently
-	 * available in this operator. Groups having a timestamp older than the last
-	 * notification will be skipped, unless the operator was configured to always
-	 * produce a full result.
+	 * This method publishes the aggregation result of each dirty group once. Groups
+	 * without any valid tuple are published as outdated (if their result was
+	 * published before) and removed from the aggregation table.
 	 *
-	 * @param[in] timestamp
-	 *    the timestamp for the result elements
-	 * @param[in] outdated
-	 *    flag indicating if the result elements should be marked as outdated
 	 * @param[in] lock
 	 *    a reference to the lock protecting the aggregation state
 	 */
-	void produceAggregates(const Timestamp& timestamp, const bool outdated, const Lock& lock) {
-    /*
-		for (const auto groupEntry : mAggregateTable) {
-			const AggregateStatePtr& aggrState = groupEntry.second;
-
-      produceAggregate(aggrState, timestamp, outdated, lock);
+	void produceAggregates(const Lock& lock) {
+		for (const auto& grpKey : mDirtyKeys) {
+			GroupEntry* group = mAggregateTable.find(grpKey);
+			// skip purged groups and keys which were marked again after a purge
+			if (group == nullptr || !group->mDirty)
+				continue;
+			const AggregateStatePtr& aggrState = group->state();
+			group->mDirty = false;
+			if (aggrState->getCounter() == 0) {
+				if (group->mPublished)
+					produceAggregate(aggrState, aggrState->getTimestamp(), true, lock);
+				mAggregateTable.erase(grpKey);
+			}
+			else {
+				produceAggregate(aggrState, aggrState->getTimestamp(), false, lock);
+				group->mPublished = true;
+			}
 		}
-    */
+		mDirtyKeys.clear();
 	}
-#endif
 
 	/**
 	 * @brief Produce a final aggregate for a specific state and publish it to all subscribers.
@@ -445,18 +537,89 @@ private:
 protected:
 
 	/**
-	 * TODO
+	 * A function called by the TriggerNotifier timer which periodically
+	 * publishes the aggregates of the dirty groups and a SlideExpired punctuation.
 	 */
   void notificationCallback() {
     Lock lock(mAggrMtx);
+    triggerAggregates(lock);
+  }
+
+	/**
+	 * Publishes the aggregates of all groups changed since the last trigger
+	 * followed by a SlideExpired punctuation. The caller has to hold the lock
+	 * protecting the aggregation state.
+	 *
+	 * @param[in] lock
+	 *    a reference to the lock protecting the aggregation state
+	 */
+  void triggerAggregates(const Lock& lock) {
+    produceAggregates(lock);
     PunctuationPtr punctuation = std::make_shared< Punctuation >( Punctuation::SlideExpired );
     this->getOutputPunctuationChannel().publish(punctuation);
   }
 
+public:
+	/**
+	 * Returns the number of groups currently maintained by the operator.
+	 *
+	 * @return the number of groups
+	 */
+	std::size_t numGroups() const {
+		Lock lock(mAggrMtx);
+		return mAggregateTable.size();
+	}
+
+	/**
+	 * Returns the memory used by the state table of the groups, i.e. the entries
+	 * with their inline aggregation states and the list of changed groups (the
+	 * aggregation states created by a factory are not included).
+	 *
+	 * @return the number of bytes
+	 */
+	std::size_t memoryUsage() const {
+		Lock lock(mAggrMtx);
+		return mAggregateTable.memoryUsage() + mDirtyKeys.capacity() * sizeof(KeyType);
+	}
+
+protected:
+	/**
+	 * @brief The entry of a group in the state table.
+	 *
+	 * Without a factory the aggregation state is stored inline in the entry and
+	 * the state pointer is a non-owning alias of it, i.e. copying it does not
+	 * touch any reference counter. If a factory is given the state is created by
+	 * the factory function and owned by the entry.
+	 */
+	class GroupEntry {
+	public:
+		GroupEntry(const AggregateStatePtr& factory, const FactoryFunc& factoryFunc) {
+			if (factory)
+				mState = factoryFunc(factory);
+			else {
+				mInlineState.emplace();
+				mState = AggregateStatePtr(AggregateStatePtr(), mInlineState.get_ptr());
+			}
+		}
+
+		GroupEntry(const GroupEntry&) = delete;
+		GroupEntry& operator=(const GroupEntry&) = delete;
+
+		const AggregateStatePtr& state() const { return mState; }
+
+		bool mDirty = false;     //< true if the group was changed since the last trigger
+		bool mPublished = false; //< true if the aggregate of the group was published by a trigger
+
+	private:
+		boost::optional<AggregateState> mInlineState; //< the state if no factory is used
+		AggregateStatePtr mState;                     //< the pointer to the state passed to the user functions
+	};
+
 private:
   using IntervalType = boost::variant<Timestamp, unsigned int>;
 
   HashTable mAggregateTable;                  //< a hash table for storing the aggregation states for each group
+  std::vector<KeyType> mDirtyKeys;            //< the keys of the groups changed since the last trigger
   TimestampExtractorFunc mTimestampExtractor; //!< a pointer to the function for extracting the timestamp from the tuple
                                               //!< for each group at runtime
   mutable AggregationMutex mAggrMtx;           //!< a mutex for synchronizing access between the trigger notifier thread
@@ -469,6 +632,7 @@ private:
   Timestamp mLastTriggerTime;                 //!< the timestamp of the last aggregate publishing
   AggregationTriggerType mTriggerType;        //!< the type of trigger activating the publishing of an aggregate value
   unsigned int mCounter;                      //!< the number of tuples processed since the last aggregate publishing
+  bool mUseWatermarks;                        //!< true if TriggerByTimestamp is driven by watermarks
   AggregateStatePtr mFactory;
   FactoryFunc mFactoryFunc;
 };
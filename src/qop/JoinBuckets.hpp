@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JoinBuckets_hpp_
+#define JoinBuckets_hpp_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "qop/FlatHashTable.hpp"
+
+namespace pfabric {
+
+  /**
+   * @brief The windowed state of one input of a join, partitioned into buckets.
+   *
+   * JoinBuckets stores the stream elements of one join input together with a
+   * stamp (a timestamp for time-based windows or a sequence number for
+   * count-based windows). The stamps are divided into consecutive buckets of a
+   * fixed width. Each bucket keeps its elements in a contiguous vector where
+   * the elements with the same key are chained, and a FlatHashTable mapping each
+   * key to the head of its chain. Thus, probing a key touches one slot run and a
+   * chain of inline entries per bucket.
+   *
+   * Expired elements are not removed one by one: as soon as all stamps of the
+   * oldest bucket are outside of the window the whole bucket is dropped. The
+   * memory of dropped buckets is recycled, i.e. in a steady state no memory is
+   * allocated. Because a bucket is only dropped as a whole, the state may keep
+   * elements of up to one bucket width beyond the window; probes therefore
+   * filter the elements by their stamp.
+   *
+   * @tparam KeyType
+   *    the data type of the join keys
+   * @tparam StreamElement
+   *    the data stream element type of the input
+   * @tparam KeyHash
+   *    the hash function for the keys
+   */
+  template <typename KeyType, typename StreamElement,
+            typename KeyHash = boost::hash<KeyType>>
+  class JoinBuckets {
+    /// marks the end of a chain
+    static constexpr std::uint32_t EndOfChain = UINT32_MAX;
+
+    /// a stored element
+    struct Entry {
+      StreamElement mElement;  //< the stream element
+      std::uint64_t mStamp;    //< the timestamp or sequence number of the element
+      std::uint32_t mNext;     //< the index of the next entry with the same key
+    };
+
+    /// the elements of a range of stamps
+    struct Bucket {
+      std::uint64_t mId;                                      //< the stamp divided by the bucket width
+      std::vector<Entry> mEntries;                            //< the elements of the bucket
+      FlatHashTable<KeyType, std::uint32_t, KeyHash> mHeads;  //< the first entry per key
+    };
+
+    typedef std::unique_ptr<Bucket> BucketPtr;
+
+  public:
+    /**
+     * Creates a new, empty state.
+     *
+     * @param bucketWidth
+     *    the range of stamps covered by a single bucket (at least 1)
+     */
+    explicit JoinBuckets(std::uint64_t bucketWidth) :
+      mBucketWidth(bucketWidth > 0 ? bucketWidth : 1), mSize(0) {}
+
+    /**
+     * Inserts an element. Elements whose stamp precedes the newest bucket
+     * (late elements) are stored in the newest bucket.
+     *
+     * @param key
+     *    the join key of the element
+     * @param stamp
+     *    the timestamp or sequence number of the element
+     * @param element
+     *    the stream element
+     */
+    void insert(const KeyType& key, std::uint64_t stamp, const StreamElement& element) {
+      const auto id = stamp / mBucketWidth;
+      if (mBuckets.empty() || mBuckets.back()->mId < id)
+        mBuckets.push_back(newBucket(id));
+      Bucket& bucket = *mBuckets.back();
+      const auto idx = static_cast<std::uint32_t>(bucket.mEntries.size());
+      auto res = bucket.mHeads.tryEmplace(key, idx);
+      bucket.mEntries.push_back({ element, stamp, res.second ? EndOfChain : *res.first });
+      *res.first = idx;
+      mSize++;
+    }
+
+    /**
+     * Invokes the given function for each element with the given key and a
+     * stamp in [minStamp, maxStamp] (from the newest to the oldest element).
+     *
+     * @param key
+     *    the join key to look up
+     * @param minStamp
+     *    the minimal stamp of the elements
+     * @param maxStamp
+     *    the maximal stamp of the elements
+     * @param func
+     *    the function called with each matching stream element
+     */
+    template <typename Func>
+    void probe(const KeyType& key, std::uint64_t minStamp, std::uint64_t maxStamp, Func func) const {
+      for (auto b = mBuckets.rbegin(); b != mBuckets.rend(); b++) {
+        const Bucket& bucket = **b;
+        auto head = bucket.mHeads.find(key);
+        if (head == nullptr)
+          continue;
+        for (auto idx = *head; idx != EndOfChain; idx = bucket.mEntries[idx].mNext) {
+          const Entry& e = bucket.mEntries[idx];
+          if (e.mStamp >= minStamp && e.mStamp <= maxStamp)
+            func(e.mElement);
+        }
+      }
+    }
+
+    /**
+     * Drops all buckets which contain only stamps < minStamp.
+     *
+     * @param minStamp
+     *    the minimal stamp of the elements which are still needed
+     * @return the number of dropped elements
+     */
+    std::size_t expire(std::uint64_t minStamp) {
+      std::size_t num = 0;
+      while (!mBuckets.empty() && (mBuckets.front()->mId + 1) * mBucketWidth <= minStamp) {
+        BucketPtr bucket = std::move(mBuckets.front());
+        mBuckets.pop_front();
+        num += bucket->mEntries.size();
+        bucket->mEntries.clear();
+        bucket->mHeads.clear();
+        mFreeBuckets.push_back(std::move(bucket));
+      }
+      mSize -= num;
+      return num;
+    }
+
+    /**
+     * Removes all elements.
+     */
+    void clear() { expire(UINT64_MAX); }
+
+    /**
+     * Returns the number of stored elements.
+     */
+    std::size_t size() const { return mSize; }
+
+    /**
+     * Returns the number of buckets containing elements.
+     */
+    std::size_t numBuckets() const { return mBuckets.size(); }
+
+  private:
+    /**
+     * Returns an empty bucket for the given id, recycling a dropped bucket
+     * if possible.
+     */
+    BucketPtr newBucket(std::uint64_t id) {
+      BucketPtr bucket;
+      if (!mFreeBuckets.empty()) {
+        bucket = std::move(mFreeBuckets.back());
+        mFreeBuckets.pop_back();
+      }
+      else
+        bucket.reset(new Bucket());
+      bucket->mId = id;
+      return bucket;
+    }
+
+    std::uint64_t mBucketWidth;            //< the range of stamps per bucket
+    std::deque<BucketPtr> mBuckets;        //< the buckets from the oldest to the newest one
+    std::vector<BucketPtr> mFreeBuckets;   //< dropped buckets for reuse
+    std::size_t mSize;                     //< the number of stored elements
+  };
+
+} /* end namespace pfabric */
+
+#endif
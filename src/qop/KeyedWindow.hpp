@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KeyedWindow_hpp_
+#define KeyedWindow_hpp_
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <boost/assert.hpp>
+
+#include "core/Punctuation.hpp"
+#include "qop/UnaryTransform.hpp"
+#include "qop/OperatorMacros.hpp"
+#include "qop/Window.hpp"
+#include "qop/WindowBuffer.hpp"
+
+namespace pfabric {
+
+  /**
+   * @brief KeyedWindow implements a sliding window per key.
+   *
+   * KeyedWindow keeps a separate sliding window for each key (determined by a
+   * key extractor function), e.g. to keep the last N readings per sensor. Like
+   * SlidingWindow, each incoming tuple is forwarded to the subscribers and
+   * tuples leaving the window of their key are published as outdated. For a
+   * row window each key keeps at most the given number of tuples, for a range
+   * window the tuples of a key are kept as long as the time difference to the
+   * most recent tuple of this key doesn't exceed the window size.
+   *
+   * The tuples of each key are stored in a separate ring buffer. In order to
+   * bound the state for idle keys, the keys are kept in LRU order: if the
+   * maximum number of keys is exceeded, the least recently used key is evicted,
+   * and if a time-to-live is given, keys without a tuple within this time are
+   * evicted, too. Evicting a key publishes all of its tuples as outdated.
+   *
+   * @tparam StreamElement
+   *    the data stream element type kept in the window
+   * @tparam KeyType
+   *    the data type of the keys
+   */
+  template<typename StreamElement, typename KeyType = DefaultKeyType>
+  class KeyedWindow : public UnaryTransform<StreamElement, StreamElement> {
+  private:
+    PFABRIC_UNARY_TRANSFORM_TYPEDEFS(StreamElement, StreamElement);
+
+  public:
+    /**
+     * Typedef for a function extracting the key from a tuple.
+     */
+    typedef std::function<KeyType(const StreamElement&)> KeyExtractorFunc;
+
+    /**
+     * Typedef for a function extracting the timestamp from a tuple.
+     */
+    typedef std::function<Timestamp(const StreamElement&)> TimestampExtractorFunc;
+
+    /**
+     * @brief Create a new keyed window operator instance.
+     *
+     * @param[in] key_func
+     *    a function for extracting the key of a tuple
+     * @param[in] ts_func
+     *    a function for extracting the timestamp of a tuple
+     * @param[in] wt
+     *    the type of the window (range or row)
+     * @param[in] sz
+     *    the window size per key (seconds or number of tuples)
+     * @param[in] maxKeys
+     *    the maximum number of keys kept (0 = unbounded)
+     * @param[in] ttl
+     *    the time (in seconds) after which an idle key is evicted (0 = never)
+     */
+    KeyedWindow(KeyExtractorFunc key_func, TimestampExtractorFunc ts_func,
+                const WindowParams::WinType& wt, const unsigned int sz,
+                const std::size_t maxKeys = 0, const unsigned int ttl = 0) :
+      mKeyExtractor(key_func), mTimestampExtractor(ts_func), mWinType(wt),
+      mWinSize(sz), mWinRange(Timestamp(sz * 1000 * 1000)), mMaxKeys(maxKeys),
+      mTTL(Timestamp(ttl * 1000 * 1000)), mClock(0) {}
+
+    /**
+     * @brief Create a new keyed row window operator instance.
+     *
+     * @param[in] key_func
+     *    a function for extracting the key of a tuple
+     * @param[in] wt
+     *    the type of the window (must be a row window)
+     * @param[in] sz
+     *    the number of tuples kept per key
+     * @param[in] maxKeys
+     *    the maximum number of keys kept (0 = unbounded)
+     */
+    KeyedWindow(KeyExtractorFunc key_func, const WindowParams::WinType& wt,
+                const unsigned int sz, const std::size_t maxKeys = 0) :
+      mKeyExtractor(key_func), mWinType(wt), mWinSize(sz), mWinRange(0),
+      mMaxKeys(maxKeys), mTTL(0), mClock(0) {
+      BOOST_ASSERT_MSG(mWinType == WindowParams::RowWindow, "RowWindow requires timestamp extractor function.");
+    }
+
+    /**
+     * @brief Bind the callback for the data channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT(InputDataChannel, KeyedWindow, processDataElement);
+
+    /**
+     * @brief Bind the callback for the punctuation channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT(InputPunctuationChannel, KeyedWindow, processPunctuation);
+
+    const std::string opName() const override { return std::string("KeyedWindow"); }
+
+    /**
+     * Returns the number of keys currently kept in the window.
+     *
+     * @return the number of keys
+     */
+    std::size_t numKeys() const {
+      std::lock_guard<std::mutex> guard(mMtx);
+      return mKeyTable.size();
+    }
+
+  private:
+    typedef std::list<KeyType> LRUList;
+
+    /**
+     * The state of a single key: its tuples and the position in the LRU list.
+     */
+    struct KeyState {
+      KeyState(std::size_t capacity) : mTuples(capacity) {}
+
+      WindowBuffer<StreamElement> mTuples;       //< the window of the key
+      Timestamp mLastAccess;                     //< the time of the most recent tuple
+      typename LRUList::iterator mLRUPos;        //< the position in the LRU list
+    };
+
+    typedef std::unordered_map<KeyType, KeyState> KeyTable;
+
+    /**
+     * @brief This method is invoked when a punctuation arrives.
+     *
+     * It ignores the punctuation because a window generates its own punctuations.
+     * Only watermarks are forwarded.
+     *
+     * @param[in] punctuation
+     *    the incoming punctuation tuple
+     */
+    void processPunctuation(const PunctuationPtr& punctuation) {
+      if (punctuation->ptype() == Punctuation::Watermark)
+        this->getOutputPunctuationChannel().publish(punctuation);
+    }
+
+    /**
+     * @brief This method is invoked when a tuple arrives from the publisher.
+     *
+     * The tuple is forwarded and added to the window of its key. Afterwards,
+     * outdated tuples of this key and idle keys are evicted.
+     *
+     * @param[in] data
+     *    the incoming stream element
+     * @param[in] outdated
+     *    flag indicating whether the tuple is new or invalidated now
+     */
+    void processDataElement(const StreamElement& data, const bool outdated) {
+      if (outdated) {
+        this->getOutputDataChannel().publish(data, outdated);
+        return;
+      }
+
+      std::lock_guard<std::mutex> guard(mMtx);
+      const auto key = mKeyExtractor(data);
+      const auto ts = mTimestampExtractor != nullptr ? mTimestampExtractor(data) : Timestamp(0);
+      if (ts > mClock)
+        mClock = ts;
+
+      auto entry = mKeyTable.find(key);
+      if (entry == mKeyTable.end()) {
+        // a row window never grows beyond its size (+1 for the new tuple),
+        // a range window starts small because most keys are sparse
+        const std::size_t capacity = mWinType == WindowParams::RowWindow ? mWinSize + 1 : 4;
+        entry = mKeyTable.emplace(key, capacity).first;
+        mLRUList.push_front(key);
+        entry->second.mLRUPos = mLRUList.begin();
+      }
+      else
+        // move the key to the front of the LRU list
+        mLRUList.splice(mLRUList.begin(), mLRUList, entry->second.mLRUPos);
+
+      auto& state = entry->second;
+      state.mLastAccess = mClock;
+      state.mTuples.push_back(data);
+      this->getOutputDataChannel().publish(data, false);
+
+      if (mWinType == WindowParams::RowWindow)
+        evictByCount(state.mTuples);
+      else
+        evictByTime(state.mTuples, ts);
+
+      evictIdleKeys();
+    }
+
+    /**
+     * Evicts the oldest tuple of a row window if the window exceeds its size.
+     */
+    void evictByCount(WindowBuffer<StreamElement>& tuples) {
+      if (tuples.size() > mWinSize) {
+        const auto tup = tuples.front();
+        tuples.pop_front();
+        this->getOutputDataChannel().publish(tup, true);
+      }
+    }
+
+    /**
+     * Evicts all tuples of a range window which are older than the window size
+     * with respect to the given (most recent) timestamp.
+     */
+    void evictByTime(WindowBuffer<StreamElement>& tuples, const Timestamp& lastTupleTime) {
+      if (lastTupleTime < mWinRange)
+        return;
+      const auto acceptedTime = lastTupleTime - mWinRange;
+      while (!tuples.empty() && mTimestampExtractor(tuples.front()) <= acceptedTime) {
+        const auto tup = tuples.front();
+        tuples.pop_front();
+        this->getOutputDataChannel().publish(tup, true);
+      }
+    }
+
+    /**
+     * Evicts the least recently used keys if the number of keys exceeds the
+     * limit or if they are idle longer than the time-to-live.
+     */
+    void evictIdleKeys() {
+      while (!mLRUList.empty()) {
+        auto entry = mKeyTable.find(mLRUList.back());
+        if ((mMaxKeys > 0 && mKeyTable.size() > mMaxKeys) ||
+            (mTTL.count() > 0 && entry->second.mLastAccess + mTTL <= mClock))
+          evictKey(entry);
+        else
+          break;
+      }
+    }
+
+    /**
+     * Removes a key and publishes all of its tuples as outdated.
+     */
+    void evictKey(typename KeyTable::iterator entry) {
+      for (const auto& tup : entry->second.mTuples)
+        this->getOutputDataChannel().publish(tup, true);
+      mLRUList.erase(entry->second.mLRUPos);
+      mKeyTable.erase(entry);
+    }
+
+    KeyExtractorFunc mKeyExtractor;             //< the function for extracting the key of a tuple
+    TimestampExtractorFunc mTimestampExtractor; //< the function for extracting the timestamp of a tuple
+    WindowParams::WinType mWinType;             //< the type of the windows
+    unsigned int mWinSize;                      //< the number of tuples per key (row window)
+    Timestamp mWinRange;                        //< the time interval per key (range window)
+    std::size_t mMaxKeys;                       //< the maximum number of keys (0 = unbounded)
+    Timestamp mTTL;                             //< the time-to-live of idle keys (0 = unbounded)
+    Timestamp mClock;                           //< the most recent timestamp seen
+    KeyTable mKeyTable;                         //< the windows of all keys
+    LRUList mLRUList;                           //< the keys ordered by their last access
+    mutable std::mutex mMtx;                    //< mutex for accessing the windows
+  };
+
+} // namespace pfabric
+
+#endif
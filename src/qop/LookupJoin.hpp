@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LookupJoin_hpp_
+#define LookupJoin_hpp_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "qop/UnaryTransform.hpp"
+#include "qop/OperatorMacros.hpp"
+#include "qop/FlatHashTable.hpp"
+#include "qop/ElementJoinTraits.hpp"
+#include "qop/DefaultElementJoin.hpp"
+#include "table/BaseTable.hpp"
+
+namespace pfabric {
+
+  /**
+   * @brief An operator joining a stream with the records of a table.
+   *
+   * For each incoming stream element the LookupJoin operator extracts a key and
+   * probes the given table (e.g. a Table or CuckooTable) with this key. If a record
+   * exists, the stream element is joined with the record, otherwise the element is
+   * discarded. Outdated stream elements are joined with the current record and
+   * forwarded as outdated. The table is probed via @c findByKey, i.e. the record is
+   * not copied into a new SmartPtr.
+   *
+   * Optionally, the operator keeps a bounded cache of records (the oldest records are
+   * evicted first). The cache registers observers at the table which count the
+   * modifications and truncates (including drop). The cache is cleared as soon as the
+   * table is modified, also if a modification happens while a record is probed. Thus,
+   * it is useful for reference data which is rarely updated. Furthermore, incoming elements can be collected in batches which
+   * are first probed together and then published, i.e. the probes are not interleaved
+   * with the downstream processing. A batch is processed if it is full or a punctuation
+   * arrives.
+   *
+   * @tparam InputStreamElement
+   *    the data stream element type consumed by the join
+   * @tparam TableType
+   *    the type of the table providing @c findByKey, @c registerObserver and
+   *    @c registerTruncateObserver (returning the connection of the observer) and
+   *    the typedefs @c RType and @c KType
+   * @tparam ElementJoinImpl
+   *    the actual join algorithm to be used for joining a stream element and a record
+   */
+  template<
+    typename InputStreamElement,
+    typename TableType,
+    typename ElementJoinImpl = DefaultElementJoin< InputStreamElement, typename TableType::RType >
+  >
+  class LookupJoin : public UnaryTransform<InputStreamElement,
+    typename ElementJoinTraits< ElementJoinImpl >::ResultElement> {
+  private:
+    PFABRIC_UNARY_TRANSFORM_TYPEDEFS(InputStreamElement, typename ElementJoinTraits< ElementJoinImpl >::ResultElement)
+
+    //the join algorithm to be used for concatenating the input elements
+    typedef ElementJoinTraits< ElementJoinImpl > ElementJoin;
+
+  public:
+    //the record type and key type of the table
+    typedef typename TableType::RType RecordType;
+    typedef typename TableType::KType KeyType;
+
+    //the join result for a stream element and a record
+    typedef typename ElementJoin::ResultElement ResultElement;
+
+    //typedef for the key extractor function
+    typedef std::function<KeyType(const InputStreamElement&)> KeyExtractorFunc;
+
+    /**
+     * @brief Constructs a new LookupJoin operator.
+     *
+     * @param[in] tbl
+     *    the table which is probed
+     * @param[in] keyFunc
+     *    the function for extracting the key from a stream element
+     * @param[in] cacheSize
+     *    the maximal number of cached records (0 = no cache)
+     * @param[in] batchSize
+     *    the number of stream elements probed together (1 = no batching)
+     */
+    LookupJoin(std::shared_ptr<TableType> tbl, KeyExtractorFunc keyFunc,
+               std::size_t cacheSize = 0, std::size_t batchSize = 1) :
+      mTable(tbl), mKeyExtractor(keyFunc), mCache(cacheSize), mCacheSize(cacheSize),
+      mNextEviction(0), mBatchSize(batchSize > 0 ? batchSize : 1),
+      mGeneration(std::make_shared<std::atomic<unsigned long>>(0)), mCacheGeneration(0) {
+      if (mCacheSize > 0) {
+        mCacheKeys.reserve(mCacheSize);
+        // a running notification may outlive the connection, thus the observer holds only a weak reference
+        std::weak_ptr<std::atomic<unsigned long>> generation = mGeneration;
+        mConnection = mTable->registerObserver([generation](const RecordType&, TableParams::ModificationMode) {
+          if (auto gen = generation.lock())
+            gen->fetch_add(1, std::memory_order_acq_rel);
+        }, TableParams::Immediate);
+        mTruncateConnection = mTable->registerTruncateObserver([generation]() {
+          if (auto gen = generation.lock())
+            gen->fetch_add(1, std::memory_order_acq_rel);
+        });
+      }
+      if (mBatchSize > 1)
+        mBatch.reserve(mBatchSize);
+    }
+
+    /**
+     * @brief Destructor unregistering the observer of the cache from the table.
+     */
+    ~LookupJoin() {
+      mConnection.disconnect();
+      mTruncateConnection.disconnect();
+    }
+
+    /**
+     * @brief Bind the callback for the data channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT(InputDataChannel, LookupJoin, processDataElement);
+
+    /**
+     * @brief Bind the callback for the punctuation channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT(InputPunctuationChannel, LookupJoin, processPunctuation);
+
+    /**
+     * Returns the number of cached records.
+     */
+    std::size_t cacheSize() const { return mCache.size(); }
+
+    const std::string opName() const override { return std::string("LookupJoin"); }
+
+  private:
+    /**
+     * @brief This method is invoked when a punctuation arrives.
+     *
+     * The pending batch is processed before the punctuation is forwarded.
+     *
+     * @param[in] punctuation
+     *    the incoming punctuation tuple
+     */
+    void processPunctuation(const PunctuationPtr& punctuation) {
+      processBatch();
+      this->getOutputPunctuationChannel().publish(punctuation);
+    }
+
+    /**
+     * @brief This method is invoked when a data stream element arrives.
+     *
+     * The element is joined with the record of its key or added to the
+     * current batch.
+     *
+     * @param[in] data
+     *    the incoming stream element
+     * @param[in] outdated
+     *    flag indicating whether the tuple is new or invalidated now
+     */
+    void processDataElement(const InputStreamElement& data, const bool outdated) {
+      if (mBatchSize == 1) {
+        validateCache();
+        ResultElement res;
+        if (probe(data, res))
+          this->getOutputDataChannel().publish(res, outdated);
+        return;
+      }
+      mBatch.push_back({ data, outdated });
+      if (mBatch.size() >= mBatchSize)
+        processBatch();
+    }
+
+    /**
+     * @brief Probes all elements of the current batch and publishes the results.
+     */
+    void processBatch() {
+      if (mBatch.empty())
+        return;
+      validateCache();
+      mResults.clear();
+      for (const auto& entry : mBatch) {
+        ResultElement res;
+        if (probe(entry.first, res))
+          mResults.push_back({ res, entry.second });
+      }
+      mBatch.clear();
+      for (const auto& res : mResults)
+        this->getOutputDataChannel().publish(res.first, res.second);
+      mResults.clear();
+    }
+
+    /**
+     * @brief Joins the given element with the record of its key.
+     *
+     * The record is taken from the cache (if any) or the table.
+     *
+     * @param[in] data
+     *    the stream element
+     * @param[out] res
+     *    the join result
+     * @return false if no record exists for the key
+     */
+    bool probe(const InputStreamElement& data, ResultElement& res) {
+      auto key = mKeyExtractor(data);
+      if (mCacheSize == 0)
+        return mTable->findByKey(key, [&](const RecordType& rec) {
+          res = ElementJoin::joinElements(data, rec);
+        });
+
+      auto cached = mCache.find(key);
+      if (cached != nullptr) {
+        res = ElementJoin::joinElements(data, *cached);
+        return true;
+      }
+      bool found = mTable->findByKey(key, [&](const RecordType& rec) {
+        res = ElementJoin::joinElements(data, rec);
+        cacheRecord(key, rec);
+      });
+      // the table notifies after a modification, thus a record which was modified
+      // while it was probed is removed by clearing the cache again
+      if (found)
+        validateCache();
+      return found;
+    }
+
+    /**
+     * @brief Adds a record to the cache, evicting the oldest record if the cache is full.
+     */
+    void cacheRecord(const KeyType& key, const RecordType& rec) {
+      if (mCacheKeys.size() < mCacheSize)
+        mCacheKeys.push_back(key);
+      else {
+        mCache.erase(mCacheKeys[mNextEviction]);
+        mCacheKeys[mNextEviction] = key;
+        mNextEviction = (mNextEviction + 1) % mCacheSize;
+      }
+      mCache.tryEmplace(key, rec);
+    }
+
+    /**
+     * @brief Clears the cache if the table was modified since the last check.
+     */
+    void validateCache() {
+      auto gen = mGeneration->load(std::memory_order_acquire);
+      if (gen != mCacheGeneration) {
+        mCache.clear();
+        mCacheKeys.clear();
+        mNextEviction = 0;
+        mCacheGeneration = gen;
+      }
+    }
+
+    std::shared_ptr<TableType> mTable;                      //< the table which is probed
+    KeyExtractorFunc mKeyExtractor;                         //< function for extracting the key of a stream element
+    FlatHashTable<KeyType, RecordType> mCache;              //< the cached records
+    std::size_t mCacheSize;                                 //< the maximal number of cached records
+    std::vector<KeyType> mCacheKeys;                        //< the keys of the cache in insertion order (a ring)
+    std::size_t mNextEviction;                              //< the position of the oldest key in mCacheKeys
+    std::size_t mBatchSize;                                 //< the number of elements probed together
+    std::vector<std::pair<InputStreamElement, bool>> mBatch; //< the elements of the current batch
+    std::vector<std::pair<ResultElement, bool>> mResults;   //< the join results of the current batch
+    std::shared_ptr<std::atomic<unsigned long>> mGeneration; //< the number of table modifications counted by the observer
+    unsigned long mCacheGeneration;                         //< the number of table modifications the cache is valid for
+    boost::signals2::connection mConnection;                //< the connection of the observer at the table
+    boost::signals2::connection mTruncateConnection;        //< the connection of the truncate observer at the table
+  };
+
+}
+
+#endif
@@ -32,10 +32,14 @@ namespace pfabric {
  *    the data stream element type consumed by the projection
  * @tparam OutputStreamElement
  *    the data stream element type produced by the projection
+ * @tparam Func
+ *    the type of the projection function (a std::function by default, but
+ *    any callable type can be used to allow inlining of the function)
  */
 template<
 	typename InputStreamElement,
-	typename OutputStreamElement
+	typename OutputStreamElement,
+	typename Func = std::function< OutputStreamElement (const InputStreamElement&, bool) >
 >
 class Map :
 	public UnaryTransform< InputStreamElement, OutputStreamElement > // use default unary transform
@@ -48,7 +52,7 @@ public:
 	/**
 	 * Typedef for a function pointer to a projection function.
 	 */
-	typedef std::function< OutputStreamElement (const InputStreamElement&, bool) > MapFunc;
+	typedef Func MapFunc;
 
 	/**
 	 * @brief Construct a new instance of the map (projection) operator.
@@ -97,7 +101,7 @@ private:
 	 *    flag indicating whether the tuple is new or invalidated now
 	 */
 	void processDataElement( const InputStreamElement& data, const bool outdated ) {
-		auto res = mFunc( data, outdated );
+		OutputStreamElement res = mFunc( data, outdated );
 		this->getOutputDataChannel().publish( res, outdated );
 	}
 
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MultiWayElementJoin_hpp_
+#define MultiWayElementJoin_hpp_
+
+#include <tuple>
+
+#include "core/StreamElementTraits.hpp"
+#include "core/TuplePtrFactory.hpp"
+
+#include "libcpp/mpl/sequences/GenerateIndexes.hpp"
+
+
+namespace pfabric {
+
+/**
+ * @brief An eager join implementation for concatenating an arbitrary number of stream elements.
+ *
+ * This class is the n-ary counterpart of the @c EagerElementJoin: the attributes of all
+ * stream elements are concatenated in the order of the @c StreamElements and passed at
+ * once to the @c TuplePtrFactory. Thus, the result of joining n elements is created
+ * directly without building the n-2 intermediate results of chained binary joins.
+ *
+ * @tparam StreamElements
+ *    the types of the stream elements to be joined
+ */
+template<
+	typename... StreamElements
+>
+class MultiWayElementJoin {
+private:
+
+	/**
+	 * @brief Get a tuple of references to all attributes of a stream element.
+	 */
+	template<
+		typename StreamElement,
+		int... AttributeIndexes
+	>
+	static auto attributeRefs( const StreamElement& element,
+		const ns_mpl::IndexTuple< AttributeIndexes... >& attributeIndexes )
+		-> decltype( std::forward_as_tuple( getAttribute< AttributeIndexes >( element )... ) )
+	{
+		return std::forward_as_tuple( getAttribute< AttributeIndexes >( element )... );
+	}
+
+	template< typename StreamElement >
+	static auto attributeRefs( const StreamElement& element )
+		-> decltype( attributeRefs( element,
+				typename ns_mpl::generateIndexes< StreamElementTraits< StreamElement >::NUM_ATTRIBUTES >::type() ) )
+	{
+		return attributeRefs( element,
+			typename ns_mpl::generateIndexes< StreamElementTraits< StreamElement >::NUM_ATTRIBUTES >::type() );
+	}
+
+	/// a std::tuple of references to the attributes of all stream elements
+	typedef decltype( std::tuple_cat( attributeRefs( std::declval< const StreamElements& >() )... ) ) AttributeRefs;
+
+	/// meta function deriving the result element type from the attribute references
+	template< typename Refs >
+	struct getResultElement;
+
+	template< typename... Refs >
+	struct getResultElement< std::tuple< Refs... > > {
+		typedef typename TuplePtrFactory::getElementType< Refs... >::type type;
+	};
+
+public:
+
+	/// the join result element type
+	typedef typename getResultElement< AttributeRefs >::type ResultElement;
+
+	/**
+	 * @brief Join all stream elements to a new result element.
+	 *
+	 * The result contains all attributes of the given elements in their order,
+	 * null flags are copied as well.
+	 *
+	 * @param[in] elements
+	 *    the stream elements to be joined
+	 * @return a new stream element containing all attributes
+	 */
+	static ResultElement joinElements( const StreamElements&... elements ) {
+		ResultElement joinedElement = std::apply( []( const auto&... attributes ) {
+			return TuplePtrFactory::create( attributes... );
+		}, std::tuple_cat( attributeRefs( elements )... ) );
+
+		// copy null attributes of all elements
+		AttributeIdx offset = 0;
+		( copyNulls( joinedElement, elements, offset ), ... );
+		return joinedElement;
+	}
+
+private:
+
+	template< typename StreamElement >
+	static void copyNulls( ResultElement& joinedElement, const StreamElement& element, AttributeIdx& offset ) {
+		const AttributeIdx numAttributes = StreamElementTraits< StreamElement >::NUM_ATTRIBUTES;
+		for( AttributeIdx attributeIdx = 0; attributeIdx < numAttributes; attributeIdx++ ) {
+			setNull( joinedElement, offset + attributeIdx, isNull( element, attributeIdx ) );
+		}
+		offset += numAttributes;
+	}
+};
+
+} /* end namespace pfabric */
+
+
+#endif /* MultiWayElementJoin_hpp_ */
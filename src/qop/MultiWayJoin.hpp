@@ -0,0 +1,427 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MultiWayJoin_hpp_
+#define MultiWayJoin_hpp_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/core/ignore_unused.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include "qop/DataSink.hpp"
+#include "qop/DataSource.hpp"
+#include "qop/OperatorMacros.hpp"
+#include "qop/MultiWayElementJoin.hpp"
+
+namespace pfabric {
+
+  /**
+   * \brief An operator implementing a symmetric hash join of n streams sharing a join key.
+   *
+   * Compared to a chain of SHJoin operators, the operator keeps exactly one hash table
+   * per input and produces the final join results directly, i.e. no intermediate join
+   * results are created, stored in hash tables and retracted again. An incoming tuple
+   * is inserted into (or removed from, if outdated) the hash table of its input and
+   * then probes the hash tables of all other inputs. The probing stops at the first
+   * input without a matching key, therefore inputs are probed in the order of their
+   * observed input rates: the input with the fewest tuples first, as it is the most
+   * likely one without a partner. The order is recomputed every reorderInterval
+   * tuples or can be fixed by setProbeOrder().
+   *
+   * Each input is represented by an Input sink which has to be connected to the
+   * producer of the corresponding stream, see getInput().
+   *
+   * @tparam KeyType
+   *    the data type of the join keys
+   * @tparam InputStreamElements
+   *    the data stream element types of all inputs (at least two)
+   */
+  template<
+  typename KeyType,
+  typename... InputStreamElements
+  >
+  class MultiWayJoin :
+    public DataSource< typename MultiWayElementJoin< InputStreamElements... >::ResultElement > {
+    public:
+      /// the number of inputs
+      static const std::size_t NUM_INPUTS = sizeof...(InputStreamElements);
+
+      static_assert(NUM_INPUTS >= 2, "a multi-way join requires at least two inputs");
+
+      /// the join algorithm for concatenating the input elements
+      typedef MultiWayElementJoin< InputStreamElements... > ElementJoin;
+
+      /// the join result for one element of each input
+      typedef typename ElementJoin::ResultElement ResultElement;
+
+      /// the data stream element type of the input I
+      template< std::size_t I >
+      using InputStreamElement = typename std::tuple_element< I, std::tuple< InputStreamElements... > >::type;
+
+      /**
+       * Typedef for the key extractor functions of all inputs.
+       */
+      typedef std::tuple< std::function< KeyType(const InputStreamElements&) >... > KeyExtractorFuncs;
+
+      /**
+       * Typedef for the pointer to a function implementing the join predicate.
+       */
+      typedef std::function< bool(const InputStreamElements&...) > JoinPredicateFunc;
+
+      /**
+       * \brief The sink receiving the tuples of input I.
+       *
+       * The sink forwards all data elements and punctuations to the join operator.
+       */
+      template< std::size_t I >
+      class Input : public DataSink< InputStreamElement< I > > {
+        PFABRIC_SINK_TYPEDEFS(InputStreamElement< I >);
+
+      public:
+        Input(MultiWayJoin& join) : mJoin(join) {}
+
+        /**
+         * @brief Bind the callback for the data channel.
+         */
+        BIND_INPUT_CHANNEL_DEFAULT( InputDataChannel, Input, processDataElement );
+
+        /**
+         * @brief Bind the callback for the punctuation channel.
+         */
+        BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, Input, processPunctuation );
+
+        const std::string opName() const override { return std::string("MultiWayJoin::Input"); }
+
+      private:
+        void processDataElement( const InputStreamElement< I >& data, const bool outdated ) {
+          mJoin.template processDataElement< I >( data, outdated );
+        }
+
+        void processPunctuation( const PunctuationPtr& punctuation ) {
+          mJoin.processPunctuation( punctuation );
+        }
+
+        MultiWayJoin& mJoin; //< the join operator
+      };
+
+      const std::string opName() const override { return std::string("MultiWayJoin"); }
+
+    private:
+      /// a hash table per input, all tuples of a key are kept in a vector
+      template< typename StreamElement >
+      using HashTable = std::unordered_map< KeyType, std::vector< StreamElement > >;
+
+      /// the tuples of all inputs matching a key (nullptr for the probing input)
+      typedef std::tuple< const std::vector< InputStreamElements >*... > Groups;
+
+      /// the tuples of a join result
+      typedef std::tuple< const InputStreamElements*... > Combination;
+
+      /// a mutex for protecting join processing from concurrent sources
+      typedef boost::mutex JoinMutex;
+
+      /// a scoped lock for the mutex
+      typedef boost::lock_guard< JoinMutex > Lock;
+
+      /// the index sequence of all inputs
+      typedef std::index_sequence_for< InputStreamElements... > InputIndexes;
+
+    public:
+      /**
+       * Constructs a new multi-way join operator.
+       *
+       * \param keyFuncs functions for extracting the join key of the tuples of each input
+       * \param joinPred function pointer to a join predicate (nullptr = key equality only)
+       * \param reorderInterval number of tuples after which the probe order is adapted
+       *        to the observed input rates (0 = keep the probe order)
+       */
+      MultiWayJoin( KeyExtractorFuncs keyFuncs, JoinPredicateFunc joinPred = nullptr,
+                    std::size_t reorderInterval = 1024 ) :
+        mKeyExtractors(std::move(keyFuncs)), mJoinPredicate(std::move(joinPred)),
+        mReorderInterval(reorderInterval), mNumSinceReorder(0) {
+        std::iota(mProbeOrder.begin(), mProbeOrder.end(), 0);
+        mArrivals.fill(0);
+        createInputs(InputIndexes());
+      }
+
+      /**
+       * Returns the sink receiving the tuples of input I which has to be connected
+       * to the producer of the stream.
+       *
+       * @return the input sink
+       */
+      template< std::size_t I >
+      std::shared_ptr< Input< I > > getInput() const {
+        return std::static_pointer_cast< Input< I > >( mInputs[I] );
+      }
+
+      /**
+       * Fixes the order in which the hash tables of the inputs are probed and
+       * disables the adaptation to the observed input rates.
+       *
+       * @param[in] order
+       *    a permutation of the input indexes [0 ... NUM_INPUTS)
+       * @throw std::invalid_argument if the order is not a permutation of the input indexes
+       */
+      void setProbeOrder( const std::array< std::size_t, NUM_INPUTS >& order ) {
+        if (!std::is_permutation( order.begin(), order.end(), identityOrder().begin() ))
+          throw std::invalid_argument( "the probe order is not a permutation of the inputs" );
+        Lock lock( mMtx );
+        mProbeOrder = order;
+        mReorderInterval = 0;
+      }
+
+      /**
+       * Returns the order in which the hash tables of the inputs are probed.
+       *
+       * @return the input indexes in probe order
+       */
+      std::array< std::size_t, NUM_INPUTS > probeOrder() const {
+        Lock lock( mMtx );
+        return mProbeOrder;
+      }
+
+      /**
+       * Returns the number of tuples currently kept in the hash tables of all inputs.
+       *
+       * @return the number of tuples
+       */
+      std::size_t stateSize() const {
+        Lock lock( mMtx );
+        return stateSize(InputIndexes());
+      }
+
+    private:
+      ////////////   channel callbacks   ////////////
+
+      /**
+       * @brief This method is invoked when a data stream element arrives from input I.
+       *
+       * It updates the hash table of input I and publishes all combinations with
+       * matching tuples of the other inputs.
+       *
+       * @param[in] data
+       *    the incoming stream element
+       * @param[in] outdated
+       *    flag indicating whether the tuple is new or invalidated now
+       */
+      template< std::size_t I >
+      void processDataElement( const InputStreamElement< I >& data, const bool outdated ) {
+        Lock lock( mMtx );
+
+        // 1. insert the tuple in the hash table of its input or remove it if outdated
+        auto keyval = std::get< I >( mKeyExtractors )( data );
+        updateHashTable< I >( keyval, data, outdated, lock );
+        if ( !outdated )
+          countArrival( I, lock );
+
+        // 2. probe all other inputs in probe order, stop at the first one without partner
+        Groups groups;
+        std::get< I >( groups ) = nullptr;
+        for ( auto input : mProbeOrder ) {
+          if ( input != I && !lookup( input, keyval, groups, InputIndexes() ) )
+            return;
+        }
+
+        // 3. publish all combinations of the matching tuples
+        Combination tuples;
+        std::get< I >( tuples ) = &data;
+        joinGroups< I, 0 >( groups, tuples, outdated );
+      }
+
+      /**
+       * @brief This method is invoked when a punctuation arrives from any input.
+       *
+       * All punctuations are forwarded.
+       *
+       * @param[in] punctuation
+       *    the incoming punctuation tuple
+       */
+      void processPunctuation( const PunctuationPtr& punctuation ) {
+        this->getOutputPunctuationChannel().publish( punctuation );
+      }
+
+      ////////////   helper methods   ////////////
+
+      template< std::size_t... Is >
+      void createInputs( std::index_sequence< Is... > ) {
+        ( ( mInputs[Is] = std::make_shared< Input< Is > >( *this ) ), ... );
+      }
+
+      template< std::size_t... Is >
+      std::size_t stateSize( std::index_sequence< Is... > ) const {
+        std::size_t num = 0;
+        ( tableSize( std::get< Is >( mTables ), num ), ... );
+        return num;
+      }
+
+      template< typename Table >
+      static void tableSize( const Table& table, std::size_t& num ) {
+        for ( const auto& entry : table )
+          num += entry.second.size();
+      }
+
+      static std::array< std::size_t, NUM_INPUTS > identityOrder() {
+        std::array< std::size_t, NUM_INPUTS > order;
+        std::iota( order.begin(), order.end(), 0 );
+        return order;
+      }
+
+      /**
+       * @brief Update the hash table of input I for a new input element.
+       *
+       * @param[in] key
+       *    the hash key for the new element
+       * @param[in] newElement
+       *    the new element
+       * @param[in] outdated
+       *    flag indicating whether the tuple is new or invalidated now
+       * @param[in] lock
+       *    reference to the lock protecting the hash tables
+       */
+      template< std::size_t I >
+      void updateHashTable( const KeyType& key, const InputStreamElement< I >& newElement,
+                            const bool outdated, const Lock& lock ) {
+        boost::ignore_unused( lock );
+        auto& hashTable = std::get< I >( mTables );
+
+        if( !outdated ) {
+          hashTable[key].push_back( newElement );
+        }
+        else {
+          auto entry = hashTable.find( key );
+          if ( entry == hashTable.end() )
+            return;
+          auto& elements = entry->second;
+          elements.erase( std::remove_if( elements.begin(), elements.end(),
+            [&]( const InputStreamElement< I >& e ) { return elementsEqual( newElement, e ); } ),
+            elements.end() );
+          if ( elements.empty() )
+            hashTable.erase( entry );
+        }
+      }
+
+      /**
+       * @brief Count a new tuple of an input and adapt the probe order if necessary.
+       *
+       * The inputs are sorted by the number of tuples received since the last
+       * adaptation, afterwards the counters are halved to prefer recent rates.
+       *
+       * @param[in] input
+       *    the index of the input
+       * @param[in] lock
+       *    reference to the lock protecting the counters
+       */
+      void countArrival( std::size_t input, const Lock& lock ) {
+        boost::ignore_unused( lock );
+        mArrivals[input]++;
+        if ( mReorderInterval == 0 || ++mNumSinceReorder < mReorderInterval )
+          return;
+
+        mNumSinceReorder = 0;
+        std::stable_sort( mProbeOrder.begin(), mProbeOrder.end(), [this]( std::size_t a, std::size_t b ) {
+          return mArrivals[a] < mArrivals[b];
+        });
+        for ( auto& num : mArrivals )
+          num /= 2;
+      }
+
+      /**
+       * @brief Look up the tuples of the given input matching a key.
+       *
+       * @return false if the input has no tuple with this key
+       */
+      template< std::size_t... Is >
+      bool lookup( std::size_t input, const KeyType& key, Groups& groups, std::index_sequence< Is... > ) const {
+        bool found = false;
+        ( ( input == Is && ( found = lookupInput< Is >( key, groups ), true ) ) || ... );
+        return found;
+      }
+
+      template< std::size_t J >
+      bool lookupInput( const KeyType& key, Groups& groups ) const {
+        const auto& hashTable = std::get< J >( mTables );
+        auto entry = hashTable.find( key );
+        if ( entry == hashTable.end() )
+          return false;
+        std::get< J >( groups ) = &entry->second;
+        return true;
+      }
+
+      /**
+       * @brief Enumerate all combinations of the matching tuples of the inputs J ... NUM_INPUTS-1.
+       *
+       * @tparam I
+       *    the index of the input of the incoming tuple
+       * @tparam J
+       *    the index of the next input to be enumerated
+       */
+      template< std::size_t I, std::size_t J >
+      void joinGroups( const Groups& groups, Combination& tuples, const bool outdated ) {
+        if constexpr ( J == NUM_INPUTS ) {
+          joinTuples( tuples, outdated, InputIndexes() );
+        }
+        else if constexpr ( J == I ) {
+          joinGroups< I, J + 1 >( groups, tuples, outdated );
+        }
+        else {
+          for ( const auto& element : *std::get< J >( groups ) ) {
+            std::get< J >( tuples ) = &element;
+            joinGroups< I, J + 1 >( groups, tuples, outdated );
+          }
+        }
+      }
+
+      /**
+       * @brief Join one tuple of each input and publish the result.
+       *
+       * This method joins the tuples and produces a result if the join predicate matches.
+       */
+      template< std::size_t... Is >
+      void joinTuples( const Combination& tuples, const bool outdated, std::index_sequence< Is... > ) {
+        if( !mJoinPredicate || mJoinPredicate( *std::get< Is >( tuples )... ) ) {
+          ResultElement joinedTuple = ElementJoin::joinElements( *std::get< Is >( tuples )... );
+          this->getOutputDataChannel().publish( joinedTuple, outdated );
+        }
+      }
+
+      std::tuple< HashTable< InputStreamElements >... > mTables; //< the hash tables of all inputs
+      std::array< std::shared_ptr< BaseOp >, NUM_INPUTS > mInputs; //< the input sinks
+      KeyExtractorFuncs mKeyExtractors;                 //< key extractors for all inputs
+      JoinPredicateFunc mJoinPredicate;                 //< a pointer to the function implementing the join predicate
+      std::array< std::size_t, NUM_INPUTS > mProbeOrder; //< the order in which the inputs are probed
+      std::array< std::uint64_t, NUM_INPUTS > mArrivals; //< the number of recently received tuples per input
+      std::size_t mReorderInterval;                     //< number of tuples between adaptations of the probe order
+      std::size_t mNumSinceReorder;                     //< number of tuples since the last adaptation
+      mutable JoinMutex mMtx;
+    };
+
+} /* end namespace pfabric */
+
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PartialAggregation_hpp_
+#define PartialAggregation_hpp_
+
+#include <memory>
+
+#include "core/Punctuation.hpp"
+#include "core/Tuple.hpp"
+#include "qop/FlatHashTable.hpp"
+#include "qop/UnaryTransform.hpp"
+#include "qop/OperatorMacros.hpp"
+
+namespace pfabric {
+
+/**
+ * @brief The first phase of a two-phase grouped aggregation.
+ *
+ * PartialAggregation pre-aggregates the stream elements of a single partition
+ * per group key. In contrast to GroupedAggregation it does not publish final
+ * results, but periodically flushes its partial aggregation states as tuples
+ * (key, state) and starts from scratch. The partial states are flushed after
+ * every @c flushInterval stream elements as well as before each punctuation is
+ * forwarded. A subsequent (final) GroupedAggregation merges the partial states
+ * of all partitions using the @c combine function of the aggregation state.
+ * Because each group can be pre-aggregated in every partition, the input
+ * stream can be partitioned independently of the grouping key, e.g. round-robin.
+ *
+ * Outdated stream elements are passed to the iterate function as usual, i.e.
+ * the partial state then represents a delta which is only combined correctly
+ * for invertible aggregates (sum, count, avg).
+ *
+ * @tparam InputStreamElement
+ *    the data stream element type consumed by the aggregation
+ * @tparam AggregateState
+ *    the aggregation state class (e.g. Aggregator1 ... AggregatorN) providing
+ *    static @c iterateForKey and @c combine functions
+ * @tparam KeyType
+ *    the data type for the key column
+ */
+template<
+  typename InputStreamElement,
+  typename AggregateState,
+  typename KeyType = DefaultKeyType
+>
+class PartialAggregation :
+  public UnaryTransform< InputStreamElement, TuplePtr< KeyType, std::shared_ptr< AggregateState > > > {
+public:
+  /// a pointer to an aggregation state
+  typedef std::shared_ptr< AggregateState > AggregateStatePtr;
+
+  /// the tuple type for publishing a partial state: (key, state)
+  typedef TuplePtr< KeyType, AggregateStatePtr > PartialAggregatePtr;
+
+  /// the function for calculating a grouping key for an incoming stream element
+  typedef std::function< KeyType(const InputStreamElement&) > GroupByFunc;
+
+  /// the function which is invoked for each incoming stream element
+  typedef std::function< void(const InputStreamElement&,
+    const KeyType&, AggregateStatePtr, const bool)> IterateFunc;
+
+private:
+  PFABRIC_UNARY_TRANSFORM_TYPEDEFS(InputStreamElement, PartialAggregatePtr);
+
+public:
+  /**
+   * @brief Create a new instance of the PartialAggregation operator.
+   *
+   * @param groupby_fun
+   *    a function pointer for getting the group id
+   * @param it_fun
+   *    a function pointer to an iteration function called for each incoming tuple
+   * @param flushInterval
+   *    the number of stream elements after which the partial states are
+   *    published (0 = only before punctuations)
+   */
+  PartialAggregation(GroupByFunc groupby_fun, IterateFunc it_fun, unsigned int flushInterval) :
+    mGroupByFunc(groupby_fun), mIterateFunc(it_fun), mFlushInterval(flushInterval), mCounter(0) {}
+
+  /**
+   * @brief Bind the callback for the data channel.
+   */
+  BIND_INPUT_CHANNEL_DEFAULT( InputDataChannel, PartialAggregation, processDataElement );
+
+  /**
+   * @brief Bind the callback for the punctuation channel.
+   */
+  BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, PartialAggregation, processPunctuation );
+
+  const std::string opName() const override { return std::string("PartialAggregation"); }
+
+  /**
+   * Returns the number of groups which are pre-aggregated since the last flush.
+   *
+   * @return the number of groups
+   */
+  std::size_t numGroups() const { return mPartials.size(); }
+
+private:
+  /**
+   * This method is invoked when a data stream element arrives. It updates the
+   * partial state of the element's group and flushes all partial states if
+   * the flush interval is reached.
+   *
+   * @param[in] data
+   *    the incoming stream element
+   * @param[in] outdated
+   *    flag indicating whether the tuple is new or invalidated now
+   */
+  void processDataElement(const InputStreamElement& data, const bool outdated) {
+    const KeyType grpKey = mGroupByFunc(data);
+    auto res = mPartials.tryEmplace(grpKey);
+    if (res.second)
+      *res.first = std::make_shared<AggregateState>();
+    mIterateFunc(data, grpKey, *res.first, outdated);
+
+    if (mFlushInterval > 0 && ++mCounter == mFlushInterval)
+      flush();
+  }
+
+  /**
+   * This method is invoked when a punctuation arrives. All partial states are
+   * flushed before the punctuation is forwarded, so that the final stage sees
+   * the complete partial results of this partition.
+   *
+   * @param[in] punctuation
+   *    the incoming punctuation tuple
+   */
+  void processPunctuation(const PunctuationPtr& punctuation) {
+    flush();
+    this->getOutputPunctuationChannel().publish(punctuation);
+  }
+
+  /**
+   * Publishes the partial states of all groups and clears the table.
+   */
+  void flush() {
+    mCounter = 0;
+    if (mPartials.empty())
+      return;
+    mPartials.forEach([this](const KeyType& key, AggregateStatePtr& state) {
+      auto tn = makeTuplePtr(key, state);
+      this->getOutputDataChannel().publish(tn, false);
+    });
+    mPartials.clear();
+  }
+
+  FlatHashTable<KeyType, AggregateStatePtr> mPartials; //< the partial states per group since the last flush
+  GroupByFunc mGroupByFunc;                            //< a pointer to the function determining the key value
+  IterateFunc mIterateFunc;                            //< a pointer to the iteration function called for each tuple
+  unsigned int mFlushInterval;                         //< the number of tuples after which the partial states are published
+  unsigned int mCounter;                               //< the number of tuples processed since the last flush
+};
+
+} /* end namespace pfabric */
+
+#endif
@@ -43,7 +43,7 @@ namespace pfabric {
  *   the data stream element type consumed by PartitionBy
  */
 template<typename StreamElement>
-class PartitionBy : public UnaryTransform<StreamElement, StreamElement> {
+class PartitionBy : public UnaryTransform<StreamElement, StreamElement>, public BufferedOperator {
 public:
 	PFABRIC_UNARY_TRANSFORM_TYPEDEFS(StreamElement, StreamElement);
 
@@ -62,9 +62,14 @@ public:
 	 *
 	 * @param pFun the function for deriving the partition id
 	 * @param numPartitions the number of partitions
+	 * @param executor optional executor processing the partitions (instead of
+	 *        a separate thread per partition)
+	 * @param queueCapacity the capacity of the queue of each partition (0 = unbounded).
+	 *        If the queue of a partition is full, the producer is blocked.
 	 */
-	PartitionBy(PartitionFunc pFun, unsigned int numPartitions) :
-			mFunc(pFun), mNumPartitions(numPartitions) {
+	PartitionBy(PartitionFunc pFun, unsigned int numPartitions, ExecutorPtr executor = nullptr,
+	            std::size_t queueCapacity = 0) :
+			mFunc(pFun), mNumPartitions(numPartitions), mExecutor(executor), mQueueCapacity(queueCapacity) {
 	}
 
 	/**
@@ -79,6 +84,23 @@ public:
 
 	const std::string opName() const override { return std::string("PartitionBy"); }
 
+	/**
+	 * Returns the maximal number of elements buffered in the queue of the given partition.
+	 *
+	 * @param id the partition id
+	 */
+	std::size_t highWaterMark(PartitionID id) const {
+		auto it = mPartitions.find(id);
+		return it != mPartitions.end() ? it->second->highWaterMark() : 0;
+	}
+
+	void collectQueueStatistics(std::vector<QueueStatistics>& stats) const override {
+		for (auto& p : mPartitions) {
+			stats.push_back({ opName() + "[" + std::to_string(p.first) + "]",
+				p.second->capacity(), p.second->size(), p.second->highWaterMark() });
+		}
+	}
+
 	/**
 	 * This method is invoked when a punctuation arrives. It simply forwards the punctuation
 	 * to all partitions.
@@ -127,8 +149,8 @@ public:
 				PunctuationChannel& punctuationChannel) {
 		BOOST_ASSERT_MSG(id >= 0 && id < mNumPartitions, "invalid partition id");
 		// we decouple the channels by introducing a Queue operator which
-		// runs the consumer side within a separate thread
-		auto queue = std::make_shared<Queue<StreamElement> >();
+		// runs the consumer side within a separate thread (or a task of the executor)
+		auto queue = std::make_shared<Queue<StreamElement> >(mExecutor, mQueueCapacity);
 
 		// and connect the Queue to the given channels
 		connectChannels(queue->getOutputDataChannel(), dataChannel);
@@ -149,6 +171,8 @@ protected:
 	PartitionTable mPartitions;  //< a hashtable for mapping parition ids to Queue
 	PartitionFunc mFunc;         //< pointer to the function producing the partition id
 	unsigned int mNumPartitions; //< number of partitions
+	ExecutorPtr mExecutor;       //< the executor for running the partitions (if any)
+	std::size_t mQueueCapacity;  //< the capacity of the queue per partition (0 = unbounded)
 };
 
 }
@@ -28,11 +28,16 @@
 #include "core/Tuple.hpp"
 #include "qop/UnaryTransform.hpp"
 #include "qop/OperatorMacros.hpp"
+#include "qop/Executor.hpp"
 
 #include <queue>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
 
 namespace pfabric {
 
@@ -43,7 +48,7 @@ namespace pfabric {
   template <typename T>
   class ConcurrentQueue {
   public:
-    ConcurrentQueue() : stopped_(false) {}
+    ConcurrentQueue() : stopped_(false), highWater_(0) {}
     ConcurrentQueue(const ConcurrentQueue&) = delete;            // disable copying
     ConcurrentQueue& operator=(const ConcurrentQueue&) = delete; // disable assignment
 
@@ -71,9 +76,33 @@ namespace pfabric {
       return true;
     }
 
+    bool tryPop(T& item) {
+      std::unique_lock<std::mutex> mlock(mutex_);
+      if (queue_.empty()) {
+        return false;
+      }
+      item = queue_.front();
+      queue_.pop();
+      return true;
+    }
+
+    bool empty() const {
+      std::unique_lock<std::mutex> mlock(mutex_);
+      return queue_.empty();
+    }
+
+    std::size_t size() const {
+      std::unique_lock<std::mutex> mlock(mutex_);
+      return queue_.size();
+    }
+
+    std::size_t highWaterMark() const { return highWater_; }
+
     void push(const T& item) {
       std::unique_lock<std::mutex> mlock(mutex_);
       queue_.push(item);
+      if (queue_.size() > highWater_)
+        highWater_ = queue_.size();
       mlock.unlock();
       cond_.notify_one();
     }
@@ -85,9 +114,301 @@ namespace pfabric {
 
   private:
     std::queue<T> queue_;
-    std::mutex mutex_;
+    mutable std::mutex mutex_;
     std::condition_variable cond_;
     std::atomic<bool> stopped_;
+    std::atomic<std::size_t> highWater_;
+  };
+
+  /**
+   * @brief A lock-free bounded ring buffer for exchanging tuples between threads.
+   *
+   * RingBufferQueue is a fixed-capacity queue based on an array of cells each
+   * carrying a sequence number. Producers claim a cell with a single CAS on the
+   * tail index, which makes the queue safe for one or many producers (SPSC and
+   * MPSC) while the single consumer never needs an atomic read-modify-write.
+   * The consumer drains elements in batches and waits adaptively: it first spins,
+   * then yields and finally parks on a condition variable. Producers only touch
+   * the mutex if the consumer is actually parked.
+   *
+   * The free cells act as credits for the producers: if no credits are left
+   * (the queue is full) a producer spins, yields and finally blocks until the
+   * consumer returns credits by draining a batch. This propagates backpressure
+   * to the upstream operators and sources which publish synchronously.
+   * Producers which must not block (e.g. tasks running on a worker of an
+   * executor) use @c pushOrDefer instead: if the queue is full, the element is
+   * kept in an overflow list which the consumer moves into the ring as soon as
+   * cells are free.
+   *
+   * @tparam T
+   *    the type of the elements stored in the queue
+   */
+  template <typename T>
+  class RingBufferQueue {
+  public:
+    /**
+     * Creates a new ring buffer. The capacity is rounded up to the next power of two.
+     *
+     * @param capacity the minimal number of elements the queue can hold
+     */
+    RingBufferQueue(std::size_t capacity) :
+      mCapacity(roundUpToPowerOfTwo(capacity)), mMask(mCapacity - 1),
+      mCells(new Cell[mCapacity]), mHead(0), mTail(0), mParked(false), mWaitingProducers(0),
+      mHighWater(0), mStopped(false), mNumDeferred(0) {
+      for (std::size_t i = 0; i < mCapacity; i++)
+        mCells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    RingBufferQueue(const RingBufferQueue&) = delete;            // disable copying
+    RingBufferQueue& operator=(const RingBufferQueue&) = delete; // disable assignment
+
+    /**
+     * Tries to insert an element without blocking.
+     *
+     * @param item the element to be inserted
+     * @return false if the queue is full
+     */
+    bool tryPush(const T& item) {
+      Cell* cell;
+      std::size_t pos = mTail.load(std::memory_order_relaxed);
+      for (;;) {
+        cell = &mCells[pos & mMask];
+        auto seq = cell->seq.load(std::memory_order_acquire);
+        auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+        if (diff == 0) {
+          if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+        }
+        else if (diff < 0)
+          return false;
+        else
+          pos = mTail.load(std::memory_order_relaxed);
+      }
+      cell->data = item;
+      cell->seq.store(pos + 1, std::memory_order_release);
+      updateHighWaterMark(pos + 1);
+      wakeupConsumer();
+      return true;
+    }
+
+    /**
+     * Inserts an element. If the queue is full the producer spins, yields and
+     * finally blocks until the consumer has freed a cell or the queue was stopped.
+     *
+     * @param item the element to be inserted
+     */
+    void push(const T& item) {
+      unsigned int spins = 0;
+      while (!tryPush(item)) {
+        if (mStopped)
+          return;
+        if (++spins < SpinLimit)
+          cpuRelax();
+        else if (spins < SpinLimit + YieldLimit)
+          std::this_thread::yield();
+        else
+          waitForCredits();
+      }
+    }
+
+    /**
+     * Inserts an element without ever blocking the producer. If the queue is full
+     * (or older deferred elements are still waiting) the element is appended to an
+     * unbounded overflow list, thus the capacity may be exceeded temporarily.
+     * The deferred elements are moved into the ring by the consumer.
+     *
+     * @param item the element to be inserted
+     */
+    void pushOrDefer(const T& item) {
+      if (mNumDeferred.load(std::memory_order_seq_cst) == 0 && tryPush(item))
+        return;
+      std::lock_guard<std::mutex> lock(mDeferredMtx);
+      if (mDeferred.empty() && tryPush(item))
+        return;
+      mDeferred.push_back(item);
+      mNumDeferred.store(mDeferred.size(), std::memory_order_seq_cst);
+      wakeupConsumer();
+    }
+
+    /**
+     * Removes up to @c maxBatch elements from the queue and passes them to the
+     * given function. The cells are released before the function is invoked, so
+     * producers can continue while the batch is processed. Must only be called
+     * by the single consumer thread.
+     *
+     * @param func the function invoked for each element
+     * @param maxBatch the maximal number of elements to be processed
+     * @return the number of processed elements
+     */
+    template <typename Func>
+    std::size_t consume(Func&& func, std::size_t maxBatch) {
+      if (mNumDeferred.load(std::memory_order_seq_cst) > 0)
+        moveDeferred();
+      std::size_t n = 0;
+      auto pos = mHead.load(std::memory_order_relaxed);
+      while (n < maxBatch) {
+        auto& cell = mCells[pos & mMask];
+        if (cell.seq.load(std::memory_order_acquire) != pos + 1)
+          break;
+        T item = std::move(cell.data);
+        cell.data = T();
+        cell.seq.store(pos + mCapacity, std::memory_order_release);
+        mHead.store(++pos, std::memory_order_relaxed);
+        func(item);
+        n++;
+      }
+      if (n > 0)
+        returnCredits();
+      return n;
+    }
+
+    /**
+     * Blocks the consumer until at least one element is available or the queue
+     * is stopped.
+     *
+     * @return false if the queue was stopped
+     */
+    bool waitForData() {
+      for (unsigned int i = 0; i < SpinLimit; i++) {
+        if (mStopped) return false;
+        if (!empty()) return true;
+        cpuRelax();
+      }
+      for (unsigned int i = 0; i < YieldLimit; i++) {
+        if (mStopped) return false;
+        if (!empty()) return true;
+        std::this_thread::yield();
+      }
+      std::unique_lock<std::mutex> lock(mMtx);
+      mParked.store(true, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      mCond.wait(lock, [this]() { return mStopped || !empty(); });
+      mParked.store(false, std::memory_order_relaxed);
+      return !mStopped;
+    }
+
+    /**
+     * Checks whether the queue contains no elements (as seen by the consumer),
+     * including the deferred ones.
+     */
+    bool empty() const {
+      auto pos = mHead.load(std::memory_order_relaxed);
+      return mCells[pos & mMask].seq.load(std::memory_order_acquire) != pos + 1 &&
+        mNumDeferred.load(std::memory_order_seq_cst) == 0;
+    }
+
+    /**
+     * Returns the (approximate) number of elements in the queue, including the
+     * deferred ones.
+     */
+    std::size_t size() const {
+      return mTail.load(std::memory_order_relaxed) - mHead.load(std::memory_order_relaxed) +
+        mNumDeferred.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the capacity of the queue.
+     */
+    std::size_t capacity() const { return mCapacity; }
+
+    /**
+     * Returns the maximal number of elements which were stored in the queue
+     * at the same time.
+     */
+    std::size_t highWaterMark() const { return mHighWater.load(std::memory_order_relaxed); }
+
+    /**
+     * Stops the queue and wakes up all waiting threads.
+     */
+    void stop() {
+      {
+        std::lock_guard<std::mutex> lock(mMtx);
+        mStopped = true;
+      }
+      mCond.notify_all();
+      mNotFull.notify_all();
+    }
+
+  private:
+    static constexpr unsigned int SpinLimit = 128;
+    static constexpr unsigned int YieldLimit = 64;
+
+    struct Cell {
+      std::atomic<std::size_t> seq;
+      T data;
+    };
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t n) {
+      std::size_t c = 2;
+      while (c < n) c <<= 1;
+      return c;
+    }
+
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+    }
+
+    bool full() const {
+      auto pos = mTail.load(std::memory_order_relaxed);
+      auto seq = mCells[pos & mMask].seq.load(std::memory_order_acquire);
+      return static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos) < 0;
+    }
+
+    void waitForCredits() {
+      std::unique_lock<std::mutex> lock(mMtx);
+      mWaitingProducers.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      mNotFull.wait(lock, [this]() { return mStopped || !full(); });
+      mWaitingProducers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void returnCredits() {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (mWaitingProducers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mMtx);
+        mNotFull.notify_all();
+      }
+    }
+
+    void moveDeferred() {
+      std::lock_guard<std::mutex> lock(mDeferredMtx);
+      while (!mDeferred.empty() && tryPush(mDeferred.front()))
+        mDeferred.pop_front();
+      mNumDeferred.store(mDeferred.size(), std::memory_order_seq_cst);
+    }
+
+    void updateHighWaterMark(std::size_t tail) {
+      auto sz = std::min(tail - mHead.load(std::memory_order_relaxed), mCapacity);
+      auto hw = mHighWater.load(std::memory_order_relaxed);
+      while (sz > hw && !mHighWater.compare_exchange_weak(hw, sz, std::memory_order_relaxed))
+        ;
+    }
+
+    void wakeupConsumer() {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (mParked.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mMtx);
+        mCond.notify_one();
+      }
+    }
+
+    const std::size_t mCapacity;                   //< the number of cells (a power of two)
+    const std::size_t mMask;                       //< mask for mapping positions to cells
+    std::unique_ptr<Cell[]> mCells;                //< the ring of cells
+    alignas(64) std::atomic<std::size_t> mHead;    //< the next position to be read by the consumer
+    alignas(64) std::atomic<std::size_t> mTail;    //< the next position to be claimed by a producer
+    alignas(64) std::atomic<bool> mParked;         //< true if the consumer waits on the condition variable
+    std::atomic<unsigned int> mWaitingProducers;   //< the number of producers waiting for credits
+    std::atomic<std::size_t> mHighWater;           //< the maximal number of elements in the queue
+    std::atomic<bool> mStopped;                    //< true if the queue was stopped
+    std::mutex mMtx;                               //< mutex for parking the consumer and the producers
+    std::condition_variable mCond;                 //< condition variable for parking the consumer
+    std::condition_variable mNotFull;              //< condition variable for producers waiting for credits
+    std::atomic<std::size_t> mNumDeferred;         //< the number of elements in the overflow list
+    std::mutex mDeferredMtx;                       //< mutex protecting the overflow list
+    std::deque<T> mDeferred;                       //< elements deferred by pushOrDefer while the queue was full
   };
 
 
@@ -157,32 +478,94 @@ namespace pfabric {
     StopSignal mStopCallback;              //< the callback which is invoked to stop the processing the queue
 	};
 
+  /**
+   * @brief Statistics about the buffer of a queue.
+   */
+  struct QueueStatistics {
+    std::string name;           //< the name of the operator owning the queue
+    std::size_t capacity;       //< the capacity of the queue (0 = unbounded)
+    std::size_t size;           //< the current number of buffered elements
+    std::size_t highWaterMark;  //< the maximal number of buffered elements so far
+  };
+
+  /**
+   * @brief Interface for operators buffering tuples in one or more queues.
+   *
+   * It allows to collect the statistics of all queues in a topology, e.g. for
+   * sizing the buffers.
+   */
+  class BufferedOperator {
+  public:
+    virtual ~BufferedOperator() {}
+
+    /**
+     * Appends the statistics of all queues of the operator to the given list.
+     *
+     * @param stats the list of statistics
+     */
+    virtual void collectQueueStatistics(std::vector<QueueStatistics>& stats) const = 0;
+  };
+
 	/**
 	 * @brief an operator for decouping tuple producer and consumer.
 	 *
 	 * The Queue operator is used for decoupling tuple producer and consumer by inserting a tuple queue
 	 * between two operators and creating a separate consumer thread that waits for incoming tuples and forwards
-	 * them to the subscriber.
+	 * them to the subscriber. By default, an unbounded mutex-based queue is used. If a capacity is given,
+	 * the tuples are exchanged via a lock-free bounded ring buffer which is drained in batches.
+	 * If an executor is given, no separate thread is created, instead the queue is drained by a task
+	 * running on the worker threads of the executor. A bounded queue applies backpressure: if it
+	 * is full, the publishing thread is blocked until the consumer has forwarded a batch of tuples.
+	 * Only a publisher running on a worker of the executor is never blocked (the worker might be
+	 * needed to drain the queue): it defers the tuple to an overflow list of the queue instead.
 	 *
 	 * @tparam StreamElement
    *    the data stream element type which is processed
 	 */
 	template<class StreamElement>
-	class Queue : public UnaryTransform<StreamElement, StreamElement> { // use default unary transform
+	class Queue : public UnaryTransform<StreamElement, StreamElement>, // use default unary transform
+	              public BufferedOperator {
 	public:
 	  PFABRIC_UNARY_TRANSFORM_TYPEDEFS(StreamElement, StreamElement)
 
 		/**
 		 * Creates a new instance of the operator.
+		 *
+		 * @param capacity the capacity of the lock-free ring buffer, 0 for an unbounded
+		 *        mutex-based queue
+		 * @param batchSize the maximal number of tuples forwarded in one batch by the
+		 *        consumer thread (only used for the ring buffer)
 		 */
-		Queue() : mNotifier(new DequeueNotifier(std::bind(&Queue::dequeueTuple, this, std::placeholders::_1),
-                                            std::bind(&Queue::stopProcessing, this))) {
+		Queue(std::size_t capacity = 0, std::size_t batchSize = 64) :
+      Queue(nullptr, capacity, batchSize) {
 		}
 
 		/**
-		 * Frees all allocated resources, i.e. deletes the notifier thread.
+		 * Creates a new instance of the operator which is processed by the given executor.
+		 *
+		 * @param executor the executor running the task for draining the queue, if
+		 *        nullptr a separate thread is used
+		 * @param capacity the capacity of the lock-free ring buffer, 0 for an unbounded
+		 *        mutex-based queue
+		 * @param batchSize the maximal number of tuples forwarded in one batch
 		 */
-		~Queue() {}
+		Queue(ExecutorPtr executor, std::size_t capacity = 0, std::size_t batchSize = 64) :
+      mRing(capacity > 0 ? new RingBufferQueue<QueueElement>(capacity) : nullptr),
+      mBatchSize(batchSize), mExecutor(executor),
+      mTask(executor ? executor->registerTask(std::bind(&Queue::drainBatch, this)) : nullptr),
+      mNotifier(executor ? nullptr :
+                new DequeueNotifier(std::bind(&Queue::dequeueTuple, this, std::placeholders::_1),
+                                    std::bind(&Queue::stopProcessing, this))) {
+		}
+
+		/**
+		 * Frees all allocated resources, i.e. deletes the notifier thread
+		 * or removes the task from the executor.
+		 */
+		~Queue() {
+      if (mTask)
+        mExecutor->unregisterTask(mTask);
+    }
 
 		/**
 		 * @brief Bind the callback for the data channel.
@@ -202,25 +585,26 @@ namespace pfabric {
 		 */
 		void processPunctuation( const PunctuationPtr& punctuation ) {
      if (punctuation != nullptr)
-        mQueue.push(std::make_tuple(punctuation->ptype(), nullptr, false));
+        enqueue(std::make_tuple(punctuation, StreamElement(), false));
 		}
 
 		/**
-		 * Implements the callback invoked by the notifier thread. It reads the next tuple from the queue and
-		 * sends it to the publishers.
+		 * Implements the callback invoked by the notifier thread. It reads the next tuple(s) from the queue and
+		 * sends them to the publishers.
 		 *
 		 * @param sender a reference to the notifier object
 		 */
 		void dequeueTuple(DequeueNotifier& sender) {
-      std::tuple<Punctuation::PType, StreamElement, bool> tp;
+      if (mRing) {
+        if (!mRing->waitForData())
+          return;
+        mRing->consume([this](QueueElement& tp) { forward(tp); }, mBatchSize);
+        return;
+      }
+      QueueElement tp;
       if (!mQueue.pop(tp))
         return;
-
-    //  std::cout << "(1) thread: " << std::this_thread::get_id() << std::endl;
-      if (std::get<0>(tp) == Punctuation::None)
-			  this->getOutputDataChannel().publish(std::get<1>(tp), std::get<2>(tp));
-      else
-        this->getOutputPunctuationChannel().publish(std::make_shared<Punctuation>(std::get<0>(tp)));
+      forward(tp);
 		}
 
 	/**
@@ -231,15 +615,84 @@ namespace pfabric {
 	 * @param outdated indicates whether the tuple is new or invalidated now (outdated == true)
 	 */
 	void processDataElement( const StreamElement& data, const bool outdated ) {
-    mQueue.push(std::make_tuple(Punctuation::None, data, outdated));
+    enqueue(std::make_tuple(PunctuationPtr(), data, outdated));
 	}
 
+  /**
+   * Returns the capacity of the queue, 0 if the queue is unbounded.
+   */
+  std::size_t capacity() const { return mRing ? mRing->capacity() : 0; }
+
+  /**
+   * Returns the current number of tuples and punctuations in the queue.
+   */
+  std::size_t size() const { return mRing ? mRing->size() : mQueue.size(); }
+
+  /**
+   * Returns the maximal number of tuples and punctuations which were
+   * stored in the queue at the same time.
+   */
+  std::size_t highWaterMark() const { return mRing ? mRing->highWaterMark() : mQueue.highWaterMark(); }
+
+  void collectQueueStatistics(std::vector<QueueStatistics>& stats) const override {
+    stats.push_back({ opName(), capacity(), size(), highWaterMark() });
+  }
+
+  const std::string opName() const override { return std::string("Queue"); }
+
 private:
-    void stopProcessing() { mQueue.stop(); }
+    /// a queue entry: either a punctuation or a tuple with its outdated flag
+    typedef std::tuple<PunctuationPtr, StreamElement, bool> QueueElement;
+
+    void enqueue(const QueueElement& tp) {
+      if (mRing) {
+        if (mExecutor && mExecutor->isWorkerThread())
+          // neither block the worker nor run other tasks nested in this
+          // call while the ring is full
+          mRing->pushOrDefer(tp);
+        else
+          mRing->push(tp);
+      }
+      else
+        mQueue.push(tp);
+      if (mTask)
+        mExecutor->schedule(mTask);
+    }
+
+    /**
+     * The task executed by the executor: forwards up to mBatchSize tuples
+     * and returns true if the queue is still not empty.
+     */
+    bool drainBatch() {
+      if (mRing) {
+        mRing->consume([this](QueueElement& tp) { forward(tp); }, mBatchSize);
+        return !mRing->empty();
+      }
+      QueueElement tp;
+      for (std::size_t i = 0; i < mBatchSize && mQueue.tryPop(tp); i++)
+        forward(tp);
+      return !mQueue.empty();
+    }
+
+    void forward(const QueueElement& tp) {
+      if (std::get<0>(tp) == nullptr)
+			  this->getOutputDataChannel().publish(std::get<1>(tp), std::get<2>(tp));
+      else
+        this->getOutputPunctuationChannel().publish(std::get<0>(tp));
+    }
+
+    void stopProcessing() {
+      if (mRing)
+        mRing->stop();
+      else
+        mQueue.stop();
+    }
 
-    ConcurrentQueue<std::tuple<Punctuation::PType, StreamElement, bool> > mQueue;
-//		boost::lockfree::spsc_queue<StreamElement,
-//		     boost::lockfree::capacity<65535> > mQueue; //< a queue acting as concurrent buffer for tuples
+    ConcurrentQueue<QueueElement> mQueue;                   //< the unbounded queue (if no capacity is given)
+    std::unique_ptr<RingBufferQueue<QueueElement>> mRing;   //< the lock-free ring buffer (if a capacity is given)
+    std::size_t mBatchSize;                                 //< max. number of tuples forwarded per dequeue call
+    ExecutorPtr mExecutor;                                  //< the executor draining the queue (if any)
+    Executor::TaskPtr mTask;                                //< the task registered at the executor
 		std::unique_ptr<DequeueNotifier> mNotifier;     //< the notifier object which triggers the dequeing
 		};
 }
@@ -18,9 +18,13 @@
 #ifndef ScaleJoin_hpp_
 #define ScaleJoin_hpp_
 
+#include <atomic>
+#include <memory>
 #include <unordered_map>
 
 #include "qop/BinaryTransform.hpp"
+#include "qop/BroadcastRing.hpp"
+#include "qop/Queue.hpp"
 #include "ElementJoinTraits.hpp"
 #include "DefaultElementJoin.hpp"
 
@@ -34,6 +38,15 @@ namespace pfabric {
    * tuples from both streams, but stores only the tuples belonging to it's ID. Therefore each incoming tuple is
    * only stored once in one of the ScaleJoin instances, reducing the overall memory usage.
    *
+   * For parallel processing the instances share a single BroadcastRing: the input channels of
+   * any instance append the tuples of both streams (and punctuations) to the ring exactly once,
+   * thus upstream operators need to be connected to only one of the instances. Each instance reads
+   * the ring with its own cursor in a separate thread (or as a task of an executor), so all instances
+   * see the same interleaving of left and right tuples and process both streams in parallel. The
+   * results of the instances are published by their threads, i.e. the instances should be connected
+   * to a Queue combining the result streams. A punctuation is forwarded by the instance which
+   * processed it last. Without a ring, the tuples are processed directly by the publishing thread.
+   *
    * @tparam LeftInputStreamElement
    *    the data stream element type from the left source
    * @tparam RightInputStreamElement
@@ -74,6 +87,22 @@ namespace pfabric {
       //the join result for two input elements
       typedef typename ElementJoin::ResultElement ResultElement;
 
+      /**
+       * @brief An entry of the ring shared by all ScaleJoin instances.
+       */
+      struct InputElement {
+        LeftInputStreamElement mLeft;                //< the tuple from the left stream (if mIsLeft)
+        RightInputStreamElement mRight;              //< the tuple from the right stream (if not mIsLeft)
+        PunctuationPtr mPunctuation;                 //< a punctuation (no tuple is stored if not null)
+        std::shared_ptr<std::atomic<int>> mPending;  //< the number of instances which have not yet seen the punctuation
+        bool mIsLeft;                                //< true if the tuple comes from the left stream
+        bool mOutdated;                              //< flag indicating whether the tuple is new or invalidated now
+      };
+
+      //typedef for the ring shared by all ScaleJoin instances
+      typedef BroadcastRing<InputElement> InputRing;
+      typedef std::shared_ptr<InputRing> InputRingPtr;
+
       /**
        * Constructs a new ScaleJoin operator subscribing to two source operators producing the
        * left and right hand-side input data streams.
@@ -85,11 +114,54 @@ namespace pfabric {
        * \param numThreads amount of ScaleJoin instances (threads)
        */
       ScaleJoin(LKeyExtractorFunc lKeyFunc, RKeyExtractorFunc rKeyFunc, JoinPredicateFunc joinPred, const int id, const int numThreads) :
-      mJoinPredicate(joinPred), mLKeyExtractor(lKeyFunc), mRKeyExtractor(rKeyFunc), mID(id), mThreadnum(numThreads) {
+      mJoinPredicate(joinPred), mLKeyExtractor(lKeyFunc), mRKeyExtractor(rKeyFunc), mID(id), mThreadnum(numThreads),
+      mBatchSize(0) {
         //initialize counters to zero
         mLCntr = mRCntr = mLOCntr = mROCntr = 0;
       }
 
+      /**
+       * Constructs a new ScaleJoin instance reading the given ring shared by all instances.
+       * The ring has to provide one reader for each instance.
+       *
+       * \param lKeyFunc function for extracting the key of tuples of the lhs stream
+       * \param rKeyFunc function for extracting the key of tuples of the rhs stream
+       * \param joinPred function pointer to a join predicate
+       * \param id unique id for the thread, used for deciding which tuples to store and as reader of the ring
+       * \param numThreads amount of ScaleJoin instances (threads)
+       * \param ring the ring shared by all instances
+       * \param executor the executor running the instance as a task, if nullptr a separate thread is used
+       * \param batchSize the maximal number of ring entries processed in one batch
+       */
+      ScaleJoin(LKeyExtractorFunc lKeyFunc, RKeyExtractorFunc rKeyFunc, JoinPredicateFunc joinPred, const int id, const int numThreads,
+                InputRingPtr ring, ExecutorPtr executor = nullptr, std::size_t batchSize = 64) :
+      mJoinPredicate(joinPred), mLKeyExtractor(lKeyFunc), mRKeyExtractor(rKeyFunc), mID(id), mThreadnum(numThreads),
+      mRing(ring), mBatchSize(batchSize), mExecutor(executor) {
+        mLCntr = mRCntr = mLOCntr = mROCntr = 0;
+        if (mExecutor) {
+          mTask = mExecutor->registerTask(std::bind(&ScaleJoin::drainBatch, this));
+          auto exec = mExecutor;
+          auto task = mTask;
+          mRing->setWakeupHandler(mID, [exec, task]() { exec->schedule(task); });
+        }
+        else
+          mNotifier.reset(new DequeueNotifier(std::bind(&ScaleJoin::dequeueElements, this, std::placeholders::_1),
+                                              [this]() { mRing->stop(); }));
+      }
+
+      /**
+       * Stops the thread or removes the task from the executor.
+       */
+      ~ScaleJoin() {
+        if (mTask)
+          mExecutor->unregisterTask(mTask);
+      }
+
+      /**
+       * Returns the ring shared by the instances (nullptr if the tuples are processed directly).
+       */
+      InputRingPtr inputRing() const { return mRing; }
+
       //bind the callback for the left handside data channel
       BIND_INPUT_CHANNEL_DEFAULT(LeftInputChannel, ScaleJoin, processLeftDataElement);
 
@@ -104,6 +176,110 @@ namespace pfabric {
       /**
        * @brief This method is invoked when a data stream element arrives from the left input channel.
        *
+       * If the instances share a ring, the element is appended to the ring, otherwise it is joined directly.
+       *
+       * @param[in] left
+       *    the incoming stream element from the left input channel
+       * @param[in] outdated
+       *    flag indicating whether the tuple is new or invalidated now
+       */
+      void processLeftDataElement(const LeftInputStreamElement& left, const bool outdated) {
+        if (mRing)
+          enqueue({ left, RightInputStreamElement(), PunctuationPtr(), nullptr, true, outdated });
+        else
+          joinLeftDataElement(left, outdated);
+      }
+
+      /**
+       * @brief This method is invoked when a data stream element arrives from the right input channel.
+       *
+       * If the instances share a ring, the element is appended to the ring, otherwise it is joined directly.
+       *
+       * @param[in] right
+       *    the incoming stream element from the right input channel
+       * @param[in] outdated
+       *    flag indicating whether the tuple is new or invalidated now
+       */
+      void processRightDataElement(const RightInputStreamElement& right, const bool outdated) {
+        if (mRing)
+          enqueue({ LeftInputStreamElement(), right, PunctuationPtr(), nullptr, false, outdated });
+        else
+          joinRightDataElement(right, outdated);
+      }
+
+      /**
+       * @brief This method is invoked when a punctuation arrives.
+       *
+       * It is forwarded to the subscribers after all instances have processed the preceding tuples.
+       *
+       * @param[in] punctuation
+       *    the incoming punctuation tuple
+       */
+      void processPunctuation(const PunctuationPtr& punctuation) {
+        if (mRing)
+          enqueue({ LeftInputStreamElement(), RightInputStreamElement(), punctuation,
+                    std::make_shared<std::atomic<int>>(mThreadnum), false, false });
+        else
+          this->getOutputPunctuationChannel().publish(punctuation);
+      }
+
+      /**
+       * @brief Appends an input element to the ring shared by all instances.
+       *
+       * @param[in] element
+       *    the tuple or punctuation with its stream
+       */
+      void enqueue(const InputElement& element) {
+        if (mExecutor && mExecutor->isWorkerThread())
+          // neither block the worker nor run other tasks nested in this
+          // call while the ring is full
+          mRing->pushOrDefer(element);
+        else
+          mRing->push(element);
+      }
+
+      /**
+       * @brief Processes an element read from the ring.
+       *
+       * @param[in] element
+       *    the tuple or punctuation with its stream
+       */
+      void processInputElement(const InputElement& element) {
+        if (element.mPunctuation) {
+          //the last instance seeing the punctuation forwards it
+          if (element.mPending->fetch_sub(1) == 1)
+            this->getOutputPunctuationChannel().publish(element.mPunctuation);
+        }
+        else if (element.mIsLeft)
+          joinLeftDataElement(element.mLeft, element.mOutdated);
+        else
+          joinRightDataElement(element.mRight, element.mOutdated);
+      }
+
+      /**
+       * Implements the callback invoked by the notifier thread: waits for
+       * the next elements of the ring and processes them.
+       *
+       * @param sender a reference to the notifier object
+       */
+      void dequeueElements(DequeueNotifier& sender) {
+        if (!mRing->waitForData(mID))
+          return;
+        mRing->consume(mID, [this](const InputElement& e) { processInputElement(e); }, mBatchSize);
+      }
+
+      /**
+       * The task executed by the executor: processes up to mBatchSize elements
+       * of the ring and returns true if further elements are pending.
+       */
+      bool drainBatch() {
+        mRing->consume(mID, [this](const InputElement& e) { processInputElement(e); }, mBatchSize);
+        return !mRing->markIdle(mID);
+      }
+
+      /**
+       * @brief Joins a data stream element from the left input channel.
+       *
        * The element is inserted into the corresponding hash table if (according to the ID) this ScaleJoin
        * instance is responsible for storing the tuple. However, it always tries to join it with elements
        * from the other hash table.
@@ -113,7 +289,7 @@ namespace pfabric {
        * @param[in] outdated
        *    flag indicating whether the tuple is new or invalidated now
        */
-      void processLeftDataElement(const LeftInputStreamElement& left, const bool outdated) {
+      void joinLeftDataElement(const LeftInputStreamElement& left, const bool outdated) {
         //extract the key from the tuple
         auto keyval = mLKeyExtractor(left);
 
@@ -152,7 +328,7 @@ namespace pfabric {
       }
 
       /**
-       * @brief This method is invoked when a data stream element arrives from the right input channel.
+       * @brief Joins a data stream element from the right input channel.
        *
        * The element is inserted into the corresponding hash table if (according to the ID) this ScaleJoin
        * instance is responsible for storing the tuple. However, it always tries to join it with elements
@@ -163,7 +339,7 @@ namespace pfabric {
        * @param[in] outdated
        *    flag indicating whether the tuple is new or invalidated now
        */
-      void processRightDataElement(const RightInputStreamElement& right, const bool outdated) {
+      void joinRightDataElement(const RightInputStreamElement& right, const bool outdated) {
         //extract the key from the tuple
         auto keyval = mRKeyExtractor(right);
 
@@ -201,18 +377,6 @@ namespace pfabric {
         }
       }
 
-      /**
-       * @brief This method is invoked when a punctuation arrives.
-       *
-       * It simply forwards the punctuation to the subscribers.
-       *
-       * @param[in] punctuation
-       *    the incoming punctuation tuple
-       */
-      void processPunctuation(const PunctuationPtr& punctuation) {
-        this->getOutputPunctuationChannel().publish(punctuation);
-      }
-
       /**
        * @brief Update a hash table for a new input element.
        *
@@ -228,7 +392,7 @@ namespace pfabric {
        *    flag indicating whether the tuple is new or invalidated now
        */
       template<typename HashTable, typename StreamElement>
-      static void updateHashTable(HashTable& hashTable, const key_t& key,
+      static void updateHashTable(HashTable& hashTable, const KeyType& key,
                                   const StreamElement& newElement, const bool outdated) {
 
         //if not outdated, just insert it into the hash table
@@ -287,6 +451,11 @@ namespace pfabric {
       const int mID;                          //unique ID of this ScaleJoin instance
       const int mThreadnum;                   //number of all ScaleJoin instances
       short mLCntr, mRCntr, mLOCntr, mROCntr; //counters for left and right stream tuples (+outdated)
+      InputRingPtr mRing;                     //ring shared by all instances (nullptr = direct processing)
+      std::size_t mBatchSize;                 //max. number of ring entries processed per batch
+      ExecutorPtr mExecutor;                  //executor running this instance (if any)
+      Executor::TaskPtr mTask;                //task registered at the executor
+      std::unique_ptr<DequeueNotifier> mNotifier; //thread reading the ring (if no executor is given)
     };
 }
 
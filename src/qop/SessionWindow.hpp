@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SessionWindow_hpp_
+#define SessionWindow_hpp_
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include <boost/unordered/unordered_map.hpp>
+
+#include "core/Punctuation.hpp"
+#include "qop/UnaryTransform.hpp"
+#include "qop/OperatorMacros.hpp"
+
+namespace pfabric {
+
+  /**
+   * @brief SessionWindow implements a keyed session window operator.
+   *
+   * SessionWindow groups the tuples of each key (determined by a key extractor
+   * function) into sessions, i.e. periods of activity separated by a gap of
+   * inactivity of at least the given size. Each incoming tuple is forwarded to
+   * the subscribers. As soon as a session is closed, i.e. no tuple of the key
+   * arrived within the gap after the last tuple of the session, all tuples of
+   * this session are published as outdated.
+   *
+   * The clock for closing sessions is the largest timestamp seen so far or -
+   * if the window receives Watermark punctuations - the most recent watermark.
+   * A tuple arriving out of order is added to the open session it belongs to,
+   * and merges two sessions if it fills the gap between them.
+   *
+   * The open sessions are kept per key in a hash table. Instead of scanning all
+   * keys, the sessions to be closed are determined by a priority queue of timers
+   * ordered by the expiry time of the sessions. A timer of a session which was
+   * extended in the meantime is simply rescheduled.
+   *
+   * @tparam StreamElement
+   *    the data stream element type kept in the window
+   * @tparam KeyType
+   *    the data type of the keys for identifying sessions
+   */
+  template<typename StreamElement, typename KeyType = DefaultKeyType>
+  class SessionWindow : public UnaryTransform<StreamElement, StreamElement> {
+  private:
+    PFABRIC_UNARY_TRANSFORM_TYPEDEFS(StreamElement, StreamElement);
+
+  public:
+    /**
+     * Typedef for a function extracting the key from a tuple.
+     */
+    typedef std::function<KeyType(const StreamElement&)> KeyExtractorFunc;
+
+    /**
+     * Typedef for a function extracting the timestamp from a tuple.
+     */
+    typedef std::function<Timestamp(const StreamElement&)> TimestampExtractorFunc;
+
+    /**
+     * @brief Create a new session window operator instance.
+     *
+     * @param[in] key_func
+     *    a function for extracting the key which identifies the sessions
+     * @param[in] ts_func
+     *    a function for extracting the timestamp of a tuple
+     * @param[in] gap
+     *    the minimal gap of inactivity between two sessions (in seconds)
+     */
+    SessionWindow(KeyExtractorFunc key_func, TimestampExtractorFunc ts_func, const unsigned int gap) :
+      mKeyExtractor(key_func), mTimestampExtractor(ts_func), mGap(Timestamp(gap * 1000 * 1000)),
+      mClock(0), mUseWatermarks(false), mNextSessionID(0), mNumSessions(0) {}
+
+    /**
+     * @brief Bind the callback for the data channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT(InputDataChannel, SessionWindow, processDataElement);
+
+    /**
+     * @brief Bind the callback for the punctuation channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT(InputPunctuationChannel, SessionWindow, processPunctuation);
+
+    const std::string opName() const override { return std::string("SessionWindow"); }
+
+    /**
+     * Returns the number of sessions which are still open.
+     *
+     * @return the number of open sessions
+     */
+    std::size_t numSessions() const { return mNumSessions; }
+
+  private:
+    /**
+     * A session, i.e. the tuples of a key between two gaps of inactivity.
+     */
+    struct Session {
+      unsigned long mID;                     //< the unique id of the session
+      Timestamp mStart;                      //< the smallest timestamp of the session
+      Timestamp mEnd;                        //< the largest timestamp of the session
+      std::vector<StreamElement> mTuples;    //< the tuples of the session
+    };
+
+    /**
+     * A timer for checking whether the session with the given id is closed.
+     */
+    struct Timer {
+      Timestamp mExpires;   //< the time when the session closes if it is not extended
+      KeyType mKey;         //< the key of the session
+      unsigned long mID;    //< the id of the session
+
+      bool operator>(const Timer& other) const { return mExpires > other.mExpires; }
+    };
+
+    typedef std::vector<Session> SessionList;
+    typedef boost::unordered_map<KeyType, SessionList> SessionTable;
+    typedef std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> TimerQueue;
+
+    /**
+     * @brief This method is invoked when a punctuation arrives.
+     *
+     * A watermark advances the clock and closes all expired sessions, the
+     * end of the stream closes all sessions. Both punctuations are forwarded,
+     * all other punctuations are ignored because a window generates its own
+     * punctuations.
+     *
+     * @param[in] punctuation
+     *    the incoming punctuation tuple
+     */
+    void processPunctuation(const PunctuationPtr& punctuation) {
+      if (punctuation->ptype() == Punctuation::Watermark) {
+        std::lock_guard<std::mutex> guard(mMtx);
+        mUseWatermarks = true;
+        advanceClock(punctuation->getTimestamp());
+      }
+      else if (punctuation->ptype() == Punctuation::EndOfStream) {
+        std::lock_guard<std::mutex> guard(mMtx);
+        advanceClock(Timestamp::max());
+      }
+      else
+        return;
+      this->getOutputPunctuationChannel().publish(punctuation);
+    }
+
+    /**
+     * @brief This method is invoked when a tuple arrives from the publisher.
+     *
+     * The tuple is added to the session of its key and forwarded. Outdated
+     * tuples are ignored.
+     *
+     * @param[in] data
+     *    the incoming stream element
+     * @param[in] outdated
+     *    flag indicating whether the tuple is new or invalidated now
+     */
+    void processDataElement(const StreamElement& data, const bool outdated) {
+      if (outdated)
+        return;
+
+      std::lock_guard<std::mutex> guard(mMtx);
+      const auto ts = mTimestampExtractor(data);
+      insertTuple(mKeyExtractor(data), ts, data);
+      this->getOutputDataChannel().publish(data, false);
+
+      if (!mUseWatermarks)
+        // a late tuple may have created a session which is already expired
+        advanceClock(std::max(mClock, ts));
+    }
+
+    /**
+     * Adds the tuple to the open session of the given key which is not farther
+     * away than the gap. All sessions bridged by the tuple are merged. If no
+     * such session exists, a new session is created.
+     */
+    void insertTuple(const KeyType& key, const Timestamp& ts, const StreamElement& data) {
+      auto& sessions = mSessionTable[key];
+      Session *target = nullptr;
+
+      for (auto it = sessions.begin(); it != sessions.end(); ) {
+        if (it->mStart < ts + mGap && ts < it->mEnd + mGap) {
+          if (target == nullptr) {
+            target = &(*it);
+            ++it;
+          } else {
+            // the tuple bridges the gap between two sessions: merge them
+            target->mStart = std::min(target->mStart, it->mStart);
+            target->mEnd = std::max(target->mEnd, it->mEnd);
+            target->mTuples.insert(target->mTuples.end(), it->mTuples.begin(), it->mTuples.end());
+            it = sessions.erase(it);
+            mNumSessions--;
+          }
+        }
+        else
+          ++it;
+      }
+
+      if (target == nullptr) {
+        sessions.push_back(Session{ mNextSessionID++, ts, ts, { data } });
+        mTimers.push(Timer{ ts + mGap, key, sessions.back().mID });
+        mNumSessions++;
+      } else {
+        target->mStart = std::min(target->mStart, ts);
+        target->mEnd = std::max(target->mEnd, ts);
+        target->mTuples.push_back(data);
+      }
+    }
+
+    /**
+     * Advances the clock to the given time and closes all sessions which
+     * expired until then. A session is closed by publishing its tuples as
+     * outdated.
+     *
+     * @param[in] now
+     *    the new time of the clock
+     */
+    void advanceClock(const Timestamp& now) {
+      mClock = now;
+      while (!mTimers.empty() && mTimers.top().mExpires <= now) {
+        const auto timer = mTimers.top();
+        mTimers.pop();
+
+        auto entry = mSessionTable.find(timer.mKey);
+        if (entry == mSessionTable.end())
+          continue;
+        auto& sessions = entry->second;
+        auto s = std::find_if(sessions.begin(), sessions.end(),
+                              [&](const Session& session) { return session.mID == timer.mID; });
+        if (s == sessions.end())
+          // the session was merged with another one
+          continue;
+
+        if (s->mEnd + mGap <= now) {
+          for (const auto& tup : s->mTuples)
+            this->getOutputDataChannel().publish(tup, true);
+          sessions.erase(s);
+          mNumSessions--;
+          if (sessions.empty())
+            mSessionTable.erase(entry);
+        }
+        else
+          // the session was extended in the meantime
+          mTimers.push(Timer{ s->mEnd + mGap, timer.mKey, timer.mID });
+      }
+    }
+
+    KeyExtractorFunc mKeyExtractor;             //< the function for extracting the key of a tuple
+    TimestampExtractorFunc mTimestampExtractor; //< the function for extracting the timestamp of a tuple
+    Timestamp mGap;                             //< the gap of inactivity closing a session
+    Timestamp mClock;                           //< the current time for closing sessions
+    bool mUseWatermarks;                        //< true if the clock is driven by watermarks
+    unsigned long mNextSessionID;               //< the id of the next session created
+    std::size_t mNumSessions;                   //< the number of open sessions
+    SessionTable mSessionTable;                 //< the open sessions of all keys
+    TimerQueue mTimers;                         //< the timers for closing the sessions
+    std::mutex mMtx;                            //< mutex for accessing the sessions
+  };
+
+} // namespace pfabric
+
+#endif
@@ -36,6 +36,12 @@ namespace pfabric {
    * check the window periodically instead of evicting tuples only if
    * new tuples arrive.
    *
+   * If a range window receives Watermark punctuations (e.g. generated by
+   * Pipe::assignWatermarks), the watermarks are used as clock instead of the
+   * timestamp of the most recent tuple: the window keeps its tuples ordered by
+   * timestamp (which allows out-of-order arrivals) and evicts them only if a
+   * watermark arrives.
+   *
    * @tparam StreamElement
    *    the data stream element type kept in the window
    */
@@ -64,14 +70,18 @@ namespace pfabric {
      * @param sz the window size (seconds or number of tuples)
      * @param windowFunc optional function for modifying incoming tuples
      * @param ei ei the eviction interval, i.e., time for triggering the eviction (in milliseconds)
+     * @param executor optional executor running the eviction (instead of the timer wheel)
+     * @param timers optional timer wheel running the eviction (default = TimerWheel::defaultWheel())
      */
     SlidingWindow(typename Window<StreamElement>::TimestampExtractorFunc func,
                   const WindowParams::WinType& wt,
                   const unsigned int sz,
                   typename Window<StreamElement>::WindowOpFunc windowFunc = nullptr,
-                  const unsigned int ei = 0) :
+                  const unsigned int ei = 0,
+                  ExecutorPtr executor = nullptr,
+                  TimerWheelPtr timers = nullptr) :
     WindowBase(func, wt, sz, windowFunc, ei ) {
-      setupEviction(ei);
+      setupEviction(ei, executor, timers);
     }
 
     /**
@@ -86,15 +96,19 @@ namespace pfabric {
      * @param sz the window size (as chrono duration or number of tuples)
      * @param windowFunc optional function for modifying incoming tuples
      * @param ei ei the eviction interval, i.e., time for triggering the eviction (in milliseconds)
+     * @param executor optional executor running the eviction (instead of the timer wheel)
+     * @param timers optional timer wheel running the eviction (default = TimerWheel::defaultWheel())
      */
     template<class Rep, class Period = std::ratio<1>>
     SlidingWindow(typename Window<StreamElement>::TimestampExtractorFunc func,
                   const WindowParams::WinType& wt,
                   const std::chrono::duration<Rep, Period> sz,
                   typename Window<StreamElement>::WindowOpFunc windowFunc = nullptr,
-                  const unsigned int ei = 0) :
+                  const unsigned int ei = 0,
+                  ExecutorPtr executor = nullptr,
+                  TimerWheelPtr timers = nullptr) :
     WindowBase(func, wt, sz, windowFunc, ei ) {
-      setupEviction(ei);
+      setupEviction(ei, executor, timers);
     }
 
     /**
@@ -107,13 +121,17 @@ namespace pfabric {
      * @param sz the window size (seconds or number of tuples)
      * @param windowFunc optional function for modifying incoming tuples
      * @param ei ei the eviction interval, i.e., time for triggering the eviction (in milliseconds)
+     * @param executor optional executor running the eviction (instead of the timer wheel)
+     * @param timers optional timer wheel running the eviction (default = TimerWheel::defaultWheel())
      */
     SlidingWindow(const WindowParams::WinType& wt,
                   const unsigned int sz,
                   typename Window<StreamElement>::WindowOpFunc windowFunc = nullptr,
-                  const unsigned int ei = 0) :
+                  const unsigned int ei = 0,
+                  ExecutorPtr executor = nullptr,
+                  TimerWheelPtr timers = nullptr) :
     WindowBase(wt, sz, windowFunc, ei ) {
-      setupEviction(ei);
+      setupEviction(ei, executor, timers);
     }
 
     /**
@@ -126,19 +144,39 @@ namespace pfabric {
      */
     BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, SlidingWindow, processPunctuation );
 
+    /**
+     * @brief Checks whether outdated tuples are always published in insertion order.
+     *
+     * This holds for row windows without a window function. Range windows are
+     * excluded because they switch to watermark-driven eviction (which orders
+     * the tuples by timestamp) as soon as a watermark arrives at runtime.
+     *
+     * @return true if the outdated tuples are published in FIFO order
+     */
+    bool evictsInInsertionOrder() const {
+      return this->windowType() == WindowParams::RowWindow && !this->hasWindowFunction();
+    }
+
 
   private:
 
     /**
      * @brief This method is invoked when a punctuation arrives.
      *
-     * It simply ignores the punctuation because a window generates its own punctuations.
+     * It ignores the punctuation because a window generates its own punctuations.
+     * Only watermarks are forwarded and trigger the eviction of range windows.
      *
      * @param[in] punctuation
      *    the incoming punctuation tuple
      */
     void processPunctuation( const PunctuationPtr& punctuation ) {
-      boost::ignore_unused( punctuation );
+      if (punctuation->ptype() == Punctuation::Watermark) {
+        if (this->mWinType == WindowParams::RangeWindow) {
+          this->mUseWatermarks = true;
+          evictByWatermark(punctuation->getTimestamp());
+        }
+        this->getOutputPunctuationChannel().publish(punctuation);
+      }
     }
 
     /**
@@ -157,14 +195,10 @@ namespace pfabric {
         // if function available
         if(this->mWindowOpFunc != nullptr) {
         // insert the tuple into buffer
-          { //necessary for lock scope!
-            std::lock_guard<std::mutex> guard(this->mMtx);
-            this->mTupleBuf.push_back(data);
-            this->mCurrSize++;
-          }
+          insertTuple(data);
 
           // check for outdated tuples
-          if (!this->mEvictThread) {
+          if (!this->mEvictThread && !this->mUseWatermarks) {
             this->mEvictFun();
           }
           // apply the window function - we do this after the window was updated
@@ -176,14 +210,10 @@ namespace pfabric {
 
         } else {
           // insert the tuple into buffer
-          { //necessary for lock scope!
-            std::lock_guard<std::mutex> guard(this->mMtx);
-            this->mTupleBuf.push_back(data);
-            this->mCurrSize++;
-          }
+          insertTuple(data);
 
           // check for outdated tuples
-          if (!this->mEvictThread) {
+          if (!this->mEvictThread && !this->mUseWatermarks) {
             this->mEvictFun();
           }
 
@@ -194,18 +224,36 @@ namespace pfabric {
     }
 
     /**
-     * Sets up the eviction function or thread.
+     * Inserts a tuple into the window buffer. If the window is driven by watermarks,
+     * the tuples are kept in timestamp order.
      */
-    void setupEviction(const unsigned int ei) {
+    void insertTuple( const StreamElement& data ) {
+      std::lock_guard<std::mutex> guard(this->mMtx);
+      auto& buf = this->mTupleBuf;
+      buf.push_back(data);
+      this->mCurrSize++;
+      if (this->mUseWatermarks) {
+        // move an out-of-order tuple to its position
+        const auto ts = this->mTimestampExtractor( data );
+        for (auto i = buf.size() - 1; i > 0 && this->mTimestampExtractor( buf[i - 1] ) > ts; i--)
+          std::swap(buf[i - 1], buf[i]);
+      }
+    }
+
+    /**
+     * Sets up the eviction function or the timer (at the executor if given, otherwise
+     * at the timer wheel).
+     */
+    void setupEviction(const unsigned int ei, ExecutorPtr executor, TimerWheelPtr timers) {
       if (ei == 0) {
         // sliding window where the incoming tuple evicts outdated tuples
         this->mEvictFun = std::bind( this->mWinType == WindowParams::RangeWindow ?
                                       &SlidingWindow::evictByTime : &SlidingWindow::evictByCount, this
                                       );
       } else {
-        // sliding window, but we need a thread for evicting tuples
+        // sliding window, but we need a timer for evicting tuples
         WindowParams::EvictionFunc efun = boost::bind( &SlidingWindow::evictByTime, this );
-        this->mEvictThread = std::make_unique< EvictionNotifier >( this->mEvictInterval, efun );
+        this->mEvictThread = std::make_unique< EvictionNotifier >( this->mEvictInterval, efun, executor, timers );
       }
     }
 
@@ -235,6 +283,8 @@ namespace pfabric {
      */
     void evictByTime() {
       std::lock_guard<std::mutex> guard(this->mMtx);
+      if (this->mUseWatermarks || this->mTupleBuf.empty())
+        return;
       const auto& lastWindowElement = this->mTupleBuf.back();
       const auto lastTupleTime = this->mTimestampExtractor( lastWindowElement );
 
@@ -262,6 +312,29 @@ namespace pfabric {
         }
       }
     }
+
+    /**
+     * Implements the eviction strategy for a RangeWindow driven by watermarks,
+     * i.e. a tuple is outdated as soon as the time difference between this tuple
+     * and the watermark exceeds the given window size.
+     *
+     * @param[in] watermark
+     *    the timestamp of the watermark
+     */
+    void evictByWatermark(const Timestamp& watermark) {
+      std::lock_guard<std::mutex> guard(this->mMtx);
+      if (watermark < boost::get<Timestamp>(this->mWinSize))
+        return;
+
+      const auto accepted_time = watermark - boost::get<Timestamp>(this->mWinSize);
+      while (!this->mTupleBuf.empty() &&
+             this->mTimestampExtractor( this->mTupleBuf.front() ) <= accepted_time) {
+        const auto tup = this->mTupleBuf.front();
+        this->mTupleBuf.pop_front();
+        this->mCurrSize--;
+        this->getOutputDataChannel().publish(tup, true);
+      }
+    }
   };
 
 }
@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SpaceSaving_hpp_
+#define SpaceSaving_hpp_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "qop/FlatHashTable.hpp"
+
+namespace pfabric {
+
+  /**
+   * @brief A summary of the most frequent keys of a stream (Space-Saving).
+   *
+   * SpaceSaving monitors at most @c capacity keys together with a counter and
+   * the maximal overestimation of this counter. If a key which is not monitored
+   * arrives and all counters are in use, the key with the minimal counter is
+   * evicted and the new key inherits its counter (+1) as well as the counter
+   * value as error. Thus, the memory is bounded independently of the number
+   * of distinct keys, every key with a frequency > N / capacity is guaranteed
+   * to be monitored and the counters overestimate the frequency by at most
+   * N / capacity.
+   *
+   * The counters are organized as a binary min-heap, so that updating a key
+   * and evicting the minimum takes O(log capacity) time. Keys are mapped to
+   * their counters by a FlatHashTable which is sized for the capacity once.
+   *
+   * In order to support sliding windows, the counter of an outdated key is
+   * decremented if the key is still monitored. Occurrences of keys which were
+   * already evicted cannot be removed, i.e. the counters remain approximate.
+   *
+   * @tparam KeyType
+   *    the data type of the keys
+   * @tparam KeyHash
+   *    the hash function for the keys
+   */
+  template <typename KeyType, typename KeyHash = boost::hash<KeyType>>
+  class SpaceSaving {
+  public:
+    /// a monitored key with its (over-)estimated frequency
+    struct Counter {
+      KeyType mKey;          //< the monitored key
+      std::uint64_t mCount;  //< the estimated frequency of the key
+      std::uint64_t mError;  //< the maximal overestimation of mCount
+    };
+
+    /**
+     * Creates a new, empty summary.
+     *
+     * @param capacity
+     *    the maximal number of monitored keys (at least 1)
+     */
+    explicit SpaceSaving(std::size_t capacity) :
+      mCapacity(std::max<std::size_t>(capacity, 1)), mIndex(mCapacity) {
+      mCounters.reserve(mCapacity);
+      mHeap.reserve(mCapacity);
+    }
+
+    /**
+     * Adds @c n occurrences of the given key.
+     *
+     * @param key
+     *    the key to be counted
+     * @param n
+     *    the number of occurrences
+     */
+    void add(const KeyType& key, std::uint64_t n = 1) {
+      auto res = mIndex.tryEmplace(key, static_cast<std::uint32_t>(mCounters.size()));
+      if (!res.second) {
+        // the key is already monitored
+        auto& c = mCounters[*res.first];
+        c.mCount += n;
+        siftDown(c.mHeapPos);
+      }
+      else if (mCounters.size() < mCapacity) {
+        // there is still an unused counter
+        mCounters.push_back({ key, n, 0, mHeap.size() });
+        mHeap.push_back(*res.first);
+        siftUp(mHeap.size() - 1);
+      }
+      else {
+        // replace the key with the minimal counter
+        const auto idx = mHeap[0];
+        auto& c = mCounters[idx];
+        mIndex.erase(c.mKey);
+        // the entries of the table are stable, i.e. res.first is still valid
+        *res.first = idx;
+        c.mKey = key;
+        c.mError = c.mCount;
+        c.mCount += n;
+        siftDown(0);
+      }
+    }
+
+    /**
+     * Removes @c n occurrences of the given key if the key is monitored.
+     *
+     * @param key
+     *    the key to be removed
+     * @param n
+     *    the number of occurrences
+     */
+    void remove(const KeyType& key, std::uint64_t n = 1) {
+      auto idx = mIndex.find(key);
+      if (idx == nullptr)
+        return;
+      auto& c = mCounters[*idx];
+      c.mCount = c.mCount > n ? c.mCount - n : 0;
+      c.mError = std::min(c.mError, c.mCount);
+      siftUp(c.mHeapPos);
+    }
+
+    /**
+     * Returns an upper bound of the frequency of the given key: the counter
+     * if the key is monitored, otherwise the minimal counter (or 0 if not all
+     * counters are in use).
+     *
+     * @param key
+     *    the key to look up
+     * @return the estimated frequency
+     */
+    std::uint64_t estimate(const KeyType& key) const {
+      auto idx = mIndex.find(key);
+      if (idx != nullptr)
+        return mCounters[*idx].mCount;
+      return mCounters.size() < mCapacity ? 0 : mCounters[mHeap[0]].mCount;
+    }
+
+    /**
+     * Returns the (at most) @c k keys with the highest counters in descending
+     * order of their counters.
+     *
+     * @param k
+     *    the number of keys
+     * @return a vector of the top-k counters
+     */
+    std::vector<Counter> topK(std::size_t k) const {
+      std::vector<Counter> res;
+      res.reserve(mCounters.size());
+      for (const auto& c : mCounters) {
+        if (c.mCount > 0)
+          res.push_back({ c.mKey, c.mCount, c.mError });
+      }
+      k = std::min(k, res.size());
+      std::partial_sort(res.begin(), res.begin() + k, res.end(),
+        [](const Counter& c1, const Counter& c2) { return c1.mCount > c2.mCount; });
+      res.resize(k);
+      return res;
+    }
+
+    /**
+     * Removes all keys from the summary.
+     */
+    void clear() {
+      mIndex.clear();
+      mCounters.clear();
+      mHeap.clear();
+    }
+
+    /**
+     * Returns the number of monitored keys.
+     */
+    std::size_t size() const { return mCounters.size(); }
+
+    /**
+     * Returns the maximal number of monitored keys.
+     */
+    std::size_t capacity() const { return mCapacity; }
+
+  private:
+    /// a counter together with its position in the heap
+    struct HeapCounter {
+      KeyType mKey;
+      std::uint64_t mCount;
+      std::uint64_t mError;
+      std::size_t mHeapPos;
+    };
+
+    bool less(std::size_t i, std::size_t j) const {
+      return mCounters[mHeap[i]].mCount < mCounters[mHeap[j]].mCount;
+    }
+
+    void swap(std::size_t i, std::size_t j) {
+      std::swap(mHeap[i], mHeap[j]);
+      mCounters[mHeap[i]].mHeapPos = i;
+      mCounters[mHeap[j]].mHeapPos = j;
+    }
+
+    /**
+     * Moves the counter at the given heap position up after it was decreased.
+     */
+    void siftUp(std::size_t pos) {
+      while (pos > 0) {
+        const auto parent = (pos - 1) / 2;
+        if (!less(pos, parent))
+          break;
+        swap(pos, parent);
+        pos = parent;
+      }
+    }
+
+    /**
+     * Moves the counter at the given heap position down after it was increased.
+     */
+    void siftDown(std::size_t pos) {
+      const auto n = mHeap.size();
+      for (;;) {
+        auto smallest = pos;
+        const auto left = 2 * pos + 1, right = left + 1;
+        if (left < n && less(left, smallest))
+          smallest = left;
+        if (right < n && less(right, smallest))
+          smallest = right;
+        if (smallest == pos)
+          break;
+        swap(pos, smallest);
+        pos = smallest;
+      }
+    }
+
+    std::size_t mCapacity;                                     //< the maximal number of monitored keys
+    FlatHashTable<KeyType, std::uint32_t, KeyHash> mIndex;     //< maps the keys to their counters
+    std::vector<HeapCounter> mCounters;                        //< the counters referenced by mIndex and mHeap
+    std::vector<std::uint32_t> mHeap;                          //< min-heap of the counter indexes
+  };
+
+} /* end namespace pfabric */
+
+#endif
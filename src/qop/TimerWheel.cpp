@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "TimerWheel.hpp"
+
+using namespace pfabric;
+
+struct TimerWheel::Timer {
+  TimerFunc mFunc;                              //< the function to be invoked
+  std::uint64_t mExpires;                       //< the tick when the timer is due
+  std::uint64_t mInterval;                      //< the interval in ticks (0 for one-shot timers)
+  bool mCancelled;                              //< true if the timer was cancelled
+  bool mFinished;                               //< true if a one-shot timer was invoked
+
+  Timer(TimerFunc func, std::uint64_t interval) :
+    mFunc(func), mExpires(0), mInterval(interval), mCancelled(false), mFinished(false) {}
+};
+
+TimerWheel::TimerWheel(std::chrono::microseconds tick) :
+  mTick(std::max(tick, std::chrono::microseconds(1))), mStart(std::chrono::steady_clock::now()),
+  mNow(0), mNumEntries(0), mNumActive(0), mCurrent(nullptr), mStopped(false), mVersion(0) {}
+
+TimerWheel::~TimerWheel() {
+  {
+    std::lock_guard<std::mutex> lock(mMtx);
+    mStopped = true;
+  }
+  mCond.notify_all();
+  if (mThread.joinable()) {
+    if (mThread.get_id() == std::this_thread::get_id())
+      // the last reference was released by a timer function
+      mThread.detach();
+    else
+      mThread.join();
+  }
+}
+
+TimerWheelPtr TimerWheel::defaultWheel() {
+  static TimerWheelPtr wheel = std::make_shared<TimerWheel>();
+  return wheel;
+}
+
+TimerWheel::TimerPtr TimerWheel::schedule(TimerFunc func, std::chrono::microseconds delay,
+                                          std::chrono::microseconds interval) {
+  // round up to full ticks - a timer never fires too early
+  auto toTicks = [this](std::chrono::microseconds d) -> std::uint64_t {
+    return d.count() <= 0 ? 0 : (d.count() + mTick.count() - 1) / mTick.count();
+  };
+  auto timer = std::make_shared<Timer>(func, interval.count() > 0 ? std::max<std::uint64_t>(1, toTicks(interval)) : 0);
+  {
+    std::lock_guard<std::mutex> lock(mMtx);
+    timer->mExpires = std::max(currentTick(), mNow) + std::max<std::uint64_t>(1, toTicks(delay));
+    insert(timer);
+    mNumActive++;
+    mVersion++;
+    if (!mThread.joinable())
+      mThread = std::thread(&TimerWheel::run, this);
+  }
+  // wake up the timer thread to recompute its waiting time
+  mCond.notify_all();
+  return timer;
+}
+
+void TimerWheel::cancel(const TimerPtr& timer) {
+  std::unique_lock<std::mutex> lock(mMtx);
+  if (!timer->mCancelled) {
+    timer->mCancelled = true;
+    if (!timer->mFinished)
+      mNumActive--;
+  }
+  // the timer is removed lazily from its slot, but we have to wait until its
+  // function has finished - unless we are called from the function itself
+  if (mThread.get_id() == std::this_thread::get_id())
+    return;
+  mDoneCond.wait(lock, [&]() { return mCurrent != timer.get(); });
+}
+
+std::uint64_t TimerWheel::currentTick() const {
+  return (std::chrono::steady_clock::now() - mStart) / mTick;
+}
+
+void TimerWheel::insert(const TimerPtr& timer) {
+  auto expires = std::max(timer->mExpires, mNow + 1);
+  auto diff = expires - mNow;
+  // find the lowest level covering the remaining time
+  auto level = 0u;
+  while (level < NumLevels - 1 && diff >= (std::uint64_t(1) << (SlotBits * (level + 1))))
+    level++;
+  if (diff >= (std::uint64_t(1) << (SlotBits * NumLevels)))
+    // beyond the range of the wheel: park it in the last slot, it is
+    // reinserted when it is cascaded
+    expires = mNow + (std::uint64_t(1) << (SlotBits * NumLevels)) - 1;
+  auto idx = (expires >> (SlotBits * level)) & (NumSlots - 1);
+  mLevels[level][idx].push_back(timer);
+  mNumEntries++;
+}
+
+void TimerWheel::cascade(unsigned int level) {
+  auto idx = (mNow >> (SlotBits * level)) & (NumSlots - 1);
+  Slot slot;
+  slot.swap(mLevels[level][idx]);
+  mNumEntries -= slot.size();
+  for (auto& timer : slot) {
+    if (!timer->mCancelled)
+      insert(timer);
+  }
+}
+
+void TimerWheel::advance(std::uint64_t tick, std::vector<TimerPtr>& batch) {
+  mNow = tick;
+  // if a lower level wraps around, the next slot of the upper level is
+  // distributed to the lower levels (starting with the highest level)
+  for (auto level = NumLevels - 1; level > 0; level--) {
+    if ((tick & ((std::uint64_t(1) << (SlotBits * level)) - 1)) == 0)
+      cascade(level);
+  }
+  Slot slot;
+  slot.swap(mLevels[0][tick & (NumSlots - 1)]);
+  mNumEntries -= slot.size();
+  for (auto& timer : slot) {
+    if (timer->mCancelled)
+      continue;
+    if (timer->mExpires > tick)
+      insert(timer);
+    else
+      batch.push_back(timer);
+  }
+}
+
+std::uint64_t TimerWheel::nextWakeup() const {
+  // the next tick with a due timer in level 0 or the next cascading of a
+  // non-empty slot: the slots of a level are visited until the level wraps
+  // around; only if the whole level is empty, the next level is considered
+  for (auto level = 0u; level < NumLevels; level++) {
+    const auto shift = SlotBits * level;
+    const auto end = ((mNow >> shift) | (NumSlots - 1)) + 1;
+    for (auto pos = (mNow >> shift) + 1; pos < end; pos++) {
+      if (!mLevels[level][pos & (NumSlots - 1)].empty())
+        return pos << shift;
+    }
+    // slots already passed hold timers of the next round
+    for (const auto& slot : mLevels[level]) {
+      if (!slot.empty())
+        return end << shift;
+    }
+  }
+  return ((mNow >> (SlotBits * NumLevels)) + 1) << (SlotBits * NumLevels);
+}
+
+void TimerWheel::run() {
+  std::unique_lock<std::mutex> lock(mMtx);
+  std::vector<TimerPtr> batch;
+
+  while (!mStopped) {
+    auto version = mVersion;
+    if (mNumEntries == 0) {
+      // nothing to do: wait for a new timer
+      mNow = std::max(mNow, currentTick());
+      mCond.wait(lock, [&]() { return mStopped || mVersion != version; });
+      continue;
+    }
+
+    auto target = nextWakeup();
+    mCond.wait_until(lock, mStart + mTick * static_cast<std::chrono::microseconds::rep>(target), [&]() {
+      return mStopped || mVersion != version || currentTick() >= target;
+    });
+    if (mStopped)
+      break;
+
+    // process all ticks up to now and collect the due timers - ticks without
+    // due timers or cascading are skipped
+    const auto now = currentTick();
+    while (mNow < now)
+      advance(std::min(nextWakeup(), now), batch);
+
+    // invoke the batch of due timers
+    for (auto& timer : batch) {
+      if (timer->mCancelled)
+        continue;
+      mCurrent = timer.get();
+      lock.unlock();
+      timer->mFunc();
+      lock.lock();
+      mCurrent = nullptr;
+      mDoneCond.notify_all();
+
+      if (timer->mCancelled)
+        continue;
+      if (timer->mInterval > 0) {
+        // reschedule a periodic timer and skip missed periods
+        timer->mExpires += timer->mInterval;
+        if (timer->mExpires <= mNow)
+          timer->mExpires += ((mNow - timer->mExpires) / timer->mInterval + 1) * timer->mInterval;
+        insert(timer);
+      } else {
+        timer->mFinished = true;
+        mNumActive--;
+      }
+    }
+    batch.clear();
+  }
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TimerWheel_hpp_
+#define TimerWheel_hpp_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pfabric {
+
+  class TimerWheel;
+
+  /**
+   * Typedef for a pointer to a timer wheel.
+   */
+  typedef std::shared_ptr<TimerWheel> TimerWheelPtr;
+
+  /**
+   * @brief A hierarchical timer wheel shared by all time-driven operators.
+   *
+   * Instead of spawning one sleeping thread per TriggerNotifier, EvictionNotifier
+   * or periodically executed query, the callbacks are registered at a timer wheel
+   * which runs all of them on a single thread. Time is divided into ticks of a
+   * configurable length (in microseconds). The wheel consists of several levels
+   * of 256 slots each: level 0 holds the timers due within the next 256 ticks,
+   * level 1 those due within the next 256^2 ticks and so on. Whenever level 0
+   * wraps around, the timers of the next slot of the upper level are cascaded
+   * down. Thus, registering and cancelling a timer takes constant time. All
+   * timers due in the same tick are collected and invoked as a batch, and the
+   * thread only wakes up for ticks with due timers (or for cascading a non-empty
+   * slot). Likewise, after a delay the wheel jumps over the ticks in between.
+   *
+   * The thread is started as soon as the first timer is registered. Callbacks
+   * run on the timer thread and should therefore be short.
+   */
+  class TimerWheel {
+  public:
+    /**
+     * Typedef for a function invoked by a timer.
+     */
+    typedef std::function<void()> TimerFunc;
+
+    struct Timer;
+
+    /**
+     * Typedef for a handle to a registered timer.
+     */
+    typedef std::shared_ptr<Timer> TimerPtr;
+
+    /**
+     * Creates a new timer wheel.
+     *
+     * @param tick the length of a tick, i.e. the resolution of the timers
+     */
+    TimerWheel(std::chrono::microseconds tick = std::chrono::microseconds(100));
+
+    /**
+     * Stops and joins the timer thread. Pending timers are discarded.
+     */
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * Registers a function which is invoked once after the given delay or -
+     * if an interval is given - periodically.
+     *
+     * @param func the function to be invoked
+     * @param delay the time until the first invocation
+     * @param interval the time between two invocations (0 = invoke only once)
+     * @return a handle to the timer
+     */
+    TimerPtr schedule(TimerFunc func, std::chrono::microseconds delay,
+                      std::chrono::microseconds interval = std::chrono::microseconds(0));
+
+    /**
+     * Registers a function which is invoked periodically.
+     *
+     * @param func the function to be invoked
+     * @param interval the time between two invocations
+     * @return a handle to the timer
+     */
+    TimerPtr scheduleEvery(TimerFunc func, std::chrono::microseconds interval) {
+      return schedule(func, interval, interval);
+    }
+
+    /**
+     * Cancels a timer. After the call returns the timer function is not running
+     * (unless cancel is called by the function itself) and will never be invoked
+     * again.
+     *
+     * @param timer the handle of the timer
+     */
+    void cancel(const TimerPtr& timer);
+
+    /**
+     * Returns the number of timers which are registered and not cancelled.
+     */
+    std::size_t numTimers() const { return mNumActive; }
+
+    /**
+     * Returns the length of a tick.
+     */
+    std::chrono::microseconds tick() const { return mTick; }
+
+    /**
+     * Returns the timer wheel used by operators which are not part of a
+     * topology (e.g. created directly in a unit test).
+     */
+    static TimerWheelPtr defaultWheel();
+
+  private:
+    static const unsigned int SlotBits = 8;
+    static const unsigned int NumSlots = 1u << SlotBits;
+    static const unsigned int NumLevels = 4;
+
+    typedef std::vector<TimerPtr> Slot;
+    typedef std::array<Slot, NumSlots> Level;
+
+    void run();
+    std::uint64_t currentTick() const;
+    void insert(const TimerPtr& timer);
+    void cascade(unsigned int level);
+    void advance(std::uint64_t tick, std::vector<TimerPtr>& batch);
+    std::uint64_t nextWakeup() const;
+
+    std::chrono::microseconds mTick;                       //< the length of a tick
+    std::chrono::steady_clock::time_point mStart;          //< the time of tick 0
+    std::array<Level, NumLevels> mLevels;                  //< the slots of all levels
+    std::uint64_t mNow;                                    //< the last tick processed
+    std::size_t mNumEntries;                               //< the number of timers in the slots
+    std::atomic<std::size_t> mNumActive;                   //< the number of timers not cancelled
+    const Timer* mCurrent;                                 //< the timer whose function is running
+    bool mStopped;                                         //< true if the wheel is shut down
+    unsigned long mVersion;                                //< incremented for each new timer
+    mutable std::mutex mMtx;                               //< mutex protecting the slots
+    std::condition_variable mCond;                         //< for waking up the timer thread
+    std::condition_variable mDoneCond;                     //< for waiting on a running timer
+    std::thread mThread;                                   //< the timer thread
+  };
+
+}
+
+#endif
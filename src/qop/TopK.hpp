@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TopK_hpp_
+#define TopK_hpp_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "core/Punctuation.hpp"
+#include "core/Tuple.hpp"
+#include "qop/OperatorMacros.hpp"
+#include "qop/SpaceSaving.hpp"
+#include "qop/TriggerNotifier.hpp"
+#include "qop/UnaryTransform.hpp"
+
+namespace pfabric {
+
+/**
+ * @brief An operator determining the most frequent keys of a stream.
+ *
+ * TopK counts the keys of the incoming stream elements approximately with a
+ * Space-Saving summary (see SpaceSaving) which monitors a bounded number of
+ * keys. In contrast to a groupBy followed by a sort, the memory consumption
+ * depends only on the capacity of the summary and not on the number of
+ * distinct keys. The k keys with the highest counts are published as tuples
+ * (rank, key, count) ordered by rank (1 = most frequent key). The temporal
+ * behaviour is defined by the trigger type (all, count, time - see
+ * PipeFabricTypes.hpp) and the trigger interval; a TriggerByCount or
+ * TriggerByTime result list is followed by a SlideExpired punctuation.
+ *
+ * The operator supports windows: outdated stream elements decrement the
+ * counter of their key (if still monitored) and a WindowExpired punctuation
+ * of a tumbling window clears the summary.
+ *
+ * @tparam InputStreamElement
+ *    the data stream element type consumed by the operator
+ * @tparam KeyType
+ *    the data type for the key column
+ * @tparam KeyHash
+ *    the hash function for the keys
+ */
+template<
+  typename InputStreamElement,
+  typename KeyType = DefaultKeyType,
+  typename KeyHash = boost::hash<KeyType>
+>
+class TopK :
+  public UnaryTransform< InputStreamElement, TuplePtr< unsigned int, KeyType, unsigned long > > {
+public:
+  /// the tuple type for publishing a frequent key: (rank, key, count)
+  typedef TuplePtr< unsigned int, KeyType, unsigned long > TopKTuplePtr;
+
+  /// the function for extracting the key from an incoming stream element
+  typedef std::function< KeyType(const InputStreamElement&) > KeyFunc;
+
+private:
+  PFABRIC_UNARY_TRANSFORM_TYPEDEFS(InputStreamElement, TopKTuplePtr);
+
+public:
+  /**
+   * @brief Create a new instance of the TopK operator.
+   *
+   * @param key_fun
+   *    a function for extracting the key of a stream element
+   * @param k
+   *    the number of keys to be published
+   * @param capacity
+   *    the number of keys monitored by the summary (at least k); a larger
+   *    capacity improves the accuracy of the counts
+   * @param tType
+   *    the trigger type specifying when the top-k keys are published
+   *    (TriggerAll, TriggerByCount, TriggerByTime)
+   * @param tInterval
+   *    the interval in seconds (TriggerByTime) or in the number of tuples
+   *    (TriggerByCount) for publishing the top-k keys
+   * @param executor
+   *    optional executor running the trigger for TriggerByTime (instead of the timer wheel)
+   * @param timers
+   *    optional timer wheel running the trigger for TriggerByTime (default = TimerWheel::defaultWheel())
+   */
+  TopK(KeyFunc key_fun, unsigned int k, unsigned int capacity,
+       AggregationTriggerType tType = TriggerAll, const unsigned int tInterval = 0,
+       ExecutorPtr executor = nullptr, TimerWheelPtr timers = nullptr) :
+    mKeyFunc(key_fun), mK(k), mSummary(std::max(k, capacity)),
+    mNotifier(tInterval > 0 && tType == TriggerByTime ?
+      new TriggerNotifier(std::bind(&TopK::notificationCallback, this), tInterval, executor, timers) : nullptr),
+    mTriggerType(tType), mTriggerInterval(tInterval), mCounter(0) {}
+
+  /**
+   * @brief Bind the callback for the data channel.
+   */
+  BIND_INPUT_CHANNEL_DEFAULT( InputDataChannel, TopK, processDataElement );
+
+  /**
+   * @brief Bind the callback for the punctuation channel.
+   */
+  BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, TopK, processPunctuation );
+
+  const std::string opName() const override { return std::string("TopK"); }
+
+  /**
+   * Returns the number of keys currently monitored by the summary.
+   *
+   * @return the number of keys
+   */
+  std::size_t numKeys() const {
+    std::lock_guard<std::mutex> guard(mMtx);
+    return mSummary.size();
+  }
+
+private:
+  /**
+   * This method is invoked when a data stream element arrives. It updates the
+   * counter of the element's key and depending on the trigger strategy
+   * publishes the top-k keys.
+   *
+   * @param[in] data
+   *    the incoming stream element
+   * @param[in] outdated
+   *    flag indicating whether the tuple is new or invalidated now
+   */
+  void processDataElement(const InputStreamElement& data, const bool outdated) {
+    std::unique_lock<std::mutex> myLock(mMtx);
+    const KeyType key = mKeyFunc(data);
+    if (outdated) {
+      mSummary.remove(key);
+      return;
+    }
+    mSummary.add(key);
+
+    switch (mTriggerType) {
+      case TriggerAll:
+        publishTopK();
+        break;
+      case TriggerByCount:
+        if (++mCounter == mTriggerInterval) {
+          mCounter = 0;
+          myLock.unlock();
+          notificationCallback();
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  /**
+   * This method is invoked when a punctuation arrives. A WindowExpired
+   * punctuation clears the summary, all punctuations are forwarded.
+   *
+   * @param[in] punctuation
+   *    the incoming punctuation tuple
+   */
+  void processPunctuation(const PunctuationPtr& punctuation) {
+    if (punctuation->ptype() == Punctuation::WindowExpired) {
+      std::lock_guard<std::mutex> guard(mMtx);
+      mSummary.clear();
+    }
+    this->getOutputPunctuationChannel().publish(punctuation);
+  }
+
+  /**
+   * Publishes the top-k keys as (rank, key, count) tuples. The caller has to
+   * hold the mutex.
+   */
+  void publishTopK() {
+    auto counters = mSummary.topK(mK);
+    unsigned int rank = 0;
+    for (const auto& c : counters) {
+      auto tn = makeTuplePtr(++rank, c.mKey, static_cast<unsigned long>(c.mCount));
+      this->getOutputDataChannel().publish(tn, false);
+    }
+  }
+
+  /**
+   * A function called by the TriggerNotifier timer (or after tInterval tuples)
+   * which publishes the top-k keys and a SlideExpired punctuation.
+   */
+  void notificationCallback() {
+    {
+      std::lock_guard<std::mutex> guard(mMtx);
+      publishTopK();
+    }
+    auto punctuation = std::make_shared<Punctuation>(Punctuation::SlideExpired);
+    this->getOutputPunctuationChannel().publish(punctuation);
+  }
+
+  KeyFunc mKeyFunc;                            //< a pointer to the function extracting the key
+  unsigned int mK;                             //< the number of keys to be published
+  SpaceSaving<KeyType, KeyHash> mSummary;      //< the summary counting the keys
+  mutable std::mutex mMtx;                     //< a mutex for synchronizing access between
+                                               //< the trigger notifier thread and the operator
+  std::unique_ptr<TriggerNotifier> mNotifier;  //< the notifier object which triggers the
+                                               //< publishing of the top-k keys periodically
+  AggregationTriggerType mTriggerType;         //< the type of trigger activating the publishing
+  unsigned int mTriggerInterval;               //< the interval (time in seconds, number of tuples)
+  unsigned int mCounter;                       //< the number of tuples processed since the
+                                               //< last publishing
+};
+
+} /* end namespace pfabric */
+
+#endif
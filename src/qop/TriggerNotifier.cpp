@@ -17,34 +17,26 @@
 
 #include "TriggerNotifier.hpp"
 
-#include <thread>
-
 
 using namespace pfabric;
 
-TriggerNotifier::TriggerNotifier(NotifierCallback::slot_type const& cb, unsigned int ti) :
-  mInterrupted(new bool(false)), mTriggerInterval(ti) {
-	mCallback.connect(cb);
-	mThread = std::make_unique< std::thread >( (std::ref(*this) ) );
+TriggerNotifier::TriggerNotifier(NotifierCallback::slot_type const& cb, unsigned int ti,
+                                 ExecutorPtr executor, TimerWheelPtr timers) :
+  mTriggerInterval(ti), mExecutor(executor) {
+  mCallback.connect(cb);
+  if (mExecutor)
+    mTimer = mExecutor->registerTimer([this]() { mCallback(); }, std::chrono::seconds(mTriggerInterval));
+  else {
+    mTimerWheel = timers ? timers : TimerWheel::defaultWheel();
+    mWheelTimer = mTimerWheel->scheduleEvery([this]() { mCallback(); }, std::chrono::seconds(mTriggerInterval));
+  }
 }
 
 TriggerNotifier::~TriggerNotifier() {
-  if (mThread) {
-    // inform thread about stopping ...
-    *mInterrupted = true;
-    // and wait ...
-    mThread->join();
+  if (mTimer) {
+    mExecutor->unregisterTask(mTimer);
   }
-}
-
-void TriggerNotifier::operator()() {
-  // loop until the interrupted flag is set to true
-  auto seconds = std::chrono::seconds(mTriggerInterval);
-
-  while(!(*mInterrupted)) {
-    // let's wait ...
-    std::this_thread::sleep_for(seconds);
-    // invoke the callback
-		mCallback();
+  if (mWheelTimer) {
+    mTimerWheel->cancel(mWheelTimer);
   }
 }
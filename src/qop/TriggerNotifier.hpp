@@ -18,13 +18,11 @@
 #ifndef TriggerNotifier_hpp_
 #define TriggerNotifier_hpp_
 
-// #include <boost/thread.hpp>
-
-#include <thread>
-
 #include <boost/signals2.hpp>
 
 #include "libcpp/types/types.hpp"
+#include "qop/Executor.hpp"
+#include "qop/TimerWheel.hpp"
 
 
 namespace pfabric {
@@ -33,7 +31,8 @@ namespace pfabric {
    *
    * TriggerNotifier is a helper class for operators which produce results
    * periodically, e.g. aggregations. It invokes a given callback (implemented by
-   * a boost::signal) of the associated operator periodically.
+   * a boost::signal) of the associated operator periodically. The callback is
+   * run as a timer either by an executor or by a timer wheel.
    */
   class TriggerNotifier {
   public:
@@ -43,31 +42,30 @@ namespace pfabric {
     typedef boost::signals2::signal<void ()> NotifierCallback;
 
     /**
-     * Create a new notifier object.
+     * Create a new notifier object. If an executor is given, the callback is
+     * run as a timer by the executor, otherwise it is registered at the given
+     * timer wheel (or the default timer wheel).
      *
      * @param cb the callback which is invoked periodically.
      * @param slen the time interval for notifications.
+     * @param executor the executor running the callback (optional)
+     * @param timers the timer wheel running the callback (optional)
      */
-    TriggerNotifier(NotifierCallback::slot_type const& cb, unsigned int slen);
+    TriggerNotifier(NotifierCallback::slot_type const& cb, unsigned int slen,
+                    ExecutorPtr executor = nullptr, TimerWheelPtr timers = nullptr);
 
     /**
      * Destructor for deallocating resources.
      */
     ~TriggerNotifier();
 
-    /**
-     * The method doing the work of the notifier. It is called by the
-     * boost::thread class.
-     */
-    void operator()();
-
   private:
-    typedef std::unique_ptr< std::thread > ThreadPtr;
-    std::shared_ptr<bool> mInterrupted; //< flag for cancelling the thread (true if the thread can be stopped)
-                                        //<  note it has to be a shared pointer, because the object is copied //< during creating the thread.
-    ThreadPtr mThread;                  //< the notifier thread
     NotifierCallback mCallback;	        //< the callback which is invoked
     unsigned int mTriggerInterval;      //< the time interval for notifications
+    ExecutorPtr mExecutor;              //< the executor running the timer (if any)
+    Executor::TaskPtr mTimer;           //< the timer registered at the executor
+    TimerWheelPtr mTimerWheel;          //< the timer wheel running the timer (if no executor)
+    TimerWheel::TimerPtr mWheelTimer;   //< the timer registered at the timer wheel
   };
 }
 
@@ -18,6 +18,9 @@
 #ifndef TumblingWindow_hpp_
 #define TumblingWindow_hpp_
 
+#include <algorithm>
+#include <vector>
+
 #include "Window.hpp"
 
 
@@ -30,6 +33,20 @@ namespace pfabric {
    * where all tuples are outdated and the window is started from scratch as
    * soon is the window size is exceeded.
    *
+   * By default (WindowParams::ExpireTuples) all tuples of an expired window are
+   * published again as outdated followed by a WindowExpired punctuation. With
+   * WindowParams::ExpireBoundary only the WindowExpired punctuation is published
+   * which is sufficient for downstream aggregates: they reset their state on this
+   * punctuation. In this mode the window does not buffer any tuple unless a
+   * window function is given.
+   *
+   * If a range window receives Watermark punctuations (e.g. generated by
+   * Pipe::assignWatermarks), a window [start, start + size) is closed only if a
+   * watermark reaches its end, i.e. tuples may arrive out of order. Tuples of
+   * the current window are forwarded immediately, tuples of later windows are
+   * held back until their window becomes the current one. Watermarks are
+   * forwarded after the windows closed by them.
+   *
    * @tparam StreamElement
    *    the data stream element type kept in the window
    */
@@ -53,12 +70,14 @@ namespace pfabric {
      * @param wt the type of the window (range or row)
      * @param sz the window size (seconds or number of tuples)
      * @param windowFunc optional function for modifying incoming tuples
+     * @param mode the way the end of a window is signaled
      */
     TumblingWindow(typename Window<StreamElement>::TimestampExtractorFunc func,
                    const WindowParams::WinType& wt,
                    const unsigned int sz,
-                   typename Window<StreamElement>::WindowOpFunc windowFunc = nullptr) :
-    WindowBase(func, wt, sz, windowFunc ) {
+                   typename Window<StreamElement>::WindowOpFunc windowFunc = nullptr,
+                   WindowParams::ExpiryMode mode = WindowParams::ExpireTuples) :
+    WindowBase(func, wt, sz, windowFunc ), mExpiryMode(mode), mWindowStart(0), mHasWindow(false) {
       setupEviction();
     }
 
@@ -69,13 +88,15 @@ namespace pfabric {
      * @param wt the type of the window (range or row)
      * @param sz the window size (as chrono duration or number of tuples)
      * @param windowFunc optional function for modifying incoming tuples
+     * @param mode the way the end of a window is signaled
      */
     template<class Rep, class Period = std::ratio<1>>
     TumblingWindow(typename Window<StreamElement>::TimestampExtractorFunc func,
                    const WindowParams::WinType& wt,
                    const std::chrono::duration<Rep, Period> sz,
-                   typename Window<StreamElement>::WindowOpFunc windowFunc = nullptr) :
-    WindowBase(func, wt, sz, windowFunc ) {
+                   typename Window<StreamElement>::WindowOpFunc windowFunc = nullptr,
+                   WindowParams::ExpiryMode mode = WindowParams::ExpireTuples) :
+    WindowBase(func, wt, sz, windowFunc ), mExpiryMode(mode), mWindowStart(0), mHasWindow(false) {
       setupEviction();
     }
 
@@ -85,10 +106,12 @@ namespace pfabric {
      * @param wt the type of the window (range or row)
      * @param sz the window size (seconds or number of tuples)
      * @param windowFunc optional function for modifying incoming tuples
+     * @param mode the way the end of a window is signaled
      */
     TumblingWindow(const WindowParams::WinType& wt, const unsigned int sz,
-    typename Window<StreamElement>::WindowOpFunc windowFunc = nullptr) :
-    WindowBase(wt, sz, windowFunc ) {
+    typename Window<StreamElement>::WindowOpFunc windowFunc = nullptr,
+    WindowParams::ExpiryMode mode = WindowParams::ExpireTuples) :
+    WindowBase(wt, sz, windowFunc ), mExpiryMode(mode), mWindowStart(0), mHasWindow(false) {
       setupEviction();
     }
 
@@ -108,13 +131,18 @@ namespace pfabric {
     /**
      * @brief This method is invoked when a punctuation arrives.
      *
-     * It simply ignores the punctuation because a window generates its own punctuations.
+     * It ignores the punctuation because a window generates its own punctuations.
+     * Only watermarks are forwarded and close the windows of range windows.
      *
      * @param[in] punctuation
      *    the incoming punctuation tuple
      */
     void processPunctuation( const PunctuationPtr& punctuation ) {
-      boost::ignore_unused( punctuation );
+      if (punctuation->ptype() == Punctuation::Watermark) {
+        if (this->mWinType == WindowParams::RangeWindow)
+          closeByWatermark(punctuation->getTimestamp());
+        this->getOutputPunctuationChannel().publish(punctuation);
+      }
     }
 
 
@@ -134,6 +162,12 @@ namespace pfabric {
         this->getOutputDataChannel().publish(data, outdated);
         return;
       }
+      else if (this->mUseWatermarks) {
+        processWithWatermarks(data);
+      }
+      else if (mExpiryMode == WindowParams::ExpireBoundary) {
+        processWithBoundary(data);
+      }
       else {
         // if function available
         if(this->mWindowOpFunc != nullptr) {
@@ -175,6 +209,157 @@ namespace pfabric {
       }
     }
 
+    /**
+     * Handles an incoming tuple if only the window boundaries are published:
+     * the tuple is forwarded directly and a WindowExpired punctuation is published
+     * before the first tuple of a new window (range window) or after the last
+     * tuple of a window (row window).
+     *
+     * @param[in] data
+     *    the incoming stream element
+     */
+    void processWithBoundary( const StreamElement& data ) {
+      bool expired = false;
+      {
+        std::lock_guard<std::mutex> guard(this->mMtx);
+        if (this->mWinType == WindowParams::RangeWindow) {
+          const Timestamp tupleTime = this->mTimestampExtractor( data );
+          const Timestamp winSize = boost::get<Timestamp>(this->mWinSize);
+          // same condition as in evictByTime: the window starts with the first tuple
+          if (this->mCurrSize > 0 && tupleTime >= winSize && mWindowStart <= tupleTime - winSize) {
+            expired = true;
+            this->mCurrSize = 0;
+            this->mTupleBuf.clear();
+          }
+          if (this->mCurrSize == 0)
+            mWindowStart = tupleTime;
+        }
+        // the buffer is only needed for the window function
+        if (this->mWindowOpFunc != nullptr)
+          this->mTupleBuf.push_back(data);
+        this->mCurrSize++;
+      }
+      if (expired)
+        publishWindowExpired();
+
+      if (this->mWindowOpFunc != nullptr) {
+        auto res = this->mWindowOpFunc(this->mTupleBuf.begin(), this->mTupleBuf.end(), data);
+        this->getOutputDataChannel().publish(res, false);
+      }
+      else
+        this->getOutputDataChannel().publish(data, false);
+
+      if (this->mWinType == WindowParams::RowWindow) {
+        {
+          std::lock_guard<std::mutex> guard(this->mMtx);
+          expired = this->mCurrSize == boost::get<unsigned int>(this->mWinSize);
+          if (expired) {
+            this->mCurrSize = 0;
+            this->mTupleBuf.clear();
+          }
+        }
+        if (expired)
+          publishWindowExpired();
+      }
+    }
+
+    /**
+     * Handles an incoming tuple of a range window driven by watermarks: a tuple of
+     * the current window is added to the window and forwarded, a tuple of a later
+     * window is held back.
+     *
+     * @param[in] data
+     *    the incoming stream element
+     */
+    void processWithWatermarks( const StreamElement& data ) {
+      std::lock_guard<std::mutex> guard(this->mMtx);
+      const Timestamp tupleTime = this->mTimestampExtractor( data );
+      if (!mHasWindow) {
+        mWindowStart = tupleTime;
+        mHasWindow = true;
+      }
+      if (tupleTime < mWindowStart + boost::get<Timestamp>(this->mWinSize))
+        addToWindow(data);
+      else
+        mPendingTuples.push_back(data);
+    }
+
+    /**
+     * Adds a tuple to the current window of a range window driven by watermarks
+     * and forwards it. The caller has to hold the lock of the window buffer.
+     *
+     * @param[in] data
+     *    the stream element of the current window
+     */
+    void addToWindow( const StreamElement& data ) {
+      // the buffer is only needed for publishing outdated tuples or for the window function
+      if (mExpiryMode == WindowParams::ExpireTuples || this->mWindowOpFunc != nullptr)
+        this->mTupleBuf.push_back(data);
+      this->mCurrSize++;
+      if (this->mWindowOpFunc != nullptr)
+        this->getOutputDataChannel().publish(
+          this->mWindowOpFunc(this->mTupleBuf.begin(), this->mTupleBuf.end(), data), false);
+      else
+        this->getOutputDataChannel().publish(data, false);
+    }
+
+    /**
+     * Closes all windows of a range window which end before the given watermark.
+     * The first watermark switches the window to watermark-driven processing.
+     *
+     * @param[in] watermark
+     *    the timestamp of the watermark
+     */
+    void closeByWatermark( const Timestamp& watermark ) {
+      std::lock_guard<std::mutex> guard(this->mMtx);
+      const Timestamp winSize = boost::get<Timestamp>(this->mWinSize);
+      if (!this->mUseWatermarks) {
+        this->mUseWatermarks = true;
+        // the window collected so far starts with its first tuple
+        mHasWindow = this->mCurrSize > 0;
+        if (mHasWindow && mExpiryMode == WindowParams::ExpireTuples)
+          mWindowStart = this->mTimestampExtractor( this->mTupleBuf.front() );
+      }
+
+      while (mHasWindow && watermark >= mWindowStart + winSize) {
+        if (mExpiryMode == WindowParams::ExpireTuples) {
+          for (auto it = this->mTupleBuf.begin(); it != this->mTupleBuf.end(); it++)
+            this->getOutputDataChannel().publish( *it, true );
+        }
+        this->mTupleBuf.clear();
+        this->mCurrSize = 0;
+        publishWindowExpired();
+
+        if (mPendingTuples.empty()) {
+          // the next tuple starts a new window
+          mHasWindow = false;
+          break;
+        }
+        // the next window is the one of the earliest tuple held back
+        Timestamp first = this->mTimestampExtractor( mPendingTuples.front() );
+        for (const auto& tup : mPendingTuples)
+          first = std::min(first, this->mTimestampExtractor( tup ));
+        mWindowStart += winSize * ((first - mWindowStart) / winSize);
+
+        std::vector< StreamElement > pending;
+        pending.swap(mPendingTuples);
+        for (const auto& tup : pending) {
+          if (this->mTimestampExtractor( tup ) < mWindowStart + winSize)
+            addToWindow(tup);
+          else
+            mPendingTuples.push_back(tup);
+        }
+      }
+    }
+
+    /**
+     * Publishes a WindowExpired punctuation.
+     */
+    void publishWindowExpired() {
+      auto pp = std::make_shared< Punctuation >( Punctuation::WindowExpired );
+      this->getOutputPunctuationChannel().publish( pp );
+    }
+
     /**
      * Sets up the eviction function.
      **/
@@ -227,18 +412,23 @@ namespace pfabric {
         if( this->mTimestampExtractor( tup ) <= accepted_time ) {
           // we have inserted the most recent tuple already because we need its timestamp,
           // but we don't evict it yet
-          const auto end = --(this->mTupleBuf.end());
-          for (auto it = this->mTupleBuf.begin(); it != end; it++) {
-            this->getOutputDataChannel().publish( *it, true );
+          while (this->mTupleBuf.size() > 1) {
+            this->getOutputDataChannel().publish( this->mTupleBuf.front(), true );
+            this->mTupleBuf.pop_front();
           }
 
           this->mCurrSize = 1;
-          this->mTupleBuf.erase( this->mTupleBuf.begin(), end );
           auto pp = std::make_shared< Punctuation >( Punctuation::WindowExpired );
           this->getOutputPunctuationChannel().publish( pp );
         }
       }
     }
+
+    WindowParams::ExpiryMode mExpiryMode; //< the way the end of a window is signaled
+    Timestamp mWindowStart;               //< the timestamp of the first tuple in the current
+                                          //< range window (ExpireBoundary or watermarks only)
+    bool mHasWindow;                      //< true if a window was started (watermarks only)
+    std::vector< StreamElement > mPendingTuples; //< tuples of later windows (watermarks only)
   };
 
 }
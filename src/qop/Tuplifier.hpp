@@ -84,14 +84,17 @@ class Tuplifier
    * @param predList the predicate list
    * @param m the tuplifying mode
    * @param ws a window size for periodic notification (default = 0)
+   * @param executor optional executor running the periodic notification
+   * @param timers optional timer wheel running the periodic notification (if no executor is given)
    */
-  Tuplifier(const std::initializer_list<std::string>& predList, TuplifierParams::TuplifyMode m, unsigned int ws = 0)
+  Tuplifier(const std::initializer_list<std::string>& predList, TuplifierParams::TuplifyMode m, unsigned int ws = 0,
+            ExecutorPtr executor = nullptr, TimerWheelPtr timers = nullptr)
       : mode(m),
         currentSubj(),
         notifier(
             ws > 0 && ws < UINT_MAX
                 ? new TriggerNotifier(
-                      boost::bind(&Tuplifier::notificationCallback, this), ws)
+                      boost::bind(&Tuplifier::notificationCallback, this), ws, executor, timers)
                 : nullptr) {
     // assert(tupleSchema.size() == predList.size() + 1);
     int i = 0;
@@ -101,8 +104,9 @@ class Tuplifier
   }
 
   Tuplifier(TimestampExtractorFunc func, 
-      const std::initializer_list<std::string>& predList, TuplifierParams::TuplifyMode m, unsigned int ws = 0) : 
-      Tuplifier(predList, m, ws) {
+      const std::initializer_list<std::string>& predList, TuplifierParams::TuplifyMode m, unsigned int ws = 0,
+      ExecutorPtr executor = nullptr, TimerWheelPtr timers = nullptr) :
+      Tuplifier(predList, m, ws, executor, timers) {
       mTimestampExtractor = func;
    }
 
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WatermarkGenerator_hpp_
+#define WatermarkGenerator_hpp_
+
+#include <functional>
+
+#include "core/Punctuation.hpp"
+#include "qop/UnaryTransform.hpp"
+#include "qop/OperatorMacros.hpp"
+
+namespace pfabric {
+
+  /**
+   * @brief An operator generating watermarks for a stream of timestamped tuples.
+   *
+   * WatermarkGenerator tracks the maximum event time (extracted by a timestamp
+   * extractor function) of the tuples seen so far and publishes Watermark
+   * punctuations carrying this maximum minus the allowed lateness. Thus,
+   * tuples may arrive out of order as long as they are not delayed more than
+   * the allowed lateness. Tuples arriving later, i.e. with a timestamp smaller
+   * than the last watermark, are dropped. Operators like range windows
+   * or aggregations triggered by timestamps use the watermarks as clock
+   * instead of the timestamps of the individual tuples. At the end of the
+   * stream a final watermark with the maximal timestamp is published.
+   *
+   * @tparam StreamElement
+   *    the data stream element type
+   */
+  template<typename StreamElement>
+  class WatermarkGenerator : public UnaryTransform<StreamElement, StreamElement> {
+  private:
+    PFABRIC_UNARY_TRANSFORM_TYPEDEFS(StreamElement, StreamElement);
+
+  public:
+    /**
+     * Typedef for a function extracting the timestamp from a tuple.
+     */
+    typedef std::function<Timestamp(const StreamElement&)> TimestampExtractorFunc;
+
+    /**
+     * @brief Construct a new instance of the watermark operator.
+     *
+     * @param[in] func
+     *      the function for extracting the timestamp from a tuple
+     * @param[in] lateness
+     *      the maximal delay of an out-of-order tuple
+     * @param[in] interval
+     *      the minimal progress of the event time between two watermarks
+     */
+    WatermarkGenerator(TimestampExtractorFunc func, Timestamp lateness, Timestamp interval = Timestamp(0)) :
+      mTimestampExtractor(func), mLateness(lateness), mInterval(interval),
+      mMaxTime(0), mWatermark(0), mHasWatermark(false), mNumLateTuples(0) {}
+
+    /**
+     * @brief Bind the callback for the data channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT(InputDataChannel, WatermarkGenerator, processDataElement);
+
+    /**
+     * @brief Bind the callback for the punctuation channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT(InputPunctuationChannel, WatermarkGenerator, processPunctuation);
+
+    const std::string opName() const override { return std::string("WatermarkGenerator"); }
+
+    /**
+     * Returns the number of tuples dropped because they arrived too late.
+     *
+     * @return the number of late tuples
+     */
+    unsigned long numLateTuples() const { return mNumLateTuples; }
+
+  private:
+
+    /**
+     * @brief This method is invoked when a punctuation arrives.
+     *
+     * It forwards the @c punctuation to the subscribers. At the end of the
+     * stream a final watermark is published before.
+     *
+     * @param[in] punctuation
+     *    the incoming punctuation tuple
+     */
+    void processPunctuation(const PunctuationPtr& punctuation) {
+      if (punctuation->ptype() == Punctuation::EndOfStream)
+        publishWatermark(Timestamp::max());
+      this->getOutputPunctuationChannel().publish(punctuation);
+    }
+
+    /**
+     * @brief This method is invoked when a stream element arrives from the publisher.
+     *
+     * It forwards the incoming stream element unless it is too late and publishes
+     * a new watermark if the event time has progressed enough.
+     *
+     * @param[in] data
+     *    the incoming stream element
+     * @param[in] outdated
+     *    flag indicating whether the tuple is new or invalidated now
+     */
+    void processDataElement(const StreamElement& data, const bool outdated) {
+      if (outdated) {
+        this->getOutputDataChannel().publish(data, outdated);
+        return;
+      }
+
+      const auto ts = mTimestampExtractor(data);
+      if (mHasWatermark && ts < mWatermark) {
+        // the tuple is delayed more than the allowed lateness
+        mNumLateTuples++;
+        return;
+      }
+      this->getOutputDataChannel().publish(data, outdated);
+
+      if (ts > mMaxTime)
+        mMaxTime = ts;
+      if (mMaxTime >= mLateness) {
+        const auto wm = mMaxTime - mLateness;
+        if (!mHasWatermark || wm >= mWatermark + mInterval)
+          publishWatermark(wm);
+      }
+    }
+
+    /**
+     * Publishes a Watermark punctuation with the given timestamp if the
+     * watermark has progressed.
+     */
+    void publishWatermark(Timestamp wm) {
+      if (mHasWatermark && wm <= mWatermark)
+        return;
+      mWatermark = wm;
+      mHasWatermark = true;
+      this->getOutputPunctuationChannel().publish(std::make_shared<Punctuation>(Punctuation::Watermark, wm));
+    }
+
+    TimestampExtractorFunc mTimestampExtractor; //< the function for extracting the timestamp from a tuple
+    Timestamp mLateness;                        //< the maximal delay of an out-of-order tuple
+    Timestamp mInterval;                        //< the minimal progress between two watermarks
+    Timestamp mMaxTime;                         //< the maximal timestamp seen so far
+    Timestamp mWatermark;                       //< the last watermark published
+    bool mHasWatermark;                         //< true if a watermark was already published
+    unsigned long mNumLateTuples;               //< the number of dropped tuples
+  };
+
+} // namespace pfabric
+
+#endif
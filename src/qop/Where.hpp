@@ -31,10 +31,17 @@ namespace pfabric {
    * Because a filter does not modify the tuple structure, the template is parameterized
    * only by one tuple type representing both input and output.
    *
+   * The predicate type is a template parameter: by default it is a std::function,
+   * but any callable (e.g. the type of a lambda) can be used which allows the
+   * compiler to inline the predicate into @c processDataElement.
+   *
    * @tparam StreamElement
    *    the data stream element type which shall be filtered
+   * @tparam Predicate
+   *    the type of the filter predicate: <tt>bool (const StreamElement&, bool)</tt>
    */
-  template<typename StreamElement>
+  template<typename StreamElement,
+           typename Predicate = std::function<bool(const StreamElement&, bool)>>
   class Where : public UnaryTransform<StreamElement, StreamElement> {
   private:
     PFABRIC_UNARY_TRANSFORM_TYPEDEFS(StreamElement, StreamElement);
@@ -43,10 +50,8 @@ namespace pfabric {
 
     /**
      * Typedef for a function pointer to a filter predicates.
-     *
-     * TODO make this a template argument for something more efficient like lambda type?
      */
-    typedef std::function<bool(const StreamElement&, bool)> PredicateFunc;
+    typedef Predicate PredicateFunc;
 
     /**
      * Create a new filter operator evaluating the given predicate
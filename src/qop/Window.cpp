@@ -15,39 +15,26 @@
  * see <http://www.gnu.org/licenses/>.
  */
 
-#include <thread>
-#include <boost/version.hpp>
-
 #include "Window.hpp"
 
-#if BOOST_VERSION < 105000
-#define TIME_UTC_ TIME_UTC
-#endif
-
 using namespace pfabric;
 
-EvictionNotifier::EvictionNotifier(unsigned int ei, WindowParams::EvictionFunc& fun) :
-mInterrupted(new bool(false)), mEvictInterval(ei), mEvictFun(fun) {
-  mThread = std::make_shared< std::thread >( *this );
+EvictionNotifier::EvictionNotifier(unsigned int ei, WindowParams::EvictionFunc& fun,
+                                   ExecutorPtr executor, TimerWheelPtr timers) :
+mEvictInterval(ei), mEvictFun(fun), mExecutor(executor) {
+  if (mExecutor)
+    mTimer = mExecutor->registerTimer(mEvictFun, std::chrono::seconds(mEvictInterval));
+  else {
+    mTimerWheel = timers ? timers : TimerWheel::defaultWheel();
+    mWheelTimer = mTimerWheel->scheduleEvery(mEvictFun, std::chrono::seconds(mEvictInterval));
+  }
 }
 
 EvictionNotifier::~EvictionNotifier() {
-  if (mThread) {
-    // inform the thread about stopping
-    *mInterrupted = true;
-    // and wait until it has stopped
-    mThread->join();
+  if (mTimer) {
+    mExecutor->unregisterTask(mTimer);
   }
-}
-
-void EvictionNotifier::operator()() {
-  // loop until the interrupted flag is set to true
-  auto seconds = std::chrono::seconds(mEvictInterval);
-
-  while(!(*mInterrupted)) {
-    // let's wait ...
-    std::this_thread::sleep_for(seconds);
-    // invoke the callback
-    mEvictFun();
+  if (mWheelTimer) {
+    mTimerWheel->cancel(mWheelTimer);
   }
 }
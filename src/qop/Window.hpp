@@ -19,14 +19,17 @@
 #define Window_hpp_
 
 #include <chrono>
-#include <list>
 #include <thread>
 #include <mutex>
 #include <boost/assert.hpp>
 #include <boost/variant.hpp>
 
+#include "core/Punctuation.hpp"
 #include "qop/UnaryTransform.hpp"
 #include "qop/OperatorMacros.hpp"
+#include "qop/Executor.hpp"
+#include "qop/TimerWheel.hpp"
+#include "qop/WindowBuffer.hpp"
 
 namespace pfabric {
 
@@ -47,6 +50,16 @@ namespace pfabric {
       RowWindow             //< a window storing a maximum number of tuples
     };
 
+    /**
+     * Literals for the ways a tumbling window signals the end of a window.
+     */
+    enum ExpiryMode {
+      ExpireTuples,         //< all tuples of the window are published as outdated
+                            //< followed by a WindowExpired punctuation
+      ExpireBoundary        //< only a WindowExpired punctuation is published, the
+                            //< tuples are not buffered (unless a window function is given)
+    };
+
   };
 
   /**
@@ -70,7 +83,7 @@ namespace pfabric {
   public UnaryTransform< StreamElement, StreamElement > // use default unary transform
   {
   public:
-    typedef typename std::list<StreamElement>::const_iterator ElementIterator;
+    typedef typename WindowBuffer<StreamElement>::const_iterator ElementIterator;
 
     typedef std::function<Timestamp(const StreamElement&)> TimestampExtractorFunc;
 
@@ -82,6 +95,16 @@ namespace pfabric {
        ElementIterator end,
       const StreamElement&)> WindowOpFunc;
 
+    /**
+     * Returns the type of the window (row or range).
+     */
+    WindowParams::WinType windowType() const { return mWinType; }
+
+    /**
+     * Returns true if a window function modifies the incoming tuples.
+     */
+    bool hasWindowFunction() const { return mWindowOpFunc != nullptr; }
+
   protected:
     PFABRIC_UNARY_TRANSFORM_TYPEDEFS(StreamElement, StreamElement);
 
@@ -99,10 +122,14 @@ namespace pfabric {
      */
     Window(TimestampExtractorFunc func, const WindowParams::WinType& wt,
         const unsigned int sz, WindowOpFunc winOpFunc = nullptr, const unsigned int ei = 0) :
-      mTimestampExtractor(func), mWinType(wt), mWindowOpFunc(winOpFunc), mEvictInterval(ei), mCurrSize(0) {
+      mTimestampExtractor(func), mWinType(wt), mWindowOpFunc(winOpFunc), mEvictInterval(ei), mCurrSize(0),
+      mUseWatermarks(false) {
         if (mWinType == WindowParams::RangeWindow)
           mWinSize = Timestamp(sz * 1000 * 1000); //< input interpreted as seconds
-        else mWinSize = sz;
+        else {
+          mWinSize = sz;
+          mTupleBuf.reserve(sz + 1);
+        }
     }
 
     /**
@@ -120,7 +147,8 @@ namespace pfabric {
     template<class Rep, class Period = std::ratio<1>>
     Window(TimestampExtractorFunc func, const WindowParams::WinType& wt,
         const std::chrono::duration<Rep, Period> sz, WindowOpFunc winOpFunc = nullptr, const unsigned int ei = 0) :
-      mTimestampExtractor(func), mWinType(wt), mWinSize(sz), mWindowOpFunc(winOpFunc), mEvictInterval(ei), mCurrSize(0) {
+      mTimestampExtractor(func), mWinType(wt), mWinSize(sz), mWindowOpFunc(winOpFunc), mEvictInterval(ei), mCurrSize(0),
+      mUseWatermarks(false) {
         if (mWinType == WindowParams::RangeWindow)
           mWinSize = std::chrono::duration_cast<Timestamp>(sz);
         else mWinSize = sz;
@@ -139,12 +167,15 @@ namespace pfabric {
      */
     Window(const WindowParams::WinType& wt,
            const unsigned int sz, WindowOpFunc winOpFunc = nullptr, const unsigned int ei = 0) :
-    mWinType(wt), mWinSize(sz), mWindowOpFunc(winOpFunc), mEvictInterval(ei), mCurrSize(0) {
+    mWinType(wt), mWinSize(sz), mWindowOpFunc(winOpFunc), mEvictInterval(ei), mCurrSize(0),
+    mUseWatermarks(false) {
       BOOST_ASSERT_MSG(mWinType == WindowParams::RowWindow, "RowWindow requires timestamp extractor function.");
+      // a new tuple is inserted before the eviction, so we need one more slot
+      mTupleBuf.reserve(sz + 1);
     }
 
-    /// a list for stream elements in the windows
-    using TupleList = std::list< StreamElement >;
+    /// a circular buffer for stream elements in the windows
+    using TupleList = WindowBuffer< StreamElement >;
     using EvictionThread = std::unique_ptr< EvictionNotifier >;
     using WinSizeType = boost::variant< Timestamp, unsigned int >;
 
@@ -158,6 +189,7 @@ namespace pfabric {
     WindowParams::EvictionFunc mEvictFun;       //< a function implementing the eviction policy
     EvictionThread mEvictThread;                //< the thread for running the eviction function
                                                 //< (if the eviction interval > 0)
+    bool mUseWatermarks;                        //< true if the eviction is driven by watermarks
     mutable std::mutex mMtx;                    //< mutex for accessing the tuple buffer
   };
 
@@ -165,39 +197,38 @@ namespace pfabric {
    * @brief Helper class for the window operator
    *
    * EvictionNotifier is a helper class for the window operator to
-   * invoke the eviction function periodically.
+   * invoke the eviction function periodically. The eviction function is
+   * run as a timer either by an executor or by a timer wheel.
    *
    * TODO: why not using TriggerNotifier instead???
    */
   class EvictionNotifier {
   public:
     /**
-     * Create a new notifier object.
+     * Create a new notifier object. If an executor is given, the eviction
+     * function is run as a timer by the executor, otherwise it is registered
+     * at the given timer wheel (or the default timer wheel).
      *
      * @param ei the eviction interval, i.e., time for triggering the eviction (in milliseconds)
      * @param fun the eviction member function
+     * @param executor the executor running the eviction function (optional)
+     * @param timers the timer wheel running the eviction function (optional)
      */
-    EvictionNotifier(unsigned int ei, WindowParams::EvictionFunc& fun);
+    EvictionNotifier(unsigned int ei, WindowParams::EvictionFunc& fun, ExecutorPtr executor = nullptr,
+                     TimerWheelPtr timers = nullptr);
 
     /**
      * Destructor
      */
     ~EvictionNotifier();
 
-    /**
-     * The method doing the work of the notifier. It is called by the
-     * boost::thread class.
-     */
-    void operator()();
-
   private:
-    typedef std::shared_ptr< std::thread > ThreadPtr;
-    std::shared_ptr<bool> mInterrupted;   //< flag for canceling the thread (true if the thread can be stopped)
-                                          //< note it has to be a shared pointer, because the object is copied
-                                          //< during creating the thread.
-    ThreadPtr mThread;                    //< the notifier thread
     unsigned int mEvictInterval;          //< the time interval for notifications
     WindowParams::EvictionFunc mEvictFun; //< the eviction function we call periodically
+    ExecutorPtr mExecutor;                //< the executor running the timer (if any)
+    Executor::TaskPtr mTimer;             //< the timer registered at the executor
+    TimerWheelPtr mTimerWheel;            //< the timer wheel running the timer (if no executor)
+    TimerWheel::TimerPtr mWheelTimer;     //< the timer registered at the timer wheel
   };
 
 } /* end namespace pfabric */
@@ -0,0 +1,425 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WindowAggregation_hpp_
+#define WindowAggregation_hpp_
+
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include <boost/core/ignore_unused.hpp>
+
+#include "core/Tuple.hpp"
+#include "core/Punctuation.hpp"
+#include "qop/AggregateFunctions.hpp"
+#include "qop/AggregateStateBase.hpp"
+#include "qop/OperatorMacros.hpp"
+#include "qop/UnaryTransform.hpp"
+#include "qop/Window.hpp"
+#include "qop/WindowBuffer.hpp"
+
+namespace pfabric {
+
+  /**
+   * @brief A FIFO of partial aggregates supporting aggregate queries in amortized O(1).
+   *
+   * TwoStackAggregates implements the two-stacks algorithm for sliding-window
+   * aggregation: partial aggregates (e.g. of panes) are pushed to a back stack
+   * whose running aggregate is maintained on insertion. Evicting the oldest
+   * partial pops from a front stack which stores suffix aggregates; if the
+   * front stack is empty, the back stack is flipped once. Thus, each partial is
+   * combined only a constant number of times and no inverse function is needed,
+   * i.e. also non-invertible aggregates like min or max can be used.
+   *
+   * @tparam AggregateState
+   *    the type of the aggregation state providing a static @c combine function
+   */
+  template <typename AggregateState>
+  class TwoStackAggregates {
+  public:
+    using AggregateStatePtr = std::shared_ptr<AggregateState>;
+
+    TwoStackAggregates() :
+      mBackAggr(std::make_shared<AggregateState>()), mResult(std::make_shared<AggregateState>()) {}
+
+    /**
+     * Returns a fresh aggregation state which can be filled and pushed
+     * afterwards. States of evicted partials are reused.
+     *
+     * @return an initialized aggregation state
+     */
+    AggregateStatePtr newPartial() {
+      AggregateStatePtr state;
+      if (mFreeList.empty())
+        state = std::make_shared<AggregateState>();
+      else {
+        state = mFreeList.back();
+        mFreeList.pop_back();
+      }
+      state->init();
+      return state;
+    }
+
+    /**
+     * Appends a partial aggregate as the most recent element.
+     *
+     * @param state the partial aggregate
+     */
+    void push(AggregateStatePtr state) {
+      if (mBack.empty())
+        mBackAggr->init();
+      AggregateState::combine(mBackAggr, state);
+      mBack.push_back(state);
+    }
+
+    /**
+     * Removes the oldest partial aggregate.
+     */
+    void pop() {
+      if (mFront.empty()) {
+        // flip the back stack: compute the suffix aggregates from the
+        // most recent to the oldest partial
+        for (auto i = mBack.size(); i > 0; i--) {
+          auto& state = mBack[i - 1];
+          if (!mFront.empty())
+            AggregateState::combine(state, mFront.back());
+          mFront.push_back(state);
+        }
+        mBack.clear();
+      }
+      mFreeList.push_back(mFront.back());
+      mFront.pop_back();
+    }
+
+    /**
+     * Returns the aggregate of all partials or nullptr if there is none.
+     * The returned state is owned by this object and valid only until the
+     * next modification.
+     *
+     * @return the aggregation state representing all partials
+     */
+    AggregateStatePtr query() {
+      if (mFront.empty())
+        return mBack.empty() ? nullptr : mBackAggr;
+      if (mBack.empty())
+        return mFront.back();
+      mResult->init();
+      AggregateState::combine(mResult, mFront.back());
+      AggregateState::combine(mResult, mBackAggr);
+      return mResult;
+    }
+
+    /**
+     * Returns the number of partial aggregates.
+     */
+    std::size_t size() const { return mFront.size() + mBack.size(); }
+
+    /**
+     * Returns true if there are no partial aggregates.
+     */
+    bool empty() const { return mFront.empty() && mBack.empty(); }
+
+  private:
+    std::vector<AggregateStatePtr> mFront;    //< suffix aggregates, the oldest one at the end
+    std::vector<AggregateStatePtr> mBack;     //< partials in the order of their arrival
+    AggregateStatePtr mBackAggr;              //< the running aggregate of all partials in mBack
+    AggregateStatePtr mResult;                //< the state for combining front and back
+    std::vector<AggregateStatePtr> mFreeList; //< states of evicted partials for reuse
+  };
+
+  /**
+   * @brief An operator computing aggregates over a sliding window.
+   *
+   * WindowAggregation combines a sliding window with an aggregation. Instead of
+   * keeping the window content and retracting each evicted tuple from the
+   * aggregate, the stream is divided into panes, i.e. non-overlapping slices
+   * of length gcd(size, slide). For each pane a partial aggregate is computed,
+   * complete panes are kept in a TwoStackAggregates structure and the result
+   * of a window is obtained by combining the partials of its panes. Therefore,
+   * the aggregation state has to provide a @c combine function (as the
+   * predefined @c Aggregator1 ... @c Aggregator4 classes do), but the
+   * aggregate functions do not need to be invertible.
+   *
+   * For row windows the operator produces the aggregate of the last @c size
+   * tuples after every @c slide tuples. For range windows it produces the
+   * aggregate of each window [k * slide - size, k * slide) as soon as a tuple
+   * with a timestamp >= k * slide arrives (or the stream ends). Range windows
+   * require tuples ordered by timestamp at pane granularity: a tuple older than
+   * the most recent pane is dropped (and counted, see numLateTuples), a later
+   * tuple within the most recent pane is added to this pane. Watermarks are
+   * ignored, i.e. out-of-order tuples are not reordered.
+   *
+   * @tparam InputStreamElement
+   *    the data stream element type consumed by the aggregation
+   * @tparam OutputStreamElement
+   *    the data stream element type produced by the aggregation
+   * @tparam AggregateState
+   *   the type of the aggregation state object
+   */
+  template<
+    typename InputStreamElement,
+    typename OutputStreamElement,
+    typename AggregateState
+  >
+  class WindowAggregation : public UnaryTransform< InputStreamElement, OutputStreamElement > {
+  protected:
+    PFABRIC_UNARY_TRANSFORM_TYPEDEFS(InputStreamElement, OutputStreamElement);
+
+  public:
+    /**
+     * Alias for pointer to the aggregation state
+     */
+    using AggregateStatePtr = std::shared_ptr<AggregateState>;
+
+    /**
+     * Alias for a function to extract the timestamp from a tuple
+     */
+    using TimestampExtractorFunc = std::function<Timestamp(const InputStreamElement&)>;
+
+    /**
+     * The function which produces the aggregation result from the aggregate state.
+     */
+    using FinalFunc = std::function<OutputStreamElement(AggregateStatePtr)>;
+
+    /**
+     * The function which is invoked for each incoming stream element to update a pane.
+     */
+    using IterateFunc = std::function<void(const InputStreamElement&, AggregateStatePtr, const bool)>;
+
+    /**
+     * Creates a new window aggregation operator with a row window.
+     *
+     * @param final_fun
+     *    a function pointer to the aggregation function
+     * @param it_fun
+     *    a function pointer to an iteration function called for each incoming tuple
+     * @param sz
+     *    the window size in number of tuples
+     * @param slide
+     *    the number of tuples after which an aggregate is produced
+     */
+    WindowAggregation(FinalFunc final_fun, IterateFunc it_fun,
+                      const unsigned int sz, const unsigned int slide = 1) :
+      mIterateFunc(it_fun), mFinalFunc(final_fun), mWinType(WindowParams::RowWindow),
+      mWinSize(sz), mSlide(slide), mPaneSize(std::gcd(sz, slide)),
+      mPaneCount(0), mSlideCount(0), mCurrPaneStart(0), mNextWindowEnd(0), mNumLateTuples(0) {
+      BOOST_ASSERT_MSG(sz > 0 && slide > 0, "window size and slide must be > 0");
+    }
+
+    /**
+     * Creates a new window aggregation operator with a range window.
+     *
+     * @param final_fun
+     *    a function pointer to the aggregation function
+     * @param it_fun
+     *    a function pointer to an iteration function called for each incoming tuple
+     * @param func
+     *    a function for extracting the timestamp value from the stream element
+     * @param sz
+     *    the window size in seconds
+     * @param slide
+     *    the slide of the window in seconds
+     */
+    WindowAggregation(FinalFunc final_fun, IterateFunc it_fun, TimestampExtractorFunc func,
+                      const unsigned int sz, const unsigned int slide) :
+      mIterateFunc(it_fun), mFinalFunc(final_fun), mTimestampExtractor(func),
+      mWinType(WindowParams::RangeWindow),
+      mWinSize(Timestamp(sz * 1000 * 1000).count()), mSlide(Timestamp(slide * 1000 * 1000).count()),
+      mPaneSize(std::gcd(mWinSize, mSlide)),
+      mPaneCount(0), mSlideCount(0), mCurrPaneStart(0), mNextWindowEnd(0), mNumLateTuples(0) {
+      BOOST_ASSERT_MSG(sz > 0 && slide > 0, "window size and slide must be > 0");
+    }
+
+    /**
+     * @brief Bind the callback for the data channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT( InputDataChannel, WindowAggregation, processDataElement );
+
+    /**
+     * @brief Bind the callback for the punctuation channel.
+     */
+    BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, WindowAggregation, processPunctuation );
+
+    const std::string opName() const override { return std::string("WindowAggregation"); }
+
+    /**
+     * Returns the number of tuples of a range window dropped because they
+     * were older than the most recent pane.
+     *
+     * @return the number of late tuples
+     */
+    unsigned long numLateTuples() const { return mNumLateTuples; }
+
+  private:
+
+    /**
+     * This method is invoked when a data stream element arrives. It adds the
+     * element to the current pane and produces the window aggregate if the
+     * window slides.
+     *
+     * @param[in] data
+     *    the incoming stream element
+     * @param[in] outdated
+     *    flag indicating whether the tuple is new or invalidated now
+     */
+    void processDataElement( const InputStreamElement& data, const bool outdated ) {
+      // the operator maintains the window itself, thus invalidations are ignored
+      if (outdated)
+        return;
+
+      if (mWinType == WindowParams::RowWindow)
+        processByCount(data);
+      else
+        processByTime(data);
+    }
+
+    /**
+     * @brief This method is invoked when a punctuation arrives.
+     *
+     * At the end of the stream the aggregate of the pending range window
+     * is produced. All punctuations are forwarded.
+     *
+     * @param[in] punctuation
+     *    the incoming punctuation tuple
+     */
+    void processPunctuation( const PunctuationPtr& punctuation ) {
+      if (punctuation->ptype() == Punctuation::EndOfStream &&
+          mWinType == WindowParams::RangeWindow && mCurrPane) {
+        closePane();
+        evictPanes(mNextWindowEnd);
+        publishAggregate();
+      }
+      this->getOutputPunctuationChannel().publish(punctuation);
+    }
+
+    /**
+     * Handles a tuple of a row window: panes are closed after mPaneSize tuples
+     * and only the last mWinSize / mPaneSize panes are kept.
+     */
+    void processByCount(const InputStreamElement& data) {
+      if (!mCurrPane)
+        mCurrPane = mPanes.newPartial();
+      mIterateFunc(data, mCurrPane, false);
+
+      if (++mPaneCount == mPaneSize) {
+        closePane();
+        while (mPanes.size() > mWinSize / mPaneSize)
+          mPanes.pop();
+      }
+      if (++mSlideCount == mSlide) {
+        // mSlide is a multiple of mPaneSize, so all panes are closed here
+        mSlideCount = 0;
+        publishAggregate();
+      }
+    }
+
+    /**
+     * Handles a tuple of a range window: panes are aligned to multiples of
+     * mPaneSize, and all windows ending before the timestamp of the tuple are
+     * produced before the tuple is added. Tuples older than the most recent
+     * pane are dropped.
+     */
+    void processByTime(const InputStreamElement& data) {
+      const auto ts = static_cast<std::uint64_t>(mTimestampExtractor(data).count());
+      if (ts < mCurrPaneStart) {
+        // the pane of the tuple was already closed
+        mNumLateTuples++;
+        return;
+      }
+
+      if (!mCurrPane && mPanes.empty())
+        // the first window which contains this tuple
+        mNextWindowEnd = (ts / mSlide + 1) * mSlide;
+
+      while (ts >= mNextWindowEnd) {
+        closePane();
+        evictPanes(mNextWindowEnd);
+        if (mPanes.empty()) {
+          // skip all empty windows
+          mNextWindowEnd = (ts / mSlide + 1) * mSlide;
+          break;
+        }
+        publishAggregate();
+        mNextWindowEnd += mSlide;
+      }
+
+      const auto paneStart = ts - ts % mPaneSize;
+      if (mCurrPane && paneStart != mCurrPaneStart)
+        closePane();
+      if (!mCurrPane) {
+        mCurrPane = mPanes.newPartial();
+        mCurrPaneStart = paneStart;
+      }
+      mIterateFunc(data, mCurrPane, false);
+    }
+
+    /**
+     * Moves the current pane (if any) to the complete panes.
+     */
+    void closePane() {
+      if (!mCurrPane)
+        return;
+      mPanes.push(mCurrPane);
+      mPaneStarts.push_back(mCurrPaneStart);
+      mCurrPane.reset();
+      mPaneCount = 0;
+    }
+
+    /**
+     * Removes all panes of a range window which are not part of the
+     * window ending at @c windowEnd.
+     */
+    void evictPanes(std::uint64_t windowEnd) {
+      while (!mPaneStarts.empty() && mPaneStarts.front() + mWinSize < windowEnd) {
+        mPanes.pop();
+        mPaneStarts.pop_front();
+      }
+    }
+
+    /**
+     * Combines the complete panes and publishes the aggregate.
+     */
+    void publishAggregate() {
+      auto state = mPanes.query();
+      if (state)
+        this->getOutputDataChannel().publish(mFinalFunc(state), false);
+    }
+
+    IterateFunc mIterateFunc;                     //< the function for adding a tuple to a pane
+    FinalFunc mFinalFunc;                         //< the function computing the final aggregates
+    TimestampExtractorFunc mTimestampExtractor;   //< the function for extracting the timestamp
+                                                  //< (range windows only)
+    WindowParams::WinType mWinType;               //< the type of window
+    std::uint64_t mWinSize;                       //< the window size (tuples or microseconds)
+    std::uint64_t mSlide;                         //< the slide (tuples or microseconds)
+    std::uint64_t mPaneSize;                      //< the pane size, i.e. gcd(mWinSize, mSlide)
+    TwoStackAggregates<AggregateState> mPanes;    //< the partial aggregates of complete panes
+    WindowBuffer<std::uint64_t> mPaneStarts;      //< the start time of each complete pane
+                                                  //< (range windows only)
+    AggregateStatePtr mCurrPane;                  //< the partial aggregate of the current pane
+    std::uint64_t mPaneCount;                     //< the number of tuples in the current pane
+    std::uint64_t mSlideCount;                    //< the number of tuples since the last result
+    std::uint64_t mCurrPaneStart;                 //< the start time of the current pane
+    std::uint64_t mNextWindowEnd;                 //< the end of the next range window
+    unsigned long mNumLateTuples;                 //< the number of dropped out-of-order tuples
+  };
+
+}
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WindowBuffer_hpp_
+#define WindowBuffer_hpp_
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <boost/assert.hpp>
+
+namespace pfabric {
+
+  /**
+   * @brief A growable circular buffer for the content of a window.
+   *
+   * WindowBuffer keeps the stream elements of a window in a single contiguous
+   * array which is used as a ring: elements are appended at the tail and evicted
+   * from the head without any allocation. Only if the buffer is full its capacity
+   * is doubled and the elements are moved into the new array. The capacity is
+   * always a power of two, so that a logical position is mapped to a slot by a
+   * simple mask. The buffer provides random-access iterators from the oldest to
+   * the most recent element.
+   *
+   * Note, that the buffer is not thread-safe, the window operators protect it
+   * by their own mutex.
+   *
+   * @tparam T
+   *    the type of the elements stored in the buffer
+   */
+  template <typename T>
+  class WindowBuffer {
+    using Allocator = std::allocator<T>;
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    /**
+     * @brief A random-access iterator over the elements of a WindowBuffer.
+     *
+     * The iterator stores the logical position (0 is the oldest element) and
+     * maps it to the slot in the ring only when it is dereferenced.
+     */
+    template <bool IsConst>
+    class Iterator {
+      using BufferPtr = typename std::conditional<IsConst, const WindowBuffer*, WindowBuffer*>::type;
+      friend class WindowBuffer;
+
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef T value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef typename std::conditional<IsConst, const T*, T*>::type pointer;
+      typedef typename std::conditional<IsConst, const T&, T&>::type reference;
+
+      Iterator() : mBuf(nullptr), mPos(0) {}
+
+      /**
+       * Converts a mutable iterator into a const iterator.
+       */
+      template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+      Iterator(const Iterator<false>& other) : mBuf(other.mBuf), mPos(other.mPos) {}
+
+      reference operator*() const { return (*mBuf)[mPos]; }
+      pointer operator->() const { return &(*mBuf)[mPos]; }
+      reference operator[](difference_type n) const { return (*mBuf)[mPos + n]; }
+
+      Iterator& operator++() { ++mPos; return *this; }
+      Iterator operator++(int) { Iterator tmp(*this); ++mPos; return tmp; }
+      Iterator& operator--() { --mPos; return *this; }
+      Iterator operator--(int) { Iterator tmp(*this); --mPos; return tmp; }
+      Iterator& operator+=(difference_type n) { mPos += n; return *this; }
+      Iterator& operator-=(difference_type n) { mPos -= n; return *this; }
+
+      friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+      friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+      friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+      friend difference_type operator-(const Iterator& a, const Iterator& b) {
+        return static_cast<difference_type>(a.mPos) - static_cast<difference_type>(b.mPos);
+      }
+
+      friend bool operator==(const Iterator& a, const Iterator& b) { return a.mPos == b.mPos; }
+      friend bool operator!=(const Iterator& a, const Iterator& b) { return a.mPos != b.mPos; }
+      friend bool operator<(const Iterator& a, const Iterator& b) { return a.mPos < b.mPos; }
+      friend bool operator>(const Iterator& a, const Iterator& b) { return a.mPos > b.mPos; }
+      friend bool operator<=(const Iterator& a, const Iterator& b) { return a.mPos <= b.mPos; }
+      friend bool operator>=(const Iterator& a, const Iterator& b) { return a.mPos >= b.mPos; }
+
+    private:
+      Iterator(BufferPtr buf, std::size_t pos) : mBuf(buf), mPos(pos) {}
+
+      BufferPtr mBuf;   //< the buffer we iterate over
+      std::size_t mPos; //< the logical position relative to the oldest element
+    };
+
+  public:
+    typedef T value_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    /**
+     * Creates a new buffer.
+     *
+     * @param capacity the number of elements for which space is preallocated
+     *        (rounded up to the next power of two)
+     */
+    explicit WindowBuffer(std::size_t capacity = DefaultCapacity) :
+      mSlots(nullptr), mCapacity(0), mMask(0), mHead(0), mSize(0) {
+      reserve(capacity);
+    }
+
+    WindowBuffer(const WindowBuffer&) = delete;            // disable copying
+    WindowBuffer& operator=(const WindowBuffer&) = delete; // disable assignment
+
+    ~WindowBuffer() {
+      clear();
+      AllocTraits::deallocate(mAlloc, mSlots, mCapacity);
+    }
+
+    /**
+     * Makes sure that the buffer can hold at least @c n elements without
+     * growing. Existing elements are moved into the new array.
+     *
+     * @param n the minimal capacity
+     */
+    void reserve(std::size_t n) {
+      if (n <= mCapacity)
+        return;
+      std::size_t cap = 2;
+      while (cap < n) cap <<= 1;
+
+      T* slots = AllocTraits::allocate(mAlloc, cap);
+      for (std::size_t i = 0; i < mSize; i++) {
+        T& elem = slot(i);
+        AllocTraits::construct(mAlloc, slots + i, std::move(elem));
+        AllocTraits::destroy(mAlloc, &elem);
+      }
+      if (mSlots != nullptr)
+        AllocTraits::deallocate(mAlloc, mSlots, mCapacity);
+
+      mSlots = slots;
+      mCapacity = cap;
+      mMask = cap - 1;
+      mHead = 0;
+    }
+
+    /**
+     * Appends an element at the tail (the most recent position) of the buffer.
+     *
+     * @param elem the element to be appended
+     */
+    void push_back(const T& elem) {
+      if (mSize == mCapacity)
+        reserve(mCapacity * 2);
+      AllocTraits::construct(mAlloc, &slot(mSize), elem);
+      mSize++;
+    }
+
+    /**
+     * Removes the oldest element from the buffer.
+     */
+    void pop_front() {
+      BOOST_ASSERT_MSG(mSize > 0, "pop_front on empty WindowBuffer");
+      AllocTraits::destroy(mAlloc, &slot(0));
+      mHead = (mHead + 1) & mMask;
+      mSize--;
+    }
+
+    /**
+     * Removes the most recent element from the buffer.
+     */
+    void pop_back() {
+      BOOST_ASSERT_MSG(mSize > 0, "pop_back on empty WindowBuffer");
+      AllocTraits::destroy(mAlloc, &slot(mSize - 1));
+      mSize--;
+    }
+
+    /**
+     * Removes all elements but keeps the allocated capacity.
+     */
+    void clear() {
+      for (std::size_t i = 0; i < mSize; i++)
+        AllocTraits::destroy(mAlloc, &slot(i));
+      mHead = 0;
+      mSize = 0;
+    }
+
+    reference front() { return slot(0); }
+    const_reference front() const { return slot(0); }
+    reference back() { return slot(mSize - 1); }
+    const_reference back() const { return slot(mSize - 1); }
+
+    /**
+     * Returns the element at the given logical position (0 is the oldest element).
+     */
+    reference operator[](std::size_t i) { return slot(i); }
+    const_reference operator[](std::size_t i) const { return slot(i); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, mSize); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, mSize); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    std::size_t size() const { return mSize; }
+    std::size_t capacity() const { return mCapacity; }
+    bool empty() const { return mSize == 0; }
+
+  private:
+    static const std::size_t DefaultCapacity = 16;
+
+    T& slot(std::size_t i) { return mSlots[(mHead + i) & mMask]; }
+    const T& slot(std::size_t i) const { return mSlots[(mHead + i) & mMask]; }
+
+    Allocator mAlloc;       //< the allocator for the slot array
+    T* mSlots;              //< the contiguous array of slots used as ring
+    std::size_t mCapacity;  //< the number of slots (always a power of two)
+    std::size_t mMask;      //< mCapacity - 1 for mapping positions to slots
+    std::size_t mHead;      //< the slot of the oldest element
+    std::size_t mSize;      //< the number of elements in the buffer
+  };
+
+} /* end namespace pfabric */
+
+#endif
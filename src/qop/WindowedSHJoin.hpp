@@ -0,0 +1,476 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WindowedSHJoin_hpp_
+#define WindowedSHJoin_hpp_
+
+#include <algorithm>
+#include <cstdint>
+
+#include <boost/core/ignore_unused.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include "qop/BinaryTransform.hpp"
+#include "qop/JoinBuckets.hpp"
+#include "qop/Window.hpp"
+#include "ElementJoinTraits.hpp"
+#include "DefaultElementJoin.hpp"
+
+namespace pfabric {
+
+  /**
+   * \brief A symmetric hash join with built-in sliding windows on both inputs.
+   *
+   * In contrast to SHJoin which relies on preceding window operators sending
+   * outdated tuples, this operator maintains a sliding window per input itself:
+   * either a time-based window (the tuples of the last n seconds, based on the
+   * timestamps of the tuples) or a count-based window (the last n tuples of the
+   * input). An incoming tuple is joined with all tuples of the other input's
+   * window having the same key and satisfying the join predicate, then it is
+   * added to the window of its own input. Thus, each pair of tuples is joined
+   * exactly once and only new join results are published.
+   *
+   * For time-based windows two tuples are joined if one of them is within the
+   * window of the other input at the timestamp of the later tuple, i.e. a tuple
+   * probes the other input only around its own timestamp, regardless of the
+   * order in which the tuples arrive. The window of an input is expired by the
+   * progress of the other input: by the timestamps of its tuples (assuming that
+   * each input is ordered by timestamp) or, as soon as the first watermark
+   * arrives, only by its watermarks. Thus, tuples arriving out of order within
+   * the lateness of the watermarks still find their partners.
+   *
+   * The windows are stored in JoinBuckets, i.e. flat hash tables per time (or
+   * sequence number) bucket which are dropped as a whole as soon as the window
+   * has passed them. Therefore, the state is bounded by the window size plus one
+   * bucket, without any outdated tuple traffic. Outdated tuples arriving at the
+   * operator are ignored.
+   *
+   * Each input has its own punctuation channel (see getLeftInputPunctuationChannel
+   * and getRightInputPunctuationChannel), because a watermark of one input says
+   * nothing about the other one. The operator forwards the minimum of the
+   * watermarks of both inputs and an EndOfStream punctuation once both inputs
+   * have ended. Punctuations arriving at the shared punctuation channel of the
+   * BinaryTransform hold for both inputs.
+   *
+   * @tparam LeftInputStreamElement
+   *    the data stream element type from the left source
+   * @tparam RightInputStreamElement
+   *    the data stream element type from the right source
+   * @tparam KeyType
+   *    the data type of the join keys
+   * @tparam ElementJoinImpl
+   *    the actual join algorithm to be used for joining two input elements
+   */
+  template<
+  typename LeftInputStreamElement,
+  typename RightInputStreamElement,
+  typename KeyType = DefaultKeyType,
+  typename ElementJoinImpl = DefaultElementJoin< LeftInputStreamElement, RightInputStreamElement >
+  >
+  class WindowedSHJoin : public BinaryTransform<LeftInputStreamElement, RightInputStreamElement,
+  typename ElementJoinTraits< ElementJoinImpl >::ResultElement>{
+    private:
+      PFABRIC_BINARY_TRANSFORM_TYPEDEFS(LeftInputStreamElement, RightInputStreamElement, typename ElementJoinTraits< ElementJoinImpl >::ResultElement);
+
+    public:
+      /**
+       * Typedef for the key extractor functions.
+       */
+      typedef std::function<KeyType(const LeftInputStreamElement&)> LKeyExtractorFunc;
+      typedef std::function<KeyType(const RightInputStreamElement&)> RKeyExtractorFunc;
+
+      /**
+       * Typedef for the timestamp extractor functions.
+       */
+      typedef std::function<Timestamp(const LeftInputStreamElement&)> LTimestampExtractorFunc;
+      typedef std::function<Timestamp(const RightInputStreamElement&)> RTimestampExtractorFunc;
+
+      /**
+       * Typedef for the pointer to a function implementing the join predicate.
+       */
+      typedef std::function< bool(const LeftInputStreamElement&, const RightInputStreamElement&) > JoinPredicateFunc;
+
+      const std::string opName() const override { return std::string("WindowedSHJoin"); }
+
+      /// the number of buckets a window is divided into
+      static constexpr unsigned int BucketsPerWindow = 8;
+
+    private:
+      /// the windowed hash tables of both inputs
+      typedef JoinBuckets< KeyType, LeftInputStreamElement > LHashTable;
+      typedef JoinBuckets< KeyType, RightInputStreamElement > RHashTable;
+
+      /// the join algorithm to be used for concatenating the input elements
+      typedef ElementJoinTraits< ElementJoinImpl > ElementJoin;
+
+      /// a mutex for protecting join processing from concurrent sources
+      typedef boost::mutex JoinMutex;
+
+      /// a scoped lock for the mutex
+      typedef boost::lock_guard< JoinMutex > Lock;
+
+      /**
+       * \brief The sink receiving the punctuations of one input.
+       *
+       * The sink forwards the punctuations to the join operator together
+       * with the input they belong to.
+       */
+      template< bool Left >
+      class PunctuationInput : public Sink< InputChannelParameters< false, DefaultSlotFunction, PunctuationPtr > > {
+        typedef Sink< InputChannelParameters< false, DefaultSlotFunction, PunctuationPtr > > SinkBase;
+
+      public:
+        /// the input channel type for incoming punctuation tuples
+        IMPORT_INPUT_CHANNEL_TYPE( SinkBase, 0, InputPunctuationChannel );
+
+        PunctuationInput(WindowedSHJoin& join) : mJoin(join) {}
+
+        /**
+         * @brief Bind the callback for the punctuation channel.
+         */
+        BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, PunctuationInput, processPunctuation );
+
+        /**
+         * @brief Get a reference to the punctuation channel of the input.
+         */
+        InputPunctuationChannel& getInputPunctuationChannel() {
+          return SinkBase::template getInputChannelByID< 0 >();
+        }
+
+      private:
+        void processPunctuation( const PunctuationPtr& punctuation ) {
+          mJoin.processInputPunctuation( punctuation, Left, !Left );
+        }
+
+        WindowedSHJoin& mJoin; //< the join operator
+      };
+
+    public:
+
+      /// the join result for two input elements
+      typedef typename ElementJoin::ResultElement ResultElement;
+
+      /**
+       * Constructs a new windowed hash join operator with count-based windows.
+       *
+       * \param lKeyFunc function for extracting the join key of tuples of the lhs stream
+       * \param rKeyFunc function for extracting the join key of tuples of the rhs stream
+       * \param joinPred function pointer to a join predicate
+       * \param lSize the number of tuples in the window of the lhs stream
+       * \param rSize the number of tuples in the window of the rhs stream
+       */
+      WindowedSHJoin( LKeyExtractorFunc lKeyFunc, RKeyExtractorFunc rKeyFunc, JoinPredicateFunc joinPred,
+                      unsigned int lSize, unsigned int rSize) :
+        WindowedSHJoin(lKeyFunc, rKeyFunc, joinPred, WindowParams::RowWindow, lSize, rSize, nullptr, nullptr) {}
+
+      /**
+       * Constructs a new windowed hash join operator with time-based windows.
+       *
+       * \param lKeyFunc function for extracting the join key of tuples of the lhs stream
+       * \param rKeyFunc function for extracting the join key of tuples of the rhs stream
+       * \param joinPred function pointer to a join predicate
+       * \param lSize the window size of the lhs stream in seconds
+       * \param rSize the window size of the rhs stream in seconds
+       * \param lTsFunc function for extracting the timestamp of tuples of the lhs stream
+       * \param rTsFunc function for extracting the timestamp of tuples of the rhs stream
+       */
+      WindowedSHJoin( LKeyExtractorFunc lKeyFunc, RKeyExtractorFunc rKeyFunc, JoinPredicateFunc joinPred,
+                      unsigned int lSize, unsigned int rSize,
+                      LTimestampExtractorFunc lTsFunc, RTimestampExtractorFunc rTsFunc) :
+        WindowedSHJoin(lKeyFunc, rKeyFunc, joinPred, WindowParams::RangeWindow,
+                       std::uint64_t(lSize) * 1000 * 1000, std::uint64_t(rSize) * 1000 * 1000, lTsFunc, rTsFunc) {}
+
+      /**
+       * @brief Bind the callback for the left handside data channel.
+       */
+      BIND_INPUT_CHANNEL_DEFAULT( LeftInputChannel, WindowedSHJoin, processLeftDataElement );
+
+      /**
+       * @brief Bind the callback for the data channel.
+       */
+      BIND_INPUT_CHANNEL_DEFAULT( RightInputChannel, WindowedSHJoin, processRightDataElement );
+
+      /**
+       * @brief Bind the callback for the punctuation channel.
+       */
+      BIND_INPUT_CHANNEL_DEFAULT( InputPunctuationChannel, WindowedSHJoin, processPunctuation );
+
+      /**
+       * @brief Get a reference to the punctuation channel of the left input.
+       */
+      typename PunctuationInput< true >::InputPunctuationChannel& getLeftInputPunctuationChannel() {
+        return mLPunctuationInput.getInputPunctuationChannel();
+      }
+
+      /**
+       * @brief Get a reference to the punctuation channel of the right input.
+       */
+      typename PunctuationInput< false >::InputPunctuationChannel& getRightInputPunctuationChannel() {
+        return mRPunctuationInput.getInputPunctuationChannel();
+      }
+
+      /**
+       * Returns the number of tuples currently kept in the windows of both inputs.
+       *
+       * @return the number of tuples
+       */
+      std::size_t stateSize() const {
+        Lock lock( mMtx );
+        return mLTable.size() + mRTable.size();
+      }
+
+    private:
+      WindowedSHJoin( LKeyExtractorFunc lKeyFunc, RKeyExtractorFunc rKeyFunc, JoinPredicateFunc joinPred,
+                      WindowParams::WinType wt, std::uint64_t lSize, std::uint64_t rSize,
+                      LTimestampExtractorFunc lTsFunc, RTimestampExtractorFunc rTsFunc) :
+        mLTable(std::max<std::uint64_t>(lSize / BucketsPerWindow, 1)),
+        mRTable(std::max<std::uint64_t>(rSize / BucketsPerWindow, 1)),
+        mJoinPredicate(joinPred), mLKeyExtractor(lKeyFunc), mRKeyExtractor(rKeyFunc),
+        mLTimestampExtractor(lTsFunc), mRTimestampExtractor(rTsFunc),
+        mWinType(wt), mLWinSize(lSize), mRWinSize(rSize), mLCount(0), mRCount(0),
+        mLNow(0), mRNow(0), mLWatermark(0), mRWatermark(0), mWatermark(0), mUseWatermarks(false),
+        mLEnded(false), mREnded(false), mLPunctuationInput(*this), mRPunctuationInput(*this) {}
+
+      ////////////   channel callbacks   ////////////
+
+      /**
+       * @brief This method is invoked when a data stream element arrives from the left input channel.
+       *
+       * It joins the element with the window of the right input and inserts it
+       * into the window of the left input.
+       *
+       * @param[in] left
+       *    the incoming stream element from the left input channel
+       * @param[in] outdated
+       *    flag indicating whether the tuple is new or invalidated now (outdated tuples are ignored)
+       */
+      void processLeftDataElement( const LeftInputStreamElement& left, const bool outdated ) {
+        if (outdated)
+          return;
+        Lock lock( mMtx );
+
+        auto keyval = mLKeyExtractor( left );
+        if (mWinType == WindowParams::RangeWindow) {
+          const std::uint64_t ts = mLTimestampExtractor(left).count();
+          if (!mUseWatermarks)
+            advanceLeftTime(ts, lock);
+          mRTable.probe(keyval, minStamp(ts, mRWinSize), ts + mLWinSize - 1,
+                        [&](const RightInputStreamElement& right) { joinTuples(left, right); });
+          // a tuple which is already outside of the window is not stored
+          if (ts >= minStamp(mRNow, mLWinSize))
+            mLTable.insert(keyval, ts, left);
+        }
+        else {
+          mLTable.expire(minStamp(++mLCount, mLWinSize));
+          mRTable.probe(keyval, minStamp(mRCount, mRWinSize), UINT64_MAX,
+                        [&](const RightInputStreamElement& right) { joinTuples(left, right); });
+          mLTable.insert(keyval, mLCount, left);
+        }
+      }
+
+      /**
+       * @brief This method is invoked when a data stream element arrives from the right input channel.
+       *
+       * It joins the element with the window of the left input and inserts it
+       * into the window of the right input.
+       *
+       * @param[in] right
+       *    the incoming stream element from the right input channel
+       * @param[in] outdated
+       *    flag indicating whether the tuple is new or invalidated now (outdated tuples are ignored)
+       */
+      void processRightDataElement( const RightInputStreamElement& right, const bool outdated ) {
+        if (outdated)
+          return;
+        Lock lock( mMtx );
+
+        auto keyval = mRKeyExtractor( right );
+        if (mWinType == WindowParams::RangeWindow) {
+          const std::uint64_t ts = mRTimestampExtractor(right).count();
+          if (!mUseWatermarks)
+            advanceRightTime(ts, lock);
+          mLTable.probe(keyval, minStamp(ts, mLWinSize), ts + mRWinSize - 1,
+                        [&](const LeftInputStreamElement& left) { joinTuples(left, right); });
+          // a tuple which is already outside of the window is not stored
+          if (ts >= minStamp(mLNow, mRWinSize))
+            mRTable.insert(keyval, ts, right);
+        }
+        else {
+          mRTable.expire(minStamp(++mRCount, mRWinSize));
+          mLTable.probe(keyval, minStamp(mLCount, mLWinSize), UINT64_MAX,
+                        [&](const LeftInputStreamElement& left) { joinTuples(left, right); });
+          mRTable.insert(keyval, mRCount, right);
+        }
+      }
+
+      /**
+       * @brief This method is invoked when a punctuation arrives at the shared punctuation channel.
+       *
+       * The punctuation holds for both inputs.
+       *
+       * @param[in] punctuation
+       *    the incoming punctuation tuple
+       */
+      void processPunctuation( const PunctuationPtr& punctuation ) {
+        processInputPunctuation( punctuation, true, true );
+      }
+
+      /**
+       * @brief This method is invoked when a punctuation arrives from an input.
+       *
+       * A watermark advances the progress of its input and expires the window of
+       * the other input (for time-based windows). From the first watermark on, the
+       * windows are expired only by watermarks. The minimum of the watermarks of
+       * both inputs is forwarded if it has progressed, EndOfStream is forwarded
+       * once both inputs have ended and all other punctuations are forwarded directly.
+       *
+       * @param[in] punctuation
+       *    the incoming punctuation tuple
+       * @param[in] left
+       *    true if the punctuation holds for the left input
+       * @param[in] right
+       *    true if the punctuation holds for the right input
+       */
+      void processInputPunctuation( const PunctuationPtr& punctuation, bool left, bool right ) {
+        PunctuationPtr out;
+        {
+          Lock lock( mMtx );
+          if (punctuation->ptype() == Punctuation::Watermark) {
+            const std::uint64_t ts = punctuation->getTimestamp().count();
+            mUseWatermarks = true;
+            if (left && ts > mLWatermark) {
+              mLWatermark = ts;
+              if (mWinType == WindowParams::RangeWindow)
+                advanceLeftTime(ts, lock);
+            }
+            if (right && ts > mRWatermark) {
+              mRWatermark = ts;
+              if (mWinType == WindowParams::RangeWindow)
+                advanceRightTime(ts, lock);
+            }
+            const std::uint64_t wm = std::min(mLWatermark, mRWatermark);
+            if (wm > mWatermark) {
+              mWatermark = wm;
+              out = std::make_shared<Punctuation>(Punctuation::Watermark,
+                                                  Timestamp(static_cast<Timestamp::rep>(wm)));
+            }
+          }
+          else if (punctuation->ptype() == Punctuation::EndOfStream) {
+            const bool ended = mLEnded && mREnded;
+            mLEnded = mLEnded || left;
+            mREnded = mREnded || right;
+            if (!ended && mLEnded && mREnded)
+              out = punctuation;
+          }
+          else
+            out = punctuation;
+        }
+        if (out)
+          this->getOutputPunctuationChannel().publish( out );
+      }
+
+      ////////////   helper methods   ////////////
+
+      /**
+       * Returns the minimal stamp of a window with the given size ending at the given stamp.
+       */
+      static std::uint64_t minStamp(std::uint64_t now, std::uint64_t size) {
+        return now >= size ? now - size + 1 : 0;
+      }
+
+      /**
+       * @brief Advances the progress of the left input and expires the window of the right input.
+       *
+       * A right tuple is no longer needed as soon as no future left tuple can
+       * find it in the window of the right input.
+       *
+       * @param[in] ts
+       *    the timestamp of a tuple or watermark of the left input (in microseconds)
+       * @param[in] lock
+       *    reference to the lock protecting the hash tables
+       */
+      void advanceLeftTime(std::uint64_t ts, const Lock& lock) {
+        boost::ignore_unused( lock );
+        if (ts > mLNow) {
+          mLNow = ts;
+          mRTable.expire(minStamp(mLNow, mRWinSize));
+        }
+      }
+
+      /**
+       * @brief Advances the progress of the right input and expires the window of the left input.
+       *
+       * @param[in] ts
+       *    the timestamp of a tuple or watermark of the right input (in microseconds)
+       * @param[in] lock
+       *    reference to the lock protecting the hash tables
+       */
+      void advanceRightTime(std::uint64_t ts, const Lock& lock) {
+        boost::ignore_unused( lock );
+        if (ts > mRNow) {
+          mRNow = ts;
+          mLTable.expire(minStamp(mRNow, mLWinSize));
+        }
+      }
+
+      /**
+       * @brief Join two tuples and publish the result.
+       *
+       * This method joins two input tuples and produces a result if the join predicate matches.
+       *
+       * @param[in] left
+       *    the tuple from the left handside of the join
+       * @param[in] right
+       *    the tuple from the right handside of the join
+       */
+      void joinTuples( const LeftInputStreamElement& left, const RightInputStreamElement& right) {
+        if( mJoinPredicate( left, right ) ) {
+          ResultElement joinedTuple = ElementJoin::joinElements( left, right );
+          this->getOutputDataChannel().publish( joinedTuple, false );
+        }
+      }
+
+      LHashTable mLTable;                            //< windowed hash table for the lhs stream
+      RHashTable mRTable;                            //< windowed hash table for the rhs stream
+      JoinPredicateFunc mJoinPredicate;              //< a pointer to the function implementing the join predicate
+      LKeyExtractorFunc mLKeyExtractor;              //< key extractor for the lhs stream
+      RKeyExtractorFunc mRKeyExtractor;              //< key extractor for the rhs stream
+      LTimestampExtractorFunc mLTimestampExtractor;  //< timestamp extractor for the lhs stream (range windows)
+      RTimestampExtractorFunc mRTimestampExtractor;  //< timestamp extractor for the rhs stream (range windows)
+      WindowParams::WinType mWinType;                //< the type of both windows
+      std::uint64_t mLWinSize;                       //< the size of the lhs window (microseconds or tuples)
+      std::uint64_t mRWinSize;                       //< the size of the rhs window (microseconds or tuples)
+      std::uint64_t mLCount;                         //< the number of tuples of the lhs stream (row windows)
+      std::uint64_t mRCount;                         //< the number of tuples of the rhs stream (row windows)
+      std::uint64_t mLNow;                           //< the progress of the lhs stream (range windows)
+      std::uint64_t mRNow;                           //< the progress of the rhs stream (range windows)
+      std::uint64_t mLWatermark;                     //< the most recent watermark of the lhs stream
+      std::uint64_t mRWatermark;                     //< the most recent watermark of the rhs stream
+      std::uint64_t mWatermark;                      //< the most recent watermark forwarded
+      bool mUseWatermarks;                           //< true if the windows are expired only by watermarks
+      bool mLEnded;                                  //< true if the lhs stream has ended
+      bool mREnded;                                  //< true if the rhs stream has ended
+      PunctuationInput< true > mLPunctuationInput;   //< the punctuation channel of the lhs stream
+      PunctuationInput< false > mRPunctuationInput;  //< the punctuation channel of the rhs stream
+      mutable JoinMutex mMtx;
+    };
+
+} /* end namespace pfabric */
+
+
+#endif
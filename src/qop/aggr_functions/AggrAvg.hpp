@@ -71,6 +71,14 @@ public:
         }
     }
 
+    /**
+     * Merges a partial average (i.e. its sum and count) into this one.
+     */
+    void combine(const AggrAvg& other) {
+        mCount += other.mCount;
+        mSum += other.mSum;
+    }
+
 	virtual Tres value() override {
         return mSum / mCount;
     }
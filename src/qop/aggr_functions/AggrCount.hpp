@@ -64,6 +64,13 @@ public:
  		mCount += (outdated ? -1 : 1);
 	}
 
+	/**
+	 * Merges a partial count into this one.
+	 */
+	void combine(const AggrCount& other) {
+		mCount += other.mCount;
+	}
+
 	virtual Tres value() override {
 		return mCount;
 	}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGGRCOUNTMIN_HPP_
+#define AGGRCOUNTMIN_HPP_
+
+#include "AggregateFunc.hpp"
+#include "SketchHash.hpp"
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+
+
+namespace pfabric {
+
+/**
+ * @brief An approximate frequency aggregation function based on a Count-Min sketch.
+ *
+ * The Count-Min sketch (Cormode, Muthukrishnan) consists of Depth rows of
+ * Width counters. Each value increments one counter per row, selected by a
+ * row-specific hash function. The frequency of a value is estimated by the
+ * minimum of its counters which never underestimates the frequency and
+ * overestimates it by at most e / Width * N with probability 1 - e^-Depth,
+ * where N is the number of values. In contrast to counting each key by a
+ * groupBy, the memory is fixed (16 KB for the defaults) independently of the
+ * number of distinct values.
+ *
+ * Outdated values decrement their counters, thus the sketch can be used for
+ * sliding windows. Two sketches are merged by adding their counters.
+ *
+ * The result of the aggregation is the estimated frequency of the value which
+ * was added last (outdated values do not change it), e.g. the frequency of the
+ * key of the current tuple in the window. After a combine it refers to the last
+ * value of the combined partial sketch, if that one has added any value. The
+ * frequency of arbitrary values is available by @c estimate.
+ *
+ * @tparam Tin
+ *    the type of the input argument
+ * @tparam Tres
+ *    the type of the result (must be convertible from an unsigned integer)
+ * @tparam Width
+ *    the number of counters per row (a power of two)
+ * @tparam Depth
+ *    the number of rows
+ */
+template<
+	typename Tin,
+	typename Tres = unsigned long,
+	unsigned int Width = 1024,
+	unsigned int Depth = 4
+>
+class AggrCountMin :
+	public AggregateFunc< Tin, Tres >
+{
+private:
+	static_assert( Width > 0 && (Width & (Width - 1)) == 0, "width must be a power of two" );
+	static_assert( Depth > 0, "depth must be at least 1" );
+
+	/// the result is derived from a counter
+	static_assert( std::is_convertible< std::uint32_t, Tres >::value,
+		"result type must be convertible from an unsigned integer"
+	);
+
+public:
+
+    AggrCountMin() {
+        init();
+    }
+
+	virtual void init() override {
+        for (auto& row : mCounters)
+            row.fill(0);
+        mTotal = 0;
+        mLast = Tin();
+        mHasLast = false;
+    }
+
+	virtual void iterate(Tin const& data, bool outdated = false) override {
+        const std::uint64_t h = sketchHash(data);
+        for (unsigned int i = 0; i < Depth; i++) {
+            auto& cnt = mCounters[i][index(h, i)];
+            if (outdated) {
+                if (cnt > 0)
+                    cnt--;
+            }
+            else
+                cnt++;
+        }
+        if (outdated) {
+            if (mTotal > 0)
+                mTotal--;
+        }
+        else {
+            mTotal++;
+            mLast = data;
+            mHasLast = true;
+        }
+    }
+
+	/**
+	 * Adds the counters of a partial sketch to this one. The partial sketch is
+	 * assumed to cover the more recent values, i.e. its last value is taken over.
+	 */
+	void combine(const AggrCountMin& other) {
+        for (unsigned int i = 0; i < Depth; i++) {
+            for (unsigned int j = 0; j < Width; j++)
+                mCounters[i][j] += other.mCounters[i][j];
+        }
+        mTotal += other.mTotal;
+        if (other.mHasLast) {
+            mLast = other.mLast;
+            mHasLast = true;
+        }
+    }
+
+	/**
+	 * Returns the estimated frequency of the given value.
+	 */
+	Tres estimate(Tin const& data) const {
+        const std::uint64_t h = sketchHash(data);
+        std::uint32_t res = mCounters[0][index(h, 0)];
+        for (unsigned int i = 1; i < Depth; i++) {
+            if (mCounters[i][index(h, i)] < res)
+                res = mCounters[i][index(h, i)];
+        }
+        return static_cast<Tres>(res);
+    }
+
+	/**
+	 * Returns the number of values represented by the sketch.
+	 */
+	std::uint64_t count() const { return mTotal; }
+
+	virtual Tres value() override {
+        return mHasLast && mTotal > 0 ? estimate(mLast) : Tres(0);
+    }
+
+private:
+    /**
+     * Returns the counter of row i for the (mixed) hash value h. The row hash
+     * functions are derived from the two halves of h (double hashing).
+     */
+    static std::uint32_t index(std::uint64_t h, unsigned int i) {
+        const std::uint32_t h1 = static_cast<std::uint32_t>(h);
+        const std::uint32_t h2 = static_cast<std::uint32_t>(h >> 32) | 1;
+        return (h1 + i * h2) & (Width - 1);
+    }
+
+	std::array<std::array<std::uint32_t, Width>, Depth> mCounters; //< the counters of the sketch
+	std::uint64_t mTotal;                                           //< the number of values
+	Tin mLast;                                                      //< the value added last
+	bool mHasLast;                                                  //< true if mLast was set
+};
+
+} /* end namespace pfabric */
+
+
+#endif /* AGGRCOUNTMIN_HPP_ */
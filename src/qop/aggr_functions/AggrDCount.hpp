@@ -80,6 +80,14 @@ public:
         }
     }
 
+	/**
+	 * Merges the value counters of a partial distinct count into this one.
+	 */
+	void combine(const AggrDCount& other) {
+        for (const auto& entry : other.dCountElements)
+            this->dCountElements[entry.first] += entry.second;
+    }
+
 	virtual Tres value() override {
         return this->dCountElements.size();
     }
@@ -53,6 +53,13 @@ public:
         mMax = std::max(mMax, data);
     }
 
+    /**
+     * Merges a partial maximum into this one.
+     */
+    void combine(const AggrGlobalMax& other) {
+        mMax = std::max(mMax, other.mMax);
+    }
+
     virtual Tin value() override {
         return mMax;
     }
@@ -53,6 +53,13 @@ public:
         mMin = std::min(mMin, data);
     }
 
+    /**
+     * Merges a partial minimum into this one.
+     */
+    void combine(const AggrGlobalMin& other) {
+        mMin = std::min(mMin, other.mMin);
+    }
+
     virtual Tin value() override {
         return mMin;
     }
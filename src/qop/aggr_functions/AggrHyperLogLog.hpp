@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGGRHYPERLOGLOG_HPP_
+#define AGGRHYPERLOGLOG_HPP_
+
+#include "AggregateFunc.hpp"
+#include "SketchHash.hpp"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+
+
+namespace pfabric {
+
+/**
+ * @brief An approximate distinct counting aggregation function based on HyperLogLog.
+ *
+ * In contrast to AggrDCount which keeps all distinct values, the HyperLogLog
+ * sketch uses a fixed number of 2^Precision one-byte registers. Each value is
+ * hashed, the first Precision bits of the hash select a register which keeps
+ * the maximal number of leading zeros (+1) of the remaining bits. The standard
+ * error of the estimate is about 1.04 / sqrt(2^Precision), i.e. 1.6% for the
+ * default of 4 KB. Two sketches are merged by taking the maximum of each
+ * register, thus partial aggregates can be combined without loss.
+ *
+ * Values cannot be removed from the sketch, i.e. outdated elements are not
+ * supported.
+ *
+ * @tparam Tin
+ *    the type of the input argument
+ * @tparam Tres
+ *    the type of the result (must be convertible from double)
+ * @tparam Precision
+ *    the number of hash bits used for selecting a register (4..18)
+ */
+template<
+	typename Tin,
+	typename Tres = unsigned long,
+	unsigned int Precision = 12
+>
+class AggrHyperLogLog :
+	public AggregateFunc< Tin, Tres >
+{
+private:
+	static_assert( Precision >= 4 && Precision <= 18, "precision must be in 4..18" );
+
+	/// the result is derived from a floating point estimate
+	static_assert( std::is_convertible< double, Tres >::value,
+		"result type must be convertible from double"
+	);
+
+	/// the number of registers
+	static constexpr std::size_t NumRegisters = std::size_t(1) << Precision;
+
+public:
+
+    AggrHyperLogLog() {
+        init();
+    }
+
+	virtual void init() override {
+        mRegisters.fill(0);
+    }
+
+	virtual void iterate(Tin const& data, bool outdated = false) override {
+        assert(!outdated);
+        const std::uint64_t h = sketchHash(data);
+        const std::size_t idx = h >> (64 - Precision);
+        // a guard bit limits the rank to 64 - Precision + 1
+        const std::uint64_t rest = (h << Precision) | (std::uint64_t(1) << (Precision - 1));
+        const std::uint8_t rank = static_cast<std::uint8_t>(__builtin_clzll(rest) + 1);
+        if (rank > mRegisters[idx])
+            mRegisters[idx] = rank;
+    }
+
+	/**
+	 * Merges the registers of a partial sketch into this one.
+	 */
+	void combine(const AggrHyperLogLog& other) {
+        for (std::size_t i = 0; i < NumRegisters; i++) {
+            if (other.mRegisters[i] > mRegisters[i])
+                mRegisters[i] = other.mRegisters[i];
+        }
+    }
+
+	virtual Tres value() override {
+        const double m = NumRegisters;
+        double sum = 0.0;
+        std::size_t zeros = 0;
+        for (auto r : mRegisters) {
+            sum += std::ldexp(1.0, -r);
+            if (r == 0)
+                zeros++;
+        }
+        double estimate = alpha() * m * m / sum;
+        // use linear counting for small cardinalities
+        if (estimate <= 2.5 * m && zeros > 0)
+            estimate = m * std::log(m / zeros);
+        return static_cast<Tres>(std::round(estimate));
+    }
+
+private:
+    /**
+     * Returns the bias correction constant for the number of registers.
+     */
+    static double alpha() {
+        switch (NumRegisters) {
+            case 16: return 0.673;
+            case 32: return 0.697;
+            case 64: return 0.709;
+            default: return 0.7213 / (1.0 + 1.079 / NumRegisters);
+        }
+    }
+
+	std::array<std::uint8_t, NumRegisters> mRegisters; //< the registers of the sketch
+};
+
+} /* end namespace pfabric */
+
+
+#endif /* AGGRHYPERLOGLOG_HPP_ */
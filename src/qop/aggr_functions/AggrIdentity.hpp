@@ -51,6 +51,13 @@ public:
  	  mValue = data;
 	}
 
+	/**
+	 * Merges a partial aggregate covering more recent values into this one.
+	 */
+	void combine(const AggrIdentity& other) {
+		mValue = other.mValue;
+	}
+
 	virtual T value() override {
 		return mValue;
 	}
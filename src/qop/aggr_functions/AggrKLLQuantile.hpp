@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGGRKLLQUANTILE_HPP_
+#define AGGRKLLQUANTILE_HPP_
+
+#include "AggregateFunc.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+namespace pfabric {
+
+/**
+ * @brief An approximate quantile aggregation function based on the KLL sketch.
+ *
+ * In contrast to AggrMedian which keeps all values of the stream, the KLL
+ * sketch (Karnin, Lang, Liberty: Optimal Quantile Approximation in Streams)
+ * keeps a hierarchy of compactors. A value inserted at level h represents 2^h
+ * values of the stream. If a level exceeds its capacity, it is sorted and every
+ * second value is promoted to the next level. The capacities shrink by the
+ * factor 2/3 from the top level downwards, thus the sketch retains at most
+ * about 3 * K values independently of the stream length, and the rank error
+ * is roughly 1.7 / K. Sketches are merged by concatenating their levels and
+ * compacting the result, thus partial aggregates can be combined.
+ *
+ * Values cannot be removed from the sketch, i.e. outdated elements are not
+ * supported.
+ *
+ * @tparam Tin
+ *    the type of the input argument (has to be ordered by operator<)
+ * @tparam Tres
+ *    the type of the result (must be convertible from Tin)
+ * @tparam Percent
+ *    the quantile to be calculated in percent (50 = median)
+ * @tparam K
+ *    the capacity of the top level which determines accuracy and size
+ */
+template<
+	typename Tin,
+	typename Tres = Tin,
+	unsigned int Percent = 50,
+	unsigned int K = 200
+>
+class AggrKLLQuantile :
+	public AggregateFunc< Tin, Tres >
+{
+private:
+	static_assert( Percent <= 100, "the quantile must be given in percent (0..100)" );
+	static_assert( K >= 8, "the capacity K is too small" );
+
+	/// the values of a single level
+	typedef std::vector<Tin> Compactor;
+
+public:
+
+    AggrKLLQuantile() {
+        init();
+    }
+
+	virtual void init() override {
+        mCompactors.assign(1, Compactor());
+        mSize = 0;
+        mCount = 0;
+        mOffset = 0;
+        mMaxSize = capacity(0);
+    }
+
+	virtual void iterate(Tin const& data, bool outdated = false) override {
+        assert(!outdated);
+        mCompactors[0].push_back(data);
+        mCount++;
+        if (++mSize >= mMaxSize)
+            compress();
+    }
+
+	/**
+	 * Merges the levels of a partial sketch into this one.
+	 */
+	void combine(const AggrKLLQuantile& other) {
+        while (mCompactors.size() < other.mCompactors.size())
+            grow();
+        for (std::size_t h = 0; h < other.mCompactors.size(); h++)
+            mCompactors[h].insert(mCompactors[h].end(),
+                                  other.mCompactors[h].begin(), other.mCompactors[h].end());
+        mCount += other.mCount;
+        mSize = retained();
+        while (mSize >= mMaxSize)
+            compress();
+    }
+
+	virtual Tres value() override {
+        std::vector<std::pair<Tin, std::uint64_t>> items;
+        items.reserve(mSize);
+        std::uint64_t total = 0;
+        for (std::size_t h = 0; h < mCompactors.size(); h++) {
+            const std::uint64_t weight = std::uint64_t(1) << h;
+            for (const auto& v : mCompactors[h])
+                items.emplace_back(v, weight);
+            total += weight * mCompactors[h].size();
+        }
+        if (items.empty())
+            return Tres();
+
+        std::sort(items.begin(), items.end(),
+                  [](const std::pair<Tin, std::uint64_t>& a, const std::pair<Tin, std::uint64_t>& b) {
+                      return a.first < b.first;
+                  });
+        const double target = Percent / 100.0 * total;
+        std::uint64_t cum = 0;
+        for (const auto& item : items) {
+            cum += item.second;
+            if (cum >= target)
+                return item.first;
+        }
+        return items.back().first;
+    }
+
+	/**
+	 * Returns the number of values retained by the sketch.
+	 */
+	std::size_t numRetained() const { return mSize; }
+
+	/**
+	 * Returns the number of values added to the sketch.
+	 */
+	std::uint64_t count() const { return mCount; }
+
+private:
+    /**
+     * Returns the capacity of the given level which depends on its distance
+     * to the top level.
+     */
+    std::size_t capacity(std::size_t level) const {
+        const auto depth = mCompactors.size() - level - 1;
+        return static_cast<std::size_t>(std::ceil(std::pow(2.0 / 3.0, depth) * K)) + 1;
+    }
+
+    /**
+     * Adds a new top level and recomputes the maximal size.
+     */
+    void grow() {
+        mCompactors.emplace_back();
+        mMaxSize = 0;
+        for (std::size_t h = 0; h < mCompactors.size(); h++)
+            mMaxSize += capacity(h);
+    }
+
+    std::size_t retained() const {
+        std::size_t n = 0;
+        for (const auto& c : mCompactors)
+            n += c.size();
+        return n;
+    }
+
+    /**
+     * Compacts the levels exceeding their capacity (from the bottom) until
+     * the sketch is below its maximal size again.
+     */
+    void compress() {
+        for (std::size_t h = 0; h < mCompactors.size(); h++) {
+            if (mCompactors[h].size() >= capacity(h)) {
+                if (h + 1 >= mCompactors.size())
+                    grow();
+                compact(h);
+                mSize = retained();
+                if (mSize < mMaxSize)
+                    break;
+            }
+        }
+    }
+
+    /**
+     * Sorts the given level and promotes every second value to the next level.
+     * The offset alternates between compactions to avoid a systematic bias.
+     * For an odd number of values the largest one stays at the level.
+     */
+    void compact(std::size_t level) {
+        Compactor& c = mCompactors[level];
+        Compactor& next = mCompactors[level + 1];
+        std::sort(c.begin(), c.end());
+        const std::size_t n = c.size() & ~std::size_t(1);
+        for (std::size_t i = mOffset; i < n; i += 2)
+            next.push_back(c[i]);
+        c.erase(c.begin(), c.begin() + n);
+        mOffset ^= 1;
+    }
+
+	std::vector<Compactor> mCompactors; //< the levels of the sketch, level h has the weight 2^h
+	std::size_t mSize;                  //< the number of values retained in all levels
+	std::size_t mMaxSize;               //< the sum of the capacities of all levels
+	std::uint64_t mCount;               //< the number of values added to the sketch
+	unsigned int mOffset;               //< the offset (0/1) used for the next compaction
+};
+
+} /* end namespace pfabric */
+
+
+#endif /* AGGRKLLQUANTILE_HPP_ */
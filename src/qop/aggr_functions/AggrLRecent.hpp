@@ -63,6 +63,13 @@ public:
         }
     }
 
+    /**
+     * Merges a partial aggregate covering more recent values into this one.
+     */
+    void combine(const AggrLRecent& other) {
+        mData.insert(mData.end(), other.mData.begin(), other.mData.end());
+    }
+
     virtual Tin value() override {
     	assert( !mData.empty() );
         return mData.front();
@@ -71,6 +71,16 @@ public:
 		}
 	}
 
+	/**
+	 * Merges a partial aggregate covering more recent values into this one.
+	 */
+	void combine(const AggrMRecent& other) {
+		if (other.mMostRecentTime >= mMostRecentTime) {
+			mVal = other.mVal;
+			mMostRecentTime = other.mMostRecentTime;
+		}
+	}
+
 	virtual Tin value() override {
         return mVal;
     }
@@ -145,6 +145,17 @@ public:
         }
     }
 
+	/**
+	 * Merges the values of a partial median into this one. Note, that this
+	 * requires to insert all values of @c other and is therefore linear in
+	 * the number of distinct values.
+	 */
+	void combine(const AggrMedian& other) {
+        for (const auto& entry : other.mapElement)
+            for (Count i = 0; i < entry.second; i++)
+                this->iterate(entry.first, false);
+    }
+
 	virtual Tres value() override {
         if(this->total == 0) {
             return 0.0;
@@ -82,6 +82,14 @@ public:
         }
     }
 
+    /**
+     * Merges the value counters of a partial extremum into this one.
+     */
+    void combine(const AggrMinMax& other) {
+        for (const auto& entry : other.mMap)
+            mMap[entry.first] += entry.second;
+    }
+
 	virtual Tin value() override {
         typename ValueCounters::const_iterator it;
         it = mMap.begin();
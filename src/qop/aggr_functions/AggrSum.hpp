@@ -50,6 +50,13 @@ public:
         mSum += (outdated ? -data : data);
     }
 
+    /**
+     * Merges a partial sum into this one.
+     */
+    void combine(const AggrSum& other) {
+        mSum += other.mSum;
+    }
+
     virtual Tin value() override {
         return mSum;
     }
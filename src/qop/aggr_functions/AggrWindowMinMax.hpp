@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGGRWINDOWMINMAX_HPP_
+#define AGGRWINDOWMINMAX_HPP_
+
+#include "AggregateFunc.hpp"
+#include "qop/WindowBuffer.hpp"
+
+#include <cassert>
+
+
+namespace pfabric {
+
+/**
+ * @brief An aggregation function for calculating an extremum in a FIFO sliding window.
+ *
+ * In contrast to AggrMinMax which maintains a counter for each distinct value
+ * in an ordered map, this function requires that outdated values arrive in the
+ * same order as they were inserted (which is the case for row windows and range
+ * windows not driven by watermarks). Then, it is sufficient to keep a monotonic
+ * deque of the values which can still become the extremum: a new value removes
+ * all values at the back which it dominates, and an outdated value is removed
+ * from the front if it is the current extremum. Thus, updates take O(1) amortized
+ * time and the values are kept in a ring buffer without any allocation per value.
+ *
+ * @tparam Tin
+ *    the type of the input argument
+ * @tparam Comparator
+ *    the comparator to be used for ordering elements (std::less = minimum,
+ *    std::greater = maximum)
+ */
+template<
+	typename Tin,
+	class Comparator
+>
+class AggrWindowMinMax :
+	public AggregateFunc< Tin, Tin >
+{
+public:
+
+    AggrWindowMinMax() {
+        init();
+    }
+
+	virtual void init() override {
+        mDeque.clear();
+    }
+
+	virtual void iterate(Tin const& data, bool outdated = false) override {
+        if (outdated) {
+            // the oldest value of the window expires: it is still in the deque
+            // only if it is the current extremum
+            if (!mDeque.empty() && !mCmp(mDeque.front(), data) && !mCmp(data, mDeque.front()))
+                mDeque.pop_front();
+        }
+        else {
+            // values dominated by the new one can never become the extremum
+            while (!mDeque.empty() && mCmp(data, mDeque.back()))
+                mDeque.pop_back();
+            mDeque.push_back(data);
+        }
+    }
+
+    /**
+     * Merges a partial extremum covering more recent values into this one.
+     */
+    void combine(const AggrWindowMinMax& other) {
+        for (const auto& v : other.mDeque)
+            iterate(v);
+    }
+
+	virtual Tin value() override {
+        assert(!mDeque.empty());
+        return mDeque.front();
+    }
+
+private:
+	WindowBuffer<Tin> mDeque; //< the candidates for the extremum, the current one at the front
+	Comparator mCmp;          //< the comparator for the values
+};
+
+} /* end namespace pfabric */
+
+
+#endif /* AGGRWINDOWMINMAX_HPP_ */
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SKETCHHASH_HPP_
+#define SKETCHHASH_HPP_
+
+#include <cstdint>
+
+#include <boost/functional/hash.hpp>
+
+
+namespace pfabric {
+
+/**
+ * @brief Computes the hash value of a value for the sketch-based aggregate functions.
+ *
+ * The bits of the boost::hash value are scrambled by the fmix64 step of MurmurHash3,
+ * because boost::hash maps integers to themselves.
+ *
+ * @param data
+ *    the value to be hashed
+ * @return the 64 bit hash value
+ */
+template< typename T >
+inline std::uint64_t sketchHash( const T& data ) {
+    std::uint64_t h = boost::hash< T >()( data );
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} /* end namespace pfabric */
+
+
+#endif /* SKETCHHASH_HPP_ */
@@ -152,6 +152,9 @@ class BDCCPTable : public BaseTable {
   /** typedef for a callback function which is invoked when the table was updated */
   using ObserverCallback = boost::signals2::signal<void(const RecordType &, TableParams::ModificationMode)>;
 
+  /** typedef for a callback function which is invoked when all tuples were deleted */
+  using TruncateCallback = boost::signals2::signal<void()>;
+
   /** typedef for an iterator to scan the table */
   using TableIterator = BDCCPIterator<KeyType, RecordType>;
 
@@ -347,17 +350,30 @@ class BDCCPTable : public BaseTable {
    *
    * \param cb the observer (slot)
    * \param mode the nofication mode (immediate or defered)
+   * \return the connection of the observer which can be used to unregister it
    *****************************************************************************/
-  void registerObserver(typename ObserverCallback::slot_type const &cb,
+  boost::signals2::connection registerObserver(typename ObserverCallback::slot_type const &cb,
                         TableParams::NotificationMode mode) {
     switch (mode) {
-      case TableParams::Immediate:mImmediateObservers.connect(cb);
-        break;
-      case TableParams::OnCommit:mDeferredObservers.connect(cb);
-        break;
+      case TableParams::Immediate:return mImmediateObservers.connect(cb);
+      case TableParams::OnCommit:
+      default:return mDeferredObservers.connect(cb);
     }
   }
 
+  /************************************************************************//**
+   * \brief Register an observer of truncates
+   *
+   * Registers an observer (a slot) which is notified once if all tuples of the
+   * table are deleted by truncate or drop.
+   *
+   * \param cb the observer (slot)
+   * \return the connection of the observer which can be used to unregister it
+   *****************************************************************************/
+  boost::signals2::connection registerTruncateObserver(typename TruncateCallback::slot_type const &cb) {
+    return mTruncateObservers.connect(cb);
+  }
+
   void drop() {
     auto pop = pool_by_pptr(q);
     transaction::run(pop, [&] {
@@ -369,6 +385,7 @@ class BDCCPTable : public BaseTable {
     pop.close();
     //pmempool_rm((pfabric::gPmemPath + BaseTable::mTableInfo->tableName() + ".db").c_str(), 1);
     std::remove((BaseTable::mTableInfo->tableName()+".db").c_str());
+    mTruncateObservers();
   }
 
   void truncate() {
@@ -378,6 +395,7 @@ class BDCCPTable : public BaseTable {
       q->pTable = make_persistent<PTableType>();
       pTable = q->pTable;
     });
+    mTruncateObservers();
   }
 
   void print() {
@@ -429,6 +447,7 @@ class BDCCPTable : public BaseTable {
   persistent_ptr<struct root> q;
   persistent_ptr<PTableType> pTable;
   ObserverCallback mImmediateObservers, mDeferredObservers;
+  TruncateCallback mTruncateObservers;
 
 }; /* class BDCCPTable */
 
@@ -91,6 +91,9 @@ inline CuckooIterator<Iter> makeCuckooIterator(Iter j, Iter e,
 template <typename RecordType, typename KeyType = DefaultKeyType>
 class CuckooTable : public BaseTable {
 public:
+  using RType = RecordType;
+  using KType = KeyType;
+
   static_assert(is_tuple<RecordType>::value, "Value type must be a pfabric::Tuple");
   using TupleType = typename RecordType::Base;
 
@@ -110,6 +113,9 @@ public:
   //< typedef for a callback function which is invoked when the table was updated
   typedef boost::signals2::signal<void (const RecordType&, TableParams::ModificationMode)> ObserverCallback;
 
+  //< typedef for a callback function which is invoked when all tuples were deleted
+  typedef boost::signals2::signal<void ()> TruncateCallback;
+
   //< typedef for an iterator to scan the table
   typedef CuckooIterator<typename TableMap::locked_table::iterator> TableIterator;
 
@@ -167,11 +173,11 @@ public:
   unsigned long deleteByKey(KeyType key) {
     try {
       auto res = mDataTable.find(key);
-      // if the key exists: notify our observers
+      // if the key exists: delete the tuples
+      mDataTable.erase_fn(key, [](RecordType r){return true;});
+      // and notify our observers afterwards
       if (!mImmediateObservers.empty())
         notifyObservers(res, TableParams::Delete, TableParams::Immediate);
-      // and delete the tuples
-      mDataTable.erase_fn(key, [](RecordType r){return true;});
     } catch(std::out_of_range &e) {
       return 0;
     }
@@ -194,8 +200,10 @@ public:
     for(auto &it : lt) {
       // and check the predicate
       if (func(it.second)) {
-        notifyObservers(it.second, TableParams::Delete, TableParams::Immediate);
+        // the observers are notified after the tuple was deleted
+        RecordType rec = it.second;
         mDataTable.erase_fn(it.first, [](RecordType r){return true;});
+        notifyObservers(rec, TableParams::Delete, TableParams::Immediate);
         num++;
       }
     }
@@ -229,7 +237,7 @@ public:
         num = mDataTable.erase_fn(key, [](RecordType r){return true;});
         mode = TableParams::Delete;
       }
-      // notify the observers
+      // notify the observers (res is a copy, thus it is still valid after a delete)
       notifyObservers(res, mode, TableParams::Immediate);
       return num;
     } else {
@@ -319,6 +327,24 @@ public:
     return false;
   }
 
+  /**
+   * @brief Apply a function to the tuple associated with the given key.
+   *
+   * In contrast to getByKey, no SmartPtr is allocated: the function is invoked
+   * with a tuple constructed on the stack while the bucket of the key is locked.
+   *
+   * @param key the key value
+   * @param func the function invoked with the tuple
+   * @return false if the key doesn't exist
+   */
+  template <typename Func>
+  bool findByKey(const KeyType& key, Func&& func) const {
+    return mDataTable.find_fn(key, [&func](const TupleType& tt) {
+      const RecordType rec(tt);
+      func(rec);
+    });
+  }
+
 
 
   /**
@@ -375,26 +401,46 @@ public:
    *
    * @param cb the observer (slot)
    * @param mode the nofication mode (immediate or defered)
+   * @return the connection of the observer which can be used to unregister it
    */
-  void registerObserver(typename ObserverCallback::slot_type const& cb,
+  boost::signals2::connection registerObserver(typename ObserverCallback::slot_type const& cb,
     TableParams::NotificationMode mode) {
       switch (mode) {
         case TableParams::Immediate:
-          mImmediateObservers.connect(cb);
-          break;
+          return mImmediateObservers.connect(cb);
         case TableParams::OnCommit:
-          mDeferredObservers.connect(cb);
-          break;
+        default:
+          return mDeferredObservers.connect(cb);
       }
   }
 
+  /**
+   * @brief Register an observer of truncates
+   *
+   * Registers an observer (a slot) which is notified once if all tuples of the
+   * table are deleted by @c truncate or @c drop. The deleted tuples are not
+   * reported to the observers registered by @c registerObserver.
+   *
+   * @param cb the observer (slot)
+   * @return the connection of the observer which can be used to unregister it
+   */
+  boost::signals2::connection registerTruncateObserver(typename TruncateCallback::slot_type const& cb) {
+    return mTruncateObservers.connect(cb);
+  }
+
   void drop() {
-    mDataTable.clear();
+    truncate();
     //mDataTable = nullptr;
   }
 
+  /**
+   * @brief Delete all tuples.
+   *
+   * Delete all tuples from the table and notify the truncate observers once.
+   */
   void truncate() {
     mDataTable.clear();
+    mTruncateObservers();
   }
 
 private:
@@ -420,6 +466,7 @@ private:
 
   TableMap mDataTable;     //< the actual table structure (a hash map)
   ObserverCallback mImmediateObservers, mDeferredObservers;
+  TruncateCallback mTruncateObservers;
 };
 
 }
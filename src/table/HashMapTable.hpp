@@ -90,6 +90,9 @@ inline HashMapIterator<Iter> makeHashMapIterator(Iter j, Iter e,
 template <typename RecordType, typename KeyType = DefaultKeyType>
 class HashMapTable : public BaseTable {
 public:
+  using RType = RecordType;
+  using KType = KeyType;
+
   //< the actual implementation of the table
   typedef std::unordered_map<KeyType, RecordType> TableMap;
 
@@ -106,6 +109,9 @@ public:
   //< typedef for a callback function which is invoked when the table was updated
   typedef boost::signals2::signal<void (const RecordType&, TableParams::ModificationMode)> ObserverCallback;
 
+  //< typedef for a callback function which is invoked when all tuples were deleted
+  typedef boost::signals2::signal<void ()> TruncateCallback;
+
   //< typedef for an iterator to scan the table
   typedef HashMapIterator<typename TableMap::iterator> TableIterator;
 
@@ -169,11 +175,14 @@ public:
       //std::lock_guard<std::mutex> lock(mMtx);
       auto res = mDataTable.find(key);
       if (res != mDataTable.end()) {
-        // if the key exists: notify our observers
-        if (!mImmediateObservers.empty())
-          notifyObservers(res->second, TableParams::Delete, TableParams::Immediate);
-        // and delete the tuples
-        nres = mDataTable.erase(key);
+        if (mImmediateObservers.empty())
+          nres = mDataTable.erase(key);
+        else {
+          // if the key exists: delete the tuples and notify our observers afterwards
+          RecordType rec = res->second;
+          nres = mDataTable.erase(key);
+          notifyObservers(rec, TableParams::Delete, TableParams::Immediate);
+        }
       }
     }
     return nres;
@@ -197,8 +206,10 @@ public:
     for(auto it = mDataTable.begin(); it != mDataTable.end(); ) {
       // and check the predicate
       if (func(it->second)) {
-        notifyObservers(it->second, TableParams::Delete, TableParams::Immediate);
+        // the observers are notified after the tuple was deleted
+        RecordType rec = it->second;
         it = mDataTable.erase(it);
+        notifyObservers(rec, TableParams::Delete, TableParams::Immediate);
         num++;
       }
       else
@@ -233,14 +244,18 @@ public:
       auto upd = ufunc(res->second);
 
       // check whether we have to perform an update ...
-      if (!upd) {
-        // or a delete
+      if (upd) {
+        //lock.unlock();
+        // notify the observers
+        notifyObservers(res->second, mode, TableParams::Immediate);
+      }
+      else {
+        // or a delete: the observers are notified after the tuple was deleted
+        RecordType rec = res->second;
         num = mDataTable.erase(key);
         mode = TableParams::Delete;
+        notifyObservers(rec, mode, TableParams::Immediate);
       }
-      //lock.unlock();
-      // notify the observers
-      notifyObservers(res->second, mode, TableParams::Immediate);
       return num;
     }
     else {
@@ -339,6 +354,26 @@ public:
       throw TableException("key not found");
   }
 
+  /**
+   * @brief Apply a function to the tuple associated with the given key.
+   *
+   * In contrast to getByKey, the tuple is not copied: the function is invoked
+   * with a reference to the tuple stored in the table which is valid only
+   * during the call.
+   *
+   * @param key the key value
+   * @param func the function invoked with the tuple
+   * @return false if the key doesn't exist
+   */
+  template <typename Func>
+  bool findByKey(const KeyType& key, Func&& func) const {
+    const auto res = mDataTable.find(key);
+    if (res == mDataTable.end())
+      return false;
+    func(res->second);
+    return true;
+  }
+
   /**
    * @brief Return a pair of iterators for scanning the table with a
    *        selection predicate.
@@ -393,26 +428,46 @@ public:
    *
    * @param cb the observer (slot)
    * @param mode the nofication mode (immediate or defered)
+   * @return the connection of the observer which can be used to unregister it
    */
-  void registerObserver(typename ObserverCallback::slot_type const& cb,
+  boost::signals2::connection registerObserver(typename ObserverCallback::slot_type const& cb,
     TableParams::NotificationMode mode) {
       switch (mode) {
         case TableParams::Immediate:
-          mImmediateObservers.connect(cb);
-          break;
+          return mImmediateObservers.connect(cb);
         case TableParams::OnCommit:
-          mDeferredObservers.connect(cb);
-          break;
+        default:
+          return mDeferredObservers.connect(cb);
       }
   }
 
+  /**
+   * @brief Register an observer of truncates
+   *
+   * Registers an observer (a slot) which is notified once if all tuples of the
+   * table are deleted by @c truncate or @c drop. The deleted tuples are not
+   * reported to the observers registered by @c registerObserver.
+   *
+   * @param cb the observer (slot)
+   * @return the connection of the observer which can be used to unregister it
+   */
+  boost::signals2::connection registerTruncateObserver(typename TruncateCallback::slot_type const& cb) {
+    return mTruncateObservers.connect(cb);
+  }
+
   void drop() {
-    mDataTable.clear();
+    truncate();
     //mDataTable = nullptr;
   }
 
+  /**
+   * @brief Delete all tuples.
+   *
+   * Delete all tuples from the table and notify the truncate observers once.
+   */
   void truncate() {
     mDataTable.clear();
+    mTruncateObservers();
   }
 private:
   /**
@@ -438,6 +493,7 @@ private:
   //mutable std::mutex mMtx; //< a mutex for getting exclusive access to the table
   TableMap mDataTable;     //< the actual table structure (a hash map)
   ObserverCallback mImmediateObservers, mDeferredObservers;
+  TruncateCallback mTruncateObservers;
 };
 
 }
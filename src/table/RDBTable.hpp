@@ -494,16 +494,16 @@ class RDBTable : public BaseTable {
    *
    * @param cb the observer (slot)
    * @param mode the nofication mode (immediate or defered)
+   * @return the connection of the observer which can be used to unregister it
    */
-  void registerObserver(typename ObserverCallback::slot_type const& cb,
+  boost::signals2::connection registerObserver(typename ObserverCallback::slot_type const& cb,
                         TableParams::NotificationMode mode) {
     switch (mode) {
       case TableParams::Immediate:
-        mImmediateObservers.connect(cb);
-        break;
+        return mImmediateObservers.connect(cb);
       case TableParams::OnCommit:
-        mDeferredObservers.connect(cb);
-        break;
+      default:
+        return mDeferredObservers.connect(cb);
     }
   }
 
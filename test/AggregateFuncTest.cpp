@@ -18,9 +18,11 @@
 #include "catch.hpp"
 
 #include <string>
+#include <vector>
 
 #include "qop/AggregateFunctions.hpp"
 #include "core/Tuple.hpp"
+#include "qop/AggregateStateBase.hpp"
 
 using namespace pfabric;
 
@@ -163,6 +165,33 @@ TEST_CASE("Calculate min/max of ints", "[AggregateFunc]") {
 	REQUIRE(aggr2.value() == 99);
 }
 
+TEST_CASE("Calculate min/max in a FIFO sliding window", "[AggregateFunc]") {
+	AggrWindowMinMax<int, std::less<int>> wmin;
+	AggrWindowMinMax<int, std::greater<int>> wmax;
+	AggrMinMax<int, std::less<int>> refMin;
+	AggrMinMax<int, std::greater<int>> refMax;
+
+	// a window of 7 values including duplicates
+	std::vector<int> data;
+	for (int i = 0; i < 200; i++)
+		data.push_back((i * 37) % 23);
+	for (auto i = 0u; i < data.size(); i++) {
+		if (i >= 7) {
+			wmin.iterate(data[i - 7], true); wmax.iterate(data[i - 7], true);
+			refMin.iterate(data[i - 7], true); refMax.iterate(data[i - 7], true);
+		}
+		wmin.iterate(data[i]); wmax.iterate(data[i]);
+		refMin.iterate(data[i]); refMax.iterate(data[i]);
+		REQUIRE(wmin.value() == refMin.value());
+		REQUIRE(wmax.value() == refMax.value());
+	}
+
+	AggrWindowMinMax<int, std::less<int>> wmin2;
+	wmin2.iterate(-1);
+	wmin.combine(wmin2);
+	REQUIRE(wmin.value() == -1);
+}
+
 TEST_CASE("Calculate least and most recent values", "[AggregateFunc]") {
 	AggrLRecent<int> aggr1;
 	AggrMRecent<int> aggr2;
@@ -218,3 +247,153 @@ TEST_CASE("Test AggrIdentity function", "[AggregateFunc]") {
 
   REQUIRE(aggr2.value() == "eee");
 }
+
+TEST_CASE("Combine partial aggregates", "[AggregateFunc]") {
+	AggrSum<int> sum1, sum2;
+	AggrAvg<double, double> avg1, avg2;
+	AggrGlobalMax<int> max1, max2;
+	AggrMedian<int, double, std::less<int>> median1, median2;
+	AggrLRecent<int> lrecent1, lrecent2;
+	AggrMRecent<int> mrecent1, mrecent2;
+	for (int i = 0; i < 10; i++) {
+		sum1.iterate(i); avg1.iterate(i); max1.iterate(i); median1.iterate(i);
+		lrecent1.iterate(i); mrecent1.iterate(i);
+	}
+	for (int i = 10; i < 15; i++) {
+		sum2.iterate(i); avg2.iterate(i); max2.iterate(i); median2.iterate(i);
+		lrecent2.iterate(i); mrecent2.iterate(i);
+	}
+	sum1.combine(sum2);
+	avg1.combine(avg2);
+	max1.combine(max2);
+	median1.combine(median2);
+	lrecent1.combine(lrecent2);
+	mrecent1.combine(mrecent2);
+
+	REQUIRE(sum1.value() == 105);
+	REQUIRE(avg1.value() == 7.0);
+	REQUIRE(max1.value() == 14);
+	REQUIRE(median1.value() == 7.0);
+	REQUIRE(lrecent1.value() == 0);
+	REQUIRE(mrecent1.value() == 14);
+}
+
+TEST_CASE("Calculate approximate distinct count", "[AggregateFunc]") {
+	AggrHyperLogLog<int> hll1, hll2;
+	REQUIRE(hll1.value() == 0);
+
+	for (int i = 0; i < 100000; i++) {
+		hll1.iterate(i);
+		// duplicates don't change the estimate
+		hll1.iterate(i / 2);
+	}
+	REQUIRE(hll1.value() == Approx(100000).epsilon(0.05));
+
+	// small cardinalities are estimated (almost) exactly
+	for (int i = 0; i < 100; i++)
+		hll2.iterate(i);
+	REQUIRE(hll2.value() == Approx(100).epsilon(0.02));
+
+	// merging results in the distinct count of the union
+	for (int i = 50000; i < 150000; i++)
+		hll2.iterate(i);
+	hll1.combine(hll2);
+	REQUIRE(hll1.value() == Approx(150000).epsilon(0.05));
+
+	AggrHyperLogLog<std::string, double> hll3;
+	for (int i = 0; i < 1000; i++)
+		hll3.iterate("key" + std::to_string(i % 500));
+	REQUIRE(hll3.value() == Approx(500).epsilon(0.05));
+}
+
+TEST_CASE("Calculate approximate frequencies", "[AggregateFunc]") {
+	AggrCountMin<int> cm1, cm2;
+	REQUIRE(cm1.value() == 0);
+
+	// key k occurs k times for k < 100, the keys 1000..10999 once
+	for (int k = 1; k < 100; k++) {
+		for (int i = 0; i < k; i++)
+			cm1.iterate(k);
+	}
+	for (int k = 1000; k < 11000; k++)
+		cm1.iterate(k);
+	REQUIRE(cm1.count() == 4950 + 10000);
+
+	// the estimate never underestimates and is bounded by e / width * N
+	const unsigned long bound = 3 * cm1.count() / 1024;
+	for (int k = 1; k < 100; k++) {
+		REQUIRE(cm1.estimate(k) >= (unsigned long)k);
+		REQUIRE(cm1.estimate(k) <= k + bound);
+	}
+	// the value is the frequency of the last key
+	REQUIRE(cm1.value() == cm1.estimate(10999));
+
+	// outdated values are subtracted
+	for (int i = 0; i < 99; i++)
+		cm1.iterate(99, true);
+	REQUIRE(cm1.estimate(99) <= bound);
+	// ... but do not change the last key
+	REQUIRE(cm1.value() == cm1.estimate(10999));
+
+	// merging an empty sketch keeps the last key
+	cm1.combine(cm2);
+	REQUIRE(cm1.value() == cm1.estimate(10999));
+
+	// merging adds the frequencies and takes over the last key
+	for (int i = 0; i < 500; i++)
+		cm2.iterate(7);
+	cm1.combine(cm2);
+	REQUIRE(cm1.estimate(7) >= 507);
+	REQUIRE(cm1.estimate(7) <= 507 + bound);
+	REQUIRE(cm1.value() == cm1.estimate(7));
+}
+
+TEST_CASE("Calculate approximate quantiles", "[AggregateFunc]") {
+	AggrKLLQuantile<int> median;
+	AggrKLLQuantile<int, double, 90> p90;
+	REQUIRE(median.value() == 0);
+
+	// insert a permutation of 0..99999
+	const int num = 100000;
+	for (int i = 0; i < num; i++) {
+		const int v = int((i * 7919L) % num);
+		median.iterate(v);
+		p90.iterate(v);
+	}
+	REQUIRE(median.count() == num);
+	// the memory is bounded
+	REQUIRE(median.numRetained() < 1000);
+	REQUIRE(std::abs(median.value() - num / 2) < num / 50);
+	REQUIRE(std::abs(p90.value() - num * 0.9) < num / 50);
+
+	// merging results in the quantile of the union
+	AggrKLLQuantile<int> median2;
+	for (int i = num; i < 2 * num; i++)
+		median2.iterate(i);
+	median.combine(median2);
+	REQUIRE(median.count() == 2 * num);
+	REQUIRE(median.numRetained() < 1000);
+	REQUIRE(std::abs(median.value() - num) < num / 25);
+
+	// for small inputs the result is exact
+	AggrKLLQuantile<int> small;
+	for (int i = 1; i <= 9; i++)
+		small.iterate(i);
+	REQUIRE(small.value() == 5);
+}
+
+TEST_CASE("Use sketches in an aggregator", "[AggregateFunc]") {
+	typedef TuplePtr<int, int> MyTuplePtr;
+	typedef Aggregator2<MyTuplePtr, AggrHyperLogLog<int>, 0, AggrKLLQuantile<int>, 1> AggrState;
+
+	auto state1 = std::make_shared<AggrState>();
+	auto state2 = std::make_shared<AggrState>();
+	for (int i = 0; i < 1000; i++) {
+		AggrState::iterate(makeTuplePtr(i % 100, i), state1, false);
+		AggrState::iterate(makeTuplePtr(100 + i % 100, 1000 + i), state2, false);
+	}
+	AggrState::combine(state1, state2);
+	auto res = AggrState::finalize(state1);
+	REQUIRE(get<0>(res) == Approx(200).epsilon(0.02));
+	REQUIRE(std::abs(get<1>(res) - 1000) < 40);
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/Tuple.hpp"
+#include "qop/Executor.hpp"
+#include "dsl/Topology.hpp"
+#include "dsl/Pipe.hpp"
+#include "dsl/PFabricContext.hpp"
+
+using namespace pfabric;
+
+TEST_CASE("Running tasks on an executor", "[Executor]") {
+  const int numProducers = 4, numItems = 10000;
+  auto executor = std::make_shared<Executor>(3);
+  REQUIRE(executor->numWorkers() == 3);
+
+  std::atomic<int> pending(0), processed(0);
+  std::atomic<bool> running(false), overlapped(false);
+
+  // a task processing up to 100 items per batch
+  auto task = executor->registerTask([&]() {
+    if (running.exchange(true)) overlapped = true;
+    for (int i = 0; i < 100 && pending > 0; i++) {
+      pending--;
+      processed++;
+    }
+    running = false;
+    return pending > 0;
+  });
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < numProducers; p++) {
+    producers.emplace_back([&]() {
+      for (int i = 0; i < numItems; i++) {
+        pending++;
+        executor->schedule(task);
+      }
+    });
+  }
+  for (auto& t : producers) t.join();
+
+  auto start = std::chrono::steady_clock::now();
+  while (processed < numProducers * numItems &&
+         std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  executor->unregisterTask(task);
+  // a task is never executed concurrently
+  REQUIRE(!overlapped);
+  REQUIRE(processed == numProducers * numItems);
+}
+
+TEST_CASE("Running timers on an executor", "[Executor]") {
+  auto executor = std::make_shared<Executor>(2);
+  std::atomic<int> calls(0);
+
+  auto timer = executor->registerTimer([&]() { calls++; }, std::chrono::milliseconds(10));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  executor->unregisterTask(timer);
+
+  int n = calls;
+  REQUIRE(n >= 5);
+  // after unregistering the timer isn't invoked anymore
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  REQUIRE(calls == n);
+}
+
+TEST_CASE("Unregistering running tasks from an executor", "[Executor]") {
+  auto executor = std::make_shared<Executor>(1);
+  std::atomic<bool> finished(false), unregistered(false);
+
+  // unregistering waits until the running batch has finished
+  auto slow = executor->registerTask([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    finished = true;
+    return false;
+  });
+  executor->schedule(slow);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  executor->unregisterTask(slow);
+  REQUIRE(finished);
+
+  // a task executed while another task yields may unregister the yielding task
+  Executor::TaskPtr outer, inner;
+  inner = executor->registerTask([&]() {
+    executor->unregisterTask(outer);
+    unregistered = true;
+    return false;
+  });
+  outer = executor->registerTask([&]() {
+    executor->schedule(inner);
+    while (!unregistered)
+      executor->yield();
+    return false;
+  });
+  executor->schedule(outer);
+
+  auto start = std::chrono::steady_clock::now();
+  while (!unregistered && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  REQUIRE(unregistered);
+  executor->unregisterTask(inner);
+  executor->unregisterTask(outer);
+}
+
+TEST_CASE("Publishing into a full queue from a worker of the executor", "[Executor][Queue]") {
+  typedef TuplePtr<int> T1;
+  const int numTuples = 200;
+
+  // a single worker runs both the producer and the consumer of the queue
+  auto executor = std::make_shared<Executor>(1);
+  auto queue = std::make_shared<Queue<T1>>(executor, 4, 2);
+  std::atomic<int> received(0);
+  std::atomic<bool> inProducer(false), nested(false), ordered(true);
+  auto sink = std::make_shared<Notify<T1>>([&](const T1& tp, bool outdated) {
+    if (inProducer) nested = true;
+    if (get<0>(tp) != received) ordered = false;
+    received++;
+  });
+  CREATE_DATA_LINK(queue, sink);
+
+  auto producer = executor->registerTask([&]() {
+    inProducer = true;
+    for (int i = 0; i < numTuples; i++)
+      queue->processDataElement(makeTuplePtr(i), false);
+    inProducer = false;
+    return false;
+  });
+  executor->schedule(producer);
+
+  auto start = std::chrono::steady_clock::now();
+  while (received < numTuples &&
+         std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  executor->unregisterTask(producer);
+
+  // the producer neither blocks the worker nor runs the consumer nested
+  REQUIRE(!nested);
+  REQUIRE(ordered);
+  REQUIRE(received == numTuples);
+}
+
+TEST_CASE("Building and running a partitioned topology on an executor", "[Executor][Topology]") {
+  typedef TuplePtr<int, double> T1;
+  typedef TuplePtr<int> T2;
+
+  const unsigned long numTuples = 10000;
+  std::vector<int> results;
+  std::mutex r_mutex;
+
+  PFabricContext ctx;
+  ctx.setNumWorkerThreads(2);
+  auto t = ctx.createTopology();
+
+  // 8 partitions but only two worker threads
+  auto s = t->streamFromGenerator<T1>([](unsigned long n) -> T1 {
+        return makeTuplePtr((int)n, n * 1.5);
+      }, numTuples)
+    .partitionBy([](auto tp) { return get<0>(tp) % 8; }, 8)
+    .where([](auto tp, bool outdated) { return get<0>(tp) % 2 == 0; } )
+    .map<T2>([](auto tp, bool outdated) -> T2 { return makeTuplePtr(get<0>(tp)); } )
+    .merge()
+    .notify([&](auto tp, bool outdated) {
+      std::lock_guard<std::mutex> lock(r_mutex);
+      results.push_back(get<0>(tp));
+    });
+
+  t->start(false);
+
+  auto start = std::chrono::steady_clock::now();
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lock(r_mutex);
+      if (results.size() == numTuples / 2) break;
+    }
+    if (std::chrono::steady_clock::now() - start > std::chrono::seconds(5)) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  std::lock_guard<std::mutex> lock(r_mutex);
+  REQUIRE(results.size() == numTuples / 2);
+  std::sort(results.begin(), results.end());
+  for (auto i = 0u; i < results.size(); i++) {
+    REQUIRE(results[i] == (int)(i * 2));
+  }
+}
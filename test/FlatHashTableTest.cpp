@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "qop/FlatHashTable.hpp"
+
+using namespace pfabric;
+
+/**
+ * A poor hash function mapping all keys to a few slots to force long
+ * probe sequences.
+ */
+struct CollidingHash {
+  std::size_t operator()(int key) const { return key % 3; }
+};
+
+/**
+ * A value type which can be neither copied nor moved.
+ */
+struct Pinned {
+  Pinned(int v) : mValue(v), mSelf(this) {}
+  Pinned(const Pinned&) = delete;
+  Pinned& operator=(const Pinned&) = delete;
+
+  int mValue;
+  Pinned* mSelf;
+};
+
+TEST_CASE("Inserting and looking up keys in a flat hash table", "[FlatHashTable]") {
+  FlatHashTable<int, int> table;
+  REQUIRE(table.empty());
+  REQUIRE(table.find(42) == nullptr);
+
+  for (int i = 0; i < 1000; i++) {
+    auto res = table.tryEmplace(i, i * 2);
+    REQUIRE(res.second);
+    REQUIRE(*res.first == i * 2);
+  }
+  REQUIRE(table.size() == 1000);
+  // the load factor stays below 0.75
+  REQUIRE(table.capacity() * 3 >= table.size() * 4);
+
+  for (int i = 0; i < 1000; i++) {
+    auto v = table.find(i);
+    REQUIRE(v != nullptr);
+    REQUIRE(*v == i * 2);
+  }
+  REQUIRE(table.find(1000) == nullptr);
+
+  // an existing key is not overwritten
+  auto res = table.tryEmplace(7, 0);
+  REQUIRE_FALSE(res.second);
+  REQUIRE(*res.first == 14);
+  REQUIRE(table.size() == 1000);
+
+  std::size_t sum = 0;
+  table.forEach([&](const int& k, int& v) { sum += v - k; });
+  REQUIRE(sum == 999 * 1000 / 2);
+}
+
+TEST_CASE("Erasing keys from a flat hash table with collisions", "[FlatHashTable]") {
+  FlatHashTable<int, std::string, CollidingHash> table;
+  std::map<int, std::string> reference;
+
+  for (int i = 0; i < 200; i++) {
+    table.tryEmplace(i, std::to_string(i));
+    reference.emplace(i, std::to_string(i));
+  }
+  // remove every second key, the remaining keys have to be found
+  // after closing the gaps
+  for (int i = 0; i < 200; i += 2) {
+    REQUIRE(table.erase(i));
+    reference.erase(i);
+  }
+  REQUIRE_FALSE(table.erase(0));
+  REQUIRE(table.size() == reference.size());
+  for (int i = 0; i < 200; i++) {
+    auto v = table.find(i);
+    if (reference.count(i) == 0)
+      REQUIRE(v == nullptr);
+    else {
+      REQUIRE(v != nullptr);
+      REQUIRE(*v == reference[i]);
+    }
+  }
+
+  // erased entries are reused
+  const auto mem = table.memoryUsage();
+  for (int i = 0; i < 200; i += 2)
+    REQUIRE(table.tryEmplace(i, "new").second);
+  REQUIRE(table.size() == 200);
+  REQUIRE(*table.find(4) == "new");
+  REQUIRE(*table.find(5) == "5");
+  REQUIRE(table.memoryUsage() == mem);
+
+  table.clear();
+  REQUIRE(table.empty());
+  REQUIRE(table.find(5) == nullptr);
+}
+
+TEST_CASE("Values of a flat hash table are stable", "[FlatHashTable]") {
+  FlatHashTable<std::string, Pinned> table;
+  std::vector<Pinned*> values;
+
+  for (int i = 0; i < 500; i++)
+    values.push_back(table.tryEmplace(std::to_string(i), i).first);
+
+  // growing the table did not move any value
+  for (int i = 0; i < 500; i++) {
+    auto v = table.find(std::to_string(i));
+    REQUIRE(v == values[i]);
+    REQUIRE(v->mSelf == v);
+    REQUIRE(v->mValue == i);
+  }
+}
@@ -66,5 +66,7 @@ TEST_CASE("Producing a data stream from inserts into a table", "[FromTable]") {
 
   mockup->wait();
   REQUIRE(mockup->numTuplesProcessed() == 10);
+  // stop the producer thread before the mockup is destroyed
+  op.reset();
   testTable->drop();
 }
@@ -187,3 +187,62 @@ TEST_CASE( "Compute a groupby with incremental min/max aggregates", "[GroupedAgg
 
 	mockup->start();
 }
+
+/*-------------------------------------------------------------------------- */
+
+/**
+ * Checks that the groups are maintained correctly by the state table: groups
+ * are purged as soon as all of their tuples are outdated and the table grows
+ * with the number of groups.
+ */
+TEST_CASE( "Maintain the groups of a windowed groupby", "[GroupedAggregation]" ) {
+	typedef MyAggregateState< const InTuplePtr& > MyAggrState;
+	typedef std::shared_ptr<MyAggrState> MyAggrStatePtr;
+	typedef GroupedAggregation<const InTuplePtr&, const OutTuplePtr&, MyAggrState > TestAggregation;
+
+	auto makeAggregation = []() {
+		return std::make_shared< TestAggregation >(
+			[](const InTuplePtr& tp) { return tp->getAttribute<0>(); },
+			[](MyAggrStatePtr myState) {
+				return makeTuplePtr(myState->group1_, myState->sum1_.value(),
+					myState->avg2_.value(), myState->cnt3_.value());
+			},
+			[](const InTuplePtr& tp, const int&, MyAggrStatePtr myState, const bool outdated) {
+				myState->group1_ = tp->getAttribute<0>();
+				myState->sum1_.iterate(tp->getAttribute<1>(), outdated);
+				myState->avg2_.iterate(tp->getAttribute<1>(), outdated);
+				myState->cnt3_.iterate(tp->getAttribute<1>(), outdated);
+			},
+			TriggerByCount, 100000);
+	};
+
+	SECTION("groups vanish with their last tuple") {
+		std::vector<InTuplePtr> input = {
+			makeTuplePtr(1,3.4), makeTuplePtr(1,9.1), makeTuplePtr(2,5.7),
+			makeTuplePtr(2,2.1), makeTuplePtr(3,2.1)
+		};
+		auto mockup = std::make_shared< StreamMockup<InTuplePtr, OutTuplePtr> >(input, std::vector<OutTuplePtr>());
+		auto win = std::make_shared< SlidingWindow<InTuplePtr> >(WindowParams::RowWindow, 2);
+		auto aggr = makeAggregation();
+
+		CREATE_DATA_LINK( mockup, win );
+		CREATE_DATA_LINK( win, aggr );
+
+		mockup->start();
+		// only the tuples (2,2.1) and (3,2.1) are still in the window
+		REQUIRE(aggr->numGroups() == 2);
+	}
+
+	SECTION("many groups") {
+		std::vector<InTuplePtr> input;
+		for (int i = 0; i < 3000; i++)
+			input.push_back(makeTuplePtr(i % 1000, 1.0));
+		auto mockup = std::make_shared< StreamMockup<InTuplePtr, OutTuplePtr> >(input, std::vector<OutTuplePtr>());
+		auto aggr = makeAggregation();
+
+		CREATE_DATA_LINK( mockup, aggr );
+
+		mockup->start();
+		REQUIRE(aggr->numGroups() == 1000);
+	}
+}
@@ -153,6 +153,23 @@ TEST_CASE("Creating a table with a given schema, inserting and deleting data", "
     REQUIRE(updateDetected == true);
   }
 
+  SECTION("observing a truncate of a table") {
+    REQUIRE(testTable->size() == 10000);
+    int numDeletes = 0, numTruncates = 0;
+
+    testTable->registerObserver([&numDeletes](const MyTuple&, TableParams::ModificationMode mode) {
+      if (mode == TableParams::Delete)
+        numDeletes++;
+    }, TableParams::Immediate);
+    testTable->registerTruncateObserver([&numTruncates]() { numTruncates++; });
+
+    // a truncate is notified once instead of reporting each deleted tuple
+    testTable->truncate();
+    REQUIRE(testTable->size() == 0);
+    REQUIRE(numTruncates == 1);
+    REQUIRE(numDeletes == 0);
+  }
+
   SECTION("scanning the whole table") {
     REQUIRE(testTable->size() == 10000);
 
@@ -70,6 +70,38 @@ TEST_CASE("Applying a map function to a tuple stream", "[Map]") {
   REQUIRE(mockup->numTuplesProcessed() == expected.size());
 }
 
+/**
+ * A test of the projection operator using the lambda type as template argument.
+ */
+TEST_CASE("Applying an inlined map function to a tuple stream", "[Map]") {
+	std::vector<InTuplePtr> input = {
+		makeTuplePtr(0, 0, 0),
+		makeTuplePtr (1, 1, 10),
+		makeTuplePtr(2, 2, 20) };
+
+	std::vector<OutTuplePtr> expected = {
+		makeTuplePtr(0, 0, 0, 0),
+		makeTuplePtr (1, 10, 1, 11),
+		makeTuplePtr(2, 20, 2, 22) };
+
+	auto mockup = std::make_shared< StreamMockup<InTuplePtr, OutTuplePtr> >(input, expected);
+
+	auto map_fun = []( const InTuplePtr& tp, bool ) {
+		return makeTuplePtr(
+			tp->getAttribute<0>(), tp->getAttribute<2>(), tp->getAttribute<1>(),
+			tp->getAttribute<1>() + tp->getAttribute<2>()
+		);
+	};
+	auto mop = std::make_shared< Map< InTuplePtr, OutTuplePtr, decltype(map_fun) > >(map_fun);
+
+	CREATE_DATA_LINK(mockup, mop)
+	CREATE_DATA_LINK(mop, mockup)
+
+	mockup->start();
+
+  REQUIRE(mockup->numTuplesProcessed() == expected.size());
+}
+
 /**
  * A simple test of the stateful map operator.
  */
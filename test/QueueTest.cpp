@@ -58,3 +58,121 @@ TEST_CASE("Decoupling producer and consumer via a queue", "[Queue]") {
 
   REQUIRE(mockup->numTuplesProcessed() == expected.size());
 }
+
+/**
+ * A test of the queue operator using the lock-free ring buffer.
+ */
+TEST_CASE("Decoupling producer and consumer via a bounded ring buffer queue", "[Queue]") {
+  std::vector<MyTuplePtr> input, expected;
+  for (int i = 0; i < 1000; i++) {
+    input.push_back(makeTuplePtr(i, i, i * 10));
+    expected.push_back(makeTuplePtr(i, i, i * 10));
+  }
+
+  auto mockup = std::make_shared< StreamMockup<MyTuplePtr, MyTuplePtr> >(input, expected);
+
+  // the capacity is smaller than the input to force a full queue
+  auto ch = std::make_shared<Queue<MyTuplePtr> >(100);
+  REQUIRE(ch->capacity() == 128);
+
+  CREATE_DATA_LINK(mockup, ch)
+  CREATE_DATA_LINK(ch, mockup)
+
+  mockup->start();
+  mockup->wait();
+
+  REQUIRE(mockup->numTuplesProcessed() == (int)expected.size());
+}
+
+/**
+ * A test of the ring buffer with multiple producers.
+ */
+TEST_CASE("Inserting into a ring buffer from multiple producers", "[Queue]") {
+  const int numProducers = 4, numItems = 10000;
+  RingBufferQueue<int> queue(64);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < numProducers; p++) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < numItems; i++)
+        queue.push(p * numItems + i);
+    });
+  }
+
+  std::vector<int> lastSeen(numProducers, -1);
+  int received = 0;
+  bool ordered = true;
+  while (received < numProducers * numItems) {
+    if (!queue.waitForData()) break;
+    received += queue.consume([&](int v) {
+      // the elements of a single producer have to arrive in order
+      auto p = v / numItems, i = v % numItems;
+      if (i <= lastSeen[p]) ordered = false;
+      lastSeen[p] = i;
+    }, 32);
+  }
+  for (auto& t : producers) t.join();
+
+  REQUIRE(ordered);
+  REQUIRE(received == numProducers * numItems);
+  REQUIRE(queue.empty());
+}
+
+/**
+ * A test of the backpressure of a bounded ring buffer: a fast producer
+ * is blocked if the slow consumer doesn't return credits.
+ */
+TEST_CASE("Blocking a producer on a full ring buffer", "[Queue]") {
+  const int numItems = 1000;
+  RingBufferQueue<int> queue(16);
+
+  std::thread producer([&queue]() {
+    for (int i = 0; i < numItems; i++)
+      queue.push(i);
+  });
+
+  int received = 0;
+  bool ordered = true;
+  while (received < numItems) {
+    if (!queue.waitForData()) break;
+    // the producer can never be more than one queue ahead
+    if (queue.size() > queue.capacity()) ordered = false;
+    queue.consume([&](int v) {
+      if (v != received) ordered = false;
+      received++;
+    }, 4);
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  producer.join();
+
+  REQUIRE(ordered);
+  REQUIRE(received == numItems);
+  REQUIRE(queue.highWaterMark() == queue.capacity());
+}
+
+/**
+ * A test of deferring elements: a producer which must not block never
+ * waits for a full ring buffer, the elements are kept in order.
+ */
+TEST_CASE("Deferring elements on a full ring buffer", "[Queue]") {
+  const int numItems = 100;
+  RingBufferQueue<int> queue(16);
+
+  for (int i = 0; i < numItems; i++)
+    queue.pushOrDefer(i);
+  REQUIRE(queue.size() == numItems);
+  REQUIRE(queue.highWaterMark() == queue.capacity());
+
+  int received = 0;
+  bool ordered = true;
+  while (!queue.empty()) {
+    queue.consume([&](int v) {
+      if (v != received) ordered = false;
+      received++;
+    }, 8);
+  }
+
+  REQUIRE(ordered);
+  REQUIRE(received == numItems);
+  REQUIRE(queue.size() == 0);
+}
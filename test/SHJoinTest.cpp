@@ -22,6 +22,9 @@
 #include "qop/DataSource.hpp"
 #include "qop/DataSink.hpp"
 #include "qop/SHJoin.hpp"
+#include "qop/WindowedSHJoin.hpp"
+#include "qop/BandJoin.hpp"
+#include "qop/MultiWayJoin.hpp"
 #include "qop/SlidingWindow.hpp"
 
 
@@ -152,3 +155,242 @@ TEST_CASE("Joining two streams with outdated items using sliding windows", "[SHJ
 
 	REQUIRE(tgen1->numProcessedTuples() == 10);
 }
+
+/**
+ * A test of the symmetric hash join with built-in count-based windows.
+ */
+TEST_CASE("Joining two streams using built-in row windows", "[WindowedSHJoin]") {
+	typedef WindowedSHJoin< MyTuplePtr, MyTuplePtr > TestJoin;
+	typedef TupleGenerator< typename TestJoin::ResultElement > TestGenerator;
+
+	auto tgen1 = std::make_shared<TestGenerator>();
+	auto tgen2 = std::make_shared<TestGenerator>();
+	auto hfun = [&]( const MyTuplePtr& tp ) { return (unsigned long) getAttribute<0>(tp); };
+	auto join_pred = [&](const MyTuplePtr& tp1, const MyTuplePtr& tp2) { return true; };
+	auto join = std::make_shared< TestJoin >(hfun, hfun, join_pred, 10, 10);
+
+	connectChannels(tgen1->getOutputDataChannel(), join->getLeftInputDataChannel());
+	connectChannels(tgen2->getOutputDataChannel(), join->getRightInputDataChannel());
+	CREATE_DATA_LINK(join, tgen1);
+
+	// 5 tuples for stream #1 and 10 corresponding tuples for stream #2
+	tgen1->start(5);
+	tgen2->start(10);
+	REQUIRE(tgen1->numProcessedTuples() == 5);
+
+	// and again 5 tuples for stream #1 which find their partners in the window
+	tgen1->start(5, false);
+	REQUIRE(tgen1->numProcessedTuples() == 10);
+	REQUIRE(tgen1->numOutdatedTuples() == 0);
+
+	// the windows are bounded without any outdated tuples
+	tgen2->start(10000);
+	REQUIRE(tgen1->numProcessedTuples() == 20);
+	REQUIRE(join->stateSize() <= 10 + 10 + 2);
+}
+
+/**
+ * A test of the symmetric hash join with built-in time-based windows.
+ */
+TEST_CASE("Joining two streams using built-in range windows", "[WindowedSHJoin]") {
+	typedef WindowedSHJoin< MyTuplePtr, MyTuplePtr > TestJoin;
+	typedef TupleGenerator< typename TestJoin::ResultElement > TestGenerator;
+
+	auto tgen1 = std::make_shared<TestGenerator>();
+	auto tgen2 = std::make_shared<TestGenerator>();
+	auto hfun = [&]( const MyTuplePtr& tp ) { return (unsigned long) getAttribute<0>(tp); };
+	auto tsfun = [&]( const MyTuplePtr& tp ) { return std::chrono::seconds(getAttribute<1>(tp)); };
+	auto join_pred = [&](const MyTuplePtr& tp1, const MyTuplePtr& tp2) { return true; };
+	// windows of 5 seconds, the timestamp of tuple i is i seconds
+	auto join = std::make_shared< TestJoin >(hfun, hfun, join_pred, 5, 5, tsfun, tsfun);
+
+	connectChannels(tgen1->getOutputDataChannel(), join->getLeftInputDataChannel());
+	connectChannels(tgen2->getOutputDataChannel(), join->getRightInputDataChannel());
+	CREATE_DATA_LINK(join, tgen1);
+
+	// although the left stream is ahead, each right tuple finds its partner
+	// with the same timestamp
+	tgen1->start(10);
+	tgen2->start(10);
+	REQUIRE(tgen1->numProcessedTuples() == 10);
+
+	// a left tuple joins only right tuples around its own timestamp: the right
+	// tuples 5..9 are outside of the window of left tuple 0 ...
+	tgen1->getOutputDataChannel().publish(makeTuplePtr(5, 0), false);
+	REQUIRE(tgen1->numProcessedTuples() == 10);
+	// ... and right tuple 9 is within the window of left tuple 5
+	tgen1->getOutputDataChannel().publish(makeTuplePtr(9, 5), false);
+	REQUIRE(tgen1->numProcessedTuples() == 11);
+
+	// a watermark expires the windows of both streams
+	connectChannels(tgen1->getOutputPunctuationChannel(), join->getInputPunctuationChannel());
+	tgen1->getOutputPunctuationChannel().publish(
+		std::make_shared<Punctuation>(Punctuation::Watermark, Timestamp(std::chrono::seconds(100))));
+	REQUIRE(join->stateSize() == 0);
+}
+
+/**
+ * A test of the symmetric hash join with built-in time-based windows and
+ * skewed inputs driven by watermarks.
+ */
+TEST_CASE("Joining two skewed streams using built-in range windows and watermarks", "[WindowedSHJoin]") {
+	typedef WindowedSHJoin< MyTuplePtr, MyTuplePtr > TestJoin;
+	typedef TupleGenerator< typename TestJoin::ResultElement > TestGenerator;
+
+	auto tgen1 = std::make_shared<TestGenerator>();
+	auto tgen2 = std::make_shared<TestGenerator>();
+	auto hfun = [&]( const MyTuplePtr& tp ) { return (unsigned long) getAttribute<0>(tp); };
+	auto tsfun = [&]( const MyTuplePtr& tp ) { return std::chrono::seconds(getAttribute<1>(tp)); };
+	auto join_pred = [&](const MyTuplePtr& tp1, const MyTuplePtr& tp2) { return true; };
+	// windows of 10 seconds
+	auto join = std::make_shared< TestJoin >(hfun, hfun, join_pred, 10, 10, tsfun, tsfun);
+
+	connectChannels(tgen1->getOutputDataChannel(), join->getLeftInputDataChannel());
+	connectChannels(tgen1->getOutputPunctuationChannel(), join->getLeftInputPunctuationChannel());
+	connectChannels(tgen2->getOutputDataChannel(), join->getRightInputDataChannel());
+	connectChannels(tgen2->getOutputPunctuationChannel(), join->getRightInputPunctuationChannel());
+	CREATE_DATA_LINK(join, tgen1);
+
+	auto watermark = [](int secs) {
+		return std::make_shared<Punctuation>(Punctuation::Watermark, Timestamp(std::chrono::seconds(secs)));
+	};
+
+	// the left stream runs far ahead of the right stream
+	tgen1->getOutputPunctuationChannel().publish(watermark(45));
+	tgen1->getOutputDataChannel().publish(makeTuplePtr(1, 50), false);
+	tgen1->getOutputDataChannel().publish(makeTuplePtr(2, 100), false);
+	tgen1->getOutputPunctuationChannel().publish(watermark(95));
+
+	// a late right tuple joins only left tuples within 10 seconds
+	tgen2->getOutputDataChannel().publish(makeTuplePtr(2, 50), false);
+	REQUIRE(tgen1->numProcessedTuples() == 0);
+	// the left watermark does not expire the left window, i.e. the slower right
+	// stream still finds its partners
+	tgen2->getOutputDataChannel().publish(makeTuplePtr(1, 52), false);
+	REQUIRE(tgen1->numProcessedTuples() == 1);
+	// the right tuples are behind the left watermark and thus not stored
+	REQUIRE(join->stateSize() == 2);
+
+	// the right watermark expires the left window
+	tgen2->getOutputPunctuationChannel().publish(watermark(200));
+	REQUIRE(join->stateSize() == 0);
+}
+
+TEST_CASE("Joining two streams using a band join", "[BandJoin]") {
+	typedef BandJoin< MyTuplePtr, MyTuplePtr > TestJoin;
+	typedef TupleGenerator< typename TestJoin::ResultElement > TestGenerator;
+
+	auto tgen1 = std::make_shared<TestGenerator>();
+	auto tgen2 = std::make_shared<TestGenerator>();
+	auto hfun = [&]( const MyTuplePtr& tp ) { return (unsigned long) getAttribute<0>(tp); };
+	auto tsfun = [&]( const MyTuplePtr& tp ) { return Timestamp(std::chrono::seconds(getAttribute<1>(tp))); };
+	// a band of 2 seconds, the timestamp of tuple i is i seconds
+	auto join = std::make_shared< TestJoin >(hfun, hfun, tsfun, tsfun, nullptr, std::chrono::seconds(2));
+
+	connectChannels(tgen1->getOutputDataChannel(), join->getLeftInputDataChannel());
+	connectChannels(tgen2->getOutputDataChannel(), join->getRightInputDataChannel());
+	CREATE_DATA_LINK(join, tgen1);
+
+	tgen1->start(10);
+	tgen2->start(10);
+	REQUIRE(tgen1->numProcessedTuples() == 10);
+	// the left tuples 6..9 (whose bucket overlaps the band of the right stream)
+	// and the right tuples 7..9 are kept
+	REQUIRE(join->stateSize() == 7);
+
+	// only the left tuples 7..9 are within the band of the right stream
+	tgen1->start(10, false);
+	REQUIRE(tgen1->numProcessedTuples() == 13);
+
+	// a watermark expires the states of both streams
+	connectChannels(tgen1->getOutputPunctuationChannel(), join->getInputPunctuationChannel());
+	tgen1->getOutputPunctuationChannel().publish(
+		std::make_shared<Punctuation>(Punctuation::Watermark, Timestamp(std::chrono::seconds(100))));
+	REQUIRE(join->stateSize() == 0);
+}
+
+/**
+ * A test of the band join driven by watermarks with a late tuple.
+ */
+TEST_CASE("Joining two streams using a band join and watermarks", "[BandJoin]") {
+	typedef BandJoin< MyTuplePtr, MyTuplePtr > TestJoin;
+	typedef TupleGenerator< typename TestJoin::ResultElement > TestGenerator;
+
+	auto tgen1 = std::make_shared<TestGenerator>();
+	auto tgen2 = std::make_shared<TestGenerator>();
+	auto hfun = [&]( const MyTuplePtr& tp ) { return (unsigned long) getAttribute<0>(tp); };
+	auto tsfun = [&]( const MyTuplePtr& tp ) { return Timestamp(std::chrono::seconds(getAttribute<1>(tp))); };
+	// a band of 2 seconds
+	auto join = std::make_shared< TestJoin >(hfun, hfun, tsfun, tsfun, nullptr, std::chrono::seconds(2));
+
+	connectChannels(tgen1->getOutputDataChannel(), join->getLeftInputDataChannel());
+	connectChannels(tgen1->getOutputPunctuationChannel(), join->getLeftInputPunctuationChannel());
+	connectChannels(tgen2->getOutputDataChannel(), join->getRightInputDataChannel());
+	connectChannels(tgen2->getOutputPunctuationChannel(), join->getRightInputPunctuationChannel());
+	CREATE_DATA_LINK(join, tgen1);
+
+	auto watermark = [](int secs) {
+		return std::make_shared<Punctuation>(Punctuation::Watermark, Timestamp(std::chrono::seconds(secs)));
+	};
+
+	tgen1->getOutputPunctuationChannel().publish(watermark(5));
+	tgen2->getOutputPunctuationChannel().publish(watermark(5));
+	tgen1->getOutputDataChannel().publish(makeTuplePtr(1, 10), false);
+
+	// a right tuple far ahead does not expire the left state ...
+	tgen2->getOutputDataChannel().publish(makeTuplePtr(2, 20), false);
+	REQUIRE(join->stateSize() == 2);
+	// ... thus a late right tuple within the lateness of the watermarks finds its partner
+	tgen2->getOutputDataChannel().publish(makeTuplePtr(1, 9), false);
+	REQUIRE(tgen1->numProcessedTuples() == 1);
+
+	// only the watermarks expire the states
+	tgen1->getOutputPunctuationChannel().publish(watermark(100));
+	tgen2->getOutputPunctuationChannel().publish(watermark(100));
+	REQUIRE(join->stateSize() == 0);
+}
+
+TEST_CASE("Joining three streams using a multi-way join", "[MultiWayJoin]") {
+	typedef MultiWayJoin< unsigned long, MyTuplePtr, MyTuplePtr, MyTuplePtr > TestJoin;
+	typedef TupleGenerator< typename TestJoin::ResultElement > TestGenerator;
+
+	auto tgen1 = std::make_shared<TestGenerator>();
+	auto tgen2 = std::make_shared<TestGenerator>();
+	auto tgen3 = std::make_shared<TestGenerator>();
+	auto hfun = [&]( const MyTuplePtr& tp ) { return (unsigned long) getAttribute<0>(tp); };
+	// adapt the probe order every 4 tuples
+	auto join = std::make_shared< TestJoin >(TestJoin::KeyExtractorFuncs(hfun, hfun, hfun), nullptr, 4);
+
+	connectChannels(tgen1->getOutputDataChannel(), join->getInput<0>()->getInputDataChannel());
+	connectChannels(tgen2->getOutputDataChannel(), join->getInput<1>()->getInputDataChannel());
+	connectChannels(tgen3->getOutputDataChannel(), join->getInput<2>()->getInputDataChannel());
+	CREATE_DATA_LINK(join, tgen1);
+
+	tgen1->start(10);
+	REQUIRE(tgen1->numProcessedTuples() == 0);
+	// the inputs without tuples are probed first
+	REQUIRE(join->probeOrder() == std::array<std::size_t, 3>{ 1, 2, 0 });
+
+	tgen2->start(10);
+	REQUIRE(tgen1->numProcessedTuples() == 0);
+	tgen3->start(10);
+	REQUIRE(tgen1->numProcessedTuples() == 10);
+	REQUIRE(join->stateSize() == 30);
+
+	// an outdated tuple is removed and retracts its join result
+	tgen2->getOutputDataChannel().publish(makeTuplePtr(3, 3), true);
+	REQUIRE(tgen1->numOutdatedTuples() == 1);
+	REQUIRE(join->stateSize() == 29);
+	tgen3->getOutputDataChannel().publish(makeTuplePtr(3, 3), false);
+	REQUIRE(tgen1->numProcessedTuples() == 10);
+
+	join->setProbeOrder({ 2, 0, 1 });
+	REQUIRE(join->probeOrder() == std::array<std::size_t, 3>{ 2, 0, 1 });
+	// an order which is not a permutation of the inputs is rejected
+	REQUIRE_THROWS_AS(join->setProbeOrder({ 2, 2, 1 }), std::invalid_argument);
+	REQUIRE_THROWS_AS(join->setProbeOrder({ 0, 1, 3 }), std::invalid_argument);
+	REQUIRE(join->probeOrder() == std::array<std::size_t, 3>{ 2, 0, 1 });
+	tgen2->start(10);
+	REQUIRE(tgen1->numProcessedTuples() == 21);
+	REQUIRE(join->probeOrder() == std::array<std::size_t, 3>{ 2, 0, 1 });
+}
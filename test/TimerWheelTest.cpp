@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "qop/TimerWheel.hpp"
+#include "dsl/Topology.hpp"
+#include "dsl/Pipe.hpp"
+#include "dsl/PFabricContext.hpp"
+
+using namespace pfabric;
+
+TEST_CASE("Running one-shot and periodic timers on a timer wheel", "[TimerWheel]") {
+  auto timers = std::make_shared<TimerWheel>(std::chrono::microseconds(50));
+  std::atomic<int> once(0), periodic(0);
+
+  auto start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::duration fired;
+  timers->schedule([&]() { fired = std::chrono::steady_clock::now() - start; once++; },
+                   std::chrono::milliseconds(20));
+  auto timer = timers->scheduleEvery([&]() { periodic++; }, std::chrono::milliseconds(10));
+  REQUIRE(timers->numTimers() == 2);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  timers->cancel(timer);
+
+  // a timer never fires too early
+  REQUIRE(once == 1);
+  REQUIRE(fired >= std::chrono::milliseconds(20));
+  int n = periodic;
+  REQUIRE(n >= 5);
+  REQUIRE(timers->numTimers() == 0);
+
+  // after cancelling the timer isn't invoked anymore
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  REQUIRE(periodic == n);
+}
+
+TEST_CASE("Cascading timers from the upper levels of a timer wheel", "[TimerWheel]") {
+  // with a tick of 10us, level 0 covers only 2.56ms
+  auto timers = std::make_shared<TimerWheel>(std::chrono::microseconds(10));
+  std::mutex mtx;
+  std::vector<int> order;
+
+  const std::vector<int> delays = { 300, 5, 120, 40, 1 };
+  for (auto d : delays) {
+    timers->schedule([&, d]() {
+      std::lock_guard<std::mutex> lock(mtx);
+      order.push_back(d);
+    }, std::chrono::milliseconds(d));
+  }
+  // a cancelled timer is never invoked
+  auto cancelled = timers->schedule([&]() {
+    std::lock_guard<std::mutex> lock(mtx);
+    order.push_back(-1);
+  }, std::chrono::milliseconds(60));
+  timers->cancel(cancelled);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  std::lock_guard<std::mutex> lock(mtx);
+  REQUIRE(order == std::vector<int>({ 1, 5, 40, 120, 300 }));
+}
+
+TEST_CASE("Catching up a timer wheel after a blocking timer", "[TimerWheel]") {
+  // with a tick of 1us, the blocking timer delays the wheel by 100000 ticks
+  auto timers = std::make_shared<TimerWheel>(std::chrono::microseconds(1));
+  std::mutex mtx;
+  std::vector<int> order;
+  auto record = [&](int d) {
+    std::lock_guard<std::mutex> lock(mtx);
+    order.push_back(d);
+  };
+
+  timers->schedule([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    record(1);
+  }, std::chrono::milliseconds(1));
+  const std::vector<int> delays = { 80, 20, 400, 150 };
+  for (auto d : delays)
+    timers->schedule([&, d]() { record(d); }, std::chrono::milliseconds(d));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(600));
+  std::lock_guard<std::mutex> lock(mtx);
+  REQUIRE(order == std::vector<int>({ 1, 20, 80, 150, 400 }));
+}
+
+TEST_CASE("Sharing a timer wheel among time-triggered operators", "[TimerWheel][Topology]") {
+  typedef TuplePtr<int, double> T1;
+  using AggrC = Aggregator1<T1, AggrCount<double, int>, 1>;
+
+  PFabricContext ctx;
+  auto t = ctx.createTopology();
+  std::atomic<int> results(0);
+
+  // three aggregates triggered every second, all run by the same timer wheel
+  for (int i = 0; i < 3; i++) {
+    t->streamFromGenerator<T1>([](unsigned long n) -> T1 {
+        return makeTuplePtr((int)n, n * 1.5);
+      }, 100)
+      .aggregate<AggrC>(TriggerByTime, 1)
+      .notify([&](auto tp, bool outdated) { results++; });
+  }
+  t->start(false);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  REQUIRE(results >= 3);
+}
+
+TEST_CASE("Running a topology periodically without blocking the timer wheel", "[TimerWheel][Topology]") {
+  typedef TuplePtr<int> T1;
+
+  auto timers = std::make_shared<TimerWheel>();
+  std::atomic<int> runs(0), ticks(0);
+  auto timer = timers->scheduleEvery([&]() { ticks++; }, std::chrono::milliseconds(10));
+  {
+    Topology t(nullptr, timers);
+    // a slow query taking one second
+    t.streamFromGenerator<T1>([](unsigned long n) -> T1 {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return makeTuplePtr((int)n);
+      }, 10)
+      .notify([&](auto tp, bool outdated) { if (get<0>(tp) == 9) runs++; });
+    t.runEvery(1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1300));
+    int n = ticks;
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    // the query runs in its own thread, i.e. the other timers are still invoked
+    REQUIRE(ticks - n >= 20);
+  }
+  // the topology waits for the run in progress
+  REQUIRE(runs == 1);
+  timers->cancel(timer);
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include "catch.hpp"
+
+#include <map>
+#include <vector>
+
+#include "core/Tuple.hpp"
+#include "dsl/Topology.hpp"
+#include "dsl/Pipe.hpp"
+#include "qop/SpaceSaving.hpp"
+
+using namespace pfabric;
+
+TEST_CASE("Counting keys exactly in a Space-Saving summary", "[SpaceSaving]") {
+  SpaceSaving<int> summary(10);
+  for (int i = 0; i < 10; i++) {
+    for (int j = 0; j <= i; j++)
+      summary.add(i);
+  }
+  REQUIRE(summary.size() == 10);
+
+  auto top = summary.topK(3);
+  REQUIRE(top.size() == 3);
+  for (int r = 0; r < 3; r++) {
+    REQUIRE(top[r].mKey == 9 - r);
+    REQUIRE(top[r].mCount == 10u - r);
+    REQUIRE(top[r].mError == 0);
+  }
+
+  summary.remove(9, 8);
+  REQUIRE(summary.estimate(9) == 2);
+  REQUIRE(summary.topK(1)[0].mKey == 8);
+  // removing an unknown key is ignored
+  summary.remove(42);
+  REQUIRE(summary.size() == 10);
+
+  summary.clear();
+  REQUIRE(summary.size() == 0);
+  REQUIRE(summary.topK(3).empty());
+}
+
+TEST_CASE("Finding the heavy hitters with a bounded Space-Saving summary", "[SpaceSaving]") {
+  SpaceSaving<int> summary(20);
+  std::map<int, std::uint64_t> freqs;
+  // three heavy keys and 1000 keys occurring only twice
+  for (int i = 0; i < 2000; i++) {
+    const int key = i % 4 == 0 ? i % 3 : 100 + i % 1000;
+    summary.add(key);
+    freqs[key]++;
+  }
+  REQUIRE(summary.size() == summary.capacity());
+
+  auto top = summary.topK(3);
+  REQUIRE(top.size() == 3);
+  std::map<int, bool> found;
+  for (const auto& c : top) {
+    found[c.mKey] = true;
+    // the counter never underestimates and the error bounds the overestimation
+    REQUIRE(c.mCount >= freqs[c.mKey]);
+    REQUIRE(c.mCount - c.mError <= freqs[c.mKey]);
+  }
+  REQUIRE(found.size() == 3);
+  REQUIRE(found.count(0) == 1);
+  REQUIRE(found.count(1) == 1);
+  REQUIRE(found.count(2) == 1);
+}
+
+TEST_CASE("Determining the top-k keys of a sliding window", "[TopK]") {
+  typedef TuplePtr<int, int> MyTuplePtr;
+
+  std::vector<std::vector<int>> results;
+  Topology t;
+  auto s = t.streamFromGenerator<MyTuplePtr>([](unsigned long n) {
+      // key 1 dominates the first 100 tuples, key 2 the last 100 tuples
+      int key = n % 2 == 0 ? (n < 100 ? 1 : 2) : 10 + n % 7;
+      return makeTuplePtr(key, (int)n);
+    }, 200)
+    .keyBy<0, int>()
+    .slidingWindow(WindowParams::RowWindow, 100)
+    .topK<int>(2, 0, TriggerByCount, 100)
+    .notify([&](auto tp, bool outdated) {
+      if (get<0>(tp) == 1)
+        results.push_back({});
+      results.back().push_back(get<1>(tp));
+      REQUIRE(get<2>(tp) > 0);
+    });
+
+  t.start(false);
+
+  REQUIRE(results.size() == 2);
+  REQUIRE(results[0].size() == 2);
+  REQUIRE(results[0][0] == 1);
+  REQUIRE(results[1][0] == 2);
+}
+
+TEST_CASE("Determining the top-k keys without a key extractor", "[TopK]") {
+  typedef TuplePtr<int, int> MyTuplePtr;
+
+  Topology t;
+  auto s = t.streamFromGenerator<MyTuplePtr>([](unsigned long n) {
+      return makeTuplePtr((int)n, (int)n);
+    }, 10);
+  REQUIRE_THROWS_AS(s.topK<int>(3), TopologyException);
+}
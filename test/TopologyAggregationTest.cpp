@@ -21,6 +21,7 @@
 #include <thread>
 #include <chrono>
 #include <future>
+#include <map>
 
 #include "core/Tuple.hpp"
 
@@ -122,6 +123,38 @@ TEST_CASE("Building and running a topology with sliding window-based aggregation
   REQUIRE(results == expected);
 }
 
+TEST_CASE("Building and running a topology with sliding window-based min/max aggregation",
+        "[Window Aggregation]") {
+  using TpPtr = TuplePtr<unsigned int, unsigned long>;
+  // AggrMinMax is replaced by the monotonic deque-based AggrWindowMinMax
+  using AggrMM = Aggregator2<TpPtr, AggrMinMax<unsigned long, std::less<unsigned long>>, 1,
+                                    AggrMinMax<unsigned long, std::greater<unsigned long>>, 1>;
+  const std::vector<unsigned long> input = {5, 3, 8, 1, 9, 7, 6, 2, 4, 10};
+
+  StreamGenerator<TpPtr>::Generator streamGen ([&](unsigned long n) -> TpPtr {
+      return makeTuplePtr((unsigned int)(n+1), input[n]);
+  });
+
+  const std::vector<unsigned long> expectedMin = {5, 3, 3, 1, 1, 1, 6, 2, 2, 2};
+  const std::vector<unsigned long> expectedMax = {5, 5, 8, 8, 9, 9, 9, 7, 6, 10};
+  std::vector<unsigned long> resultsMin, resultsMax;
+
+  Topology t;
+  auto s = t.streamFromGenerator<TpPtr>(streamGen, input.size())
+    .slidingWindow(WindowParams::RowWindow, 3)
+    .aggregate<AggrMM>()
+    .notify([&](auto tp, bool outdated) {
+        if (!outdated) {
+          resultsMin.push_back(get<0>(tp));
+          resultsMax.push_back(get<1>(tp));
+        }
+    });
+  t.start(false);
+
+  REQUIRE(resultsMin == expectedMin);
+  REQUIRE(resultsMax == expectedMax);
+}
+
 TEST_CASE("Building and running a topology with tumbling window-based aggregation",
         "[Window Aggregation]") {
   using TpPtr = TuplePtr<unsigned int, unsigned long>;
@@ -175,3 +208,198 @@ TEST_CASE("Building and running a topology with window-based aggregation and cus
 
   REQUIRE(results == expected);
 }
+
+TEST_CASE("Building and running a topology with pane-based window aggregation",
+        "[Window Aggregation]") {
+  using TpPtr = TuplePtr<unsigned int, unsigned long>;
+  using AggrMin = Aggregator1<TpPtr, AggrGlobalMin<unsigned long>, 1>;
+  using AggrC = Aggregator1<TpPtr, AggrCount<unsigned long, int>, 1>;
+  const auto amountOfTp = 10;
+
+  StreamGenerator<TpPtr>::Generator streamGen ([](unsigned long n) -> TpPtr {
+      return makeTuplePtr((unsigned int)(n+1), n+1);
+  });
+
+  const std::vector<unsigned long> expected1 = {1, 1, 1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<unsigned long> results1;
+
+  Topology t1;
+  auto s1 = t1.streamFromGenerator<TpPtr>(streamGen, amountOfTp)
+    .windowAggregate<AggrMin>(WindowParams::RowWindow, 3)
+    .notify([&](auto tp, bool outdated) {
+        REQUIRE(!outdated);
+        results1.push_back(get<0>(tp));
+    });
+  t1.start(false);
+
+  REQUIRE(results1 == expected1);
+
+  // windows [0, 5), [5, 10), and [10, 15) at the end of the stream
+  const std::vector<unsigned long> expected2 = {4, 5, 1};
+  std::vector<unsigned long> results2;
+
+  Topology t2;
+  auto s2 = t2.streamFromGenerator<TpPtr>(streamGen, amountOfTp)
+    .assignTimestamps<0>()
+    .windowAggregate<AggrC>(WindowParams::RangeWindow, 5, 5)
+    .notify([&](auto tp, bool outdated) {
+        results2.push_back(get<0>(tp));
+    });
+  t2.start(false);
+
+  REQUIRE(results2 == expected2);
+
+  Topology t3;
+  REQUIRE_THROWS_AS(t3.streamFromGenerator<TpPtr>(streamGen, amountOfTp)
+    .windowAggregate<AggrC>(WindowParams::RangeWindow, 5, 5), TopologyException);
+}
+
+TEST_CASE("Building and running a topology with boundary-based tumbling window aggregation",
+        "[Window Aggregation]") {
+  using TpPtr = TuplePtr<unsigned int, unsigned long>;
+  using AggrC = Aggregator1<TpPtr, AggrCount<unsigned long, int> , 1>;
+  const auto amountOfTp = 10;
+
+  StreamGenerator<TpPtr>::Generator streamGen ([](unsigned long n) -> TpPtr {
+      return makeTuplePtr((unsigned int)(n+1), n+1);
+  });
+
+  const std::vector<unsigned long> expected1 = {1, 2, 3, 4, 5, 1, 2, 3, 4, 5};
+  std::vector<unsigned long> results1;
+
+  Topology t1;
+  auto func = [](auto tp) { return Timestamp(get<0>(tp)*1000*1000); };
+  auto s1 = t1.streamFromGenerator<TpPtr>(streamGen, amountOfTp)
+    .assignTimestamps(func)
+    .tumblingWindow(WindowParams::RangeWindow, 5, nullptr, WindowParams::ExpireBoundary)
+    .aggregate<AggrC>()
+    .notify([&](auto tp, bool outdated) {
+        REQUIRE(!outdated);
+        results1.push_back(get<0>(tp));
+    });
+  t1.start(false);
+
+  REQUIRE(results1 == expected1);
+
+  // count odd and even values in windows of 4 tuples
+  const std::vector<unsigned long> expected2 = {1, 1, 2, 2, 1, 1, 2, 2, 1, 1};
+  std::vector<unsigned long> results2;
+
+  Topology t2;
+  auto s2 = t2.streamFromGenerator<TpPtr>(streamGen, amountOfTp)
+    .keyBy<DefaultKeyType>([](auto tp) { return get<1>(tp) % 2; })
+    .tumblingWindow(WindowParams::RowWindow, 4, nullptr, WindowParams::ExpireBoundary)
+    .groupBy<AggrC, DefaultKeyType>()
+    .notify([&](auto tp, bool outdated) {
+        REQUIRE(!outdated);
+        results2.push_back(get<0>(tp));
+    });
+  t2.start(false);
+
+  REQUIRE(results2 == expected2);
+}
+
+TEST_CASE("Building and running a topology with watermark-based window aggregation",
+        "[Window Aggregation]") {
+  using TpPtr = TuplePtr<unsigned int, unsigned long>;
+  using AggrC = Aggregator1<TpPtr, AggrCount<unsigned long, int> , 1>;
+  // out-of-order timestamps, the final tuple exceeds the allowed lateness
+  const std::vector<unsigned int> times = { 2, 1, 3, 5, 4, 6, 8, 7, 9, 11, 10, 12, 3 };
+
+  StreamGenerator<TpPtr>::Generator streamGen ([&](unsigned long n) -> TpPtr {
+      return makeTuplePtr(times[n], n+1);
+  });
+
+  // watermark 6 triggers the aggregate over [2,6], the final watermark
+  // expires the whole window
+  const std::vector<unsigned long> expected = {6, 0};
+  std::vector<unsigned long> results;
+
+  Topology t;
+  auto func = [](auto tp) { return std::chrono::seconds(get<0>(tp)); };
+  auto s = t.streamFromGenerator<TpPtr>(streamGen, times.size())
+    .assignTimestamps(func)
+    .assignWatermarks(2000)
+    .slidingWindow(WindowParams::RangeWindow, 5)
+    .aggregate<AggrC>(TriggerByTimestamp, 5)
+    .notify([&](auto tp, bool outdated) {
+        if (!outdated) results.push_back(get<0>(tp));
+    });
+  t.start(false);
+
+  REQUIRE(results == expected);
+
+  Topology t2;
+  REQUIRE_THROWS_AS(t2.streamFromGenerator<TpPtr>(streamGen, times.size())
+    .assignWatermarks(2000), TopologyException);
+}
+
+TEST_CASE("Building and running a topology with session window-based grouping",
+        "[Window Aggregation]") {
+  using TpPtr = TuplePtr<unsigned long, unsigned int>;
+  using AggrC = Aggregator1<TpPtr, AggrCount<unsigned int, int> , 1>;
+  // key 0 has the sessions {1, 2, 3} and {10, 11}, key 1 has the session {2, 4, 6}
+  const std::vector<std::pair<unsigned long, unsigned int>> input =
+    { {0, 1}, {1, 2}, {0, 2}, {0, 3}, {1, 4}, {1, 6}, {0, 10}, {0, 11} };
+
+  StreamGenerator<TpPtr>::Generator streamGen ([&](unsigned long n) -> TpPtr {
+      return makeTuplePtr(input[n].first, input[n].second);
+  });
+
+  // the count per key grows with each tuple and shrinks to 0 when the session is closed:
+  // tuple 6 closes the first session of key 0, tuple 10 the session of key 1, and the
+  // end of the stream the second session of key 0
+  const std::vector<int> expected = { 1, 1, 2, 3, 2, 3, 2, 1, 0, 1, 2, 1, 0, 2, 1, 0 };
+  std::vector<int> results;
+
+  Topology t;
+  auto func = [](auto tp) { return std::chrono::seconds(get<1>(tp)); };
+  auto s = t.streamFromGenerator<TpPtr>(streamGen, input.size())
+    .keyBy<0>()
+    .assignTimestamps(func)
+    .sessionWindow(3)
+    .groupBy<AggrC, unsigned long>()
+    .notify([&](auto tp, bool outdated) {
+        results.push_back(get<0>(tp));
+    });
+  t.start(false);
+
+  REQUIRE(results == expected);
+
+  Topology t2;
+  REQUIRE_THROWS_AS(t2.streamFromGenerator<TpPtr>(streamGen, input.size())
+    .assignTimestamps(func)
+    .sessionWindow(3), TopologyException);
+}
+
+TEST_CASE("Building and running a topology with keyed window-based grouping",
+        "[Window Aggregation]") {
+  using TpPtr = TuplePtr<unsigned long, double>;
+  using AggrS = Aggregator2<TpPtr, AggrIdentity<unsigned long>, 0, AggrSum<double>, 1>;
+  const auto amountOfTp = 12;
+
+  // 3 sensors sending the readings 0, 1, 2, ...
+  StreamGenerator<TpPtr>::Generator streamGen ([](unsigned long n) -> TpPtr {
+      return makeTuplePtr(n % 3, (double)(n / 3));
+  });
+
+  std::map<unsigned long, double> results;
+
+  Topology t;
+  auto s = t.streamFromGenerator<TpPtr>(streamGen, amountOfTp)
+    .keyBy<0>()
+    .keyedWindow(WindowParams::RowWindow, 2)
+    .groupBy<AggrS, unsigned long>()
+    .notify([&](auto tp, bool outdated) {
+        results[get<0>(tp)] = get<1>(tp);
+    });
+  t.start(false);
+
+  // the sum of the last 2 readings (2 + 3) per sensor
+  const std::map<unsigned long, double> expected = { {0, 5.0}, {1, 5.0}, {2, 5.0} };
+  REQUIRE(results == expected);
+
+  Topology t2;
+  REQUIRE_THROWS_AS(t2.streamFromGenerator<TpPtr>(streamGen, amountOfTp)
+    .keyedWindow(WindowParams::RowWindow, 2), TopologyException);
+}
@@ -19,6 +19,7 @@
 #include <thread>
 #include <chrono>
 #include <future>
+#include <random>
 
 #include <boost/core/ignore_unused.hpp>
 
@@ -29,10 +30,13 @@
 #include "core/Tuple.hpp"
 
 #include "table/Table.hpp"
+#include "table/StateContext.hpp"
 
 #include "dsl/Topology.hpp"
 #include "dsl/Pipe.hpp"
 
+#include "qop/FlatHashTable.hpp"
+
 #include "benchmark/benchmark.h"
 
 using namespace pfabric;
@@ -68,8 +72,7 @@ void TopologyMapWhereTest(benchmark::State& state) {
 	  //remove tuples whose <int> value is no multiple of 50
 	  .where([](auto tp, bool outdated) { return get<1>(tp) % 50 == 0; });
 
-    t.start();
-    t.wait();
+    t.start(false);
   }
 }
 //register method for testing
@@ -97,12 +100,63 @@ void TopologyWhereMapTest(benchmark::State& state) {
         return makeTuplePtr(get<2>(tp), get<0>(tp));
       });
 
-    t.start();
-    t.wait();
+    t.start(false);
   }
 }
 BENCHMARK(TopologyWhereMapTest);
 
+/**
+ *Testing method one and two with operator fusion: "map" and "where" are
+ *executed as a single fused operator.
+ */
+void TopologyFusedMapWhereTest(benchmark::State& state) {
+
+  typedef TuplePtr<int, std::string, double> T1;
+  typedef TuplePtr<double, int> T2;
+
+  TestDataGenerator tgen("file.csv");
+  tgen.writeData(1000);
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s = t.newStreamFromFile("file.csv")
+      .extract<T1>(',')
+      .fuse()
+        .map<T2>([](auto tp, bool outdated) -> T2 {
+          return makeTuplePtr(get<2>(tp), get<0>(tp));
+        })
+        .where([](auto tp, bool outdated) { return get<1>(tp) % 50 == 0; })
+      .endFuse();
+
+    t.start(false);
+  }
+}
+BENCHMARK(TopologyFusedMapWhereTest);
+
+void TopologyFusedWhereMapTest(benchmark::State& state) {
+
+  typedef TuplePtr<int, std::string, double> T1;
+  typedef TuplePtr<double, int> T2;
+
+  TestDataGenerator tgen("file.csv");
+  tgen.writeData(1000);
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s = t.newStreamFromFile("file.csv")
+      .extract<T1>(',')
+      .fuse()
+        .where([](auto tp, bool outdated) { return get<0>(tp) % 50 == 0; })
+        .map<T2>([](auto tp, bool outdated) -> T2 {
+          return makeTuplePtr(get<2>(tp), get<0>(tp));
+        })
+      .endFuse();
+
+    t.start(false);
+  }
+}
+BENCHMARK(TopologyFusedWhereMapTest);
+
 /**
  *Testing method three: partitioned "where" before "map"
  *In addition to method two, a partitioning with three partitions is used.
@@ -138,6 +192,170 @@ void TopologyPartitionedWhereBeforeMapTest(benchmark::State& state) {
 }
 BENCHMARK(TopologyPartitionedWhereBeforeMapTest);
 
+/**
+ *Testing the queue operator: a generated stream is decoupled via a queue.
+ *The argument denotes the capacity of the queue: 0 uses the mutex-based
+ *unbounded queue, otherwise the lock-free ring buffer is used.
+ */
+void TopologyQueueTest(benchmark::State& state) {
+
+  typedef TuplePtr<int, double> T1;
+
+  const unsigned long numTuples = 100000;
+  const std::size_t capacity = state.range(0);
+
+  while (state.KeepRunning()) {
+    std::atomic<unsigned long> received(0);
+    Topology t;
+    auto s = t.streamFromGenerator<T1>([](unsigned long n) -> T1 {
+        return makeTuplePtr((int)n, n * 1.5);
+      }, numTuples)
+      .queue(capacity)
+      .notify([&](auto tp, bool outdated) { received++; });
+
+    t.start(false);
+    //wait until the consumer thread has forwarded all tuples
+    while (received < numTuples)
+      std::this_thread::yield();
+  }
+}
+BENCHMARK(TopologyQueueTest)->Arg(0)->Arg(1024);
+
+/**
+ *Testing tuple allocation: each generated tuple is mapped to a new tuple,
+ *i.e. two tuples are created and released per stream element (taken from
+ *the slab pools if USE_TUPLE_POOL is defined).
+ */
+void TopologyTupleAllocationTest(benchmark::State& state) {
+
+  typedef TuplePtr<int, double> T1;
+  typedef TuplePtr<double, int> T2;
+
+  const unsigned long numTuples = 100000;
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s = t.streamFromGenerator<T1>([](unsigned long n) -> T1 {
+        return makeTuplePtr((int)n, n * 1.5);
+      }, numTuples)
+      .map<T2>([](auto tp, bool outdated) -> T2 {
+        return makeTuplePtr(get<1>(tp), get<0>(tp));
+      })
+      .where([](auto tp, bool outdated) { return get<1>(tp) % 50 == 0; });
+
+    t.start(false);
+  }
+}
+BENCHMARK(TopologyTupleAllocationTest);
+
+/**
+ *Testing columnar batches: the same query as TopologyTupleAllocationTest, but
+ *"where" and "map" are evaluated batch-wise on a TupleBatch.
+ */
+void TopologyBatchMapWhereTest(benchmark::State& state) {
+
+  typedef TuplePtr<int, double> T1;
+  typedef TupleBatch<int, double> B1;
+  typedef TupleBatchPtr<double, int> B2;
+
+  const unsigned long numTuples = 100000;
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s = t.streamFromGenerator<T1>([](unsigned long n) -> T1 {
+        return makeTuplePtr((int)n, n * 1.5);
+      }, numTuples)
+      .batchColumns(1024)
+      .mapBatch<B2>([](const B1& b, std::size_t row) {
+        return std::make_tuple(get<1>(b, row), get<0>(b, row));
+      })
+      .whereBatch([](const TupleBatch<double, int>& b, std::size_t row) {
+        return get<1>(b, row) % 50 == 0;
+      });
+
+    t.start(false);
+  }
+}
+BENCHMARK(TopologyBatchMapWhereTest);
+
+/**
+ *Testing windows: a row-based sliding window where each incoming tuple
+ *evicts the oldest one from the window buffer.
+ */
+void TopologySlidingWindowTest(benchmark::State& state) {
+
+  typedef TuplePtr<int, double> T1;
+
+  const unsigned long numTuples = 100000;
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s = t.streamFromGenerator<T1>([](unsigned long n) -> T1 {
+        return makeTuplePtr((int)n, n * 1.5);
+      }, numTuples)
+      .slidingWindow(WindowParams::RowWindow, state.range(0))
+      .where([](auto tp, bool outdated) { return !outdated; });
+
+    t.start(false);
+  }
+}
+BENCHMARK(TopologySlidingWindowTest)->Arg(100)->Arg(10000);
+
+/**
+ *Testing sliding window aggregation: the maximum over the last 1000 tuples
+ *is computed either by a window producing outdated tuples followed by an
+ *aggregation (Arg 0) or by the pane-based window aggregation (Arg 1).
+ */
+void TopologyWindowAggregationTest(benchmark::State& state) {
+
+  typedef TuplePtr<int, double> T1;
+  typedef Aggregator1<T1, AggrMinMax<double, std::greater<double>>, 1> AggrStateMinMax;
+  typedef Aggregator1<T1, AggrGlobalMax<double>, 1> AggrStateMax;
+
+  const unsigned long numTuples = 100000;
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s = t.streamFromGenerator<T1>([](unsigned long n) -> T1 {
+        return makeTuplePtr((int)n, (double)((n * 7919) % 10007));
+      }, numTuples);
+    if (state.range(0) == 0)
+      s.slidingWindow(WindowParams::RowWindow, 1000)
+       .aggregate<AggrStateMinMax>();
+    else
+      s.windowAggregate<AggrStateMax>(WindowParams::RowWindow, 1000);
+
+    t.start(false);
+  }
+}
+BENCHMARK(TopologyWindowAggregationTest)->Arg(0)->Arg(1);
+
+/**
+ *Testing tumbling windows: the sum of each window of 10000 tuples is
+ *computed with a window publishing all tuples as outdated (Arg 0) or
+ *only the window boundary (Arg 1).
+ */
+void TopologyTumblingWindowTest(benchmark::State& state) {
+
+  typedef TuplePtr<int, double> T1;
+  typedef Aggregator1<T1, AggrSum<double>, 1> AggrStateSum;
+
+  const unsigned long numTuples = 100000;
+  const auto mode = state.range(0) == 0 ? WindowParams::ExpireTuples : WindowParams::ExpireBoundary;
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s = t.streamFromGenerator<T1>([](unsigned long n) -> T1 {
+        return makeTuplePtr((int)n, n * 1.5);
+      }, numTuples)
+      .tumblingWindow(WindowParams::RowWindow, 10000, nullptr, mode)
+      .aggregate<AggrStateSum>(TriggerByCount, 10000);
+
+    t.start(false);
+  }
+}
+BENCHMARK(TopologyTumblingWindowTest)->Arg(0)->Arg(1);
+
 //Some math operation used for next two testing methods
 double doMath(double input) {
 	double result = 0;
@@ -180,6 +398,187 @@ void TopologyGroupByTest(benchmark::State& state) {
 }
 BENCHMARK(TopologyGroupByTest);
 
+/**
+ *An allocator counting the number of bytes currently allocated. It is used
+ *to determine the memory footprint of the node-based group state table.
+ */
+static std::size_t allocatedBytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+  typedef T value_type;
+
+  CountingAllocator() = default;
+  template <typename U> CountingAllocator(const CountingAllocator<U>&) {}
+
+  T* allocate(std::size_t n) {
+    allocatedBytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, std::size_t n) {
+    allocatedBytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(p, n);
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const CountingAllocator<T>&, const CountingAllocator<U>&) { return false; }
+
+/**
+ *Testing the group state table of the groupby operator:
+ *A stream of at least 1M tuples with uniformly distributed keys out of the
+ *given number of keys is aggregated either by a boost::unordered_map with
+ *heap-allocated states and two lookups per tuple (Arg 0, the former
+ *implementation) or by the GroupedAggregation operator itself, i.e. its
+ *FlatHashTable of group entries with inline states (Arg 1). The number of
+ *groups and the memory footprint of the table (as bytes per group) are
+ *reported.
+ */
+void TopologyGroupByStateTableTest(benchmark::State& state) {
+  typedef TuplePtr<int, std::string, double> T1;
+  typedef Aggregator1<T1, AggrSum<double>, 2, int> AggrStateSum;
+  typedef std::shared_ptr<AggrStateSum> AggrStatePtr;
+  typedef std::pair<const int, AggrStatePtr> NodeType;
+  typedef boost::unordered_map<int, AggrStatePtr, boost::hash<int>, std::equal_to<int>,
+                               CountingAllocator<NodeType>> NodeTable;
+  typedef GroupedAggregation<T1, typename AggrStateSum::ResultTypePtr, AggrStateSum, int> GroupByOp;
+
+  const int numKeys = state.range(1);
+  std::vector<int> keys(std::max(1000000, 2 * numKeys));
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> dist(0, numKeys - 1);
+  for (auto& k : keys)
+    k = dist(gen);
+
+  std::size_t numGroups = 0;
+  double bytesPerGroup = 0;
+  while (state.KeepRunning()) {
+    if (state.range(0) == 0) {
+      allocatedBytes = 0;
+      NodeTable table;
+      for (auto k : keys) {
+        auto tp = makeTuplePtr(k, std::string(), 1.0);
+        auto key = get<0>(tp);
+        if (table.count(key) == 0)
+          table.insert({ key, std::allocate_shared<AggrStateSum>(CountingAllocator<AggrStateSum>()) });
+        AggrStateSum::iterateForKey(tp, key, table.find(key)->second, false);
+      }
+      numGroups = table.size();
+      bytesPerGroup = double(allocatedBytes) / numGroups;
+    }
+    else {
+      // the aggregates are published only once at the end
+      GroupByOp op([](const T1& tp) { return get<0>(tp); }, AggrStateSum::finalize,
+                   AggrStateSum::iterateForKey, TriggerByCount, keys.size());
+      auto slot = op.getInputDataChannel().getSlot();
+      for (auto k : keys)
+        slot(makeTuplePtr(k, std::string(), 1.0), false);
+      numGroups = op.numGroups();
+      bytesPerGroup = double(op.memoryUsage()) / numGroups;
+    }
+  }
+  state.counters["numGroups"] = numGroups;
+  state.counters["bytesPerGroup"] = bytesPerGroup;
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(TopologyGroupByStateTableTest)->Args({0, 1000})->Args({1, 1000})
+  ->Args({0, 100000})->Args({1, 100000})->Args({0, 10000000})->Args({1, 10000000})
+  ->Unit(benchmark::kMillisecond);
+
+/**
+ *Generates the keys of a skewed stream: 1M keys out of 100000 distinct keys
+ *following a Zipfian distribution.
+ */
+static const std::vector<int>& zipfianKeys() {
+  static std::vector<int> keys;
+  if (keys.empty()) {
+    ZipfianGenerator<int> zipfGen(0, 99999);
+    keys.resize(1000000);
+    for (auto& k : keys)
+      k = zipfGen.nextValue();
+  }
+  return keys;
+}
+
+/**
+ *Testing the top-k keys of a sliding window over a Zipfian stream:
+ *The 10 most frequent keys of the last 100000 tuples are determined either
+ *by counting all keys with a groupby and sorting the counts (Arg 0) or by
+ *the topK operator with a bounded Space-Saving summary (Arg 1).
+ */
+void TopologyTopKTest(benchmark::State& state) {
+  typedef TuplePtr<int, int> T1;
+  typedef TuplePtr<int, int> T2;
+  typedef Aggregator2<T1, AggrIdentity<int>, 0, AggrCount<int, int>, 0, int> AggrStateCount;
+
+  const auto& keys = zipfianKeys();
+
+  while (state.KeepRunning()) {
+    Topology t;
+    std::unordered_map<int, int> counts;
+    unsigned long numResults = 0;
+    auto s = t.streamFromGenerator<T1>([&keys](unsigned long n) -> T1 {
+        return makeTuplePtr(keys[n], (int)n);
+      }, keys.size())
+      .keyBy<0, int>()
+      .slidingWindow(WindowParams::RowWindow, 100000);
+    if (state.range(0) == 0)
+      s.groupBy<AggrStateCount, int>()
+       .notify([&](auto tp, bool outdated) {
+          counts[get<0>(tp)] = get<1>(tp);
+          if (!outdated && ++numResults % 1000 == 0) {
+            // extract the top-10 keys from all counts every 1000 tuples
+            std::vector<std::pair<int, int>> top(counts.begin(), counts.end());
+            std::partial_sort(top.begin(), top.begin() + std::min<std::size_t>(10, top.size()), top.end(),
+              [](const auto& p1, const auto& p2) { return p1.second > p2.second; });
+            benchmark::DoNotOptimize(top);
+          }
+        });
+    else
+      s.topK<int>(10, 1000, TriggerByCount, 1000)
+       .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+
+    t.start(false);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(TopologyTopKTest)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/**
+ *Testing approximate per-key frequencies in a sliding window over a Zipfian
+ *stream: the frequency of the key of each tuple within the last 100000 tuples
+ *is computed either exactly by a groupby (Arg 0) or by a Count-Min sketch
+ *aggregate with a fixed size of 16 KB (Arg 1).
+ */
+void TopologyCountMinTest(benchmark::State& state) {
+  typedef TuplePtr<int, int> T1;
+  typedef Aggregator2<T1, AggrIdentity<int>, 0, AggrCount<int, int>, 0, int> AggrStateCount;
+  typedef Aggregator1<T1, AggrCountMin<int>, 0> AggrStateCountMin;
+
+  const auto& keys = zipfianKeys();
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s = t.streamFromGenerator<T1>([&keys](unsigned long n) -> T1 {
+        return makeTuplePtr(keys[n], (int)n);
+      }, keys.size())
+      .keyBy<0, int>()
+      .slidingWindow(WindowParams::RowWindow, 100000);
+    if (state.range(0) == 0)
+      s.groupBy<AggrStateCount, int>()
+       .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+    else
+      s.aggregate<AggrStateCountMin>()
+       .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+
+    t.start(false);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(TopologyCountMinTest)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
 /**
  *Testing method five: partitioned "groupby"
  *Here the groupby operator along with some math in a mapping operator is
@@ -218,6 +617,173 @@ void TopologyPartitionedGroupByTest(benchmark::State& state) {
 }
 BENCHMARK(TopologyPartitionedGroupByTest);
 
+/**
+ *Testing windowed joins: two streams of 100000 tuples with 1000 distinct keys
+ *are joined over row windows of 1000 tuples either by sliding windows
+ *sending outdated tuples to the symmetric hash join (Arg 0) or by the join
+ *with built-in windows expiring its state in bulk (Arg 1).
+ */
+void TopologyWindowJoinTest(benchmark::State& state) {
+  typedef TuplePtr<int, int> T1;
+
+  const unsigned long numTuples = 100000;
+  auto gen = [](unsigned long n) { return makeTuplePtr((int)((n * 7919) % 1000), (int)n); };
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, numTuples)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, numTuples)
+      .keyBy<0>();
+    if (state.range(0) == 0) {
+      auto w1 = s1.slidingWindow(WindowParams::RowWindow, 1000);
+      s2.slidingWindow(WindowParams::RowWindow, 1000)
+        .join(w1, [](auto tp1, auto tp2) { return true; })
+        .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+    }
+    else
+      s2.windowJoin(s1, [](auto tp1, auto tp2) { return true; }, WindowParams::RowWindow, 1000)
+        .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+
+    t.start(false);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * numTuples);
+}
+BENCHMARK(TopologyWindowJoinTest)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/**
+ *Testing band joins: two streams of 20000 tuples (100 keys, one tuple per
+ *millisecond) are joined on the key and |ts1 - ts2| <= 50 ms either by the
+ *symmetric hash join evaluating the band as predicate (Arg 0) or by the band
+ *join probing only the band (Arg 1).
+ */
+void TopologyBandJoinTest(benchmark::State& state) {
+  typedef TuplePtr<int, int> T1;
+
+  const unsigned long numTuples = 20000;
+  auto gen = [](unsigned long n) { return makeTuplePtr((int)((n * 7919) % 100), (int)n); };
+  auto tsFunc = [](auto tp) { return std::chrono::milliseconds(get<1>(tp)); };
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, numTuples)
+      .assignTimestamps(tsFunc)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, numTuples)
+      .assignTimestamps(tsFunc)
+      .keyBy<0>();
+    if (state.range(0) == 0)
+      s2.join(s1, [](auto tp1, auto tp2) { return std::abs(get<1>(tp1) - get<1>(tp2)) <= 50; })
+        .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+    else
+      s2.bandJoin(s1, nullptr, std::chrono::milliseconds(50))
+        .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+
+    t.start(false);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * numTuples);
+}
+BENCHMARK(TopologyBandJoinTest)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/**
+ *Testing multi-way joins: two streams of 10000 tuples with 1000 distinct keys
+ *and a third stream of 10000 tuples with 10000 distinct keys are joined on the
+ *key either by chaining two symmetric hash joins materializing the
+ *intermediate results (Arg 0) or by the multi-way join (Arg 1).
+ */
+void TopologyMultiWayJoinTest(benchmark::State& state) {
+  typedef TuplePtr<int, int> T1;
+
+  const unsigned long numTuples = 10000;
+  auto gen = [](unsigned long n) { return makeTuplePtr((int)((n * 7919) % 1000), (int)n); };
+  auto gen3 = [](unsigned long n) { return makeTuplePtr((int)((n * 7919) % 10000), (int)n); };
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, numTuples)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, numTuples)
+      .keyBy<0>();
+    auto s3 = t.streamFromGenerator<T1>(gen3, numTuples)
+      .keyBy<0>();
+    if (state.range(0) == 0)
+      s1.join(s2, [](auto tp1, auto tp2) { return true; })
+        .keyBy<0>()
+        .join(s3, [](auto tp1, auto tp2) { return true; })
+        .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+    else
+      s1.multiJoin<unsigned long>(nullptr, s2, s3)
+        .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+
+    t.start(false);
+  }
+  state.SetItemsProcessed(state.iterations() * 3 * numTuples);
+}
+BENCHMARK(TopologyMultiWayJoinTest)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/**
+ *Testing ScaleJoin: two streams of 100000 tuples with unique keys are joined
+ *by 1, 2, 4 or 8 join instances reading the shared ring in parallel.
+ */
+void TopologyScaleJoinTest(benchmark::State& state) {
+  typedef TuplePtr<int, int> T1;
+
+  const unsigned long numTuples = 100000;
+  auto gen = [](unsigned long n) { return makeTuplePtr((int)n, (int)n); };
+
+  while (state.KeepRunning()) {
+    std::atomic<unsigned long> results(0);
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, numTuples)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, numTuples)
+      .keyBy<0>()
+      .scaleJoin(s1, [](auto tp1, auto tp2) { return true; }, state.range(0))
+      .notify([&](auto tp, bool outdated) { results++; });
+
+    t.start(false);
+    //wait until all join results were forwarded by the combining queue
+    while (results < numTuples)
+      std::this_thread::yield();
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * numTuples);
+}
+BENCHMARK(TopologyScaleJoinTest)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/**
+ *Testing stream enrichment: 100000 tuples are joined with a table of 10000
+ *records by calling getByKey in a map (Arg 0), by a lookup join (Arg 1) and by
+ *a lookup join caching 1000 records (Arg 2).
+ */
+void TopologyLookupJoinTest(benchmark::State& state) {
+  typedef TuplePtr<int, int> T1;
+  typedef Tuple<int, std::string, double> RecordType;
+
+  const unsigned long numTuples = 100000;
+  auto tbl = std::make_shared<Table<RecordType, int>>("LookupTable");
+  for (int i = 0; i < 10000; i++)
+    tbl->insert(i, RecordType(i, "a string field", i * 0.5));
+  auto gen = [](unsigned long n) { return makeTuplePtr((int)((n * 7919) % 10000) / 10, (int)n); };
+
+  while (state.KeepRunning()) {
+    Topology t;
+    auto s = t.streamFromGenerator<T1>(gen, numTuples);
+    if (state.range(0) == 0)
+      s.map<TuplePtr<int, int, int, std::string, double>>([&](auto tp, bool) {
+          auto rec = tbl->getByKey(get<0>(tp));
+          return makeTuplePtr(get<0>(tp), get<1>(tp), get<0>(*rec), get<1>(*rec), get<2>(*rec));
+        })
+        .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+    else
+      s.lookupJoin(tbl, [](auto tp) { return get<0>(tp); }, state.range(0) == 2 ? 1000 : 0)
+        .notify([](auto tp, bool outdated) { benchmark::DoNotOptimize(tp); });
+
+    t.start(false);
+  }
+  state.SetItemsProcessed(state.iterations() * numTuples);
+}
+BENCHMARK(TopologyLookupJoinTest)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
 /**
  *Testing method six: partitioned join
  *ERROR while testing: "double free or corruption (out)"
@@ -21,6 +21,8 @@
 #include <thread>
 #include <chrono>
 #include <future>
+#include <map>
+#include <mutex>
 
 #include <boost/filesystem.hpp>
 
@@ -263,3 +265,157 @@ TEST_CASE("Building and running a topology with partitioned grouping",
 	}
   }
 }
+
+TEST_CASE("Building and running a topology with grouping triggered by watermarks",
+        "[GroupBy]") {
+  typedef TuplePtr<unsigned long, unsigned int> MyTuplePtr;
+  typedef Aggregator1<MyTuplePtr, AggrCount<unsigned int, unsigned int>, 1> AggrStateCount;
+
+  StreamGenerator<MyTuplePtr>::Generator streamGen ([](unsigned long n) -> MyTuplePtr {
+    // swap neighboured timestamps to simulate out-of-order arrivals
+    return makeTuplePtr(n % 3, (unsigned int)(n % 2 == 0 ? n + 1 : n - 1));
+  });
+  unsigned long num = 100;
+  auto func = [](auto tp) { return std::chrono::seconds(get<1>(tp)); };
+
+  Topology t1;
+  REQUIRE_THROWS_AS((t1.streamFromGenerator<MyTuplePtr>(streamGen, num)
+    .keyBy<0>()
+    .groupBy<AggrStateCount, unsigned long>(TriggerByTimestamp, 10)), TopologyException);
+
+  Topology t2;
+  auto s = t2.streamFromGenerator<MyTuplePtr>(streamGen, num)
+    .assignTimestamps(func)
+    .assignWatermarks(1000)
+    .keyBy<0>()
+    .groupBy<AggrStateCount, unsigned long>(TriggerByTimestamp, 10);
+
+  // triggering the aggregates must not block the topology
+  REQUIRE_NOTHROW(t2.start(false));
+}
+
+TEST_CASE("Building and running a topology with two-phase grouping on skewed keys",
+        "[Partitioned Grouping]") {
+  typedef TuplePtr<unsigned long, double> MyTuplePtr;
+  typedef Aggregator2<MyTuplePtr, AggrIdentity<unsigned long>, 0,
+                      AggrSum<double>, 1, unsigned long> AggrState;
+
+  // half of the tuples belong to group 0
+  StreamGenerator<MyTuplePtr>::Generator streamGen ([](unsigned long n) -> MyTuplePtr {
+    return makeTuplePtr(n < 500 ? 0ul : n % 10, (double)n + 0.5);
+  });
+  const unsigned long num = 1000;
+
+  std::map<unsigned long, double> expected;
+  for (auto n = 0ul; n < num; n++)
+    expected[n < 500 ? 0ul : n % 10] += n + 0.5;
+
+  std::mutex mtx;
+  std::map<unsigned long, double> results;
+  unsigned long rr = 0;
+
+  Topology t;
+  auto s = t.streamFromGenerator<MyTuplePtr>(streamGen, num)
+    .keyBy<0>()
+    // round-robin partitioning independent of the grouping key
+    .partitionBy([&rr](auto tp) { return rr++ % 4; }, 4)
+    .twoPhaseGroupBy<AggrState, unsigned long>(50)
+    .notify([&](auto tp, bool outdated) {
+      std::lock_guard<std::mutex> guard(mtx);
+      results[get<0>(tp)] = get<1>(tp);
+    });
+
+  t.start();
+  // the last result per group contains the combined partial states of all partitions
+  for (auto i = 0; i < 100; i++) {
+    {
+      std::lock_guard<std::mutex> guard(mtx);
+      if (results == expected)
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  t.wait();
+
+  std::lock_guard<std::mutex> guard(mtx);
+  REQUIRE(results.size() == expected.size());
+  for (auto& res : results)
+    REQUIRE(res.second == Approx(expected[res.first]));
+}
+
+TEST_CASE("Two-phase grouping requires a partitioned stream", "[Partitioned Grouping]") {
+  typedef TuplePtr<unsigned long, double> MyTuplePtr;
+  typedef Aggregator2<MyTuplePtr, AggrIdentity<unsigned long>, 0,
+                      AggrSum<double>, 1, unsigned long> AggrState;
+
+  Topology t;
+  auto s = t.streamFromGenerator<MyTuplePtr>([](unsigned long n) {
+      return makeTuplePtr(n, (double)n);
+    }, 10)
+    .keyBy<0>();
+  REQUIRE_THROWS_AS((s.twoPhaseGroupBy<AggrState, unsigned long>(10)), TopologyException);
+}
+
+TEST_CASE("Building and running a topology with grouping triggered by count",
+        "[GroupBy]") {
+  typedef TuplePtr<int, int> MyTuplePtr;
+  typedef Aggregator2<MyTuplePtr, AggrIdentity<int>, 0, AggrCount<int, int>, 1, int> AggrState;
+
+  std::vector<int> keys = { 1, 1, 2, 2, 3, 3, 3, 3 };
+  std::map<int, int> results;
+  std::vector<int> outdatedKeys;
+  unsigned int numResults = 0;
+
+  Topology t;
+  auto s = t.streamFromGenerator<MyTuplePtr>([&keys](unsigned long n) {
+      return makeTuplePtr(keys[n], (int)n);
+    }, keys.size())
+    .keyBy<0, int>()
+    .slidingWindow(WindowParams::RowWindow, 2)
+    .groupBy<AggrState, int>(TriggerByCount, 2)
+    .notify([&](auto tp, bool outdated) {
+      numResults++;
+      if (outdated) {
+        outdatedKeys.push_back(get<0>(tp));
+        REQUIRE(get<1>(tp) == 0);
+      }
+      else
+        results[get<0>(tp)] = get<1>(tp);
+    });
+
+  t.start(false);
+
+  // each trigger publishes only the groups changed since the last trigger,
+  // vanished groups are published as outdated
+  REQUIRE(numResults == 6);
+  REQUIRE(results.size() == 3);
+  for (auto iter : results)
+    REQUIRE(iter.second == 2);
+  REQUIRE(outdatedKeys == std::vector<int>({ 1, 2 }));
+}
+
+TEST_CASE("Building and running a topology with grouping triggered by count over a tumbling window",
+        "[GroupBy]") {
+  typedef TuplePtr<int, int> MyTuplePtr;
+  typedef Aggregator2<MyTuplePtr, AggrIdentity<int>, 0, AggrCount<int, int>, 1, int> AggrState;
+
+  std::vector<int> results;
+
+  Topology t;
+  auto s = t.streamFromGenerator<MyTuplePtr>([](unsigned long n) {
+      return makeTuplePtr(1, (int)n);
+    }, 6)
+    .keyBy<0, int>()
+    .tumblingWindow(WindowParams::RowWindow, 3, nullptr, WindowParams::ExpireBoundary)
+    .groupBy<AggrState, int>(TriggerByCount, 2)
+    .notify([&](auto tp, bool outdated) {
+      REQUIRE(!outdated);
+      results.push_back(get<1>(tp));
+    });
+
+  t.start(false);
+
+  // the final aggregate of each window is published before the window expires,
+  // the next window starts counting from scratch
+  REQUIRE(results == std::vector<int>({ 2, 3, 2, 3 }));
+}
@@ -17,6 +17,7 @@
 
 #include "catch.hpp"
 
+#include <atomic>
 #include <sstream>
 #include <thread>
 #include <chrono>
@@ -60,6 +61,54 @@ TEST_CASE("Building and running a topology with ScaleJoin (3 instances)", "[Scal
   REQUIRE(results == num);
 }
 
+//ScaleJoin instances run as tasks of an executor and share a small ring
+TEST_CASE("Building and running a topology with ScaleJoin using an executor", "[ScaleJoin]") {
+  typedef TuplePtr<int, int> T1;
+
+  const unsigned long num = 1000;
+  std::atomic<unsigned long> results(0), outdatedResults(0);
+  auto gen1 = [](unsigned long n) { return makeTuplePtr((int)(n % 100), (int)n); };
+  auto gen2 = [](unsigned long n) { return makeTuplePtr((int)n, (int)n); };
+  auto joinPred = [](auto tp1, auto tp2) { return true; };
+  auto countResults = [&](auto tp, bool outdated) {
+    if (outdated) outdatedResults++;
+    else results++;
+  };
+
+  SECTION("producing on the source threads") {
+    Topology t(2);
+    auto s1 = t.streamFromGenerator<T1>(gen1, num)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen2, 100)
+      .keyBy<0>()
+      .scaleJoin(s1, joinPred, 4, 64)
+      .notify(countResults);
+
+    t.start(false);
+    for (int i = 0; i < 500 && results < num; i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  SECTION("producing on a worker") {
+    // a single worker runs the queue draining s1 and all join instances
+    Topology t(1);
+    auto s1 = t.streamFromGenerator<T1>(gen1, num)
+      .keyBy<0>()
+      .queue(16);
+    auto s2 = t.streamFromGenerator<T1>(gen2, 100)
+      .keyBy<0>()
+      .scaleJoin(s1, joinPred, 4, 8)
+      .notify(countResults);
+
+    t.start(false);
+    for (int i = 0; i < 500 && results < num; i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  REQUIRE(results == num);
+  REQUIRE(outdatedResults == 0);
+}
+
 //Symmetric Hash Join without partitioning
 TEST_CASE("Building and running a topology with joins", "[Unpartitioned Join]") {
   typedef TuplePtr<int, std::string, double> T1;
@@ -294,3 +343,242 @@ TEST_CASE("Building and running a topology with a join on two partitioned stream
     REQUIRE(results[i][1] == results[i][3]);
   }
 }
+
+//Symmetric Hash Join with built-in windows
+TEST_CASE("Building and running a topology with a windowed join", "[Windowed Join]") {
+  typedef TuplePtr<int, int> T1;
+
+  auto gen = [](unsigned long n) { return makeTuplePtr((int)(n % 10), (int)n); };
+  unsigned int results = 0;
+
+  SECTION("row windows") {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, 100)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, 100)
+      .keyBy<0>()
+      .windowJoin(s1, [](auto tp1, auto tp2) { return true; }, WindowParams::RowWindow, 10)
+      .notify([&](auto tp, bool outdated) { REQUIRE(!outdated); results++; });
+
+    t.start(false);
+    // each key occurs once in the last 10 tuples of the other stream
+    REQUIRE(results == 100);
+  }
+
+  SECTION("range windows") {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, 100)
+      .assignTimestamps([](auto tp) { return std::chrono::seconds(get<1>(tp)); })
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, 100)
+      .assignTimestamps([](auto tp) { return std::chrono::seconds(get<1>(tp)); })
+      .keyBy<0>()
+      .windowJoin(s1, [](auto tp1, auto tp2) { return true; }, WindowParams::RangeWindow, 10)
+      .notify([&](auto tp, bool outdated) { REQUIRE(!outdated); results++; });
+
+    t.start(false);
+    REQUIRE(results == 100);
+  }
+
+  SECTION("range windows without timestamps") {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, 100)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, 100)
+      .keyBy<0>();
+    REQUIRE_THROWS_AS(s2.windowJoin(s1, [](auto tp1, auto tp2) { return true; },
+                                    WindowParams::RangeWindow, 10), TopologyException);
+  }
+}
+
+TEST_CASE("Building and running a topology with a band join", "[Band Join]") {
+  typedef TuplePtr<int, int> T1;
+
+  auto gen = [](unsigned long n) { return makeTuplePtr((int)(n % 5), (int)n); };
+  unsigned int results = 0;
+
+  SECTION("with timestamps") {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, 100)
+      .assignTimestamps([](auto tp) { return std::chrono::seconds(get<1>(tp)); })
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, 100)
+      .assignTimestamps([](auto tp) { return std::chrono::seconds(get<1>(tp)); })
+      .keyBy<0>()
+      .bandJoin(s1, nullptr, std::chrono::seconds(5))
+      .notify([&](auto tp, bool outdated) {
+        REQUIRE(get<0>(tp) == get<2>(tp));
+        REQUIRE(std::abs(get<1>(tp) - get<3>(tp)) <= 5);
+        results++;
+      });
+
+    t.start(false);
+    // tuple n matches the tuples n-5, n and n+5 of the other stream
+    REQUIRE(results == 290);
+  }
+
+  SECTION("with watermarks") {
+    Topology t;
+    Timestamp watermark(0);
+    unsigned int ends = 0;
+    auto s1 = t.streamFromGenerator<T1>(gen, 100)
+      .assignTimestamps([](auto tp) { return std::chrono::seconds(get<1>(tp)); })
+      .assignWatermarks(0)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, 100)
+      .assignTimestamps([](auto tp) { return std::chrono::seconds(get<1>(tp)); })
+      .assignWatermarks(0)
+      .keyBy<0>()
+      .bandJoin(s1, nullptr, std::chrono::seconds(5))
+      .notify([&](auto tp, bool outdated) {
+        REQUIRE(std::abs(get<1>(tp) - get<3>(tp)) <= 5);
+        results++;
+      }, [&](auto pp) {
+        if (pp->ptype() == Punctuation::Watermark) {
+          REQUIRE(pp->getTimestamp() > watermark);
+          watermark = pp->getTimestamp();
+        }
+        else if (pp->ptype() == Punctuation::EndOfStream)
+          ends++;
+      });
+
+    t.start(false);
+    // the end of the first stream does not expire the state of the second one
+    REQUIRE(results == 290);
+    // the minimum of the watermarks of both streams is forwarded
+    REQUIRE(watermark == Timestamp::max());
+    REQUIRE(ends == 1);
+  }
+
+  SECTION("without timestamps") {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, 100)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, 100)
+      .keyBy<0>();
+    REQUIRE_THROWS_AS(s2.bandJoin(s1, nullptr, std::chrono::seconds(5)), TopologyException);
+  }
+}
+
+TEST_CASE("Building and running a topology with a multi-way join", "[Multi-Way Join]") {
+  typedef TuplePtr<int, int> T1;
+
+  auto gen = [](unsigned long n) { return makeTuplePtr((int)(n % 5), (int)n); };
+  unsigned int results = 0;
+
+  SECTION("without predicate") {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, 50)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, 50)
+      .keyBy<0>();
+    auto s3 = t.streamFromGenerator<T1>(gen, 50)
+      .keyBy<0>()
+      .multiJoin<unsigned long>(nullptr, s1, s2)
+      .notify([&](auto tp, bool outdated) {
+        REQUIRE(get<0>(tp) == get<2>(tp));
+        REQUIRE(get<0>(tp) == get<4>(tp));
+        results++;
+      });
+
+    t.start(false);
+    // each key occurs 10 times per stream
+    REQUIRE(results == 5000);
+  }
+
+  SECTION("with predicate and fixed probe order") {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, 50)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, 50)
+      .keyBy<0>();
+    auto s3 = t.streamFromGenerator<T1>(gen, 50)
+      .keyBy<0>()
+      .multiJoin<unsigned long>([](const T1& tp1, const T1& tp2, const T1& tp3) {
+          return get<1>(tp1) == get<1>(tp2) && get<1>(tp2) == get<1>(tp3);
+        }, 0, s1, s2)
+      .notify([&](auto tp, bool outdated) {
+        REQUIRE(get<1>(tp) == get<5>(tp));
+        results++;
+      });
+
+    t.start(false);
+    REQUIRE(results == 50);
+  }
+
+  SECTION("without key") {
+    Topology t;
+    auto s1 = t.streamFromGenerator<T1>(gen, 50)
+      .keyBy<0>();
+    auto s2 = t.streamFromGenerator<T1>(gen, 50);
+    auto s3 = t.streamFromGenerator<T1>(gen, 50)
+      .keyBy<0>();
+    REQUIRE_THROWS_AS(s3.multiJoin<unsigned long>(nullptr, s1, s2), TopologyException);
+  }
+}
+
+TEST_CASE("Building and running a topology with a lookup join", "[Lookup Join]") {
+  typedef TuplePtr<int, int> T1;
+  typedef Tuple<int, std::string> RecordType;
+
+  auto tbl = std::make_shared<Table<RecordType, int>>("LookupTable");
+  for (int i = 0; i < 10; i += 2)
+    tbl->insert(i, RecordType(i, "record #" + std::to_string(i)));
+
+  auto gen = [](unsigned long n) { return makeTuplePtr((int)(n % 10), (int)n); };
+  unsigned int results = 0;
+
+  SECTION("without cache") {
+    Topology t;
+    auto s = t.streamFromGenerator<T1>(gen, 100)
+      .lookupJoin(tbl, [](auto tp) { return get<0>(tp); })
+      .notify([&](auto tp, bool outdated) {
+        REQUIRE(get<0>(tp) == get<2>(tp));
+        REQUIRE(get<3>(tp) == "record #" + std::to_string(get<0>(tp)));
+        results++;
+      });
+
+    t.start(false);
+    // only even keys exist in the table
+    REQUIRE(results == 50);
+  }
+
+  SECTION("with cache and batches") {
+    std::vector<std::string> values;
+    Topology t;
+    auto s = t.streamFromGenerator<T1>(gen, 20)
+      .lookupJoin(tbl, [](auto tp) { return get<0>(tp); }, 8, 3)
+      .notify([&](auto tp, bool outdated) {
+        values.push_back(get<3>(tp));
+        // the cache is invalidated by the update of the table
+        if (get<1>(tp) == 10)
+          tbl->insert(2, RecordType(2, "updated"));
+      });
+
+    t.start(false);
+    REQUIRE(values.size() == 10);
+    REQUIRE(values[1] == "record #2");
+    REQUIRE(values[5] == "record #0");
+    REQUIRE(values[6] == "updated");
+  }
+
+  SECTION("with cache and deletes") {
+    Topology t;
+    auto s = t.streamFromGenerator<T1>(gen, 30)
+      .lookupJoin(tbl, [](auto tp) { return get<0>(tp); }, 8)
+      .notify([&](auto tp, bool outdated) {
+        // deleted records are not taken from the cache
+        REQUIRE((get<0>(tp) != 2 || get<1>(tp) < 10));
+        REQUIRE(get<1>(tp) < 20);
+        results++;
+        if (get<1>(tp) == 10)
+          tbl->deleteByKey(2);
+        else if (get<1>(tp) == 18)
+          tbl->truncate();
+      });
+
+    t.start(false);
+    REQUIRE(results == 9);
+    REQUIRE(tbl->size() == 0);
+  }
+}
@@ -21,6 +21,7 @@
 #include <thread>
 #include <chrono>
 #include <future>
+#include <atomic>
 
 #include <boost/core/ignore_unused.hpp>
 
@@ -65,6 +66,68 @@ TEST_CASE("Building and running a simple topology", "[Topology]") {
   REQUIRE(strm.str() == expected);
 }
 
+TEST_CASE("Building and running a topology with fused operators", "[Topology]") {
+  typedef TuplePtr<int, std::string, double> T1;
+  typedef TuplePtr<double, int> T2;
+
+  TestDataGenerator tgen("file.csv");
+  tgen.writeData(10);
+
+  std::stringstream strm;
+  std::string expected = "0.5,0\n400.5,4\n800.5,8\n";
+  int numNotified = 0;
+
+  Topology t;
+  auto s1 = t.newStreamFromFile("file.csv")
+    .extract<T1>(',')
+    .fuse()
+      .where([](auto tp, bool outdated) { return get<0>(tp) % 2 == 0; } )
+      .notify([&](auto tp, bool outdated) { numNotified++; })
+      .map<T2>([](auto tp, bool outdated) -> T2 {
+        return makeTuplePtr(get<2>(tp), get<0>(tp));
+      })
+      .where([](auto tp, bool outdated) { return get<1>(tp) % 4 == 0; } )
+    .endFuse()
+    .print(strm);
+
+  t.start();
+  t.wait();
+
+  REQUIRE(numNotified == 5);
+  REQUIRE(strm.str() == expected);
+}
+
+TEST_CASE("Building and running a topology with std::function UDFs", "[Topology]") {
+  typedef TuplePtr<int, std::string, double> T1;
+  typedef TuplePtr<double, int> T2;
+
+  TestDataGenerator tgen("file.csv");
+  tgen.writeData(5);
+
+  std::stringstream strm;
+  std::string expected = "0.5,0\n200.5,2\n400.5,4\n";
+
+  // dynamically typed UDFs (e.g. from the Python binding) use the std::function overloads
+  std::function<bool(const T1&, bool)> pred = [](const T1& tp, bool outdated) {
+    return get<0>(tp) % 2 == 0;
+  };
+  Map<T1, T2>::MapFunc func = [](const T1& tp, bool outdated) -> T2 {
+    return makeTuplePtr(get<2>(tp), get<0>(tp));
+  };
+
+  Topology t;
+  auto s1 = t.newStreamFromFile("file.csv")
+    .extract<T1>(',')
+    .where(pred)
+    .map<T2>(func)
+    .print(strm);
+
+  t.start();
+  t.wait();
+
+  REQUIRE(strm.str() == expected);
+}
+
 TEST_CASE("Building and running a topology with ZMQ", "[Topology]") {
   typedef TuplePtr<int, int> T1;
 
@@ -166,6 +229,41 @@ TEST_CASE("Building and running a topology with partitioning", "[Topology]") {
   }
 }
 
+TEST_CASE("Building and running a topology with bounded queues", "[Topology]") {
+  typedef TuplePtr<int, double> T1;
+
+  const unsigned long numTuples = 5000;
+  std::atomic<unsigned long> processed(0);
+
+  Topology t;
+  auto s = t.streamFromGenerator<T1>([](unsigned long n) -> T1 {
+        return makeTuplePtr((int)n, n * 1.5);
+      }, numTuples)
+    .partitionBy([](auto tp) { return get<0>(tp) % 4; }, 4, 32)
+    .where([](auto tp, bool outdated) {
+      // a slow consumer
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+      return true;
+    } )
+    .merge(64)
+    .notify([&](auto tp, bool outdated) { processed++; });
+
+  t.start(false);
+  auto start = std::chrono::steady_clock::now();
+  while (processed < numTuples &&
+         std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  REQUIRE(processed == numTuples);
+
+  // 4 partition queues + the merge queue
+  auto stats = t.queueStatistics();
+  REQUIRE(stats.size() == 5);
+  for (auto& qs : stats) {
+    REQUIRE(qs.capacity > 0);
+    REQUIRE(qs.highWaterMark <= qs.capacity);
+  }
+}
+
 TEST_CASE("Building and running a topology with batcher", "[Topology]") {
   typedef TuplePtr<int, std::string, double> T1;
 
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+
+#include <map>
+#include <vector>
+
+#include "core/Tuple.hpp"
+#include "core/TupleBatch.hpp"
+#include "dsl/Topology.hpp"
+#include "dsl/Pipe.hpp"
+
+using namespace pfabric;
+
+typedef TuplePtr<int, double> MyTuplePtr;
+typedef TupleBatch<int, double> MyBatch;
+
+TEST_CASE("Building a columnar tuple batch", "[TupleBatch]") {
+  MyBatch batch(10);
+  for (int i = 0; i < 10; i++)
+    batch.append(makeTuplePtr(i, i * 0.5), i == 9);
+
+  auto tp = makeTuplePtr(42, 1.0);
+  tp->setNull(1);
+  batch.append(tp);
+
+  REQUIRE(batch.size() == 11);
+  REQUIRE(!batch.hasSelection());
+  REQUIRE(batch.column<0>().size() == 11);
+  REQUIRE(get<0>(batch, 3) == 3);
+  REQUIRE(batch.value<1>(4) == 2.0);
+  REQUIRE(batch.isOutdated(9));
+  REQUIRE(!batch.isOutdated(8));
+  REQUIRE(batch.isNull(1, 10));
+  REQUIRE(!batch.isNull(0, 10));
+  REQUIRE(!batch.isNull(1, 3));
+
+  // outdated rows are subtracted, null values are ignored
+  REQUIRE(batch.count() == 9);
+  REQUIRE(batch.sum<0>() == 42 + 36 - 9);
+  REQUIRE(batch.sum<1>() == Approx(18.0 - 4.5));
+
+  // materialize a row as tuple
+  auto res = batch.tuple(10);
+  REQUIRE(get<0>(res) == 42);
+  REQUIRE(res->isNull(1));
+}
+
+TEST_CASE("Selecting rows from a tuple batch", "[TupleBatch]") {
+  MyBatch batch;
+  for (int i = 0; i < 100; i++)
+    batch.appendRow(std::make_tuple(i, i * 1.0));
+
+  auto sel = batch.select(MyBatch::SelectionVector { 1, 3, 5, 7 });
+  REQUIRE(sel.size() == 4);
+  REQUIRE(sel.numRows() == 100);
+  REQUIRE(sel.hasSelection());
+  REQUIRE(sel.sum<0>() == 16);
+  REQUIRE(sel.count() == 4);
+
+  std::vector<int> rows;
+  sel.forEachRow([&](std::size_t r) { rows.push_back(get<0>(sel, r)); });
+  REQUIRE(rows == std::vector<int>({ 1, 3, 5, 7 }));
+
+  // the columns are shared, appending to the original batch copies them
+  batch.appendRow(std::make_tuple(100, 100.0));
+  REQUIRE(batch.size() == 101);
+  REQUIRE(sel.numRows() == 100);
+}
+
+TEST_CASE("Filtering and projecting columnar batches in a topology", "[TupleBatch]") {
+  typedef TupleBatchPtr<double, int> OutBatchPtr;
+  const int numTuples = 1000;
+
+  std::vector<TuplePtr<double, int>> results;
+  int numBatches = 0;
+
+  Topology t;
+  auto s = t.streamFromGenerator<MyTuplePtr>([](unsigned long n) -> MyTuplePtr {
+        return makeTuplePtr((int)n, n * 0.5);
+      }, numTuples)
+    .batchColumns(64)
+    .whereBatch([](const MyBatch& batch, std::size_t row) { return get<0>(batch, row) % 3 == 0; })
+    .mapBatch<OutBatchPtr>([](const MyBatch& batch, std::size_t row) {
+        return std::make_tuple(get<1>(batch, row) * 2, get<0>(batch, row));
+      })
+    .notify([&](auto tp, bool outdated) { numBatches++; })
+    .unbatchColumns()
+    .notify([&](auto tp, bool outdated) { results.push_back(tp); });
+
+  t.start(false);
+
+  REQUIRE(numBatches == (numTuples + 63) / 64);
+  REQUIRE(results.size() == (numTuples + 2) / 3);
+  for (std::size_t i = 0; i < results.size(); i++) {
+    REQUIRE(get<1>(results[i]) == (int)i * 3);
+    REQUIRE(get<0>(results[i]) == i * 3.0);
+  }
+}
+
+TEST_CASE("Aggregating columnar batches", "[TupleBatch]") {
+  typedef TuplePtr<double, long> AggrTuplePtr;
+  typedef TuplePtr<int, double> GroupTuplePtr;
+  struct SumState { double sum = 0.0; long cnt = 0; };
+  const int numTuples = 1000;
+
+  AggrTuplePtr total;
+  std::map<int, double> groups;
+  int numGroupResults = 0;
+
+  Topology t;
+  auto s = t.streamFromGenerator<MyTuplePtr>([](unsigned long n) -> MyTuplePtr {
+        return makeTuplePtr((int)(n % 10), 1.0 * n);
+      }, numTuples)
+    .batchColumns(100);
+
+  s.aggregateBatch<AggrTuplePtr, SumState>(
+      [](const MyBatch& batch, SumState& state) {
+        state.sum += batch.sum<1>();
+        state.cnt += batch.count();
+      },
+      [](const SumState& state) { return makeTuplePtr(state.sum, state.cnt); })
+    .notify([&](auto tp, bool outdated) { total = tp; });
+
+  s.groupByBatch<0, GroupTuplePtr, SumState>(
+      [](const MyBatch& batch, std::size_t row, SumState& state) {
+        state.sum += get<1>(batch, row);
+      },
+      [](const int& key, const SumState& state) { return makeTuplePtr(key, state.sum); })
+    .notify([&](auto tp, bool outdated) {
+        groups[get<0>(tp)] = get<1>(tp);
+        numGroupResults++;
+      });
+
+  t.start(false);
+
+  REQUIRE(get<0>(total) == numTuples * (numTuples - 1) / 2.0);
+  REQUIRE(get<1>(total) == numTuples);
+  // 10 batches, each updating all 10 groups
+  REQUIRE(groups.size() == 10);
+  REQUIRE(numGroupResults == 100);
+  for (int k = 0; k < 10; k++)
+    REQUIRE(groups[k] == 100.0 * k + 49500.0);
+}
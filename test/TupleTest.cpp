@@ -21,6 +21,10 @@
 #include <boost/core/ignore_unused.hpp>
 
 #include <vector>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "core/Tuple.hpp"
 
@@ -131,6 +135,76 @@ TEST_CASE("Tuple null fields", "[Tuple]") {
 	REQUIRE(! tp->isNull(4));
 }
 
+#ifdef USE_TUPLE_POOL
+TEST_CASE("Tuple allocation from slab pools", "[Tuple]") {
+	typedef Tuple<int, double, long> MyTuple;
+	typedef TuplePool<TupleSlabPool::sizeClass(sizeof(MyTuple))> MyPool;
+
+	// a released tuple is recycled by the next allocation of the same thread
+	auto tp1 = makeTuplePtr(1, 2.0, 3L);
+	const void *addr = tp1.get();
+	REQUIRE(TupleSlabPool::owner(tp1.get()) == MyPool::localPool());
+	tp1.reset();
+	auto tp2 = makeTuplePtr(4, 5.0, 6L);
+	REQUIRE(tp2.get() == addr);
+	REQUIRE(tp2->getAttribute<0>() == 4);
+
+	// create and release many tuples without growing the pool
+	auto numSlabs = MyPool::localPool()->numSlabs();
+	for (int i = 0; i < 100000; i++) {
+		auto tp = makeTuplePtr(i, 1.0 * i, 2L * i);
+		REQUIRE(tp->getAttribute<0>() == i);
+	}
+	REQUIRE(MyPool::localPool()->numSlabs() == numSlabs);
+}
+
+TEST_CASE("Releasing pooled tuples on another thread", "[Tuple]") {
+	typedef TuplePtr<int, double, long> MyTuplePtr;
+	const int numTuples = 1000;
+
+	std::vector<MyTuplePtr> tuples;
+	std::set<const void *> addresses;
+	std::mutex mtx;
+	std::condition_variable cond;
+	bool released = false;
+	int reused = 0;
+
+	std::thread producer([&]() {
+		std::vector<MyTuplePtr> created;
+		for (int i = 0; i < numTuples; i++) {
+			created.push_back(makeTuplePtr(i, 1.0 * i, 2L * i));
+			addresses.insert(created.back().get());
+		}
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			tuples.swap(created);
+			cond.notify_one();
+			cond.wait(lock, [&]() { return released; });
+		}
+		// blocks released by the main thread are returned to this thread's pool
+		std::vector<MyTuplePtr> more;
+		for (int i = 0; i < numTuples; i++) {
+			more.push_back(makeTuplePtr(i, 1.0 * i, 2L * i));
+			if (addresses.count(more.back().get()) > 0) reused++;
+		}
+	});
+
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		cond.wait(lock, [&]() { return tuples.size() == numTuples; });
+		for (auto& tp : tuples) {
+			REQUIRE(TupleSlabPool::owner(tp.get()) != nullptr);
+			REQUIRE(tp->getAttribute<0>() < numTuples);
+		}
+		tuples.clear();
+		released = true;
+		cond.notify_one();
+	}
+	producer.join();
+	REQUIRE(reused == numTuples);
+}
+#endif
+
 TEST_CASE("Tuple microbenchmarking", "[Tuple]") {
 	StreamType res;
 	{
@@ -59,3 +59,31 @@ TEST_CASE("Applying a filter to a tuple stream", "[Where]") {
   
   REQUIRE(mockup->numTuplesProcessed() == expected.size());
 }
+
+/**
+ * A test of the filter operator using the lambda type as template argument.
+ */
+TEST_CASE("Applying an inlined filter to a tuple stream", "[Where]") {
+	std::vector<MyTuplePtr> input = {
+		makeTuplePtr(0, 0, 0),
+		makeTuplePtr (1, 1, 10),
+		makeTuplePtr(2, 2, 20) };
+
+	std::vector<MyTuplePtr> expected = {
+		makeTuplePtr(0, 0, 0),
+		makeTuplePtr(2, 2, 20) };
+
+	auto mockup = std::make_shared< StreamMockup<MyTuplePtr, MyTuplePtr> >(input, expected);
+
+	auto filter_fun = []( const MyTuplePtr& tp, bool outdated ) {
+		return tp->getAttribute<0>() % 2 == 0;
+	};
+	auto wop = std::make_shared< Where<MyTuplePtr, decltype(filter_fun)> >(filter_fun);
+
+	CREATE_DATA_LINK(mockup, wop)
+	CREATE_DATA_LINK(wop, mockup)
+
+	mockup->start();
+
+	REQUIRE(mockup->numTuplesProcessed() == expected.size());
+}
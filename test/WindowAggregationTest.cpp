@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include "core/Tuple.hpp"
+#include "qop/AggregateFunctions.hpp"
+#include "qop/AggregateStateBase.hpp"
+#include "qop/WindowAggregation.hpp"
+
+#include "StreamMockup.hpp"
+
+using namespace pfabric;
+
+typedef TuplePtr<int> InTuplePtr;
+typedef TuplePtr<int, int> OutTuplePtr;
+typedef TuplePtr<int, int> TsTuplePtr;
+
+TEST_CASE("Maintaining partial aggregates with two stacks", "[WindowAggregation]") {
+  typedef Aggregator1<InTuplePtr, AggrGlobalMax<int>, 0> MaxState;
+
+  TwoStackAggregates<MaxState> stacks;
+  std::deque<int> window;
+  REQUIRE(stacks.query() == nullptr);
+
+  std::srand(42);
+  for (int i = 0; i < 1000; i++) {
+    if (window.empty() || std::rand() % 3 != 0) {
+      auto v = std::rand() % 1000;
+      auto state = stacks.newPartial();
+      MaxState::iterate(makeTuplePtr(v), state, false);
+      stacks.push(state);
+      window.push_back(v);
+    } else {
+      stacks.pop();
+      window.pop_front();
+    }
+    REQUIRE(stacks.size() == window.size());
+    if (!window.empty()) {
+      auto res = MaxState::finalize(stacks.query());
+      REQUIRE(get<0>(res) == *std::max_element(window.begin(), window.end()));
+    }
+  }
+}
+
+TEST_CASE("Computing non-invertible aggregates over a row window", "[WindowAggregation]") {
+  typedef Aggregator2<InTuplePtr,
+                      AggrGlobalMin<int>, 0,
+                      AggrGlobalMax<int>, 0> MyAggrState;
+  typedef WindowAggregation<InTuplePtr, OutTuplePtr, MyAggrState> TestAggregation;
+
+  std::vector<InTuplePtr> input = {
+    makeTuplePtr(5), makeTuplePtr(3), makeTuplePtr(8), makeTuplePtr(1),
+    makeTuplePtr(9), makeTuplePtr(2), makeTuplePtr(7)
+  };
+
+  std::vector<OutTuplePtr> expected = {
+    makeTuplePtr(5, 5), makeTuplePtr(3, 5), makeTuplePtr(3, 8), makeTuplePtr(1, 8),
+    makeTuplePtr(1, 9), makeTuplePtr(1, 9), makeTuplePtr(2, 9)
+  };
+
+  auto mockup = std::make_shared< StreamMockup<InTuplePtr, OutTuplePtr> >(input, expected);
+  auto aggr = std::make_shared<TestAggregation>(MyAggrState::finalize, MyAggrState::iterate, 3);
+
+  CREATE_LINK(mockup, aggr);
+  CREATE_LINK(aggr, mockup);
+
+  mockup->start();
+  REQUIRE(mockup->numTuplesProcessed() == (int)expected.size());
+}
+
+TEST_CASE("Computing aggregates over a row window with a slide", "[WindowAggregation]") {
+  typedef Aggregator2<InTuplePtr,
+                      AggrSum<int>, 0,
+                      AggrCount<int, int>, 0> MyAggrState;
+  typedef WindowAggregation<InTuplePtr, OutTuplePtr, MyAggrState> TestAggregation;
+
+  std::vector<InTuplePtr> input;
+  for (int i = 1; i <= 8; i++)
+    input.push_back(makeTuplePtr(i));
+
+  std::vector<OutTuplePtr> expected = {
+    makeTuplePtr(3, 2), makeTuplePtr(10, 4), makeTuplePtr(18, 4), makeTuplePtr(26, 4)
+  };
+
+  auto mockup = std::make_shared< StreamMockup<InTuplePtr, OutTuplePtr> >(input, expected);
+  auto aggr = std::make_shared<TestAggregation>(MyAggrState::finalize, MyAggrState::iterate, 4, 2);
+
+  CREATE_LINK(mockup, aggr);
+  CREATE_LINK(aggr, mockup);
+
+  mockup->start();
+  REQUIRE(mockup->numTuplesProcessed() == (int)expected.size());
+}
+
+TEST_CASE("Computing aggregates over a range window with a slide", "[WindowAggregation]") {
+  typedef Aggregator2<TsTuplePtr,
+                      AggrSum<int>, 1,
+                      AggrGlobalMax<int>, 1> MyAggrState;
+  typedef WindowAggregation<TsTuplePtr, OutTuplePtr, MyAggrState> TestAggregation;
+
+  // (timestamp in seconds, value)
+  std::vector<TsTuplePtr> input = {
+    makeTuplePtr(1, 1), makeTuplePtr(2, 2), makeTuplePtr(6, 6), makeTuplePtr(7, 7),
+    makeTuplePtr(11, 11), makeTuplePtr(12, 12), makeTuplePtr(16, 16), makeTuplePtr(30, 30)
+  };
+
+  // windows of 10 seconds every 5 seconds, the empty window [20, 30) is skipped
+  // and the last window is produced at the end of the stream
+  std::vector<OutTuplePtr> expected = {
+    makeTuplePtr(3, 2), makeTuplePtr(16, 7), makeTuplePtr(36, 12),
+    makeTuplePtr(39, 16), makeTuplePtr(16, 16), makeTuplePtr(30, 30)
+  };
+
+  auto mockup = std::make_shared< StreamMockup<TsTuplePtr, OutTuplePtr> >(input, expected);
+  auto aggr = std::make_shared<TestAggregation>(MyAggrState::finalize, MyAggrState::iterate,
+    [](const TsTuplePtr& tp) { return Timestamp(get<0>(tp) * 1000 * 1000); }, 10, 5);
+
+  CREATE_LINK(mockup, aggr);
+  CREATE_LINK(aggr, mockup);
+
+  mockup->start();
+  REQUIRE(mockup->numTuplesProcessed() == (int)expected.size() - 1);
+
+  mockup->getOutputPunctuationChannel().publish(std::make_shared<Punctuation>(Punctuation::EndOfStream));
+  REQUIRE(mockup->numTuplesProcessed() == (int)expected.size());
+}
+
+TEST_CASE("Dropping late tuples of a range window", "[WindowAggregation]") {
+  typedef Aggregator2<TsTuplePtr,
+                      AggrSum<int>, 1,
+                      AggrGlobalMax<int>, 1> MyAggrState;
+  typedef WindowAggregation<TsTuplePtr, OutTuplePtr, MyAggrState> TestAggregation;
+
+  // (timestamp in seconds, value), the tuples with value 100 are older than
+  // the most recent pane of 5 seconds
+  std::vector<TsTuplePtr> input = {
+    makeTuplePtr(1, 1), makeTuplePtr(2, 2), makeTuplePtr(6, 6), makeTuplePtr(3, 100),
+    makeTuplePtr(7, 7), makeTuplePtr(11, 11), makeTuplePtr(12, 12), makeTuplePtr(4, 100),
+    makeTuplePtr(9, 100), makeTuplePtr(16, 16)
+  };
+
+  // the same results as without the late tuples
+  std::vector<OutTuplePtr> expected = {
+    makeTuplePtr(3, 2), makeTuplePtr(16, 7), makeTuplePtr(36, 12), makeTuplePtr(39, 16)
+  };
+
+  auto mockup = std::make_shared< StreamMockup<TsTuplePtr, OutTuplePtr> >(input, expected);
+  auto aggr = std::make_shared<TestAggregation>(MyAggrState::finalize, MyAggrState::iterate,
+    [](const TsTuplePtr& tp) { return Timestamp(get<0>(tp) * 1000 * 1000); }, 10, 5);
+
+  CREATE_LINK(mockup, aggr);
+  CREATE_LINK(aggr, mockup);
+
+  mockup->start();
+  REQUIRE(aggr->numLateTuples() == 3);
+  REQUIRE(mockup->numTuplesProcessed() == (int)expected.size() - 1);
+
+  mockup->getOutputPunctuationChannel().publish(std::make_shared<Punctuation>(Punctuation::EndOfStream));
+  REQUIRE(mockup->numTuplesProcessed() == (int)expected.size());
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2014-2021 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the PipeFabric package.
+ *
+ * PipeFabric is free software: you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * PipeFabric is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PipeFabric. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "core/Tuple.hpp"
+#include "qop/WindowBuffer.hpp"
+
+using namespace pfabric;
+
+typedef TuplePtr< int, int > MyTuplePtr;
+
+TEST_CASE("Appending and evicting elements in a window buffer", "[WindowBuffer]") {
+  WindowBuffer<int> buf(4);
+  REQUIRE(buf.empty());
+  REQUIRE(buf.capacity() == 4);
+
+  for (int i = 0; i < 4; i++)
+    buf.push_back(i);
+  // wrap around without growing
+  buf.pop_front();
+  buf.pop_front();
+  buf.push_back(4);
+  buf.push_back(5);
+  REQUIRE(buf.capacity() == 4);
+  REQUIRE(buf.size() == 4);
+  REQUIRE(buf.front() == 2);
+  REQUIRE(buf.back() == 5);
+
+  std::vector<int> content(buf.begin(), buf.end());
+  REQUIRE(content == std::vector<int>({ 2, 3, 4, 5 }));
+
+  // the buffer grows if it is full and keeps the order of the elements
+  buf.push_back(6);
+  REQUIRE(buf.capacity() == 8);
+  REQUIRE(buf.size() == 5);
+  for (std::size_t i = 0; i < buf.size(); i++)
+    REQUIRE(buf[i] == (int)i + 2);
+
+  buf.clear();
+  REQUIRE(buf.empty());
+  REQUIRE(buf.capacity() == 8);
+}
+
+TEST_CASE("Iterating over a window buffer with random-access iterators", "[WindowBuffer]") {
+  WindowBuffer<int> buf(8);
+  for (int i = 0; i < 12; i++) {
+    buf.push_back(i);
+    if (buf.size() > 5)
+      buf.pop_front();
+  }
+  // the buffer now contains 7, 8, 9, 10, 11
+  const WindowBuffer<int>& cbuf = buf;
+  auto beg = cbuf.begin(), end = cbuf.end();
+  REQUIRE(end - beg == 5);
+  REQUIRE(*(beg + 2) == 9);
+  REQUIRE(beg[4] == 11);
+  REQUIRE(*(end - 1) == 11);
+  REQUIRE(beg < end);
+  REQUIRE(std::accumulate(beg, end, 0) == 45);
+
+  // mutable iterators can be used with the standard algorithms
+  std::reverse(buf.begin(), buf.end());
+  REQUIRE(buf.front() == 11);
+  REQUIRE(buf.back() == 7);
+  std::sort(buf.begin(), buf.end());
+  REQUIRE(std::is_sorted(cbuf.begin(), cbuf.end()));
+  REQUIRE(std::lower_bound(cbuf.begin(), cbuf.end(), 10) - cbuf.begin() == 3);
+}
+
+TEST_CASE("Releasing tuples stored in a window buffer", "[WindowBuffer]") {
+  auto tp = makeTuplePtr(1, 2);
+  {
+    WindowBuffer<MyTuplePtr> buf(2);
+    for (int i = 0; i < 10; i++)
+      buf.push_back(tp);
+    REQUIRE(tp->refCount() == 11);
+    buf.pop_front();
+    REQUIRE(tp->refCount() == 10);
+  }
+  REQUIRE(tp->refCount() == 1);
+}
@@ -26,8 +26,11 @@
 #include "core/StreamElementTraits.hpp"
 #include "qop/DataSink.hpp"
 #include "qop/DataSource.hpp"
+#include "qop/KeyedWindow.hpp"
+#include "qop/SessionWindow.hpp"
 #include "qop/SlidingWindow.hpp"
 #include "qop/TumblingWindow.hpp"
+#include "qop/WatermarkGenerator.hpp"
 
 
 using namespace pfabric;
@@ -47,22 +50,33 @@ public:
   typedef typename SinkBase::InputDataElementTraits InputDataElementTraits;
 
   TupleGenerator() :
-    mTimestampExtractor(nullptr), mTuplesProcessed(0), mOutdatedTuplesProcessed(0) {
+    mTimestampExtractor(nullptr), mTuplesProcessed(0), mOutdatedTuplesProcessed(0),
+    mPunctuationsProcessed(0) {
     }
 
   TupleGenerator(Window<MyTuplePtr>::TimestampExtractorFunc func) :
-    mTimestampExtractor(func), mTuplesProcessed(0), mOutdatedTuplesProcessed(0) {
+    mTimestampExtractor(func), mTuplesProcessed(0), mOutdatedTuplesProcessed(0),
+    mPunctuationsProcessed(0) {
     }
 
   void start(int ntuples, Timestamp start_time = Timestamp(0)) {
     const bool outdated = false;
-    mOutdatedTuplesProcessed = mTuplesProcessed = 0;
+    mOutdatedTuplesProcessed = mTuplesProcessed = mPunctuationsProcessed = 0;
     for ( int i = 1; i <= ntuples; i++) {
       auto tp = makeTuplePtr(i, i, Timestamp(i * 1000000 + start_time.count()));
       this->getOutputDataChannel().publish(tp, outdated);
     }
   }
 
+  void startWithTimestamps(const std::vector<int>& secs) {
+    const bool outdated = false;
+    mOutdatedTuplesProcessed = mTuplesProcessed = mPunctuationsProcessed = 0;
+    for (auto i : secs) {
+      auto tp = makeTuplePtr(i, i, Timestamp(i * 1000000));
+      this->getOutputDataChannel().publish(tp, outdated);
+    }
+  }
+
   int numProcessedTuples() const {
     return mTuplesProcessed;
   }
@@ -71,6 +85,10 @@ public:
     return mOutdatedTuplesProcessed;
   }
 
+  int numPunctuations() const {
+    return mPunctuationsProcessed;
+  }
+
 
   /**
    * @brief Bind the callback for the data channel.
@@ -103,12 +121,13 @@ private:
   }
 
   void processPunctuation( const PunctuationPtr& punctuation ) {
-    boost::ignore_unused( punctuation );
+    if (punctuation->ptype() == Punctuation::WindowExpired)
+      mPunctuationsProcessed++;
   }
 
   Window<MyTuplePtr>::TimestampExtractorFunc mTimestampExtractor;
 
-  int mTuplesProcessed, mOutdatedTuplesProcessed;
+  int mTuplesProcessed, mOutdatedTuplesProcessed, mPunctuationsProcessed;
   std::set<Timestamp> mTupleSet;
 };
 
@@ -125,6 +144,8 @@ TEST_CASE("Checking a simple row-based sliding window", "[SlidingWindow]") {
 
   auto tgen = std::make_shared< TupleGenerator >(ts_fun);
   auto win = std::make_shared< TestWindow >( ts_fun, WindowParams::RowWindow, 10 );
+  // a row window publishes outdated tuples in insertion order
+  REQUIRE(win->evictsInInsertionOrder());
 
   CREATE_DATA_LINK(tgen, win);
   CREATE_DATA_LINK(win, tgen);
@@ -151,6 +172,8 @@ TEST_CASE("Checking a simple range-based sliding window", "[SlidingWindow]") {
 
   auto tgen = std::make_shared<TupleGenerator>( ts_fun );
   auto win = std::make_shared< TestWindow >( ts_fun, WindowParams::RangeWindow, 10 );
+  // a range window may be driven by watermarks which reorder the tuples
+  REQUIRE(!win->evictsInInsertionOrder());
 
   CREATE_DATA_LINK(tgen, win);
   CREATE_DATA_LINK(win, tgen);
@@ -208,3 +231,172 @@ TEST_CASE("Checking a range-based tumbling window", "[TumblingWindow]") {
   REQUIRE(tgen->numProcessedTuples() == 10);
   REQUIRE(tgen->numOutdatedTuples() == 8);
 }
+
+
+TEST_CASE("Checking tumbling windows publishing only window boundaries", "[TumblingWindow]") {
+  typedef TumblingWindow< MyTuplePtr > TestWindow;
+
+  auto ts_fun = [&]( const MyTuplePtr& tp ) -> Timestamp {
+    return tp->getAttribute<2>();
+  };
+
+  auto tgen = std::make_shared<TupleGenerator>( ts_fun );
+  auto rowWin = std::make_shared< TestWindow >( WindowParams::RowWindow, 3, nullptr,
+    WindowParams::ExpireBoundary );
+
+  CREATE_LINK(tgen, rowWin);
+  CREATE_LINK(rowWin, tgen);
+
+  // 10 tuples are forwarded, the windows [1,3], [4,6], and [7,9] are expired
+  tgen->start(10);
+  REQUIRE(tgen->numProcessedTuples() == 10);
+  REQUIRE(tgen->numOutdatedTuples() == 0);
+  REQUIRE(tgen->numPunctuations() == 3);
+
+  auto tgen2 = std::make_shared<TupleGenerator>( ts_fun );
+  auto rangeWin = std::make_shared< TestWindow >( ts_fun, WindowParams::RangeWindow, 4, nullptr,
+    WindowParams::ExpireBoundary );
+
+  CREATE_LINK(tgen2, rangeWin);
+  CREATE_LINK(rangeWin, tgen2);
+
+  // the windows [1,4] and [5,8] are expired by the tuples with timestamp 5 and 9
+  tgen2->start(10);
+  REQUIRE(tgen2->numProcessedTuples() == 10);
+  REQUIRE(tgen2->numOutdatedTuples() == 0);
+  REQUIRE(tgen2->numPunctuations() == 2);
+}
+
+
+TEST_CASE("Checking a range-based tumbling window driven by watermarks", "[TumblingWindow]") {
+  typedef TumblingWindow< MyTuplePtr > TestWindow;
+
+  auto ts_fun = [&]( const MyTuplePtr& tp ) -> Timestamp {
+    return tp->getAttribute<2>();
+  };
+
+  auto tgen = std::make_shared<TupleGenerator>( ts_fun );
+  // watermarks lag 2 seconds behind the most recent timestamp
+  auto wmGen = std::make_shared< WatermarkGenerator<MyTuplePtr> >( ts_fun, Timestamp(2 * 1000000) );
+  auto win = std::make_shared< TestWindow >( ts_fun, WindowParams::RangeWindow, 4 );
+
+  CREATE_LINK(tgen, wmGen);
+  CREATE_LINK(wmGen, win);
+  CREATE_LINK(win, tgen);
+
+  // watermark 6 closes the window [1,5), watermark 10 the window [5,9), 10 is
+  // delayed exactly by the allowed lateness, and 6 arrives too late
+  tgen->startWithTimestamps({ 1, 3, 2, 5, 4, 8, 7, 12, 10, 6 });
+  REQUIRE(tgen->numProcessedTuples() == 9);
+  REQUIRE(wmGen->numLateTuples() == 1);
+  REQUIRE(tgen->numOutdatedTuples() == 7);
+  REQUIRE(tgen->numPunctuations() == 2);
+}
+
+
+TEST_CASE("Checking a range-based sliding window driven by watermarks", "[SlidingWindow]") {
+  typedef SlidingWindow< MyTuplePtr > TestWindow;
+
+  auto ts_fun = [&]( const MyTuplePtr& tp ) -> Timestamp {
+    return tp->getAttribute<2>();
+  };
+
+  auto tgen = std::make_shared<TupleGenerator>( ts_fun );
+  // watermarks lag 2 seconds behind the most recent timestamp
+  auto wmGen = std::make_shared< WatermarkGenerator<MyTuplePtr> >( ts_fun, Timestamp(2 * 1000000) );
+  auto win = std::make_shared< TestWindow >( ts_fun, WindowParams::RangeWindow, 4 );
+
+  CREATE_LINK(tgen, wmGen);
+  CREATE_LINK(wmGen, win);
+  CREATE_LINK(win, tgen);
+
+  // the tuple with timestamp 6 arrives after watermark 10 and is dropped
+  tgen->startWithTimestamps({ 1, 3, 2, 5, 4, 8, 7, 12, 6 });
+  REQUIRE(tgen->numProcessedTuples() == 8);
+  REQUIRE(wmGen->numLateTuples() == 1);
+  // watermark 6 expires 1 and 2, watermark 10 expires 3, 4, and 5
+  REQUIRE(tgen->numOutdatedTuples() == 5);
+}
+
+
+TEST_CASE("Checking a keyed session window", "[SessionWindow]") {
+  typedef SessionWindow< MyTuplePtr, int > TestWindow;
+
+  auto ts_fun = [&]( const MyTuplePtr& tp ) -> Timestamp {
+    return tp->getAttribute<2>();
+  };
+
+  auto tgen = std::make_shared<TupleGenerator>( ts_fun );
+  auto win = std::make_shared< TestWindow >( [](const MyTuplePtr& tp) { return tp->getAttribute<0>() % 2; },
+                                             ts_fun, 3 );
+
+  CREATE_LINK(tgen, win);
+  CREATE_LINK(win, tgen);
+
+  // sessions: {1, 3} closed by 10, {2} closed immediately, {10, 12} closed by 20
+  tgen->startWithTimestamps({ 1, 3, 10, 12, 2, 20 });
+  REQUIRE(tgen->numProcessedTuples() == 6);
+  REQUIRE(tgen->numOutdatedTuples() == 5);
+  REQUIRE(win->numSessions() == 1);
+
+  auto tgen2 = std::make_shared<TupleGenerator>( ts_fun );
+  auto wmGen = std::make_shared< WatermarkGenerator<MyTuplePtr> >( ts_fun, Timestamp(5 * 1000000) );
+  auto win2 = std::make_shared< TestWindow >( [](const MyTuplePtr& tp) { return 0; }, ts_fun, 4 );
+
+  CREATE_LINK(tgen2, wmGen);
+  CREATE_LINK(wmGen, win2);
+  CREATE_LINK(win2, tgen2);
+
+  // the late tuple 9 bridges the gap between the sessions {6} and {12}
+  tgen2->startWithTimestamps({ 6, 12 });
+  REQUIRE(win2->numSessions() == 2);
+  tgen2->startWithTimestamps({ 9 });
+  REQUIRE(win2->numSessions() == 1);
+  REQUIRE(tgen2->numOutdatedTuples() == 0);
+}
+
+
+TEST_CASE("Checking a keyed sliding window", "[KeyedWindow]") {
+  typedef KeyedWindow< MyTuplePtr, int > TestWindow;
+
+  auto ts_fun = [&]( const MyTuplePtr& tp ) -> Timestamp {
+    return tp->getAttribute<2>();
+  };
+  auto key_fun = [](const MyTuplePtr& tp) { return tp->getAttribute<0>() % 3; };
+
+  // each of the 3 keys keeps its last 2 tuples
+  auto tgen = std::make_shared<TupleGenerator>( ts_fun );
+  auto win = std::make_shared< TestWindow >( key_fun, WindowParams::RowWindow, 2 );
+
+  CREATE_LINK(tgen, win);
+  CREATE_LINK(win, tgen);
+
+  tgen->start(12);
+  REQUIRE(tgen->numProcessedTuples() == 12);
+  REQUIRE(tgen->numOutdatedTuples() == 6);
+  REQUIRE(win->numKeys() == 3);
+
+  // only 2 keys are kept, the least recently used one is evicted
+  auto tgen2 = std::make_shared<TupleGenerator>( ts_fun );
+  auto lruWin = std::make_shared< TestWindow >( key_fun, WindowParams::RowWindow, 5, 2 );
+
+  CREATE_LINK(tgen2, lruWin);
+  CREATE_LINK(lruWin, tgen2);
+
+  tgen2->start(12);
+  REQUIRE(tgen2->numProcessedTuples() == 12);
+  REQUIRE(tgen2->numOutdatedTuples() == 10);
+  REQUIRE(lruWin->numKeys() == 2);
+
+  // keys without a tuple within 3 seconds are evicted
+  auto tgen3 = std::make_shared<TupleGenerator>( ts_fun );
+  auto ttlWin = std::make_shared< TestWindow >( key_fun, ts_fun, WindowParams::RangeWindow, 100, 0, 3 );
+
+  CREATE_LINK(tgen3, ttlWin);
+  CREATE_LINK(ttlWin, tgen3);
+
+  tgen3->startWithTimestamps({ 1, 2, 3, 10 });
+  REQUIRE(tgen3->numProcessedTuples() == 4);
+  REQUIRE(tgen3->numOutdatedTuples() == 2);
+  REQUIRE(ttlWin->numKeys() == 1);
+}